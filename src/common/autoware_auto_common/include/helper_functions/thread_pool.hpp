@@ -0,0 +1,201 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+/// \file
+/// \brief This file defines a fixed-size worker pool for fork-join style parallel loops
+
+#ifndef HELPER_FUNCTIONS__THREAD_POOL_HPP_
+#define HELPER_FUNCTIONS__THREAD_POOL_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace autoware
+{
+namespace common
+{
+namespace helper_functions
+{
+/// \brief A fixed-size pool of worker threads which execute indexed tasks in fork-join fashion.
+///
+/// Threads are created once on construction and reused for every call to run(), so no threads are
+/// created and no memory is allocated per call. The calling thread takes part in the work, so a
+/// pool of size 1 runs everything on the calling thread.
+///
+/// Tasks are claimed dynamically by whichever thread is free. Results which must be reproducible
+/// should therefore be written per task index and combined by the caller in index order.
+class ThreadPool
+{
+public:
+  /// \brief Constructor
+  /// \param[in] num_threads The total number of threads working on a run(), including the
+  ///                        calling thread
+  /// \throw std::domain_error If num_threads is zero
+  explicit ThreadPool(const std::size_t num_threads)
+  : m_workers{},
+    m_mutex{},
+    m_work_cv{},
+    m_done_cv{},
+    m_generation{0U},
+    m_stop{false},
+    m_task_context{nullptr},
+    m_task_function{nullptr},
+    m_num_tasks{0U},
+    m_next_task{0U},
+    m_num_busy_workers{0U},
+    m_error{nullptr}
+  {
+    if (num_threads == 0U) {
+      throw std::domain_error{"ThreadPool: must have at least one thread"};
+    }
+    m_workers.reserve(num_threads - 1U);
+    for (std::size_t idx = 1U; idx < num_threads; ++idx) {
+      m_workers.emplace_back([this] {worker_loop();});
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool & operator=(const ThreadPool &) = delete;
+
+  /// \brief Destructor, joins all worker threads
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      m_stop = true;
+    }
+    m_work_cv.notify_all();
+    for (auto & worker : m_workers) {
+      worker.join();
+    }
+  }
+
+  /// \brief Get the number of threads working on a run(), including the calling thread
+  /// \return Number of threads
+  std::size_t size() const
+  {
+    return m_workers.size() + 1U;
+  }
+
+  /// \brief Call task(idx) for every idx in [0, num_tasks) and block until all calls returned.
+  ///        Must not be called concurrently or from within a task.
+  /// \param[in] num_tasks The number of tasks
+  /// \param[in] task A callable taking the task index as a std::size_t
+  /// \tparam TaskT The callable type
+  /// \throw Rethrows the first exception thrown by a task, after all tasks finished
+  template<typename TaskT>
+  void run(const std::size_t num_tasks, TaskT && task)
+  {
+    using TaskValueT = std::remove_reference_t<TaskT>;
+    if (m_workers.empty() || (num_tasks < 2U)) {
+      for (std::size_t idx = 0U; idx < num_tasks; ++idx) {
+        task(idx);
+      }
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      // Type-erase without std::function to avoid an allocation per call
+      m_task_context = const_cast<void *>(static_cast<const void *>(&task));
+      m_task_function = [](void * context, const std::size_t idx) {
+          (*static_cast<TaskValueT *>(context))(idx);
+        };
+      m_num_tasks = num_tasks;
+      m_next_task.store(0U);
+      m_num_busy_workers = m_workers.size();
+      m_error = nullptr;
+      ++m_generation;
+    }
+    m_work_cv.notify_all();
+    execute_tasks();
+    std::unique_lock<std::mutex> lock{m_mutex};
+    m_done_cv.wait(lock, [this] {return m_num_busy_workers == 0U;});
+    if (m_error) {
+      std::rethrow_exception(m_error);
+    }
+  }
+
+private:
+  using TaskFunction = void (*)(void *, std::size_t);
+
+  /// \brief Claim and execute tasks until none are left
+  void execute_tasks()
+  {
+    for (std::size_t idx = m_next_task.fetch_add(1U); idx < m_num_tasks;
+      idx = m_next_task.fetch_add(1U))
+    {
+      try {
+        m_task_function(m_task_context, idx);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        if (!m_error) {
+          m_error = std::current_exception();
+        }
+      }
+    }
+  }
+
+  void worker_loop()
+  {
+    uint64_t seen_generation = 0U;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_work_cv.wait(lock, [this, seen_generation] {
+            return m_stop || (m_generation != seen_generation);
+          });
+        if (m_stop) {
+          return;
+        }
+        seen_generation = m_generation;
+      }
+      execute_tasks();
+      bool notify = false;
+      {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        --m_num_busy_workers;
+        notify = (m_num_busy_workers == 0U);
+      }
+      if (notify) {
+        m_done_cv.notify_one();
+      }
+    }
+  }
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_work_cv;
+  std::condition_variable m_done_cv;
+  uint64_t m_generation;
+  bool m_stop;
+  void * m_task_context;
+  TaskFunction m_task_function;
+  std::size_t m_num_tasks;
+  std::atomic<std::size_t> m_next_task;
+  std::size_t m_num_busy_workers;
+  std::exception_ptr m_error;
+};  // class ThreadPool
+}  // namespace helper_functions
+}  // namespace common
+}  // namespace autoware
+
+#endif  // HELPER_FUNCTIONS__THREAD_POOL_HPP_
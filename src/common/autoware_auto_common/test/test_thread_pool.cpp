@@ -0,0 +1,70 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "helper_functions/thread_pool.hpp"
+
+using autoware::common::helper_functions::ThreadPool;
+
+TEST(ThreadPool, BadCases)
+{
+  EXPECT_THROW(ThreadPool{0U}, std::domain_error);
+}
+
+TEST(ThreadPool, RunsEveryTaskOnce)
+{
+  for (std::size_t num_threads = 1U; num_threads < 5U; ++num_threads) {
+    ThreadPool pool{num_threads};
+    EXPECT_EQ(pool.size(), num_threads);
+    std::vector<std::atomic<uint32_t>> counts(1000U);
+    for (auto & count : counts) {
+      count.store(0U);
+    }
+    // Reuse the pool several times, including with fewer tasks than threads
+    for (std::size_t num_tasks : {1000U, 3U, 0U, 1U, 1000U}) {
+      pool.run(num_tasks, [&counts](const std::size_t idx) {++counts[idx];});
+    }
+    EXPECT_EQ(counts[0U].load(), 4U);
+    EXPECT_EQ(counts[1U].load(), 3U);
+    EXPECT_EQ(counts[2U].load(), 3U);
+    for (std::size_t idx = 3U; idx < counts.size(); ++idx) {
+      EXPECT_EQ(counts[idx].load(), 2U);
+    }
+  }
+}
+
+TEST(ThreadPool, PropagatesException)
+{
+  ThreadPool pool{3U};
+  std::atomic<uint32_t> num_run{0U};
+  EXPECT_THROW(
+    pool.run(
+      100U, [&num_run](const std::size_t idx) {
+        ++num_run;
+        if (idx == 42U) {
+          throw std::runtime_error{"task failed"};
+        }
+      }),
+    std::runtime_error);
+  // Remaining tasks still run, and the pool stays usable
+  EXPECT_EQ(num_run.load(), 100U);
+  pool.run(10U, [&num_run](const std::size_t) {++num_run;});
+  EXPECT_EQ(num_run.load(), 110U);
+}
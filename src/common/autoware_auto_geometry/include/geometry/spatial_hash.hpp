@@ -22,9 +22,10 @@
 
 #include <common/types.hpp>
 #include <geometry/spatial_hash_config.hpp>
+#include <geometry/spatial_hash_storage.hpp>
 #include <geometry/visibility_control.hpp>
+#include <type_traits>
 #include <vector>
-#include <unordered_map>
 #include <utility>
 
 using autoware::common::types::float32_t;
@@ -43,6 +44,8 @@ namespace spatial_hash
 /// \brief An implementation of the spatial hash or integer lattice data structure for efficient
 ///        (O(1)) near neighbor queries.
 /// \tparam PointT The point type stored in this data structure. Must have float members x, y, and z
+/// \tparam ConfigT The configuration type. Determines the dimensionality of queries and, via its
+///                 Layout member type, how points are stored
 ///
 /// This implementation can support both 2D and 3D queries
 /// (though only one type per data structure), and can support queries of varying radius. This data
@@ -53,12 +56,12 @@ class GEOMETRY_PUBLIC SpatialHashBase
   using Index3 = details::Index3;
   //lint -e{9131} NOLINT There's no other way to make this work in a static assert
   static_assert(
-    std::is_same<ConfigT, Config2d>::value || std::is_same<ConfigT, Config3d>::value,
+    std::is_base_of<Config2d, ConfigT>::value || std::is_base_of<Config3d, ConfigT>::value,
     "SpatialHash only works with Config2d or Config3d");
 
 public:
-  using Hash = std::unordered_multimap<Index, PointT>;
-  using IT = typename Hash::const_iterator;
+  using Hash = typename details::StorageSelector<PointT, typename ConfigT::Layout>::type;
+  using IT = typename Hash::IT;
   /// \brief Wrapper around an iterator and a distance (from some query point)
   class Output
   {
@@ -112,7 +115,7 @@ private:
   /// \param[in] cfg The configuration object for this class
   explicit SpatialHashBase(const ConfigT & cfg)
   : m_config{cfg},
-    m_hash(),
+    m_hash(cfg.get_num_bins(), cfg.get_capacity()),
     m_neighbors{},  // TODO(c.ho) reserve, but there's no default constructor for output
     m_bins_hit{},  // zero initialization (and below)
     m_neighbors_found{}
@@ -159,9 +162,6 @@ private:
   /// should be used with care and only on valid iterators
   IT erase(const IT point)
   {
-    if (end() == m_hash.find(point->first)) {
-      throw std::domain_error{"SpatialHash: Attempting to erase invalid iterator"};
-    }
     return m_hash.erase(point);
   }
 
@@ -246,6 +246,8 @@ protected:
   {
     // reset output
     m_neighbors.clear();
+    // Flat storage groups newly inserted points by bin here
+    m_hash.finalize();
     // Compute bin, bin range
     const Index3 ref_idx = m_config.index3(x, y, z);
     const float32_t radius2 = radius * radius;
@@ -284,7 +286,7 @@ private:
     const Index idx =
       m_config.bin(point_adapter::x_(pt), point_adapter::y_(pt), point_adapter::z_(pt));
     // Insert into bin
-    return m_hash.insert(std::make_pair(idx, pt));
+    return m_hash.insert(idx, pt);
   }
 
   const ConfigT m_config;
@@ -298,19 +300,23 @@ private:
 /// apex_app::common::geometry::spatial_hash::SpatialHashBase to provide different function
 /// signatures on 2D and 3D configurations
 /// \tparam PointT The point type stored in this data structure. Must have float members x, y and z
-template<typename PointT, typename ConfigT>
+/// \tparam ConfigT The configuration type, Config2d, Config3d, or a type derived from them
+template<typename PointT, typename ConfigT, typename Enable = void>
 class GEOMETRY_PUBLIC SpatialHash;
 
-/// \brief Explicit specialization of SpatialHash for 2D configuration
+/// \brief Partial specialization of SpatialHash for 2D configurations
 /// \tparam PointT The point type stored in this data structure.
-template<typename PointT>
-class GEOMETRY_PUBLIC SpatialHash<PointT, Config2d>: public SpatialHashBase<PointT, Config2d>
+/// \tparam ConfigT Config2d or a type derived from it
+template<typename PointT, typename ConfigT>
+class GEOMETRY_PUBLIC SpatialHash<PointT, ConfigT,
+  std::enable_if_t<std::is_base_of<Config2d, ConfigT>::value>>
+  : public SpatialHashBase<PointT, ConfigT>
 {
 public:
-  using OutputVector = typename SpatialHashBase<PointT, Config2d>::OutputVector;
+  using OutputVector = typename SpatialHashBase<PointT, ConfigT>::OutputVector;
 
-  explicit SpatialHash(const Config2d & cfg)
-  : SpatialHashBase<PointT, Config2d>(cfg) {}
+  explicit SpatialHash(const ConfigT & cfg)
+  : SpatialHashBase<PointT, ConfigT>(cfg) {}
 
   /// \brief Finds all points within a fixed radius of a reference point
   /// \param[in] x The x component of the reference point
@@ -337,16 +343,19 @@ public:
   }
 };
 
-/// \brief Explicit specialization of SpatialHash for 3D configuration
+/// \brief Partial specialization of SpatialHash for 3D configurations
 /// \tparam PointT The point type stored in this data structure. Must have float members x, y and z
-template<typename PointT>
-class GEOMETRY_PUBLIC SpatialHash<PointT, Config3d>: public SpatialHashBase<PointT, Config3d>
+/// \tparam ConfigT Config3d or a type derived from it
+template<typename PointT, typename ConfigT>
+class GEOMETRY_PUBLIC SpatialHash<PointT, ConfigT,
+  std::enable_if_t<std::is_base_of<Config3d, ConfigT>::value>>
+  : public SpatialHashBase<PointT, ConfigT>
 {
 public:
-  using OutputVector = typename SpatialHashBase<PointT, Config3d>::OutputVector;
+  using OutputVector = typename SpatialHashBase<PointT, ConfigT>::OutputVector;
 
-  explicit SpatialHash(const Config3d & cfg)
-  : SpatialHashBase<PointT, Config3d>(cfg) {}
+  explicit SpatialHash(const ConfigT & cfg)
+  : SpatialHashBase<PointT, ConfigT>(cfg) {}
 
   /// \brief Finds all points within a fixed radius of a reference point
   /// \param[in] x The x component of the reference point
@@ -382,6 +391,10 @@ template<typename T>
 using SpatialHash2d = SpatialHash<T, Config2d>;
 template<typename T>
 using SpatialHash3d = SpatialHash<T, Config3d>;
+template<typename T>
+using FlatSpatialHash2d = SpatialHash<T, FlatConfig2d>;
+template<typename T>
+using FlatSpatialHash3d = SpatialHash<T, FlatConfig3d>;
 }  // namespace spatial_hash
 }  // namespace geometry
 }  // namespace common
@@ -64,6 +64,11 @@ struct GEOMETRY_PUBLIC Index3
 };  // struct Index3
 
 using BinRange = std::pair<Index3, Index3>;
+
+/// \brief Layout tag: points are stored in a node-based std::unordered_multimap
+struct GEOMETRY_PUBLIC MultimapLayout {};
+/// \brief Layout tag: points are counting-sorted by bin into one contiguous array
+struct GEOMETRY_PUBLIC FlatLayout {};
 }  // namespace details
 
 /// \brief The base class for the configuration object for the SpatialHash class
@@ -182,6 +187,13 @@ public:
     return m_capacity;
   }
 
+  /// \brief Get the total number of bins of the lattice
+  /// \return The number of bins
+  Index get_num_bins() const
+  {
+    return m_z_stride * (m_max_z_idx + 1U);
+  }
+
   /// \brief Getter for the side length, equivalently the lookup radius
   float32_t radius2() const
   {
@@ -355,6 +367,8 @@ private:
 class GEOMETRY_PUBLIC Config2d : public Config<Config2d>
 {
 public:
+  /// \brief Points are stored in an std::unordered_multimap
+  using Layout = details::MultimapLayout;
   /// \brief Config constructor for 2D spatial hash
   /// \param[in] min_x The minimum x value for the spatial hash
   /// \param[in] max_x The maximum x value for the spatial hash
@@ -421,6 +435,8 @@ public:
 class GEOMETRY_PUBLIC Config3d : public Config<Config3d>
 {
 public:
+  /// \brief Points are stored in an std::unordered_multimap
+  using Layout = details::MultimapLayout;
   /// \brief Config constructor for a 3d spatial hash
   /// \param[in] min_x The minimum x value for the spatial hash
   /// \param[in] max_x The maximum x value for the spatial hash
@@ -486,6 +502,29 @@ public:
     return (dx * dx) + (dy * dy) + (dz * dz);
   }
 };  // class Config3d
+
+/// \brief Configuration class for a 2d spatial hash backed by a flat, counting-sorted point array.
+///
+/// Memory for all points and a dense offset table over all bins is allocated on construction, so
+/// insertion never allocates. Points are grouped by bin on the first query after an insertion,
+/// which makes this layout best suited to inserting a whole scan at once and then querying it.
+class GEOMETRY_PUBLIC FlatConfig2d : public Config2d
+{
+public:
+  using Config2d::Config2d;
+  /// \brief Points are stored in a flat array, grouped by bin
+  using Layout = details::FlatLayout;
+};  // class FlatConfig2d
+
+/// \brief Configuration class for a 3d spatial hash backed by a flat, counting-sorted point array.
+///        See FlatConfig2d.
+class GEOMETRY_PUBLIC FlatConfig3d : public Config3d
+{
+public:
+  using Config3d::Config3d;
+  /// \brief Points are stored in a flat array, grouped by bin
+  using Layout = details::FlatLayout;
+};  // class FlatConfig3d
 }  // namespace spatial_hash
 }  // namespace geometry
 }  // namespace common
@@ -0,0 +1,376 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+/// \file
+/// \brief This file implements the point storage backends used by the spatial hash
+
+#ifndef GEOMETRY__SPATIAL_HASH_STORAGE_HPP_
+#define GEOMETRY__SPATIAL_HASH_STORAGE_HPP_
+
+#include <common/types.hpp>
+#include <geometry/spatial_hash_config.hpp>
+#include <geometry/visibility_control.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace autoware
+{
+namespace common
+{
+namespace geometry
+{
+namespace spatial_hash
+{
+namespace details
+{
+
+/// \brief Storage backend which keeps points in a node-based std::unordered_multimap. Supports
+///        cheap interleaving of insertions and queries at the cost of one allocation per point.
+/// \tparam PointT The point type stored in this data structure
+template<typename PointT>
+class GEOMETRY_PUBLIC MultimapStorage
+{
+public:
+  using Hash = std::unordered_multimap<Index, PointT>;
+  using IT = typename Hash::const_iterator;
+
+  /// \brief Constructor
+  /// \param[in] num_bins The number of bins of the lattice, unused
+  /// \param[in] capacity The maximum number of points
+  MultimapStorage(const Index num_bins, const Index capacity)
+  : m_hash()
+  {
+    (void)num_bins;
+    (void)capacity;
+  }
+
+  /// \brief Store a point in the specified bin
+  /// \param[in] bin The bin index of the point
+  /// \param[in] pt The point to store
+  /// \return Iterator pointing to the stored point
+  IT insert(const Index bin, const PointT & pt)
+  {
+    return m_hash.insert(std::make_pair(bin, pt));
+  }
+
+  /// \brief Removes the specified element
+  /// \param[in] point An iterator pointing to the point to be removed
+  /// \return An iterator pointing to the element after the erased element
+  /// \throw std::domain_error If point does not belong to this data structure
+  IT erase(const IT point)
+  {
+    if (end() == m_hash.find(point->first)) {
+      throw std::domain_error{"SpatialHash: Attempting to erase invalid iterator"};
+    }
+    return m_hash.erase(point);
+  }
+
+  /// \brief Prepare the storage for queries; a no-op for this backend
+  void finalize() {}
+
+  /// \brief Get all points stored in a bin
+  /// \param[in] bin The bin index
+  /// \return A pair of iterators delimiting the points in the bin
+  std::pair<IT, IT> equal_range(const Index bin) const
+  {
+    return m_hash.equal_range(bin);
+  }
+
+  /// \brief Remove all points
+  void clear()
+  {
+    m_hash.clear();
+  }
+  /// \brief Get number of stored points
+  Index size() const
+  {
+    return m_hash.size();
+  }
+  /// \brief Whether there are no stored points
+  bool8_t empty() const
+  {
+    return m_hash.empty();
+  }
+  /// \brief Get iterator to the first point
+  IT begin() const
+  {
+    return m_hash.begin();
+  }
+  /// \brief Get iterator past the last point
+  IT end() const
+  {
+    return m_hash.end();
+  }
+
+private:
+  Hash m_hash;
+};  // class MultimapStorage
+
+/// \brief Storage backend which keeps all points in one contiguous array, grouped by bin using a
+///        counting sort (compressed sparse row layout). All memory is allocated up front.
+///
+/// Points are appended on insertion and bucketed lazily on the first query following one or more
+/// insertions. This is intended for the build-once, query-many usage pattern of per-scan
+/// processing. Erased points are marked with an invalid bin index and skipped by iterators; they
+/// are compacted away on the next bucketing pass.
+/// \tparam PointT The point type stored in this data structure
+template<typename PointT>
+class GEOMETRY_PUBLIC FlatStorage
+{
+public:
+  using value_type = std::pair<Index, PointT>;
+
+  /// \brief Forward iterator over live points which skips erased entries
+  class ConstIterator
+  {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = typename FlatStorage::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    ConstIterator() = default;
+    /// \brief Constructor
+    /// \param[in] ptr The element pointed to, advanced to the first live element
+    /// \param[in] last One past the last element this iterator may visit
+    ConstIterator(const pointer ptr, const pointer last)
+    : m_ptr{ptr},
+      m_last{last}
+    {
+      skip_erased();
+    }
+    reference operator*() const
+    {
+      return *m_ptr;
+    }
+    pointer operator->() const
+    {
+      return m_ptr;
+    }
+    ConstIterator & operator++()
+    {
+      ++m_ptr;
+      skip_erased();
+      return *this;
+    }
+    ConstIterator operator++(int)
+    {
+      ConstIterator ret{*this};
+      ++(*this);
+      return ret;
+    }
+    bool8_t operator==(const ConstIterator & rhs) const
+    {
+      return m_ptr == rhs.m_ptr;
+    }
+    bool8_t operator!=(const ConstIterator & rhs) const
+    {
+      return m_ptr != rhs.m_ptr;
+    }
+
+private:
+    void skip_erased()
+    {
+      while ((m_ptr != m_last) && (INVALID_BIN == m_ptr->first)) {
+        ++m_ptr;
+      }
+    }
+    pointer m_ptr{nullptr};
+    pointer m_last{nullptr};
+  };  // class ConstIterator
+  using IT = ConstIterator;
+
+  /// \brief Constructor
+  /// \param[in] num_bins The number of bins of the lattice
+  /// \param[in] capacity The maximum number of points
+  FlatStorage(const Index num_bins, const Index capacity)
+  : m_points{},
+    m_scratch{},
+    m_offsets(num_bins + 1U, Index{}),
+    m_num_alive{},
+    m_first_alive{},
+    m_dirty{false}
+  {
+    m_points.reserve(capacity);
+    m_scratch.reserve(capacity);
+  }
+
+  /// \brief Store a point in the specified bin
+  /// \param[in] bin The bin index of the point
+  /// \param[in] pt The point to store
+  /// \return Iterator pointing to the stored point, invalidated by the next query
+  IT insert(const Index bin, const PointT & pt)
+  {
+    // Reclaim slots of erased points rather than growing past the preallocated capacity
+    if (m_points.size() >= m_points.capacity()) {
+      bucket();
+    }
+    m_points.emplace_back(bin, pt);
+    ++m_num_alive;
+    m_dirty = true;
+    return IT{&m_points.back(), data_end()};
+  }
+
+  /// \brief Removes the specified element. Other iterators remain valid.
+  /// \param[in] point An iterator pointing to the point to be removed
+  /// \return An iterator pointing to the element after the erased element
+  /// \throw std::domain_error If point is erased or does not belong to this data structure
+  IT erase(const IT point)
+  {
+    const value_type * const ptr = point.operator->();
+    if ((ptr < m_points.data()) || (ptr >= data_end()) || (INVALID_BIN == ptr->first)) {
+      throw std::domain_error{"SpatialHash: Attempting to erase invalid iterator"};
+    }
+    const Index idx = static_cast<Index>(ptr - m_points.data());
+    m_points[idx].first = INVALID_BIN;
+    --m_num_alive;
+    // Everything before m_first_alive is erased, so begin() never rescans the same prefix
+    if (idx == m_first_alive) {
+      while ((m_first_alive < m_points.size()) && (INVALID_BIN == m_points[m_first_alive].first)) {
+        ++m_first_alive;
+      }
+    }
+    return IT{ptr + 1, data_end()};
+  }
+
+  /// \brief Group points by bin if any were inserted since the last call. Invalidates iterators.
+  void finalize()
+  {
+    if (m_dirty) {
+      bucket();
+    }
+  }
+
+  /// \brief Get all points stored in a bin; only meaningful after finalize()
+  /// \param[in] bin The bin index
+  /// \return A pair of iterators delimiting the points in the bin
+  std::pair<IT, IT> equal_range(const Index bin) const
+  {
+    const value_type * const first = m_points.data() + m_offsets[bin];
+    const value_type * const last = m_points.data() + m_offsets[bin + 1U];
+    return std::make_pair(IT{first, last}, IT{last, last});
+  }
+
+  /// \brief Remove all points
+  void clear()
+  {
+    m_points.clear();
+    m_num_alive = Index{};
+    m_first_alive = Index{};
+    // Bin offsets are stale; rebuild them on the next query
+    m_dirty = true;
+  }
+  /// \brief Get number of stored points
+  Index size() const
+  {
+    return m_num_alive;
+  }
+  /// \brief Whether there are no stored points
+  bool8_t empty() const
+  {
+    return Index{} == m_num_alive;
+  }
+  /// \brief Get iterator to the first point
+  IT begin() const
+  {
+    return IT{m_points.data() + m_first_alive, data_end()};
+  }
+  /// \brief Get iterator past the last point
+  IT end() const
+  {
+    return IT{data_end(), data_end()};
+  }
+
+private:
+  static constexpr Index INVALID_BIN = std::numeric_limits<Index>::max();
+
+  const value_type * data_end() const
+  {
+    return m_points.data() + m_points.size();
+  }
+
+  /// \brief Stable counting sort of live points by bin, dropping erased points
+  void bucket()
+  {
+    const Index num_bins = m_offsets.size() - 1U;
+    // Histogram, shifted by one so the prefix sum yields the start offset of each bin
+    std::fill(m_offsets.begin(), m_offsets.end(), Index{});
+    for (const auto & pt : m_points) {
+      if (INVALID_BIN != pt.first) {
+        ++m_offsets[pt.first + 1U];
+      }
+    }
+    for (Index idx = 1U; idx <= num_bins; ++idx) {
+      m_offsets[idx] += m_offsets[idx - 1U];
+    }
+    // Scatter; this advances each bin's offset to the start of the following bin
+    m_scratch.resize(m_num_alive);
+    for (const auto & pt : m_points) {
+      if (INVALID_BIN != pt.first) {
+        m_scratch[m_offsets[pt.first]] = pt;
+        ++m_offsets[pt.first];
+      }
+    }
+    // Shift back so that m_offsets[bin] is again the start of bin
+    for (Index idx = num_bins; idx > 0U; --idx) {
+      m_offsets[idx] = m_offsets[idx - 1U];
+    }
+    m_offsets[0U] = Index{};
+    std::swap(m_points, m_scratch);
+    m_first_alive = Index{};
+    m_dirty = false;
+  }
+
+  std::vector<value_type> m_points;
+  std::vector<value_type> m_scratch;
+  std::vector<Index> m_offsets;
+  Index m_num_alive;
+  Index m_first_alive;
+  bool8_t m_dirty;
+};  // class FlatStorage
+
+template<typename PointT>
+constexpr Index FlatStorage<PointT>::INVALID_BIN;
+
+/// \brief Select the storage backend for a given point type and spatial hash layout tag
+template<typename PointT, typename LayoutT>
+struct StorageSelector;
+
+template<typename PointT>
+struct StorageSelector<PointT, MultimapLayout>
+{
+  using type = MultimapStorage<PointT>;
+};
+
+template<typename PointT>
+struct StorageSelector<PointT, FlatLayout>
+{
+  using type = FlatStorage<PointT>;
+};
+}  // namespace details
+}  // namespace spatial_hash
+}  // namespace geometry
+}  // namespace common
+}  // namespace autoware
+
+#endif  // GEOMETRY__SPATIAL_HASH_STORAGE_HPP_
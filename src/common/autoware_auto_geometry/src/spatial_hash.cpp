@@ -112,6 +112,8 @@ Index Config3d::index_(const details::Index3 & idx) const
 ////////////////////////////////////////////////////////////////////////////////
 template class SpatialHash<geometry_msgs::msg::Point32, Config2d>;
 template class SpatialHash<geometry_msgs::msg::Point32, Config3d>;
+template class SpatialHash<geometry_msgs::msg::Point32, FlatConfig2d>;
+template class SpatialHash<geometry_msgs::msg::Point32, FlatConfig3d>;
 }  // namespace spatial_hash
 }  // namespace geometry
 }  // namespace common
@@ -18,6 +18,8 @@
 #define TEST_SPATIAL_HASH_HPP_
 
 #include <geometry_msgs/msg/point32.hpp>
+#include <algorithm>
+#include <random>
 #include <vector>
 #include <limits>
 #include "geometry/spatial_hash.hpp"
@@ -27,9 +29,13 @@ using autoware::common::types::float64_t;
 using autoware::common::types::bool8_t;
 using autoware::common::geometry::spatial_hash::Config2d;
 using autoware::common::geometry::spatial_hash::Config3d;
+using autoware::common::geometry::spatial_hash::FlatConfig2d;
+using autoware::common::geometry::spatial_hash::FlatConfig3d;
 using autoware::common::geometry::spatial_hash::SpatialHash;
 using autoware::common::geometry::spatial_hash::SpatialHash2d;
 using autoware::common::geometry::spatial_hash::SpatialHash3d;
+using autoware::common::geometry::spatial_hash::FlatSpatialHash2d;
+using autoware::common::geometry::spatial_hash::FlatSpatialHash3d;
 
 template<typename PointT>
 class TypedSpatialHashTest : public ::testing::Test
@@ -230,6 +236,100 @@ TYPED_TEST(TypedSpatialHashTest, 3d)
   EXPECT_EQ(count, 0U);
 }
 
+/// Sorted coordinates of all neighbors, for comparing results across storage layouts
+template<typename OutputVectorT>
+std::vector<std::vector<float32_t>> sorted_neighbors(const OutputVectorT & nbrs)
+{
+  std::vector<std::vector<float32_t>> ret{};
+  for (const auto & itd : nbrs) {
+    const geometry_msgs::msg::Point32 & pt = itd;
+    ret.push_back({pt.x, pt.y, pt.z, itd.get_distance()});
+  }
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
+
+/// flat layout should find exactly the same neighbors as the multimap layout
+TEST(FlatSpatialHash, MatchesMultimap)
+{
+  using PointT = geometry_msgs::msg::Point32;
+  std::mt19937 gen{1234U};
+  std::uniform_real_distribution<float32_t> dist{-25.0F, 25.0F};
+  SpatialHash2d<PointT> hash2{Config2d{-20.0F, 20.0F, -20.0F, 20.0F, 1.5F, 2000U}};
+  FlatSpatialHash2d<PointT> flat2{FlatConfig2d{-20.0F, 20.0F, -20.0F, 20.0F, 1.5F, 2000U}};
+  SpatialHash3d<PointT> hash3{Config3d{-20.0F, 20.0F, -20.0F, 20.0F, -5.0F, 5.0F, 1.5F, 2000U}};
+  FlatSpatialHash3d<PointT> flat3{
+    FlatConfig3d{-20.0F, 20.0F, -20.0F, 20.0F, -5.0F, 5.0F, 1.5F, 2000U}};
+  std::vector<PointT> pts{};
+  for (uint32_t idx = 0U; idx < 2000U; ++idx) {
+    PointT pt;
+    pt.x = dist(gen);
+    pt.y = dist(gen);
+    pt.z = dist(gen) * 0.2F;
+    pts.push_back(pt);
+  }
+  hash2.insert(pts.begin(), pts.end());
+  flat2.insert(pts.begin(), pts.end());
+  hash3.insert(pts.begin(), pts.end());
+  flat3.insert(pts.begin(), pts.end());
+  EXPECT_EQ(flat2.size(), hash2.size());
+  EXPECT_EQ(flat3.size(), hash3.size());
+  for (uint32_t idx = 0U; idx < 100U; ++idx) {
+    const PointT & ref = pts[idx * 20U];
+    const float32_t radius = 0.5F + (0.05F * static_cast<float32_t>(idx));
+    const auto expected2 = sorted_neighbors(hash2.near(ref, radius));
+    ASSERT_FALSE(expected2.empty());
+    EXPECT_EQ(sorted_neighbors(flat2.near(ref, radius)), expected2);
+    const auto expected3 = sorted_neighbors(hash3.near(ref, radius));
+    ASSERT_FALSE(expected3.empty());
+    EXPECT_EQ(sorted_neighbors(flat3.near(ref, radius)), expected3);
+  }
+  EXPECT_EQ(flat2.bins_hit(), hash2.bins_hit());
+  EXPECT_EQ(flat2.neighbors_found(), hash2.neighbors_found());
+}
+
+/// erased points should no longer be visible through queries or iteration
+TEST(FlatSpatialHash, EraseAndReuse)
+{
+  using PointT = geometry_msgs::msg::Point32;
+  FlatSpatialHash2d<PointT> hash{FlatConfig2d{-10.0F, 10.0F, -10.0F, 10.0F, 1.0F, 100U}};
+  PointT ref;
+  for (uint32_t idx = 0U; idx < 100U; ++idx) {
+    PointT pt;
+    pt.x = -9.5F + (0.19F * static_cast<float32_t>(idx));
+    pt.y = 0.5F;
+    hash.insert(pt);
+  }
+  EXPECT_THROW(hash.insert(ref), std::length_error);
+  ref.x = 0.0F;
+  ref.y = 0.0F;
+  // Erase everything near the origin, as clustering does
+  const auto nbrs = hash.near(ref, 2.0F);
+  ASSERT_FALSE(nbrs.empty());
+  for (const auto & itd : nbrs) {
+    (void)hash.erase(itd);
+  }
+  EXPECT_THROW(hash.erase(nbrs.front()), std::domain_error);
+  EXPECT_EQ(hash.size(), 100U - nbrs.size());
+  EXPECT_TRUE(hash.near(ref, 2.0F).empty());
+  EXPECT_EQ(hash.near(ref, 3.0F).size(), 10U);
+  EXPECT_EQ(static_cast<std::size_t>(std::distance(hash.begin(), hash.end())), hash.size());
+  // Repeatedly erase the first point, as the cluster seeding does
+  while (!hash.empty()) {
+    (void)hash.erase(hash.begin());
+  }
+  EXPECT_EQ(hash.begin(), hash.end());
+  EXPECT_TRUE(hash.near(ref, 20.0F).empty());
+  // Slots of erased points are reclaimed
+  for (uint32_t idx = 0U; idx < 100U; ++idx) {
+    hash.insert(ref);
+  }
+  EXPECT_EQ(hash.near(ref, 1.0F).size(), 100U);
+  hash.clear();
+  EXPECT_TRUE(hash.empty());
+  EXPECT_TRUE(hash.near(ref, 1.0F).empty());
+}
+
 /// edge cases
 TEST(SpatialHashConfig, BadCases)
 {
@@ -17,7 +17,12 @@
 
 #include <autoware_auto_mapping_msgs/msg/had_map_bin.hpp>
 #include <lanelet2_core/LaneletMap.h>
+#include <boost/optional.hpp>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
+#include "had_map_utils/had_map_flat_format.hpp"
 #include "had_map_utils/visibility_control.hpp"
 
 namespace autoware
@@ -31,10 +36,73 @@ void HAD_MAP_UTILS_PUBLIC toBinaryMsg(
   const std::shared_ptr<lanelet::LaneletMap> & map,
   autoware_auto_mapping_msgs::msg::HADMapBin & msg);
 
+/// \brief Fill a map from a binary message. Both the boost archive written by toBinaryMsg
+/// and the flat format written by toFlatBinaryMsg are accepted, the format is detected from
+/// the message content.
+/// \throw std::runtime_error if a flat map message fails validation
 void HAD_MAP_UTILS_PUBLIC fromBinaryMsg(
   const autoware_auto_mapping_msgs::msg::HADMapBin & msg,
   std::shared_ptr<lanelet::LaneletMap> & map);
 
+/// \brief Serialize a map into the flat format, see had_map_flat_format.hpp
+/// \param[in] map Map to serialize
+/// \param[out] out Flat map buffer
+void HAD_MAP_UTILS_PUBLIC serializeFlatMap(
+  lanelet::LaneletMap & map,
+  std::vector<std::uint8_t> & out);
+
+/// \brief Like toBinaryMsg, but writes the flat format that can be read in place
+void HAD_MAP_UTILS_PUBLIC toFlatBinaryMsg(
+  const std::shared_ptr<lanelet::LaneletMap> & map,
+  autoware_auto_mapping_msgs::msg::HADMapBin & msg);
+
+/// \brief Write a map in the flat format to a file that can be opened with MappedFlatMapFile
+/// \throw std::runtime_error if the file cannot be written
+void HAD_MAP_UTILS_PUBLIC writeFlatMapFile(
+  lanelet::LaneletMap & map,
+  const std::string & path);
+
+/// \brief Creates lanelet primitives from a flat map on demand.
+///
+/// Every primitive is built at most once and shared afterwards, so primitives referring to
+/// the same point or line string end up sharing it like in the original map. Lanelets and
+/// areas that are only reached through a rule parameter of a regulatory element are created
+/// without their own regulatory elements; those are attached once the lanelet or area is
+/// requested through lanelet() or area(). The view has to outlive the materializer.
+class HAD_MAP_UTILS_PUBLIC FlatMapMaterializer
+{
+public:
+  explicit FlatMapMaterializer(const FlatMapView & view);
+
+  /// \brief Get a primitive by its index in the view, e.g. from FlatMapView::findLanelet
+  /// \throw std::out_of_range if the index is invalid
+  lanelet::Point3d point(const std::uint32_t index);
+  lanelet::LineString3d lineString(const std::uint32_t index);
+  lanelet::Polygon3d polygon(const std::uint32_t index);
+  lanelet::Lanelet lanelet(const std::uint32_t index);
+  lanelet::Area area(const std::uint32_t index);
+  lanelet::RegulatoryElementPtr regulatoryElement(const std::uint32_t index);
+
+  /// \brief Materialize everything and add it to a map
+  void addTo(lanelet::LaneletMap & map);
+
+private:
+  lanelet::AttributeMap attributes(const FlatRange & range) const;
+  lanelet::LineString3d bound(const FlatBoundRef & ref);
+  lanelet::Lanelet laneletWithoutRules(const std::uint32_t index);
+  lanelet::Area areaWithoutRules(const std::uint32_t index);
+
+  const FlatMapView & m_view;
+  std::vector<boost::optional<lanelet::Point3d>> m_points;
+  std::vector<boost::optional<lanelet::LineString3d>> m_line_strings;
+  std::vector<boost::optional<lanelet::Polygon3d>> m_polygons;
+  std::vector<boost::optional<lanelet::Lanelet>> m_lanelets;
+  std::vector<boost::optional<lanelet::Area>> m_areas;
+  std::vector<lanelet::RegulatoryElementPtr> m_regulatory_elements;
+  std::vector<bool8_t> m_lanelet_rules_attached;
+  std::vector<bool8_t> m_area_rules_attached;
+};
+
 }  // namespace had_map_utils
 }  // namespace common
 }  // namespace autoware
@@ -0,0 +1,366 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+/// \file
+/// \brief Flat, offset based binary layout for lanelet2 maps.
+///
+/// A flat map is a single contiguous buffer: a fixed header followed by one array per
+/// primitive type. Primitives refer to each other by array index, and every array of
+/// primitives carrying an id is sorted by that id. The buffer can therefore be read in
+/// place, e.g. directly from HADMapBin::data or from a memory mapped file, without any
+/// parsing pass. Nothing in this file depends on lanelet2; conversion to and from
+/// lanelet objects lives in had_map_conversion.hpp.
+
+#ifndef HAD_MAP_UTILS__HAD_MAP_FLAT_FORMAT_HPP_
+#define HAD_MAP_UTILS__HAD_MAP_FLAT_FORMAT_HPP_
+
+#include <common/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "had_map_utils/visibility_control.hpp"
+
+namespace autoware
+{
+namespace common
+{
+namespace had_map_utils
+{
+
+using autoware::common::types::bool8_t;
+
+/// Magic bytes at the start of every flat map buffer
+constexpr char kFlatMapMagic[8] = {'A', 'W', 'F', 'L', 'A', 'T', 'L', 'L'};
+/// Layout version, bumped on every incompatible change of the records below
+constexpr std::uint32_t kFlatMapVersion = 1U;
+/// Marker for an absent optional index, e.g. a lanelet without a custom centerline
+constexpr std::uint32_t kFlatInvalidIndex = 0xFFFFFFFFU;
+/// Flag set on points and line strings that are part of the map layers. Cleared for
+/// primitives that are only owned by another primitive, e.g. custom centerlines.
+constexpr std::uint32_t kFlatInLayer = 1U;
+
+/// Arrays stored in a flat map, in buffer order
+enum class FlatSectionId : std::uint32_t
+{
+  STRINGS = 0U,  ///< Character data, count is in bytes
+  ATTRIBUTES,  ///< FlatAttribute
+  POINTS,  ///< FlatPoint
+  POINT_INDICES,  ///< std::uint32_t, into POINTS
+  LINE_STRINGS,  ///< FlatLineString
+  POLYGONS,  ///< FlatLineString
+  BOUND_REFS,  ///< FlatBoundRef, into LINE_STRINGS
+  BOUND_RANGES,  ///< FlatRange, into BOUND_REFS (inner bounds of areas)
+  LANELETS,  ///< FlatLanelet
+  AREAS,  ///< FlatArea
+  REGULATORY_ELEMENTS,  ///< FlatRegulatoryElement
+  RULE_PARAMETERS,  ///< FlatRuleParameter
+  REGULATORY_ELEMENT_INDICES,  ///< std::uint32_t, into REGULATORY_ELEMENTS
+  COUNT
+};
+constexpr std::size_t kFlatSectionCount = static_cast<std::size_t>(FlatSectionId::COUNT);
+
+/// Location of a string in the STRINGS section
+struct FlatStringRef
+{
+  std::uint32_t offset;
+  std::uint32_t size;
+};
+
+/// Contiguous run of elements in another section
+struct FlatRange
+{
+  std::uint32_t begin;
+  std::uint32_t size;
+};
+
+struct FlatAttribute
+{
+  FlatStringRef key;
+  FlatStringRef value;
+};
+
+struct FlatPoint
+{
+  std::int64_t id;
+  double x;
+  double y;
+  double z;
+  FlatRange attributes;
+  std::uint32_t flags;
+  std::uint32_t reserved;
+};
+
+/// Line strings and polygons share their layout
+struct FlatLineString
+{
+  std::int64_t id;
+  FlatRange points;  ///< into POINT_INDICES
+  FlatRange attributes;
+  std::uint32_t flags;
+  std::uint32_t reserved;
+};
+
+/// Reference to a line string as used by a lanelet or area, possibly inverted
+struct FlatBoundRef
+{
+  std::uint32_t line_string;
+  std::uint32_t inverted;
+};
+
+struct FlatLanelet
+{
+  std::int64_t id;
+  FlatBoundRef left;
+  FlatBoundRef right;
+  FlatRange attributes;
+  FlatRange regulatory_elements;  ///< into REGULATORY_ELEMENT_INDICES
+  std::uint32_t centerline;  ///< into LINE_STRINGS or kFlatInvalidIndex
+  std::uint32_t reserved;
+};
+
+struct FlatArea
+{
+  std::int64_t id;
+  FlatRange outer;  ///< into BOUND_REFS
+  FlatRange inner;  ///< into BOUND_RANGES
+  FlatRange attributes;
+  FlatRange regulatory_elements;  ///< into REGULATORY_ELEMENT_INDICES
+};
+
+struct FlatRegulatoryElement
+{
+  std::int64_t id;
+  FlatRange attributes;
+  FlatRange parameters;  ///< into RULE_PARAMETERS
+};
+
+/// Primitive type referenced by a rule parameter
+enum class FlatParameterType : std::uint16_t
+{
+  POINT = 0U,
+  LINE_STRING,
+  POLYGON,
+  LANELET,
+  AREA,
+  COUNT
+};
+
+struct FlatRuleParameter
+{
+  FlatStringRef role;
+  std::uint16_t type;  ///< FlatParameterType
+  std::uint16_t inverted;
+  std::uint32_t index;  ///< into the section matching type
+};
+
+struct FlatSection
+{
+  std::uint64_t offset;  ///< from the start of the buffer, 8 byte aligned
+  std::uint64_t count;  ///< number of elements
+};
+
+struct FlatHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t section_count;
+  std::int64_t id_counter;  ///< lanelet id counter at the time of serialization
+  FlatSection sections[kFlatSectionCount];
+};
+
+static_assert(sizeof(FlatPoint) == 48U, "FlatPoint layout changed");
+static_assert(sizeof(FlatLineString) == 32U, "FlatLineString layout changed");
+static_assert(sizeof(FlatLanelet) == 48U, "FlatLanelet layout changed");
+static_assert(sizeof(FlatArea) == 40U, "FlatArea layout changed");
+static_assert(sizeof(FlatRegulatoryElement) == 24U, "FlatRegulatoryElement layout changed");
+static_assert(sizeof(FlatRuleParameter) == 16U, "FlatRuleParameter layout changed");
+
+/// \brief Read only array referring into a flat map buffer
+template<typename T>
+class FlatArray
+{
+public:
+  FlatArray() = default;
+  FlatArray(const T * data, std::size_t size)
+  : m_data(data), m_size(size) {}
+
+  const T * begin() const {return m_data;}
+  const T * end() const {return m_data + m_size;}
+  std::size_t size() const {return m_size;}
+  bool empty() const {return m_size == 0U;}
+  const T & operator[](std::size_t i) const {return m_data[i];}
+
+private:
+  const T * m_data{nullptr};
+  std::size_t m_size{0U};
+};
+
+/// \brief Check whether a buffer starts with the flat map magic bytes
+/// \param[in] data Start of the buffer
+/// \param[in] size Size of the buffer in bytes
+/// \return True if the buffer looks like a flat map, it may still fail validation
+bool8_t HAD_MAP_UTILS_PUBLIC isFlatMap(const std::uint8_t * data, std::size_t size);
+
+/// \brief Zero copy view of a flat map buffer.
+///
+/// The whole buffer is validated once on construction: section bounds, string and range
+/// bounds, all cross references and the id ordering. After that the accessors are plain
+/// pointer arithmetic. The view does not own the buffer, which has to outlive it and must
+/// be 8 byte aligned (any heap allocation or memory mapping is).
+class HAD_MAP_UTILS_PUBLIC FlatMapView
+{
+public:
+  /// \brief Validate the buffer and set up the view
+  /// \param[in] data Start of the buffer
+  /// \param[in] size Size of the buffer in bytes
+  /// \throw std::runtime_error if the buffer is not a valid flat map of a supported version
+  FlatMapView(const std::uint8_t * data, std::size_t size);
+
+  std::int64_t idCounter() const {return m_header->id_counter;}
+
+  FlatArray<FlatPoint> points() const {return m_points;}
+  FlatArray<FlatLineString> lineStrings() const {return m_line_strings;}
+  FlatArray<FlatLineString> polygons() const {return m_polygons;}
+  FlatArray<FlatLanelet> lanelets() const {return m_lanelets;}
+  FlatArray<FlatArea> areas() const {return m_areas;}
+  FlatArray<FlatRegulatoryElement> regulatoryElements() const {return m_regulatory_elements;}
+
+  FlatArray<FlatAttribute> attributes(const FlatRange & range) const;
+  FlatArray<std::uint32_t> pointIndices(const FlatRange & range) const;
+  FlatArray<FlatBoundRef> boundRefs(const FlatRange & range) const;
+  FlatArray<FlatRange> boundRanges(const FlatRange & range) const;
+  FlatArray<FlatRuleParameter> ruleParameters(const FlatRange & range) const;
+  FlatArray<std::uint32_t> regulatoryElementIndices(const FlatRange & range) const;
+
+  /// \brief Copy a string out of the string table
+  std::string str(const FlatStringRef & ref) const;
+  /// \brief Pointer to the (not null terminated) characters of a string
+  const char * strData(const FlatStringRef & ref) const {return m_strings + ref.offset;}
+
+  /// \brief Binary search for a primitive by id
+  /// \return Index into the corresponding array or kFlatInvalidIndex if there is none
+  std::uint32_t findPoint(std::int64_t id) const;
+  std::uint32_t findLineString(std::int64_t id) const;
+  std::uint32_t findPolygon(std::int64_t id) const;
+  std::uint32_t findLanelet(std::int64_t id) const;
+  std::uint32_t findArea(std::int64_t id) const;
+  std::uint32_t findRegulatoryElement(std::int64_t id) const;
+
+private:
+  template<typename T>
+  FlatArray<T> section(FlatSectionId id) const;
+  void validate() const;
+
+  const std::uint8_t * m_data;
+  std::size_t m_size;
+  const FlatHeader * m_header;
+  const char * m_strings;
+  std::size_t m_strings_size;
+  FlatArray<FlatAttribute> m_attributes;
+  FlatArray<FlatPoint> m_points;
+  FlatArray<std::uint32_t> m_point_indices;
+  FlatArray<FlatLineString> m_line_strings;
+  FlatArray<FlatLineString> m_polygons;
+  FlatArray<FlatBoundRef> m_bound_refs;
+  FlatArray<FlatRange> m_bound_ranges;
+  FlatArray<FlatLanelet> m_lanelets;
+  FlatArray<FlatArea> m_areas;
+  FlatArray<FlatRegulatoryElement> m_regulatory_elements;
+  FlatArray<FlatRuleParameter> m_rule_parameters;
+  FlatArray<std::uint32_t> m_regulatory_element_indices;
+};
+
+/// \brief Incrementally assembles a flat map buffer.
+///
+/// Records are appended in id order per primitive type; the caller is responsible for
+/// filling in indices consistent with that order. Strings are deduplicated.
+class HAD_MAP_UTILS_PUBLIC FlatMapBuilder
+{
+public:
+  using AttributeList = std::vector<std::pair<std::string, std::string>>;
+
+  FlatStringRef addString(const std::string & str);
+  FlatRange addAttributes(const AttributeList & attributes);
+  FlatRange addPointIndices(const std::vector<std::uint32_t> & indices);
+  FlatRange addBoundRefs(const std::vector<FlatBoundRef> & refs);
+  FlatRange addBoundRanges(const std::vector<FlatRange> & ranges);
+  FlatRange addRuleParameters(const std::vector<FlatRuleParameter> & parameters);
+  FlatRange addRegulatoryElementIndices(const std::vector<std::uint32_t> & indices);
+
+  /// \brief Append a primitive record
+  /// \return Index of the new record
+  /// \throw std::runtime_error if the id is not larger than the previous one of that type
+  std::uint32_t addPoint(const FlatPoint & point);
+  std::uint32_t addLineString(const FlatLineString & line_string);
+  std::uint32_t addPolygon(const FlatLineString & polygon);
+  std::uint32_t addLanelet(const FlatLanelet & lanelet);
+  std::uint32_t addArea(const FlatArea & area);
+  std::uint32_t addRegulatoryElement(const FlatRegulatoryElement & regulatory_element);
+
+  /// \brief Write the complete buffer
+  /// \param[in] id_counter Id counter stored in the header
+  /// \param[out] out Destination, resized to fit exactly
+  void serialize(std::int64_t id_counter, std::vector<std::uint8_t> & out) const;
+
+private:
+  std::vector<char> m_strings;
+  std::unordered_map<std::string, FlatStringRef> m_string_lookup;
+  std::vector<FlatAttribute> m_attributes;
+  std::vector<FlatPoint> m_points;
+  std::vector<std::uint32_t> m_point_indices;
+  std::vector<FlatLineString> m_line_strings;
+  std::vector<FlatLineString> m_polygons;
+  std::vector<FlatBoundRef> m_bound_refs;
+  std::vector<FlatRange> m_bound_ranges;
+  std::vector<FlatLanelet> m_lanelets;
+  std::vector<FlatArea> m_areas;
+  std::vector<FlatRegulatoryElement> m_regulatory_elements;
+  std::vector<FlatRuleParameter> m_rule_parameters;
+  std::vector<std::uint32_t> m_regulatory_element_indices;
+};
+
+/// \brief Read only memory mapping of a flat map file
+class HAD_MAP_UTILS_PUBLIC MappedFlatMapFile
+{
+public:
+  /// \brief Map the file and validate its content
+  /// \throw std::runtime_error if the file cannot be mapped or is not a valid flat map
+  explicit MappedFlatMapFile(const std::string & path);
+  ~MappedFlatMapFile();
+  MappedFlatMapFile(const MappedFlatMapFile &) = delete;
+  MappedFlatMapFile & operator=(const MappedFlatMapFile &) = delete;
+
+  const FlatMapView & view() const {return *m_view;}
+  const std::uint8_t * data() const {return m_data;}
+  std::size_t size() const {return m_size;}
+
+private:
+  const std::uint8_t * m_data{nullptr};
+  std::size_t m_size{0U};
+  std::unique_ptr<FlatMapView> m_view;
+};
+
+}  // namespace had_map_utils
+}  // namespace common
+}  // namespace autoware
+
+#endif  // HAD_MAP_UTILS__HAD_MAP_FLAT_FORMAT_HPP_
@@ -17,14 +17,20 @@
 //lint -e537 pclint vs cpplint NOLINT
 
 #include <lanelet2_io/io_handlers/Serialize.h>
+#include <lanelet2_core/primitives/RegulatoryElement.h>
 
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
 
 #include <algorithm>
+#include <fstream>
 #include <limits>
+#include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "had_map_utils/had_map_conversion.hpp"
@@ -57,6 +63,12 @@ void fromBinaryMsg(
   const autoware_auto_mapping_msgs::msg::HADMapBin & msg,
   std::shared_ptr<lanelet::LaneletMap> & map)
 {
+  if (isFlatMap(msg.data.data(), msg.data.size())) {
+    const FlatMapView view{msg.data.data(), msg.data.size()};
+    FlatMapMaterializer{view}.addTo(*map);
+    lanelet::utils::registerId(view.idCounter());
+    return;
+  }
   std::string data_str;
   data_str.assign(msg.data.begin(), msg.data.end());
   std::stringstream ss;
@@ -68,6 +80,538 @@ void fromBinaryMsg(
   lanelet::utils::registerId(id_counter);
 }
 
+namespace
+{
+using IndexMap = std::unordered_map<lanelet::Id, std::uint32_t>;
+
+/// Gathers every primitive reachable from the map layers, ordered by id. Custom centerlines
+/// and their points are not part of the layers but still need to be stored.
+class FlatMapCollector
+{
+public:
+  explicit FlatMapCollector(lanelet::LaneletMap & map)
+  {
+    for (const auto & regulatory_element : map.regulatoryElementLayer) {
+      add(lanelet::RegulatoryElementConstPtr{regulatory_element});
+    }
+    for (const auto & layer_lanelet : map.laneletLayer) {
+      add(lanelet::ConstLanelet{layer_lanelet});
+    }
+    for (const auto & layer_area : map.areaLayer) {
+      add(lanelet::ConstArea{layer_area});
+    }
+    for (const auto & polygon : map.polygonLayer) {
+      add(lanelet::ConstPolygon3d{polygon});
+    }
+    for (const auto & line_string : map.lineStringLayer) {
+      add(lanelet::ConstLineString3d{line_string});
+    }
+    for (const auto & point : map.pointLayer) {
+      add(lanelet::ConstPoint3d{point});
+    }
+  }
+
+  std::map<lanelet::Id, lanelet::ConstPoint3d> points;
+  std::map<lanelet::Id, lanelet::ConstLineString3d> line_strings;
+  std::map<lanelet::Id, lanelet::ConstPolygon3d> polygons;
+  std::map<lanelet::Id, lanelet::ConstLanelet> lanelets;
+  std::map<lanelet::Id, lanelet::ConstArea> areas;
+  std::map<lanelet::Id, lanelet::RegulatoryElementConstPtr> regulatory_elements;
+
+private:
+  void add(const lanelet::ConstPoint3d & point)
+  {
+    points.emplace(point.id(), point);
+  }
+
+  void add(const lanelet::ConstLineString3d & line_string)
+  {
+    const auto base = line_string.inverted() ? line_string.invert() : line_string;
+    if (line_strings.emplace(base.id(), base).second) {
+      for (std::size_t i = 0U; i < base.size(); ++i) {
+        add(base[i]);
+      }
+    }
+  }
+
+  void add(const lanelet::ConstPolygon3d & polygon)
+  {
+    const auto base = polygon.inverted() ? polygon.invert() : polygon;
+    if (polygons.emplace(base.id(), base).second) {
+      for (std::size_t i = 0U; i < base.size(); ++i) {
+        add(base[i]);
+      }
+    }
+  }
+
+  void add(const lanelet::ConstLanelet & lanelet)
+  {
+    const auto base = lanelet.inverted() ? lanelet.invert() : lanelet;
+    if (lanelets.emplace(base.id(), base).second) {
+      add(base.leftBound());
+      add(base.rightBound());
+      if (base.hasCustomCenterline()) {
+        add(base.centerline());
+      }
+      for (const auto & regulatory_element : base.regulatoryElements()) {
+        add(regulatory_element);
+      }
+    }
+  }
+
+  void add(const lanelet::ConstArea & area)
+  {
+    if (areas.emplace(area.id(), area).second) {
+      for (const auto & line_string : area.outerBound()) {
+        add(line_string);
+      }
+      for (const auto & inner : area.innerBounds()) {
+        for (const auto & line_string : inner) {
+          add(line_string);
+        }
+      }
+      for (const auto & regulatory_element : area.regulatoryElements()) {
+        add(regulatory_element);
+      }
+    }
+  }
+
+  void add(const lanelet::RegulatoryElementConstPtr & regulatory_element)
+  {
+    if (!regulatory_elements.emplace(regulatory_element->id(), regulatory_element).second) {
+      return;
+    }
+    for (const auto & role : regulatory_element->constData()->parameters) {
+      for (const auto & parameter : role.second) {
+        if (const auto * point = boost::get<lanelet::Point3d>(&parameter)) {
+          add(lanelet::ConstPoint3d{*point});
+        } else if (const auto * line_string = boost::get<lanelet::LineString3d>(&parameter)) {
+          add(lanelet::ConstLineString3d{*line_string});
+        } else if (const auto * polygon = boost::get<lanelet::Polygon3d>(&parameter)) {
+          add(lanelet::ConstPolygon3d{*polygon});
+        } else if (const auto * weak_lanelet = boost::get<lanelet::WeakLanelet>(&parameter)) {
+          if (!weak_lanelet->expired()) {
+            add(lanelet::ConstLanelet{weak_lanelet->lock()});
+          }
+        } else if (const auto * weak_area = boost::get<lanelet::WeakArea>(&parameter)) {
+          if (!weak_area->expired()) {
+            add(lanelet::ConstArea{weak_area->lock()});
+          }
+        }
+      }
+    }
+  }
+};
+
+template<typename T>
+IndexMap make_index_map(const std::map<lanelet::Id, T> & primitives)
+{
+  IndexMap indices;
+  indices.reserve(primitives.size());
+  std::uint32_t index = 0U;
+  for (const auto & primitive : primitives) {
+    indices.emplace(primitive.first, index++);
+  }
+  return indices;
+}
+
+FlatRange add_attributes(
+  FlatMapBuilder & builder, const lanelet::AttributeMap & attributes,
+  FlatMapBuilder::AttributeList & scratch)
+{
+  scratch.clear();
+  for (const auto & attribute : attributes) {
+    scratch.emplace_back(attribute.first, attribute.second.value());
+  }
+  return builder.addAttributes(scratch);
+}
+
+template<typename LineStringT>
+FlatLineString make_line_string(
+  FlatMapBuilder & builder, const LineStringT & line_string, const IndexMap & point_indices,
+  const std::uint32_t flags, FlatMapBuilder::AttributeList & scratch)
+{
+  std::vector<std::uint32_t> points;
+  points.reserve(line_string.size());
+  for (std::size_t i = 0U; i < line_string.size(); ++i) {
+    points.push_back(point_indices.at(line_string[i].id()));
+  }
+  return FlatLineString{line_string.id(), builder.addPointIndices(points),
+    add_attributes(builder, line_string.attributes(), scratch), flags, 0U};
+}
+
+FlatBoundRef make_bound_ref(
+  const lanelet::ConstLineString3d & line_string, const IndexMap & line_string_indices)
+{
+  return FlatBoundRef{line_string_indices.at(line_string.id()),
+    line_string.inverted() ? 1U : 0U};
+}
+
+FlatRange add_bound_refs(
+  FlatMapBuilder & builder, const lanelet::ConstLineStrings3d & line_strings,
+  const IndexMap & line_string_indices)
+{
+  std::vector<FlatBoundRef> refs;
+  refs.reserve(line_strings.size());
+  for (const auto & line_string : line_strings) {
+    refs.push_back(make_bound_ref(line_string, line_string_indices));
+  }
+  return builder.addBoundRefs(refs);
+}
+
+FlatRange add_regulatory_element_indices(
+  FlatMapBuilder & builder, const lanelet::RegulatoryElementConstPtrs & regulatory_elements,
+  const IndexMap & regulatory_element_indices)
+{
+  std::vector<std::uint32_t> indices;
+  indices.reserve(regulatory_elements.size());
+  for (const auto & regulatory_element : regulatory_elements) {
+    indices.push_back(regulatory_element_indices.at(regulatory_element->id()));
+  }
+  return builder.addRegulatoryElementIndices(indices);
+}
+
+template<typename T>
+void check_index(const std::vector<T> & cache, const std::uint32_t index)
+{
+  if (index >= cache.size()) {
+    throw std::out_of_range("FlatMapMaterializer: primitive index out of range");
+  }
+}
+}  // namespace
+
+void serializeFlatMap(
+  lanelet::LaneletMap & map,
+  std::vector<std::uint8_t> & out)
+{
+  const FlatMapCollector collector{map};
+  const auto point_indices = make_index_map(collector.points);
+  const auto line_string_indices = make_index_map(collector.line_strings);
+  const auto polygon_indices = make_index_map(collector.polygons);
+  const auto lanelet_indices = make_index_map(collector.lanelets);
+  const auto area_indices = make_index_map(collector.areas);
+  const auto regulatory_element_indices = make_index_map(collector.regulatory_elements);
+
+  FlatMapBuilder builder;
+  FlatMapBuilder::AttributeList scratch;
+  for (const auto & entry : collector.points) {
+    const auto & point = entry.second;
+    builder.addPoint(
+      FlatPoint{point.id(), point.x(), point.y(), point.z(),
+        add_attributes(builder, point.attributes(), scratch),
+        map.pointLayer.exists(point.id()) ? kFlatInLayer : 0U, 0U});
+  }
+  for (const auto & entry : collector.line_strings) {
+    const std::uint32_t flags = map.lineStringLayer.exists(entry.first) ? kFlatInLayer : 0U;
+    builder.addLineString(make_line_string(builder, entry.second, point_indices, flags, scratch));
+  }
+  for (const auto & entry : collector.polygons) {
+    builder.addPolygon(
+      make_line_string(builder, entry.second, point_indices, kFlatInLayer, scratch));
+  }
+  for (const auto & entry : collector.lanelets) {
+    const auto & lanelet = entry.second;
+    const std::uint32_t centerline = lanelet.hasCustomCenterline() ?
+      line_string_indices.at(lanelet.centerline().id()) : kFlatInvalidIndex;
+    builder.addLanelet(
+      FlatLanelet{lanelet.id(),
+        make_bound_ref(lanelet.leftBound(), line_string_indices),
+        make_bound_ref(lanelet.rightBound(), line_string_indices),
+        add_attributes(builder, lanelet.attributes(), scratch),
+        add_regulatory_element_indices(
+          builder, lanelet.regulatoryElements(), regulatory_element_indices),
+        centerline, 0U});
+  }
+  for (const auto & entry : collector.areas) {
+    const auto & area = entry.second;
+    std::vector<FlatRange> inner;
+    for (const auto & inner_bound : area.innerBounds()) {
+      inner.push_back(add_bound_refs(builder, inner_bound, line_string_indices));
+    }
+    builder.addArea(
+      FlatArea{area.id(),
+        add_bound_refs(builder, area.outerBound(), line_string_indices),
+        builder.addBoundRanges(inner),
+        add_attributes(builder, area.attributes(), scratch),
+        add_regulatory_element_indices(
+          builder, area.regulatoryElements(), regulatory_element_indices)});
+  }
+  for (const auto & entry : collector.regulatory_elements) {
+    const auto & regulatory_element = entry.second;
+    std::vector<FlatRuleParameter> parameters;
+    for (const auto & role : regulatory_element->constData()->parameters) {
+      const auto role_ref = builder.addString(role.first);
+      for (const auto & parameter : role.second) {
+        FlatRuleParameter flat{role_ref, 0U, 0U, 0U};
+        if (const auto * point = boost::get<lanelet::Point3d>(&parameter)) {
+          flat.type = static_cast<std::uint16_t>(FlatParameterType::POINT);
+          flat.index = point_indices.at(point->id());
+        } else if (const auto * line_string = boost::get<lanelet::LineString3d>(&parameter)) {
+          flat.type = static_cast<std::uint16_t>(FlatParameterType::LINE_STRING);
+          flat.inverted = line_string->inverted() ? 1U : 0U;
+          flat.index = line_string_indices.at(line_string->id());
+        } else if (const auto * polygon = boost::get<lanelet::Polygon3d>(&parameter)) {
+          flat.type = static_cast<std::uint16_t>(FlatParameterType::POLYGON);
+          flat.inverted = polygon->inverted() ? 1U : 0U;
+          flat.index = polygon_indices.at(polygon->id());
+        } else if (const auto * weak_lanelet = boost::get<lanelet::WeakLanelet>(&parameter)) {
+          if (weak_lanelet->expired()) {
+            continue;
+          }
+          const auto locked = weak_lanelet->lock();
+          flat.type = static_cast<std::uint16_t>(FlatParameterType::LANELET);
+          flat.inverted = locked.inverted() ? 1U : 0U;
+          flat.index = lanelet_indices.at(locked.id());
+        } else if (const auto * weak_area = boost::get<lanelet::WeakArea>(&parameter)) {
+          if (weak_area->expired()) {
+            continue;
+          }
+          flat.type = static_cast<std::uint16_t>(FlatParameterType::AREA);
+          flat.index = area_indices.at(weak_area->lock().id());
+        }
+        parameters.push_back(flat);
+      }
+    }
+    builder.addRegulatoryElement(
+      FlatRegulatoryElement{regulatory_element->id(),
+        add_attributes(builder, regulatory_element->attributes(), scratch),
+        builder.addRuleParameters(parameters)});
+  }
+  builder.serialize(lanelet::utils::getId(), out);
+}
+
+void toFlatBinaryMsg(
+  const std::shared_ptr<lanelet::LaneletMap> & map,
+  autoware_auto_mapping_msgs::msg::HADMapBin & msg)
+{
+  serializeFlatMap(*map, msg.data);
+}
+
+void writeFlatMapFile(
+  lanelet::LaneletMap & map,
+  const std::string & path)
+{
+  std::vector<std::uint8_t> data;
+  serializeFlatMap(map, data);
+  std::ofstream file{path, std::ios::binary | std::ios::trunc};
+  file.write(
+    reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+  if (!file) {
+    throw std::runtime_error("writeFlatMapFile: failed to write " + path);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+FlatMapMaterializer::FlatMapMaterializer(const FlatMapView & view)
+: m_view(view),
+  m_points(view.points().size()),
+  m_line_strings(view.lineStrings().size()),
+  m_polygons(view.polygons().size()),
+  m_lanelets(view.lanelets().size()),
+  m_areas(view.areas().size()),
+  m_regulatory_elements(view.regulatoryElements().size()),
+  m_lanelet_rules_attached(view.lanelets().size(), false),
+  m_area_rules_attached(view.areas().size(), false)
+{
+}
+
+lanelet::AttributeMap FlatMapMaterializer::attributes(const FlatRange & range) const
+{
+  lanelet::AttributeMap result;
+  for (const auto & attribute : m_view.attributes(range)) {
+    result[m_view.str(attribute.key)] = lanelet::Attribute{m_view.str(attribute.value)};
+  }
+  return result;
+}
+
+lanelet::Point3d FlatMapMaterializer::point(const std::uint32_t index)
+{
+  check_index(m_points, index);
+  auto & cached = m_points[index];
+  if (!cached) {
+    const auto & record = m_view.points()[index];
+    cached = lanelet::Point3d{record.id, record.x, record.y, record.z,
+      attributes(record.attributes)};
+  }
+  return *cached;
+}
+
+lanelet::LineString3d FlatMapMaterializer::lineString(const std::uint32_t index)
+{
+  check_index(m_line_strings, index);
+  if (!m_line_strings[index]) {
+    const auto & record = m_view.lineStrings()[index];
+    lanelet::Points3d points;
+    points.reserve(record.points.size);
+    for (const auto point_index : m_view.pointIndices(record.points)) {
+      points.push_back(point(point_index));
+    }
+    m_line_strings[index] =
+      lanelet::LineString3d{record.id, points, attributes(record.attributes)};
+  }
+  return *m_line_strings[index];
+}
+
+lanelet::Polygon3d FlatMapMaterializer::polygon(const std::uint32_t index)
+{
+  check_index(m_polygons, index);
+  if (!m_polygons[index]) {
+    const auto & record = m_view.polygons()[index];
+    lanelet::Points3d points;
+    points.reserve(record.points.size);
+    for (const auto point_index : m_view.pointIndices(record.points)) {
+      points.push_back(point(point_index));
+    }
+    m_polygons[index] = lanelet::Polygon3d{record.id, points, attributes(record.attributes)};
+  }
+  return *m_polygons[index];
+}
+
+lanelet::LineString3d FlatMapMaterializer::bound(const FlatBoundRef & ref)
+{
+  const auto line_string = lineString(ref.line_string);
+  return (ref.inverted != 0U) ? line_string.invert() : line_string;
+}
+
+lanelet::Lanelet FlatMapMaterializer::laneletWithoutRules(const std::uint32_t index)
+{
+  check_index(m_lanelets, index);
+  if (!m_lanelets[index]) {
+    const auto & record = m_view.lanelets()[index];
+    lanelet::Lanelet result{record.id, bound(record.left), bound(record.right),
+      attributes(record.attributes)};
+    if (record.centerline != kFlatInvalidIndex) {
+      result.setCenterline(lineString(record.centerline));
+    }
+    m_lanelets[index] = result;
+  }
+  return *m_lanelets[index];
+}
+
+lanelet::Lanelet FlatMapMaterializer::lanelet(const std::uint32_t index)
+{
+  auto result = laneletWithoutRules(index);
+  if (!m_lanelet_rules_attached[index]) {
+    m_lanelet_rules_attached[index] = true;
+    const auto & record = m_view.lanelets()[index];
+    for (const auto rule_index : m_view.regulatoryElementIndices(record.regulatory_elements)) {
+      result.addRegulatoryElement(regulatoryElement(rule_index));
+    }
+  }
+  return result;
+}
+
+lanelet::Area FlatMapMaterializer::areaWithoutRules(const std::uint32_t index)
+{
+  check_index(m_areas, index);
+  if (!m_areas[index]) {
+    const auto & record = m_view.areas()[index];
+    const auto make_bounds = [this](const FlatRange & range) {
+        lanelet::LineStrings3d line_strings;
+        line_strings.reserve(range.size);
+        for (const auto & ref : m_view.boundRefs(range)) {
+          line_strings.push_back(bound(ref));
+        }
+        return line_strings;
+      };
+    lanelet::InnerBounds inner;
+    for (const auto & range : m_view.boundRanges(record.inner)) {
+      inner.push_back(make_bounds(range));
+    }
+    m_areas[index] = lanelet::Area{record.id, make_bounds(record.outer), inner,
+      attributes(record.attributes)};
+  }
+  return *m_areas[index];
+}
+
+lanelet::Area FlatMapMaterializer::area(const std::uint32_t index)
+{
+  auto result = areaWithoutRules(index);
+  if (!m_area_rules_attached[index]) {
+    m_area_rules_attached[index] = true;
+    const auto & record = m_view.areas()[index];
+    for (const auto rule_index : m_view.regulatoryElementIndices(record.regulatory_elements)) {
+      result.addRegulatoryElement(regulatoryElement(rule_index));
+    }
+  }
+  return result;
+}
+
+lanelet::RegulatoryElementPtr FlatMapMaterializer::regulatoryElement(const std::uint32_t index)
+{
+  check_index(m_regulatory_elements, index);
+  if (!m_regulatory_elements[index]) {
+    const auto & record = m_view.regulatoryElements()[index];
+    lanelet::RuleParameterMap parameters;
+    for (const auto & parameter : m_view.ruleParameters(record.parameters)) {
+      auto & role = parameters[m_view.str(parameter.role)];
+      const bool8_t inverted = parameter.inverted != 0U;
+      switch (static_cast<FlatParameterType>(parameter.type)) {
+        case FlatParameterType::POINT:
+          role.emplace_back(point(parameter.index));
+          break;
+        case FlatParameterType::LINE_STRING: {
+            const auto rule_line_string = lineString(parameter.index);
+            role.emplace_back(inverted ? rule_line_string.invert() : rule_line_string);
+            break;
+          }
+        case FlatParameterType::POLYGON: {
+            const auto rule_polygon = polygon(parameter.index);
+            role.emplace_back(inverted ? rule_polygon.invert() : rule_polygon);
+            break;
+          }
+        case FlatParameterType::LANELET: {
+            const auto rule_lanelet = laneletWithoutRules(parameter.index);
+            role.emplace_back(
+              lanelet::WeakLanelet{inverted ? rule_lanelet.invert() : rule_lanelet});
+            break;
+          }
+        case FlatParameterType::AREA:
+          role.emplace_back(lanelet::WeakArea{areaWithoutRules(parameter.index)});
+          break;
+        default:
+          throw std::runtime_error("FlatMapMaterializer: unknown rule parameter type");
+      }
+    }
+    auto rule_attributes = attributes(record.attributes);
+    const auto subtype = rule_attributes.find(lanelet::AttributeNamesString::Subtype);
+    const std::string rule_name = (subtype != rule_attributes.end()) ?
+      subtype->second.value() : std::string{lanelet::GenericRegulatoryElement::RuleName};
+    m_regulatory_elements[index] = lanelet::RegulatoryElementFactory::create(
+      rule_name, std::make_shared<lanelet::RegulatoryElementData>(
+        record.id, std::move(parameters), std::move(rule_attributes)));
+  }
+  return m_regulatory_elements[index];
+}
+
+void FlatMapMaterializer::addTo(lanelet::LaneletMap & map)
+{
+  const auto points = m_view.points();
+  for (std::uint32_t i = 0U; i < points.size(); ++i) {
+    if ((points[i].flags & kFlatInLayer) != 0U) {
+      map.add(point(i));
+    }
+  }
+  const auto line_strings = m_view.lineStrings();
+  for (std::uint32_t i = 0U; i < line_strings.size(); ++i) {
+    if ((line_strings[i].flags & kFlatInLayer) != 0U) {
+      map.add(lineString(i));
+    }
+  }
+  for (std::uint32_t i = 0U; i < m_view.polygons().size(); ++i) {
+    map.add(polygon(i));
+  }
+  for (std::uint32_t i = 0U; i < m_view.lanelets().size(); ++i) {
+    map.add(lanelet(i));
+  }
+  for (std::uint32_t i = 0U; i < m_view.areas().size(); ++i) {
+    map.add(area(i));
+  }
+  for (std::uint32_t i = 0U; i < m_view.regulatoryElements().size(); ++i) {
+    map.add(regulatoryElement(i));
+  }
+}
+
 }  // namespace had_map_utils
 }  // namespace common
 }  // namespace autoware
@@ -0,0 +1,460 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include "had_map_utils/had_map_flat_format.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace autoware
+{
+namespace common
+{
+namespace had_map_utils
+{
+
+namespace
+{
+constexpr std::size_t kFlatAlignment = 8U;
+
+constexpr std::size_t kSectionElementSize[kFlatSectionCount] = {
+  sizeof(char),
+  sizeof(FlatAttribute),
+  sizeof(FlatPoint),
+  sizeof(std::uint32_t),
+  sizeof(FlatLineString),
+  sizeof(FlatLineString),
+  sizeof(FlatBoundRef),
+  sizeof(FlatRange),
+  sizeof(FlatLanelet),
+  sizeof(FlatArea),
+  sizeof(FlatRegulatoryElement),
+  sizeof(FlatRuleParameter),
+  sizeof(std::uint32_t)
+};
+
+std::size_t align_up(std::size_t value)
+{
+  return (value + kFlatAlignment - 1U) & ~(kFlatAlignment - 1U);
+}
+
+void check(const bool8_t condition, const char * what)
+{
+  if (!condition) {
+    throw std::runtime_error(std::string{"Invalid flat map: "} + what);
+  }
+}
+
+template<typename T>
+void check_range(const FlatRange & range, const FlatArray<T> & target, const char * what)
+{
+  check(
+    static_cast<std::uint64_t>(range.begin) + range.size <= target.size(), what);
+}
+
+template<typename T>
+void check_sorted_ids(const FlatArray<T> & records, const char * what)
+{
+  for (std::size_t i = 1U; i < records.size(); ++i) {
+    check(records[i - 1U].id < records[i].id, what);
+  }
+}
+
+template<typename T>
+std::uint32_t find_by_id(const FlatArray<T> & records, const std::int64_t id)
+{
+  const auto it = std::lower_bound(
+    records.begin(), records.end(), id,
+    [](const T & record, const std::int64_t value) {return record.id < value;});
+  if (it == records.end() || it->id != id) {
+    return kFlatInvalidIndex;
+  }
+  return static_cast<std::uint32_t>(it - records.begin());
+}
+
+template<typename T>
+FlatRange append(std::vector<T> & section, const std::vector<T> & values)
+{
+  const FlatRange range{static_cast<std::uint32_t>(section.size()),
+    static_cast<std::uint32_t>(values.size())};
+  section.insert(section.end(), values.begin(), values.end());
+  return range;
+}
+
+template<typename T>
+std::uint32_t append_record(std::vector<T> & section, const T & record)
+{
+  if (!section.empty() && section.back().id >= record.id) {
+    throw std::runtime_error("FlatMapBuilder: records must be added in increasing id order");
+  }
+  section.push_back(record);
+  return static_cast<std::uint32_t>(section.size() - 1U);
+}
+}  // namespace
+
+bool8_t isFlatMap(const std::uint8_t * data, const std::size_t size)
+{
+  return (data != nullptr) && (size >= sizeof(kFlatMapMagic)) &&
+         (std::memcmp(data, kFlatMapMagic, sizeof(kFlatMapMagic)) == 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+FlatMapView::FlatMapView(const std::uint8_t * data, const std::size_t size)
+: m_data(data), m_size(size), m_header(nullptr)
+{
+  check(isFlatMap(data, size), "bad magic");
+  check(size >= sizeof(FlatHeader), "truncated header");
+  check((reinterpret_cast<std::uintptr_t>(data) % kFlatAlignment) == 0U, "misaligned buffer");
+  m_header = reinterpret_cast<const FlatHeader *>(data);
+  check(m_header->version == kFlatMapVersion, "unsupported version");
+  check(m_header->section_count == kFlatSectionCount, "unexpected section count");
+  for (std::size_t i = 0U; i < kFlatSectionCount; ++i) {
+    const auto & sec = m_header->sections[i];
+    check((sec.offset % kFlatAlignment) == 0U, "misaligned section");
+    check(sec.offset <= size, "section out of bounds");
+    check(sec.count <= (size - sec.offset) / kSectionElementSize[i], "section out of bounds");
+    check(sec.count <= kFlatInvalidIndex, "section too large");
+  }
+  const auto strings = section<char>(FlatSectionId::STRINGS);
+  m_strings = strings.begin();
+  m_strings_size = strings.size();
+  m_attributes = section<FlatAttribute>(FlatSectionId::ATTRIBUTES);
+  m_points = section<FlatPoint>(FlatSectionId::POINTS);
+  m_point_indices = section<std::uint32_t>(FlatSectionId::POINT_INDICES);
+  m_line_strings = section<FlatLineString>(FlatSectionId::LINE_STRINGS);
+  m_polygons = section<FlatLineString>(FlatSectionId::POLYGONS);
+  m_bound_refs = section<FlatBoundRef>(FlatSectionId::BOUND_REFS);
+  m_bound_ranges = section<FlatRange>(FlatSectionId::BOUND_RANGES);
+  m_lanelets = section<FlatLanelet>(FlatSectionId::LANELETS);
+  m_areas = section<FlatArea>(FlatSectionId::AREAS);
+  m_regulatory_elements = section<FlatRegulatoryElement>(FlatSectionId::REGULATORY_ELEMENTS);
+  m_rule_parameters = section<FlatRuleParameter>(FlatSectionId::RULE_PARAMETERS);
+  m_regulatory_element_indices =
+    section<std::uint32_t>(FlatSectionId::REGULATORY_ELEMENT_INDICES);
+  validate();
+}
+
+template<typename T>
+FlatArray<T> FlatMapView::section(const FlatSectionId id) const
+{
+  const auto & sec = m_header->sections[static_cast<std::size_t>(id)];
+  return FlatArray<T>{reinterpret_cast<const T *>(m_data + sec.offset),
+    static_cast<std::size_t>(sec.count)};
+}
+
+void FlatMapView::validate() const
+{
+  const auto check_string = [this](const FlatStringRef & ref) {
+      check(static_cast<std::uint64_t>(ref.offset) + ref.size <= m_strings_size, "bad string");
+    };
+  for (const auto & attribute : m_attributes) {
+    check_string(attribute.key);
+    check_string(attribute.value);
+  }
+  for (const auto index : m_point_indices) {
+    check(index < m_points.size(), "bad point index");
+  }
+  for (const auto & ref : m_bound_refs) {
+    check(ref.line_string < m_line_strings.size(), "bad bound reference");
+  }
+  for (const auto & range : m_bound_ranges) {
+    check_range(range, m_bound_refs, "bad inner bound range");
+  }
+  for (const auto index : m_regulatory_element_indices) {
+    check(index < m_regulatory_elements.size(), "bad regulatory element index");
+  }
+  const std::size_t parameter_targets[] = {m_points.size(), m_line_strings.size(),
+    m_polygons.size(), m_lanelets.size(), m_areas.size()};
+  for (const auto & parameter : m_rule_parameters) {
+    check_string(parameter.role);
+    check(
+      parameter.type < static_cast<std::uint16_t>(FlatParameterType::COUNT),
+      "bad rule parameter type");
+    check(parameter.index < parameter_targets[parameter.type], "bad rule parameter index");
+  }
+
+  for (const auto & point : m_points) {
+    check_range(point.attributes, m_attributes, "bad point attributes");
+  }
+  for (const auto * line_strings : {&m_line_strings, &m_polygons}) {
+    for (const auto & line_string : *line_strings) {
+      check_range(line_string.points, m_point_indices, "bad line string points");
+      check_range(line_string.attributes, m_attributes, "bad line string attributes");
+    }
+  }
+  for (const auto & lanelet : m_lanelets) {
+    check(lanelet.left.line_string < m_line_strings.size(), "bad left bound");
+    check(lanelet.right.line_string < m_line_strings.size(), "bad right bound");
+    check(
+      (lanelet.centerline == kFlatInvalidIndex) ||
+      (lanelet.centerline < m_line_strings.size()), "bad centerline");
+    check_range(lanelet.attributes, m_attributes, "bad lanelet attributes");
+    check_range(
+      lanelet.regulatory_elements, m_regulatory_element_indices,
+      "bad lanelet regulatory elements");
+  }
+  for (const auto & area : m_areas) {
+    check_range(area.outer, m_bound_refs, "bad outer bound");
+    check_range(area.inner, m_bound_ranges, "bad inner bounds");
+    check_range(area.attributes, m_attributes, "bad area attributes");
+    check_range(
+      area.regulatory_elements, m_regulatory_element_indices, "bad area regulatory elements");
+  }
+  for (const auto & regulatory_element : m_regulatory_elements) {
+    check_range(
+      regulatory_element.attributes, m_attributes, "bad regulatory element attributes");
+    check_range(
+      regulatory_element.parameters, m_rule_parameters, "bad regulatory element parameters");
+  }
+
+  check_sorted_ids(m_points, "points not sorted by id");
+  check_sorted_ids(m_line_strings, "line strings not sorted by id");
+  check_sorted_ids(m_polygons, "polygons not sorted by id");
+  check_sorted_ids(m_lanelets, "lanelets not sorted by id");
+  check_sorted_ids(m_areas, "areas not sorted by id");
+  check_sorted_ids(m_regulatory_elements, "regulatory elements not sorted by id");
+}
+
+FlatArray<FlatAttribute> FlatMapView::attributes(const FlatRange & range) const
+{
+  return {m_attributes.begin() + range.begin, range.size};
+}
+
+FlatArray<std::uint32_t> FlatMapView::pointIndices(const FlatRange & range) const
+{
+  return {m_point_indices.begin() + range.begin, range.size};
+}
+
+FlatArray<FlatBoundRef> FlatMapView::boundRefs(const FlatRange & range) const
+{
+  return {m_bound_refs.begin() + range.begin, range.size};
+}
+
+FlatArray<FlatRange> FlatMapView::boundRanges(const FlatRange & range) const
+{
+  return {m_bound_ranges.begin() + range.begin, range.size};
+}
+
+FlatArray<FlatRuleParameter> FlatMapView::ruleParameters(const FlatRange & range) const
+{
+  return {m_rule_parameters.begin() + range.begin, range.size};
+}
+
+FlatArray<std::uint32_t> FlatMapView::regulatoryElementIndices(const FlatRange & range) const
+{
+  return {m_regulatory_element_indices.begin() + range.begin, range.size};
+}
+
+std::string FlatMapView::str(const FlatStringRef & ref) const
+{
+  return std::string{strData(ref), ref.size};
+}
+
+std::uint32_t FlatMapView::findPoint(const std::int64_t id) const
+{
+  return find_by_id(m_points, id);
+}
+
+std::uint32_t FlatMapView::findLineString(const std::int64_t id) const
+{
+  return find_by_id(m_line_strings, id);
+}
+
+std::uint32_t FlatMapView::findPolygon(const std::int64_t id) const
+{
+  return find_by_id(m_polygons, id);
+}
+
+std::uint32_t FlatMapView::findLanelet(const std::int64_t id) const
+{
+  return find_by_id(m_lanelets, id);
+}
+
+std::uint32_t FlatMapView::findArea(const std::int64_t id) const
+{
+  return find_by_id(m_areas, id);
+}
+
+std::uint32_t FlatMapView::findRegulatoryElement(const std::int64_t id) const
+{
+  return find_by_id(m_regulatory_elements, id);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+FlatStringRef FlatMapBuilder::addString(const std::string & str)
+{
+  const auto it = m_string_lookup.find(str);
+  if (it != m_string_lookup.end()) {
+    return it->second;
+  }
+  const FlatStringRef ref{static_cast<std::uint32_t>(m_strings.size()),
+    static_cast<std::uint32_t>(str.size())};
+  m_strings.insert(m_strings.end(), str.begin(), str.end());
+  m_string_lookup.emplace(str, ref);
+  return ref;
+}
+
+FlatRange FlatMapBuilder::addAttributes(const AttributeList & attributes)
+{
+  const FlatRange range{static_cast<std::uint32_t>(m_attributes.size()),
+    static_cast<std::uint32_t>(attributes.size())};
+  for (const auto & attribute : attributes) {
+    m_attributes.push_back({addString(attribute.first), addString(attribute.second)});
+  }
+  return range;
+}
+
+FlatRange FlatMapBuilder::addPointIndices(const std::vector<std::uint32_t> & indices)
+{
+  return append(m_point_indices, indices);
+}
+
+FlatRange FlatMapBuilder::addBoundRefs(const std::vector<FlatBoundRef> & refs)
+{
+  return append(m_bound_refs, refs);
+}
+
+FlatRange FlatMapBuilder::addBoundRanges(const std::vector<FlatRange> & ranges)
+{
+  return append(m_bound_ranges, ranges);
+}
+
+FlatRange FlatMapBuilder::addRuleParameters(const std::vector<FlatRuleParameter> & parameters)
+{
+  return append(m_rule_parameters, parameters);
+}
+
+FlatRange FlatMapBuilder::addRegulatoryElementIndices(const std::vector<std::uint32_t> & indices)
+{
+  return append(m_regulatory_element_indices, indices);
+}
+
+std::uint32_t FlatMapBuilder::addPoint(const FlatPoint & point)
+{
+  return append_record(m_points, point);
+}
+
+std::uint32_t FlatMapBuilder::addLineString(const FlatLineString & line_string)
+{
+  return append_record(m_line_strings, line_string);
+}
+
+std::uint32_t FlatMapBuilder::addPolygon(const FlatLineString & polygon)
+{
+  return append_record(m_polygons, polygon);
+}
+
+std::uint32_t FlatMapBuilder::addLanelet(const FlatLanelet & lanelet)
+{
+  return append_record(m_lanelets, lanelet);
+}
+
+std::uint32_t FlatMapBuilder::addArea(const FlatArea & area)
+{
+  return append_record(m_areas, area);
+}
+
+std::uint32_t FlatMapBuilder::addRegulatoryElement(
+  const FlatRegulatoryElement & regulatory_element)
+{
+  return append_record(m_regulatory_elements, regulatory_element);
+}
+
+void FlatMapBuilder::serialize(const std::int64_t id_counter, std::vector<std::uint8_t> & out)
+const
+{
+  const std::pair<const void *, std::size_t> sections[kFlatSectionCount] = {
+    {m_strings.data(), m_strings.size()},
+    {m_attributes.data(), m_attributes.size()},
+    {m_points.data(), m_points.size()},
+    {m_point_indices.data(), m_point_indices.size()},
+    {m_line_strings.data(), m_line_strings.size()},
+    {m_polygons.data(), m_polygons.size()},
+    {m_bound_refs.data(), m_bound_refs.size()},
+    {m_bound_ranges.data(), m_bound_ranges.size()},
+    {m_lanelets.data(), m_lanelets.size()},
+    {m_areas.data(), m_areas.size()},
+    {m_regulatory_elements.data(), m_regulatory_elements.size()},
+    {m_rule_parameters.data(), m_rule_parameters.size()},
+    {m_regulatory_element_indices.data(), m_regulatory_element_indices.size()}
+  };
+
+  FlatHeader header{};
+  std::memcpy(header.magic, kFlatMapMagic, sizeof(kFlatMapMagic));
+  header.version = kFlatMapVersion;
+  header.section_count = static_cast<std::uint32_t>(kFlatSectionCount);
+  header.id_counter = id_counter;
+  std::size_t offset = align_up(sizeof(FlatHeader));
+  for (std::size_t i = 0U; i < kFlatSectionCount; ++i) {
+    header.sections[i].offset = offset;
+    header.sections[i].count = sections[i].second;
+    offset = align_up(offset + sections[i].second * kSectionElementSize[i]);
+  }
+
+  out.assign(offset, 0U);
+  std::memcpy(out.data(), &header, sizeof(header));
+  for (std::size_t i = 0U; i < kFlatSectionCount; ++i) {
+    if (sections[i].second > 0U) {
+      std::memcpy(
+        out.data() + header.sections[i].offset, sections[i].first,
+        sections[i].second * kSectionElementSize[i]);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+MappedFlatMapFile::MappedFlatMapFile(const std::string & path)
+{
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("MappedFlatMapFile: cannot open " + path);
+  }
+  struct stat file_stat {};
+  if ((::fstat(fd, &file_stat) != 0) || (file_stat.st_size <= 0)) {
+    ::close(fd);
+    throw std::runtime_error("MappedFlatMapFile: cannot stat or empty file " + path);
+  }
+  m_size = static_cast<std::size_t>(file_stat.st_size);
+  void * const mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("MappedFlatMapFile: cannot map " + path);
+  }
+  m_data = static_cast<const std::uint8_t *>(mapping);
+  try {
+    m_view = std::make_unique<FlatMapView>(m_data, m_size);
+  } catch (...) {
+    ::munmap(mapping, m_size);
+    throw;
+  }
+}
+
+MappedFlatMapFile::~MappedFlatMapFile()
+{
+  ::munmap(const_cast<std::uint8_t *>(m_data), m_size);
+}
+
+}  // namespace had_map_utils
+}  // namespace common
+}  // namespace autoware
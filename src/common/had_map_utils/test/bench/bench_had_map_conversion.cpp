@@ -0,0 +1,132 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <benchmark/benchmark.h>
+#include <had_map_utils/had_map_conversion.hpp>
+#include <had_map_utils/had_map_flat_format.hpp>
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet2_core/utility/Utilities.h>
+
+#include <memory>
+#include <vector>
+
+using autoware::common::had_map_utils::FlatMapMaterializer;
+using autoware::common::had_map_utils::FlatMapView;
+using autoware_auto_mapping_msgs::msg::HADMapBin;
+
+namespace
+{
+
+constexpr std::size_t kPointsPerBound = 20U;
+
+/// A block of parallel roads: every road is a chain of lanelets, neighbouring lanes share
+/// their bounds like in a real city map. Lanelet count is roughly lanes * segments.
+lanelet::LaneletMapPtr create_map(const std::size_t lanes, const std::size_t segments)
+{
+  lanelet::Lanelets lanelets;
+  lanelets.reserve(lanes * segments);
+  for (std::size_t s = 0U; s < segments; ++s) {
+    std::vector<lanelet::LineString3d> bounds;
+    for (std::size_t b = 0U; b <= lanes; ++b) {
+      lanelet::Points3d points;
+      for (std::size_t p = 0U; p < kPointsPerBound; ++p) {
+        points.emplace_back(
+          lanelet::utils::getId(), 3.5 * static_cast<double>(b),
+          static_cast<double>(s * kPointsPerBound + p), 0.0);
+      }
+      bounds.emplace_back(lanelet::utils::getId(), points);
+      bounds.back().setAttribute(lanelet::AttributeName::Type, "line_thin");
+      bounds.back().setAttribute(lanelet::AttributeName::Subtype, "dashed");
+    }
+    for (std::size_t l = 0U; l < lanes; ++l) {
+      lanelets.emplace_back(lanelet::utils::getId(), bounds[l], bounds[l + 1U]);
+      lanelets.back().setAttribute(lanelet::AttributeName::Subtype, "road");
+      lanelets.back().setAttribute(lanelet::AttributeName::SpeedLimit, "30");
+    }
+  }
+  return lanelet::utils::createMap(lanelets);
+}
+
+lanelet::LaneletMapPtr create_map(const benchmark::State & state)
+{
+  return create_map(8U, static_cast<std::size_t>(state.range(0)));
+}
+
+}  // namespace
+
+static void BenchBoostSerialize(benchmark::State & state)
+{
+  const auto map = create_map(state);
+  HADMapBin msg;
+  for (auto _ : state) {
+    autoware::common::had_map_utils::toBinaryMsg(map, msg);
+    benchmark::DoNotOptimize(msg.data.data());
+  }
+  state.counters["bytes"] = static_cast<double>(msg.data.size());
+}
+
+static void BenchFlatSerialize(benchmark::State & state)
+{
+  const auto map = create_map(state);
+  HADMapBin msg;
+  for (auto _ : state) {
+    autoware::common::had_map_utils::toFlatBinaryMsg(map, msg);
+    benchmark::DoNotOptimize(msg.data.data());
+  }
+  state.counters["bytes"] = static_cast<double>(msg.data.size());
+}
+
+static void BenchBoostDeserialize(benchmark::State & state)
+{
+  HADMapBin msg;
+  autoware::common::had_map_utils::toBinaryMsg(create_map(state), msg);
+  for (auto _ : state) {
+    auto map = std::make_shared<lanelet::LaneletMap>();
+    autoware::common::had_map_utils::fromBinaryMsg(msg, map);
+    benchmark::DoNotOptimize(map.get());
+  }
+}
+
+static void BenchFlatDeserialize(benchmark::State & state)
+{
+  HADMapBin msg;
+  autoware::common::had_map_utils::toFlatBinaryMsg(create_map(state), msg);
+  for (auto _ : state) {
+    auto map = std::make_shared<lanelet::LaneletMap>();
+    autoware::common::had_map_utils::fromBinaryMsg(msg, map);
+    benchmark::DoNotOptimize(map.get());
+  }
+}
+
+/// Open the buffer in place and materialize a single lanelet, the lazy access pattern
+static void BenchFlatViewSingleLanelet(benchmark::State & state)
+{
+  HADMapBin msg;
+  autoware::common::had_map_utils::toFlatBinaryMsg(create_map(state), msg);
+  for (auto _ : state) {
+    const FlatMapView view{msg.data.data(), msg.data.size()};
+    FlatMapMaterializer materializer{view};
+    auto lanelet = materializer.lanelet(static_cast<std::uint32_t>(view.lanelets().size() / 2U));
+    benchmark::DoNotOptimize(lanelet.id());
+  }
+}
+
+BENCHMARK(BenchBoostSerialize)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchFlatSerialize)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchBoostDeserialize)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchFlatDeserialize)->Arg(10)->Arg(100)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchFlatViewSingleLanelet)->Arg(10)->Arg(100)->Arg(1000)->Unit(
+  benchmark::kMillisecond);
@@ -0,0 +1,194 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <gtest/gtest.h>
+#include <had_map_utils/had_map_conversion.hpp>
+#include <had_map_utils/had_map_flat_format.hpp>
+#include <lanelet2_core/primitives/BasicRegulatoryElements.h>
+#include <lanelet2_core/utility/Utilities.h>
+
+#include <memory>
+#include <stdexcept>
+
+using autoware::common::had_map_utils::FlatMapMaterializer;
+using autoware::common::had_map_utils::FlatMapView;
+using autoware::common::had_map_utils::fromBinaryMsg;
+using autoware::common::had_map_utils::isFlatMap;
+using autoware::common::had_map_utils::kFlatInvalidIndex;
+using autoware::common::had_map_utils::toBinaryMsg;
+using autoware::common::had_map_utils::toFlatBinaryMsg;
+using autoware_auto_mapping_msgs::msg::HADMapBin;
+
+namespace
+{
+lanelet::LineString3d make_line(const double x, const std::size_t n_points)
+{
+  lanelet::Points3d points;
+  for (std::size_t i = 0U; i < n_points; ++i) {
+    points.emplace_back(lanelet::utils::getId(), x, static_cast<double>(i), 0.0);
+  }
+  return lanelet::LineString3d{lanelet::utils::getId(), points};
+}
+
+/// Two neighbouring lanelets sharing a bound, one with a custom centerline and a traffic
+/// light, plus an area with a hole
+lanelet::LaneletMapPtr make_map()
+{
+  const auto left = make_line(-1.0, 5U);
+  const auto middle = make_line(1.0, 5U);
+  const auto right = make_line(3.0, 5U);
+  lanelet::Lanelet lanelet_a{lanelet::utils::getId(), left, middle};
+  lanelet_a.setAttribute(lanelet::AttributeName::Subtype, "road");
+  lanelet_a.setCenterline(make_line(0.0, 5U));
+  lanelet::Lanelet lanelet_b{lanelet::utils::getId(), middle, right};
+
+  auto light = make_line(0.0, 2U);
+  light.setAttribute(lanelet::AttributeName::Type, "traffic_light");
+  const auto traffic_light = lanelet::TrafficLight::make(
+    lanelet::utils::getId(), lanelet::AttributeMap{}, {light}, make_line(0.5, 2U));
+  lanelet_a.addRegulatoryElement(traffic_light);
+
+  lanelet::Point3d p0{lanelet::utils::getId(), 10.0, 0.0, 0.0};
+  lanelet::Point3d p1{lanelet::utils::getId(), 20.0, 0.0, 0.0};
+  lanelet::Point3d p2{lanelet::utils::getId(), 20.0, 10.0, 0.0};
+  lanelet::Point3d p3{lanelet::utils::getId(), 10.0, 10.0, 0.0};
+  lanelet::LineString3d outer_a{lanelet::utils::getId(), {p0, p1, p2}};
+  lanelet::LineString3d outer_b{lanelet::utils::getId(), {p2, p3, p0}};
+  lanelet::LineString3d hole{lanelet::utils::getId(), {
+      lanelet::Point3d{lanelet::utils::getId(), 12.0, 2.0, 0.0},
+      lanelet::Point3d{lanelet::utils::getId(), 14.0, 2.0, 0.0},
+      lanelet::Point3d{lanelet::utils::getId(), 14.0, 4.0, 0.0}}};
+  lanelet::Area area{lanelet::utils::getId(), {outer_a, outer_b}, {{hole}}};
+  area.setAttribute(lanelet::AttributeName::Subtype, "parking");
+
+  auto map = lanelet::utils::createMap({lanelet_a, lanelet_b}, {area});
+  map->add(lanelet::Point3d{lanelet::utils::getId(), 7.0, 8.0, 9.0});
+  return map;
+}
+}  // namespace
+
+TEST(HadMapFlatFormat, RoundTripThroughMessage)
+{
+  const auto map = make_map();
+  HADMapBin msg;
+  toFlatBinaryMsg(map, msg);
+  ASSERT_TRUE(isFlatMap(msg.data.data(), msg.data.size()));
+
+  auto restored = std::make_shared<lanelet::LaneletMap>();
+  fromBinaryMsg(msg, restored);
+
+  EXPECT_EQ(restored->pointLayer.size(), map->pointLayer.size());
+  EXPECT_EQ(restored->lineStringLayer.size(), map->lineStringLayer.size());
+  EXPECT_EQ(restored->polygonLayer.size(), map->polygonLayer.size());
+  EXPECT_EQ(restored->laneletLayer.size(), map->laneletLayer.size());
+  EXPECT_EQ(restored->areaLayer.size(), map->areaLayer.size());
+  EXPECT_EQ(restored->regulatoryElementLayer.size(), map->regulatoryElementLayer.size());
+
+  for (const auto & point : map->pointLayer) {
+    const auto other = restored->pointLayer.get(point.id());
+    EXPECT_DOUBLE_EQ(other.x(), point.x());
+    EXPECT_DOUBLE_EQ(other.y(), point.y());
+    EXPECT_DOUBLE_EQ(other.z(), point.z());
+  }
+  for (const auto & lanelet : map->laneletLayer) {
+    const auto other = restored->laneletLayer.get(lanelet.id());
+    EXPECT_EQ(other.leftBound().id(), lanelet.leftBound().id());
+    EXPECT_EQ(other.rightBound().id(), lanelet.rightBound().id());
+    EXPECT_EQ(other.leftBound().inverted(), lanelet.leftBound().inverted());
+    EXPECT_EQ(other.hasCustomCenterline(), lanelet.hasCustomCenterline());
+    EXPECT_EQ(other.attributes().size(), lanelet.attributes().size());
+    ASSERT_EQ(other.regulatoryElements().size(), lanelet.regulatoryElements().size());
+    if (lanelet.hasCustomCenterline()) {
+      EXPECT_EQ(other.centerline().id(), lanelet.centerline().id());
+      EXPECT_EQ(other.centerline().size(), lanelet.centerline().size());
+    }
+    for (const auto & rule : other.regulatoryElements()) {
+      const auto traffic_light = std::dynamic_pointer_cast<const lanelet::TrafficLight>(rule);
+      ASSERT_NE(traffic_light, nullptr);
+      ASSERT_TRUE(static_cast<bool>(traffic_light->stopLine()));
+      EXPECT_EQ(traffic_light->trafficLights().size(), 1U);
+    }
+  }
+  for (const auto & area : map->areaLayer) {
+    const auto other = restored->areaLayer.get(area.id());
+    ASSERT_EQ(other.outerBound().size(), area.outerBound().size());
+    ASSERT_EQ(other.innerBounds().size(), area.innerBounds().size());
+    EXPECT_EQ(other.outerBound()[1].id(), area.outerBound()[1].id());
+    EXPECT_EQ(other.attribute(lanelet::AttributeName::Subtype).value(), "parking");
+  }
+
+  // Shared primitives stay shared
+  for (const auto & lanelet : map->laneletLayer) {
+    for (const auto & other : map->laneletLayer) {
+      if (lanelet.rightBound().id() == other.leftBound().id()) {
+        EXPECT_EQ(
+          restored->laneletLayer.get(lanelet.id()).rightBound().constData(),
+          restored->laneletLayer.get(other.id()).leftBound().constData());
+      }
+    }
+  }
+}
+
+TEST(HadMapFlatFormat, LazyMaterialization)
+{
+  const auto map = make_map();
+  HADMapBin msg;
+  toFlatBinaryMsg(map, msg);
+  const FlatMapView view{msg.data.data(), msg.data.size()};
+  FlatMapMaterializer materializer{view};
+
+  for (const auto & lanelet : map->laneletLayer) {
+    const auto index = view.findLanelet(lanelet.id());
+    ASSERT_NE(index, kFlatInvalidIndex);
+    const auto other = materializer.lanelet(index);
+    EXPECT_EQ(other.id(), lanelet.id());
+    EXPECT_EQ(other.regulatoryElements().size(), lanelet.regulatoryElements().size());
+    // Cached: the same lanelet data is returned again
+    EXPECT_EQ(materializer.lanelet(index).constData(), other.constData());
+  }
+  EXPECT_EQ(view.findLanelet(lanelet::InvalId), kFlatInvalidIndex);
+  EXPECT_THROW(
+    materializer.lanelet(static_cast<std::uint32_t>(view.lanelets().size())),
+    std::out_of_range);
+}
+
+TEST(HadMapFlatFormat, RejectsCorruptData)
+{
+  const auto map = make_map();
+  HADMapBin msg;
+  toFlatBinaryMsg(map, msg);
+
+  auto truncated = msg.data;
+  truncated.resize(truncated.size() / 2U);
+  EXPECT_THROW(FlatMapView(truncated.data(), truncated.size()), std::runtime_error);
+
+  auto bad_version = msg.data;
+  bad_version[8U] = 0xFFU;
+  EXPECT_THROW(FlatMapView(bad_version.data(), bad_version.size()), std::runtime_error);
+}
+
+TEST(HadMapFlatFormat, BoostFormatStillAccepted)
+{
+  const auto map = make_map();
+  HADMapBin msg;
+  toBinaryMsg(map, msg);
+  EXPECT_FALSE(isFlatMap(msg.data.data(), msg.data.size()));
+
+  auto restored = std::make_shared<lanelet::LaneletMap>();
+  fromBinaryMsg(msg, restored);
+  EXPECT_EQ(restored->laneletLayer.size(), map->laneletLayer.size());
+  EXPECT_EQ(restored->areaLayer.size(), map->areaLayer.size());
+}
@@ -42,6 +42,22 @@ struct OSQP_INTERFACE_PUBLIC CSC_Matrix
 OSQP_INTERFACE_PUBLIC CSC_Matrix calCSCMatrix(const Eigen::MatrixXd & mat);
 /// \brief Calculate upper trapezoidal CSC matrix from square Eigen matrix
 OSQP_INTERFACE_PUBLIC CSC_Matrix calCSCMatrixTrapezoidal(const Eigen::MatrixXd & mat);
+/// \brief Convert the upper trapezoidal part of a square matrix into CSC format, keeping zero
+///        entries. The sparsity pattern only depends on the size of the matrix, so the values can
+///        later be replaced with updateCSCMatrixValues() without changing the pattern.
+/// \param mat (n,n) matrix to convert
+/// \return CSC matrix containing all n * (n + 1) / 2 upper trapezoidal entries
+/// \throw std::invalid_argument if the matrix is not square
+OSQP_INTERFACE_PUBLIC CSC_Matrix calCSCMatrixTrapezoidalDense(const Eigen::MatrixXd & mat);
+/// \brief Overwrite the values of a CSC matrix with the entries of a dense matrix at the stored
+///        sparsity pattern, without allocating.
+/// \param mat dense matrix of the same size as the one csc_mat was created from
+/// \param csc_mat CSC matrix whose values are updated
+/// \param upper_trapezoidal whether csc_mat only stores the upper trapezoidal part of mat
+/// \return false if mat has a non-zero entry outside of the sparsity pattern (the values of
+///         csc_mat are unspecified in this case), true otherwise
+OSQP_INTERFACE_PUBLIC bool updateCSCMatrixValues(
+  const Eigen::MatrixXd & mat, CSC_Matrix & csc_mat, const bool upper_trapezoidal);
 /// \brief Print the given CSC matrix to the standard output
 OSQP_INTERFACE_PUBLIC void printCSCMatrix(const CSC_Matrix & csc_mat);
 
@@ -152,6 +152,14 @@ public:
   void updateL(const std::vector<double> & l_new);
   void updateU(const std::vector<double> & u_new);
   void updateBounds(const std::vector<double> & l_new, const std::vector<double> & u_new);
+  /// \brief Warm start the next call to optimize() on the stored problem from the given values
+  ///        instead of from the solution of the previous call.
+  /// \param primal_variables (n) vector of primal variables
+  /// \param dual_variables (m) vector of dual variables (lagrange multipliers)
+  /// \throw std::invalid_argument if the sizes do not match the stored problem
+  void setWarmStart(
+    const std::vector<float64_t> & primal_variables,
+    const std::vector<float64_t> & dual_variables);
   void updateEpsAbs(const double eps_abs);
   void updateEpsRel(const double eps_rel);
   void updateMaxIter(const int iter);
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cmath>
 #include <exception>
+#include <stdexcept>
 #include <iostream>
 #include <vector>
 
@@ -114,6 +116,71 @@ CSC_Matrix calCSCMatrixTrapezoidal(const Eigen::MatrixXd & mat)
   return csc_matrix;
 }
 
+CSC_Matrix calCSCMatrixTrapezoidalDense(const Eigen::MatrixXd & mat)
+{
+  const Eigen::Index cols = mat.cols();
+
+  if (mat.rows() != cols) {
+    throw std::invalid_argument("Matrix must be square (n, n)");
+  }
+
+  const size_t elem = static_cast<size_t>((cols * (cols + 1)) / 2);
+  std::vector<c_float> vals;
+  vals.reserve(elem);
+  std::vector<c_int> row_idxs;
+  row_idxs.reserve(elem);
+  std::vector<c_int> col_idxs;
+  col_idxs.reserve(static_cast<size_t>(cols + 1));
+
+  col_idxs.push_back(0);
+  for (Eigen::Index j = 0; j < cols; j++) {  // col iteration
+    for (Eigen::Index i = 0; i <= j; i++) {  // row iteration
+      vals.push_back(mat(i, j));
+      row_idxs.push_back(i);
+    }
+    col_idxs.push_back(static_cast<c_int>(vals.size()));
+  }
+
+  CSC_Matrix csc_matrix = {vals, row_idxs, col_idxs};
+
+  return csc_matrix;
+}
+
+bool updateCSCMatrixValues(
+  const Eigen::MatrixXd & mat, CSC_Matrix & csc_mat, const bool upper_trapezoidal)
+{
+  const Eigen::Index rows = mat.rows();
+  const Eigen::Index cols = mat.cols();
+
+  if ((static_cast<Eigen::Index>(csc_mat.m_col_idxs.size()) != (cols + 1)) ||
+    (upper_trapezoidal && (rows != cols)))
+  {
+    return false;
+  }
+
+  for (Eigen::Index j = 0; j < cols; j++) {  // col iteration
+    const size_t col_begin = static_cast<size_t>(csc_mat.m_col_idxs[static_cast<size_t>(j)]);
+    const size_t col_end = static_cast<size_t>(csc_mat.m_col_idxs[static_cast<size_t>(j + 1)]);
+    const Eigen::Index last_row = upper_trapezoidal ? j : (rows - 1);
+    size_t k = col_begin;
+    for (Eigen::Index i = 0; i <= last_row; i++) {  // row iteration
+      if ((k < col_end) && (csc_mat.m_row_idxs[k] == i)) {
+        csc_mat.m_vals[k] = mat(i, j);
+        k++;
+      } else if (std::fabs(mat(i, j)) >= 1e-9) {
+        // Non-zero entry outside of the sparsity pattern
+        return false;
+      }
+    }
+    if (k != col_end) {
+      // The pattern has row indices beyond the size of the matrix
+      return false;
+    }
+  }
+
+  return true;
+}
+
 void printCSCMatrix(const CSC_Matrix & csc_mat)
 {
   std::cout << "[";
@@ -16,6 +16,7 @@
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <tuple>
 #include <vector>
@@ -152,6 +153,21 @@ void OSQPInterface::updateBounds(
   osqp_update_bounds(m_work.get(), l_dyn, u_dyn);
 }
 
+void OSQPInterface::setWarmStart(
+  const std::vector<float64_t> & primal_variables,
+  const std::vector<float64_t> & dual_variables)
+{
+  if (!m_work_initialized) {
+    throw std::invalid_argument("setWarmStart: the problem is not initialized");
+  }
+  if ((static_cast<int64_t>(primal_variables.size()) != m_param_n) ||
+    (static_cast<int64_t>(dual_variables.size()) != static_cast<int64_t>(m_data->m)))
+  {
+    throw std::invalid_argument("setWarmStart: sizes do not match the problem");
+  }
+  osqp_warm_start(m_work.get(), primal_variables.data(), dual_variables.data());
+}
+
 void OSQPInterface::updateEpsAbs(const double eps_abs)
 {
   m_settings->eps_abs = eps_abs;  // for default setting
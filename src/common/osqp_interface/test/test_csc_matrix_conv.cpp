@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <string>
+#include <stdexcept>
 #include <tuple>
 #include <vector>
 
@@ -169,6 +170,78 @@ TEST(TestCscMatrixConv, Trapezoidal) {
     EXPECT_EQ(e.what(), std::string("Matrix must be square (n, n)"));
   }
 }
+TEST(TestCscMatrixConv, TrapezoidalDense) {
+  using autoware::common::osqp::CSC_Matrix;
+  using autoware::common::osqp::calCSCMatrixTrapezoidalDense;
+
+  Eigen::MatrixXd square(3, 3);
+  square << 1.0, 0.0, 3.0,
+    0.0, 5.0, 0.0,
+    7.0, 8.0, 9.0;
+
+  const CSC_Matrix square_m = calCSCMatrixTrapezoidalDense(square);
+  // All upper trapezoidal entries are stored, including zeros
+  ASSERT_EQ(square_m.m_vals.size(), size_t(6));
+  EXPECT_EQ(square_m.m_vals[0], 1.0);
+  EXPECT_EQ(square_m.m_vals[1], 0.0);
+  EXPECT_EQ(square_m.m_vals[2], 5.0);
+  EXPECT_EQ(square_m.m_vals[3], 3.0);
+  EXPECT_EQ(square_m.m_vals[4], 0.0);
+  EXPECT_EQ(square_m.m_vals[5], 9.0);
+  ASSERT_EQ(square_m.m_row_idxs.size(), size_t(6));
+  EXPECT_EQ(square_m.m_row_idxs[0], c_int(0));
+  EXPECT_EQ(square_m.m_row_idxs[1], c_int(0));
+  EXPECT_EQ(square_m.m_row_idxs[2], c_int(1));
+  EXPECT_EQ(square_m.m_row_idxs[3], c_int(0));
+  EXPECT_EQ(square_m.m_row_idxs[4], c_int(1));
+  EXPECT_EQ(square_m.m_row_idxs[5], c_int(2));
+  ASSERT_EQ(square_m.m_col_idxs.size(), size_t(4));
+  EXPECT_EQ(square_m.m_col_idxs[0], c_int(0));
+  EXPECT_EQ(square_m.m_col_idxs[1], c_int(1));
+  EXPECT_EQ(square_m.m_col_idxs[2], c_int(3));
+  EXPECT_EQ(square_m.m_col_idxs[3], c_int(6));
+
+  Eigen::MatrixXd rect(1, 2);
+  rect << 1.0, 2.0;
+  EXPECT_THROW(calCSCMatrixTrapezoidalDense(rect), std::invalid_argument);
+}
+
+TEST(TestCscMatrixConv, UpdateValues) {
+  using autoware::common::osqp::CSC_Matrix;
+  using autoware::common::osqp::calCSCMatrix;
+  using autoware::common::osqp::calCSCMatrixTrapezoidalDense;
+  using autoware::common::osqp::updateCSCMatrixValues;
+
+  Eigen::MatrixXd rect(2, 3);
+  rect << 1.0, 0.0, 3.0,
+    0.0, 5.0, 6.0;
+  CSC_Matrix rect_m = calCSCMatrix(rect);
+
+  // Same pattern, new values. Entries of the pattern may become zero
+  Eigen::MatrixXd rect_new(2, 3);
+  rect_new << 2.0, 0.0, 0.0,
+    0.0, 4.0, 7.0;
+  ASSERT_TRUE(updateCSCMatrixValues(rect_new, rect_m, false));
+  EXPECT_EQ(rect_m.m_vals, (std::vector<c_float>{2.0, 4.0, 0.0, 7.0}));
+  EXPECT_EQ(rect_m.m_row_idxs, (std::vector<c_int>{0, 1, 0, 1}));
+  EXPECT_EQ(rect_m.m_col_idxs, (std::vector<c_int>{0, 1, 2, 4}));
+
+  // Non-zero entry outside of the pattern
+  rect_new(1, 0) = 1.0;
+  EXPECT_FALSE(updateCSCMatrixValues(rect_new, rect_m, false));
+  // Size mismatch
+  EXPECT_FALSE(updateCSCMatrixValues(Eigen::MatrixXd::Ones(2, 2), rect_m, false));
+
+  Eigen::MatrixXd square = Eigen::MatrixXd::Zero(2, 2);
+  CSC_Matrix square_m = calCSCMatrixTrapezoidalDense(square);
+  Eigen::MatrixXd square_new(2, 2);
+  square_new << 1.0, 2.0,
+    2.0, 3.0;
+  // The lower triangular part is ignored
+  ASSERT_TRUE(updateCSCMatrixValues(square_new, square_m, true));
+  EXPECT_EQ(square_m.m_vals, (std::vector<c_float>{1.0, 2.0, 3.0}));
+}
+
 TEST(TestCscMatrixConv, Print) {
   using autoware::common::osqp::CSC_Matrix;
   using autoware::common::osqp::printCSCMatrix;
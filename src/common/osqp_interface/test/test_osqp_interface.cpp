@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <stdexcept>
 #include <tuple>
 #include <vector>
 
@@ -132,5 +133,27 @@ TEST(TestOsqpInterface, BasicQp) {
     result = osqp.optimize();
     check_result(result);
   }
+
+  {
+    using autoware::common::osqp::calCSCMatrixTrapezoidalDense;
+    using autoware::common::osqp::updateCSCMatrixValues;
+    // Persistent workspace: keep the sparsity pattern and only update the values
+    CSC_Matrix P_csc = calCSCMatrixTrapezoidalDense(Eigen::MatrixXd::Zero(2, 2));
+    CSC_Matrix A_csc = calCSCMatrix(A);
+    std::vector<float64_t> q_ini(2, 0.0);
+    autoware::common::osqp::OSQPInterface osqp(P_csc, A_csc, q_ini, l, u, 1e-6);
+    osqp.optimize();
+
+    ASSERT_TRUE(updateCSCMatrixValues(P, P_csc, true));
+    osqp.updateCscP(P_csc);
+    osqp.updateQ(q);
+    osqp.updateBounds(l, u);
+    EXPECT_THROW(osqp.setWarmStart({0.3}, {-2.9, 0.0, 0.2, 0.0}), std::invalid_argument);
+    EXPECT_THROW(osqp.setWarmStart({0.3, 0.7}, {-2.9, 0.0}), std::invalid_argument);
+    osqp.setWarmStart({0.3, 0.7}, {-2.9, 0.0, 0.2, 0.0});
+    std::tuple<std::vector<float64_t>, std::vector<float64_t>, int, int,
+      int> result = osqp.optimize();
+    check_result(result);
+  }
 }
 }  // namespace
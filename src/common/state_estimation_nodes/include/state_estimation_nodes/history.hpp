@@ -29,9 +29,10 @@
 #include <Eigen/Core>
 
 #include <chrono>
-#include <map>
 #include <memory>
+#include <stdexcept>
 #include <utility>
+#include <vector>
 
 namespace autoware
 {
@@ -91,11 +92,15 @@ struct ResetEvent
 ///
 /// @brief      This class encapsulates a history of events used with EKF.
 ///
-///             The class handles adding events to a history of a specified size. It models the
-///             behavior of a circular buffer, meaning that as new events come in, the oldest ones
-///             are removed. The events can be either measurement types or specific events like
-///             reset or prediction. Whenever an event is added to the middle of the history all the
-///             following events get rolled on top of this event to produce a new state.
+///             The class handles adding events to a history of a specified size. It is stored in a
+///             circular buffer kept sorted by timestamp, meaning that as new events come in, the
+///             oldest ones are removed. The buffer is allocated once up front, so adding events
+///             does not allocate in steady state. The events can be either measurement types or
+///             specific events like reset or prediction. Every entry keeps the filter state after
+///             its event, i.e. acts as a checkpoint. Whenever an event is added to the middle of
+///             the history the filter is restored from the checkpoint right before it and all the
+///             following events get rolled on top of this event to produce a new state. The number
+///             of events that may be replayed like this can be bounded.
 ///
 /// @tparam     FilterT       Type of EKF filter used.
 /// @tparam     kNumOfStates  Dimensionality of the state in the filter.
@@ -116,24 +121,33 @@ class History
 
   /// Typedef for timestamps.
   using Timestamp = std::chrono::system_clock::time_point;
-  /// Typedef for history map type.
-  using HistoryMap = std::multimap<Timestamp, HistoryEntry>;
+  /// Typedef for the storage of history entries.
+  using EntryVector = std::vector<HistoryEntry, Eigen::aligned_allocator<HistoryEntry>>;
 
 public:
   ///
   /// @brief      Construct history from a filter pointer with a specific size.
   ///
   /// @param      filter                 The filter pointer to be used internally.
-  /// @param[in]  max_history_size       The maximum history size.
+  /// @param[in]  max_history_size       The maximum history size. Zero means unbounded.
   /// @param[in]  mahalanobis_threshold  The mahalanobis threshold
+  /// @param[in]  max_replay_size        The maximum number of events that may be replayed when an
+  ///                                    event is added to the middle of history. Zero means
+  ///                                    unbounded.
   ///
   explicit History(
     FilterT & filter,
     const std::size_t max_history_size,
-    const common::types::float32_t mahalanobis_threshold)
+    const common::types::float32_t mahalanobis_threshold,
+    const std::size_t max_replay_size = 0U)
   : m_filter{filter},
     m_max_history_size{max_history_size},
-    m_mahalanobis_threshold{mahalanobis_threshold} {}
+    m_max_replay_size{max_replay_size},
+    m_mahalanobis_threshold{mahalanobis_threshold}
+  {
+    m_entries.reserve(max_history_size);
+    m_timestamps.reserve(max_history_size);
+  }
 
   ///
   /// @brief      Add an event to history. If it is added to the middle the following ones are
@@ -142,15 +156,24 @@ public:
   /// @param[in]  timestamp  The timestamp of the event.
   /// @param[in]  entry      The entry to be added to history.
   ///
-  void emplace_event(const Timestamp & timestamp, const HistoryEntry & entry);
+  /// @return     False if the event was dropped because it would have required replaying more
+  ///             than max_replay_size events, true otherwise.
+  ///
+  common::types::bool8_t emplace_event(const Timestamp & timestamp, const HistoryEntry & entry);
   /// @brief      Check if the history is empty.
-  inline bool empty() const noexcept {return m_history.empty();}
+  inline bool empty() const noexcept {return m_size == 0U;}
   /// @brief      Get size of history.
-  inline std::size_t size() const noexcept {return m_history.size();}
+  inline std::size_t size() const noexcept {return m_size;}
   /// @brief      Get last timestamp in history.
-  inline const Timestamp & get_last_timestamp() const noexcept {return m_history.rbegin()->first;}
+  inline const Timestamp & get_last_timestamp() const noexcept
+  {
+    return m_timestamps[slot(m_size - 1U)];
+  }
   /// @brief      Get last event in history.
-  inline const HistoryEntry & get_last_event() const noexcept {return m_history.rbegin()->second;}
+  inline const HistoryEntry & get_last_event() const noexcept
+  {
+    return m_entries[slot(m_size - 1U)];
+  }
   /// @brief      Get the filter as a const ref.
   const FilterT & get_filter() const noexcept {return m_filter;}
   /// @brief      Get the filter.
@@ -162,21 +185,48 @@ private:
   ///
   inline void drop_oldest_event_if_needed()
   {
-    if ((m_history.size() >= m_max_history_size) && (m_max_history_size > 0U)) {
-      (void) m_history.erase(m_history.begin());
+    if ((m_size >= m_max_history_size) && (m_max_history_size > 0U)) {
+      m_head = slot(1U);
+      --m_size;
     }
   }
 
+  /// @brief      Map a position in history (0 is the oldest event) to a slot in the buffer.
+  inline std::size_t slot(const std::size_t index) const noexcept
+  {
+    const auto position = m_head + index;
+    return (position < m_entries.size()) ? position : (position - m_entries.size());
+  }
+
+  ///
+  /// @brief      Find the position after all events with a timestamp not later than the given one.
+  ///
+  std::size_t upper_bound(const Timestamp & timestamp) const noexcept;
+
+  ///
+  /// @brief      Insert an entry at a position, moving all the following ones back by one slot.
+  ///
+  void insert(const std::size_t index, const Timestamp & timestamp, const HistoryEntry & entry);
+
+  ///
+  /// @brief      Remove the entry at a position, moving all the following ones forward by one slot.
+  ///
+  void erase(const std::size_t index);
+
   ///
   /// @brief      Update all the following events as their state is based on the current one.
   ///
-  /// @param[in]  start_iter  The current iterator with the new state.
+  /// @param[in]  start_index  The position of the event with the new state.
   ///
-  void update_impacted_events(const typename HistoryMap::iterator & start_iter);
+  void update_impacted_events(const std::size_t start_index);
 
-  HistoryMap m_history{};  ///< history of events.
+  EntryVector m_entries{};  ///< Ring buffer of history entries.
+  std::vector<Timestamp> m_timestamps{};  ///< Timestamps matching the entries slot by slot.
+  std::size_t m_head{};  ///< Slot of the oldest event.
+  std::size_t m_size{};  ///< Number of events in history.
   FilterT & m_filter{};  ///< pointer to the filter implementation.
   std::size_t m_max_history_size{};  ///< Maximum number of events in history.
+  std::size_t m_max_replay_size{};  ///< Maximum number of events replayed on an insertion.
   common::types::float32_t m_mahalanobis_threshold{};  ///< Mahalanobis distance threshold.
 };
 
@@ -275,44 +325,97 @@ private:
 };
 
 template<typename FilterT, typename ... EventT>
-void History<FilterT, EventT...>::emplace_event(
+common::types::bool8_t History<FilterT, EventT...>::emplace_event(
   const Timestamp & timestamp, const HistoryEntry & entry)
 {
+  auto index = upper_bound(timestamp);
+  if ((m_max_replay_size > 0U) && ((m_size - index) > m_max_replay_size)) {
+    return false;
+  }
+  if ((m_size >= m_max_history_size) && (m_max_history_size > 0U) && (index > 0U)) {
+    --index;
+  }
   drop_oldest_event_if_needed();
-  const auto iterator_to_inserted_position = m_history.emplace(timestamp, entry);
-  update_impacted_events(iterator_to_inserted_position);
+  insert(index, timestamp, entry);
+  update_impacted_events(index);
+  return true;
+}
+
+template<typename FilterT, typename ... EventT>
+std::size_t History<FilterT, EventT...>::upper_bound(const Timestamp & timestamp) const noexcept
+{
+  std::size_t first = 0U;
+  std::size_t count = m_size;
+  while (count > 0U) {
+    const auto step = count / 2U;
+    const auto middle = first + step;
+    if (!(timestamp < m_timestamps[slot(middle)])) {
+      first = middle + 1U;
+      count -= step + 1U;
+    } else {
+      count = step;
+    }
+  }
+  return first;
+}
+
+template<typename FilterT, typename ... EventT>
+void History<FilterT, EventT...>::insert(
+  const std::size_t index, const Timestamp & timestamp, const HistoryEntry & entry)
+{
+  if (m_size == m_entries.size()) {
+    // Only happens while the buffer is still growing to its capacity, the ring has not wrapped
+    // around yet, so the new slot is the logical end.
+    m_entries.push_back(entry);
+    m_timestamps.push_back(timestamp);
+  }
+  for (auto i = m_size; i > index; --i) {
+    m_entries[slot(i)] = std::move(m_entries[slot(i - 1U)]);
+    m_timestamps[slot(i)] = m_timestamps[slot(i - 1U)];
+  }
+  m_entries[slot(index)] = entry;
+  m_timestamps[slot(index)] = timestamp;
+  ++m_size;
+}
+
+template<typename FilterT, typename ... EventT>
+void History<FilterT, EventT...>::erase(const std::size_t index)
+{
+  for (auto i = index + 1U; i < m_size; ++i) {
+    m_entries[slot(i - 1U)] = std::move(m_entries[slot(i)]);
+    m_timestamps[slot(i - 1U)] = m_timestamps[slot(i)];
+  }
+  --m_size;
 }
 
 template<typename FilterT, typename ... EventT>
-void History<FilterT, EventT...>::update_impacted_events(
-  const typename HistoryMap::iterator & start_iter)
+void History<FilterT, EventT...>::update_impacted_events(const std::size_t start_index)
 {
   Timestamp previous_timestamp{};
-  if (start_iter == m_history.begin()) {
-    if (!mpark::holds_alternative<ResetEvent<FilterT>>(start_iter->second.event())) {
-      (void) m_history.erase(start_iter);
+  if (start_index == 0U) {
+    if (!mpark::holds_alternative<ResetEvent<FilterT>>(m_entries[slot(start_index)].event())) {
+      erase(start_index);
       throw std::runtime_error(
               "Non-reset event inserted to the beginning of history. This might "
               "happen if a very old event is inserted into the queue. Consider "
               "increasing the queue size or debug program latencies.");
     }
   } else {
-    const auto prev_iter = std::prev(start_iter);
-    previous_timestamp = prev_iter->first;
-    const auto & prev_entry = prev_iter->second;
+    const auto & prev_entry = m_entries[slot(start_index - 1U)];
+    previous_timestamp = m_timestamps[slot(start_index - 1U)];
     m_filter.reset(
       typename FilterT::State{prev_entry.stored_state()},
       prev_entry.stored_covariance());
   }
-  for (auto iter = start_iter; iter != m_history.end(); ++iter) {
-    const auto current_timestamp = iter->first;
-    auto & entry = iter->second;
+  for (auto index = start_index; index < m_size; ++index) {
+    const auto current_timestamp = m_timestamps[slot(index)];
+    auto & entry = m_entries[slot(index)];
     mpark::visit(
       EkfStateUpdater{m_filter, m_mahalanobis_threshold, current_timestamp - previous_timestamp},
       entry.event());
     entry.update_stored_state(m_filter.state());
     entry.update_stored_covariance(m_filter.covariance());
-    previous_timestamp = iter->first;
+    previous_timestamp = current_timestamp;
   }
 }
 
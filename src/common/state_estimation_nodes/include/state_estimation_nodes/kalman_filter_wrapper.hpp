@@ -80,6 +80,9 @@ public:
   /// @param[in]  history_duration          Length of the history of events.
   /// @param[in]  mahalanobis_threshold     The threshold on the Mahalanobis distance for outlier
   ///                                       rejection.
+  /// @param[in]  max_replay_size           The maximum number of history events that may be
+  ///                                       replayed to incorporate a late observation. Later
+  ///                                       observations are dropped. Zero means unbounded.
   ///
   KalmanFilterWrapper(
     const typename FilterT::MotionModel motion_model,
@@ -89,7 +92,8 @@ public:
     const std::string & frame_id,
     const std::chrono::nanoseconds & history_duration = std::chrono::milliseconds{5000},
     common::types::float32_t mahalanobis_threshold =
-    std::numeric_limits<common::types::float32_t>::max())
+    std::numeric_limits<common::types::float32_t>::max(),
+    const std::size_t max_replay_size = 0U)
   : m_initial_covariance{initial_state_covariance},
     m_frame_id{frame_id},
     m_mahalanobis_threshold{mahalanobis_threshold},
@@ -103,7 +107,8 @@ public:
     m_history{
       m_filter,
       static_cast<std::size_t>(history_duration / expected_dt),
-      m_mahalanobis_threshold} {}
+      m_mahalanobis_threshold,
+      max_replay_size} {}
 
   ///
   /// Reset the filter state using the default covariance and state derived from the measurement.
@@ -162,15 +167,15 @@ public:
   /// @tparam     MeasurementT           Measurement type that is a concrete template specialization
   ///                                    of the Measurement class.
   ///
-  /// @return     true if the observation was successful, false otherwise. In case of an
+  /// @return     true if the observation was successful, false otherwise, i.e. if the filter is
+  ///             not initialized or the observation is too late to be replayed. In case of an
   ///             unsuccessful update, the state of the underlying filter has not been changed.
   ///
   template<typename MeasurementT>
   common::types::bool8_t add_observation_to_history(const MeasurementT & measurement)
   {
     if (!is_initialized()) {return false;}
-    m_history.emplace_event(measurement.timestamp, measurement.measurement);
-    return true;
+    return m_history.emplace_event(measurement.timestamp, measurement.measurement);
   }
 
   /// Check if the filter is is_initialized with a state.
@@ -127,6 +127,10 @@ StateEstimationNode::StateEstimationNode(
     declare_parameter("state_variances", std::vector<float64_t>{})};
   const auto mahalanobis_threshold{
     declare_parameter("mahalanobis_threshold", std::numeric_limits<float32_t>::max())};
+  const auto max_replay_events{declare_parameter("max_replay_events", std::int64_t{0})};
+  if (max_replay_events < 0) {
+    throw std::domain_error("The max_replay_events parameter must not be negative.");
+  }
 
   using State = typename FilterWrapperT::State;
   m_ekf = std::make_unique<FilterWrapperT>(
@@ -136,7 +140,8 @@ StateEstimationNode::StateEstimationNode(
     time_between_publish_requests,
     m_frame_id,
     kDefaultHistoryLength,
-    mahalanobis_threshold);
+    mahalanobis_threshold,
+    static_cast<std::size_t>(max_replay_events));
 
 
   const std::vector<std::string> empty_vector{};
@@ -170,7 +175,7 @@ void StateEstimationNode::pose_callback(const PoseMsgT::SharedPtr msg)
     convert_to<Stamped<PoseMeasurementXYZRPY64>>::from(*msg).cast<float32_t>();
   if (m_ekf->is_initialized()) {
     if (!m_ekf->add_observation_to_history(measurement)) {
-      throw std::runtime_error("Cannot add a pose observation to history.");
+      RCLCPP_WARN(get_logger(), "Dropped a pose observation that arrived too late to replay.");
     }
   } else {
     m_ekf->add_reset_event_to_history(measurement);
@@ -188,7 +193,8 @@ void StateEstimationNode::relative_pos_callback(const RelativePosMsgT::SharedPtr
   const auto measurement = convert_to<Stamped<PoseMeasurementXYZ64>>::from(*msg).cast<float32_t>();
   if (m_ekf->is_initialized()) {
     if (!m_ekf->add_observation_to_history(measurement)) {
-      throw std::runtime_error("Cannot add a relative pose observation to history.");
+      RCLCPP_WARN(
+        get_logger(), "Dropped a relative pose observation that arrived too late to replay.");
     }
   } else {
     m_ekf->add_reset_event_to_history(measurement);
@@ -0,0 +1,102 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <benchmark/benchmark.h>
+#include <measurement_conversion/measurement_typedefs.hpp>
+#include <state_estimation_nodes/filter_typedefs.hpp>
+#include <state_estimation_nodes/history.hpp>
+
+#include <chrono>
+#include <limits>
+#include <vector>
+
+using autoware::common::state_estimation::ConstAccelerationKalmanFilterXYZRPY;
+using autoware::common::state_estimation::History;
+using autoware::common::state_estimation::PoseMeasurementXYZ32;
+using autoware::common::state_estimation::PoseMeasurementXYZRPY32;
+using autoware::common::state_estimation::PredictionEvent;
+using autoware::common::state_estimation::ResetEvent;
+
+namespace
+{
+
+using FilterT = ConstAccelerationKalmanFilterXYZRPY;
+using State = FilterT::State;
+using HistoryT = History<
+  FilterT, PredictionEvent, ResetEvent<FilterT>, PoseMeasurementXYZ32, PoseMeasurementXYZRPY32>;
+
+constexpr std::chrono::milliseconds kPredictionPeriod{10};
+constexpr std::size_t kHistorySize = 500U;
+/// A late localizer pose arrives once every this many prediction cycles.
+constexpr std::int64_t kLatePoseEveryCycles = 10;
+
+FilterT create_filter()
+{
+  return FilterT{
+    autoware::common::motion_model::LinearMotionModel<State>{},
+    autoware::common::state_estimation::make_wiener_noise<State>(
+      std::vector<float>{2.0F, 2.0F, 2.0F, 2.0F, 2.0F, 2.0F}),
+    State{},
+    State::Matrix::Identity()};
+}
+
+}  // namespace
+
+/// A 100Hz prediction and odometry stream with a late localizer pose every 100ms. The first
+/// argument is the latency of the pose in prediction cycles, the second one the replay bound.
+static void BenchHistoryLatePoses(benchmark::State & state)
+{
+  const auto latency_cycles = state.range(0);
+  const auto max_replay_size = static_cast<std::size_t>(state.range(1));
+  auto filter = create_filter();
+  HistoryT history{
+    filter, kHistorySize, std::numeric_limits<float>::max(), max_replay_size};
+  auto timestamp = std::chrono::system_clock::time_point{};
+  history.emplace_event(timestamp, ResetEvent<FilterT>{State{}, State::Matrix::Identity()});
+  const PoseMeasurementXYZ32 odometry{
+    PoseMeasurementXYZ32::State::Vector::Zero(), PoseMeasurementXYZ32::State::Matrix::Identity()};
+  const PoseMeasurementXYZRPY32 pose{
+    PoseMeasurementXYZRPY32::State::Vector::Zero(),
+    PoseMeasurementXYZRPY32::State::Matrix::Identity()};
+  std::int64_t cycle = 0;
+  std::int64_t dropped = 0;
+  const auto run_cycle = [&](const bool with_poses) {
+      timestamp += kPredictionPeriod;
+      history.emplace_event(timestamp, PredictionEvent{});
+      history.emplace_event(timestamp + kPredictionPeriod / 2, odometry);
+      if (with_poses && ((++cycle % kLatePoseEveryCycles) == 0)) {
+        if (!history.emplace_event(
+            timestamp - latency_cycles * kPredictionPeriod + kPredictionPeriod / 4, pose))
+        {
+          ++dropped;
+        }
+      }
+    };
+  // Fill the history so that late poses never land before its beginning.
+  while (history.size() < kHistorySize) {
+    run_cycle(false);
+  }
+  for (auto _ : state) {
+    run_cycle(true);
+    benchmark::DoNotOptimize(history.get_last_event().stored_state());
+  }
+  state.counters["dropped"] = static_cast<double>(dropped);
+}
+
+BENCHMARK(BenchHistoryLatePoses)
+->Args({5, 0})->Args({20, 0})->Args({50, 0})
+->Args({20, 32})->Args({50, 32})
+->Unit(benchmark::kMicrosecond);
@@ -71,6 +71,25 @@ public:
   MOCK_METHOD(void, correct, (Measurement));
 };
 
+/// A filter whose state depends on the order in which the measurements are applied.
+class OrderSensitiveFilter
+{
+public:
+  using State = FilterState;
+
+  State state() const {return m_state;}
+  State::Matrix covariance() const {return State::Matrix::Identity();}
+  void reset(const State & state, const State::Matrix &) {m_state = state;}
+  void predict(std::chrono::system_clock::duration) {}
+  void correct(const Measurement & measurement)
+  {
+    m_state.vector() = 0.5F * m_state.vector() + measurement.state().vector();
+  }
+
+private:
+  State m_state{};
+};
+
 using ::testing::_;
 using ::testing::Return;
 
@@ -216,3 +235,65 @@ TEST(HistoryTest, ExhaustHistory) {
   }
   ASSERT_EQ(history_size, history.size());
 }
+
+/// @test Test that events that would need too long a replay are dropped.
+TEST(HistoryTest, BoundedReplay) {
+  using HistoryT = History<MockFilter, PredictionEvent, ResetEvent<MockFilter>, Measurement>;
+
+  const std::chrono::system_clock::time_point timestamp{std::chrono::system_clock::now()};
+  const std::chrono::system_clock::duration dt{std::chrono::milliseconds{10}};
+  const FilterState state{FilterState::Vector{23.0F}};
+  const FilterState::Matrix covariance{23.0F * FilterState::Matrix::Identity()};
+  auto filter = std::make_unique<MockFilter>();
+  HistoryT history{*filter, 10U, 100, 1U};
+  EXPECT_CALL(history.get_filter(), state()).WillRepeatedly(Return(state));
+  EXPECT_CALL(history.get_filter(), covariance()).WillRepeatedly(Return(covariance));
+  // The initial reset, two measurements at the end and one late measurement that replays one event.
+  EXPECT_CALL(history.get_filter(), reset(state, covariance)).Times(4);
+  EXPECT_CALL(history.get_filter(), predict(_)).Times(4);
+  EXPECT_CALL(history.get_filter(), correct(_)).Times(4);
+
+  EXPECT_TRUE(history.emplace_event(timestamp, ResetEvent<MockFilter>{state, covariance}));
+  EXPECT_TRUE(history.emplace_event(timestamp + dt, Measurement{state.vector(), covariance}));
+  EXPECT_TRUE(history.emplace_event(timestamp + 2 * dt, Measurement{state.vector(), covariance}));
+  // Two events would have to be replayed, so this one is dropped.
+  EXPECT_FALSE(history.emplace_event(timestamp + dt / 2, Measurement{state.vector(), covariance}));
+  EXPECT_EQ(3U, history.size());
+  // Only one event is replayed here.
+  EXPECT_TRUE(
+    history.emplace_event(timestamp + 3 * dt / 2, Measurement{state.vector(), covariance}));
+  EXPECT_EQ(4U, history.size());
+  EXPECT_EQ(timestamp + 2 * dt, history.get_last_timestamp());
+}
+
+/// @test Test that late events are replayed in order after the history has wrapped around.
+TEST(HistoryTest, KeepsOrderAcrossWraparound) {
+  using HistoryT =
+    History<OrderSensitiveFilter, PredictionEvent, ResetEvent<OrderSensitiveFilter>, Measurement>;
+
+  const auto history_size = 4U;
+  const std::chrono::system_clock::time_point timestamp{};
+  const std::chrono::system_clock::duration dt{std::chrono::milliseconds{10}};
+  OrderSensitiveFilter filter{};
+  HistoryT history{filter, history_size, 100};
+  const auto measurement = [](const float value) {
+      return Measurement{MeasurementState::Vector{value}, MeasurementState::Matrix::Identity()};
+    };
+
+  history.emplace_event(
+    timestamp,
+    ResetEvent<OrderSensitiveFilter>{FilterState{}, FilterState::Matrix::Identity()});
+  for (auto i = 1; i <= 5; ++i) {
+    history.emplace_event(timestamp + i * dt, measurement(static_cast<float>(i)));
+  }
+  history.emplace_event(timestamp + 7 * dt / 2, measurement(3.5F));
+  history.emplace_event(timestamp + 9 * dt / 2, measurement(4.5F));
+
+  float expected = 0.0F;
+  for (const auto value : {1.0F, 2.0F, 3.0F, 3.5F, 4.0F, 4.5F, 5.0F}) {
+    expected = 0.5F * expected + value;
+  }
+  ASSERT_EQ(history_size, history.size());
+  EXPECT_EQ(timestamp + 5 * dt, history.get_last_timestamp());
+  EXPECT_FLOAT_EQ(expected, history.get_last_event().stored_state().vector()(0));
+}
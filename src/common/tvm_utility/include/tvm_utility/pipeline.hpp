@@ -19,9 +19,18 @@
 #include <tvm_vendor/tvm/runtime/packed_func.h>
 #include <tvm_vendor/tvm/runtime/registry.h>
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -50,7 +59,7 @@ public:
     handle_ = std::make_shared<TVMArrayHandle>(x);
   }
 
-  TVMArrayHandle getArray() const {return *handle_.get();}
+  TVMArrayHandle getArray() const {return handle_ ? *handle_ : nullptr;}
 
 private:
   std::shared_ptr<TVMArrayHandle> handle_{nullptr, [](TVMArrayHandle ptr) {
@@ -62,6 +71,140 @@ private:
 
 using TVMArrayContainerVector = std::vector<TVMArrayContainer>;
 
+/**
+ * @brief Copy the content of a set of tensors into a set of tensors living in
+ * host memory. The destination tensors are (re)allocated with the shape and
+ * data type of the source tensors if they do not match already, so that a
+ * destination which is reused for tensors of the same layout only allocates
+ * once.
+ *
+ * @param src The tensors to copy.
+ * @param dst The destination tensors.
+ * @throw std::runtime_error If TVM fails to copy the data.
+ */
+inline void copyTVMArrays(const TVMArrayContainerVector & src, TVMArrayContainerVector & dst)
+{
+  auto same_layout = [](const DLTensor * lhs, const DLTensor * rhs) {
+      if ((lhs->ndim != rhs->ndim) || (lhs->dtype.code != rhs->dtype.code) ||
+        (lhs->dtype.bits != rhs->dtype.bits) || (lhs->dtype.lanes != rhs->dtype.lanes))
+      {
+        return false;
+      }
+      return std::equal(lhs->shape, lhs->shape + lhs->ndim, rhs->shape);
+    };
+
+  dst.resize(src.size());
+  for (std::size_t index = 0; index < src.size(); ++index) {
+    const TVMArrayHandle from = src[index].getArray();
+    if (from == nullptr) {
+      throw std::runtime_error("copyTVMArrays: source variable is null");
+    }
+    if ((dst[index].getArray() == nullptr) || !same_layout(from, dst[index].getArray())) {
+      dst[index] = TVMArrayContainer(
+        std::vector<int64_t>(from->shape, from->shape + from->ndim),
+        static_cast<DLDataTypeCode>(from->dtype.code), from->dtype.bits, from->dtype.lanes,
+        kDLCPU, 0);
+    }
+    if (TVMArrayCopyFromTo(from, dst[index].getArray(), nullptr) != 0) {
+      throw std::runtime_error(std::string("copyTVMArrays: ") + TVMGetLastError());
+    }
+  }
+}
+
+/**
+ * @class BoundedQueue
+ * @brief Thread-safe FIFO queue with a fixed capacity, used to hand data over
+ * between the stages of an asynchronous pipeline.
+ *
+ * @tparam T The type of the queued elements.
+ */
+template<class T>
+class BoundedQueue
+{
+public:
+  /**
+   * @brief Construct a new BoundedQueue object
+   *
+   * @param capacity The maximum number of queued elements, at least 1.
+   */
+  explicit BoundedQueue(std::size_t capacity)
+  : capacity_(capacity > 0U ? capacity : 1U) {}
+
+  /**
+   * @brief Append an element, waiting for free space if the queue is full.
+   *
+   * @param item The element to append.
+   * @return False if the queue was closed, in which case the element is dropped.
+   */
+  bool push(T item)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] {return closed_ || (items_.size() < capacity_);});
+    if (closed_) {
+      return false;
+    }
+    items_.push_back(std::move(item));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Append an element if there is free space.
+   *
+   * @param item The element to append.
+   * @return False if the queue is full or closed, in which case the element is dropped.
+   */
+  bool try_push(T item)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_ || (items_.size() >= capacity_)) {
+      return false;
+    }
+    items_.push_back(std::move(item));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Remove the oldest element, waiting for one if the queue is empty.
+   *
+   * @param item Receives the removed element.
+   * @return False if the queue is closed and all elements were consumed.
+   */
+  bool pop(T & item)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] {return closed_ || !items_.empty();});
+    if (items_.empty()) {
+      return false;
+    }
+    item = std::move(items_.front());
+    items_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Refuse further elements and wake up all waiting threads. Elements
+   * already in the queue can still be popped.
+   */
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+private:
+  const std::size_t capacity_;
+  std::deque<T> items_{};
+  bool closed_{false};
+  std::mutex mutex_{};
+  std::condition_variable not_empty_{};
+  std::condition_variable not_full_{};
+};
+
 /**
  * @class PipelineStage
  * @brief Base class for all types of pipeline stages.
@@ -144,23 +287,246 @@ public:
     inference_engine_(inference_engine),
     post_processor_(post_processor) {}
 
+  Pipeline(const Pipeline &) = delete;
+  Pipeline & operator=(const Pipeline &) = delete;
+
+  /**
+   * @brief Destroy the Pipeline object, stopping the asynchronous mode if it
+   * is running.
+   */
+  ~Pipeline()
+  {
+    try {
+      stop_async();
+    } catch (...) {
+      // Errors of the worker threads cannot be reported anymore
+    }
+  }
+
   /**
-   * @brief run the pipeline. Return asynchronously in a callback.
+   * @brief Run the pipeline synchronously on the caller's thread.
    *
    * @param input The data to push into the pipeline
    * @return The pipeline output
+   * @throw std::logic_error If the asynchronous mode is running.
    */
   OutputType schedule(const InputType & input)
   {
+    if (async_) {
+      throw std::logic_error("schedule: the pipeline is running in asynchronous mode");
+    }
     auto input_tensor = pre_processor_.schedule(input);
     auto output_tensor = inference_engine_.schedule(input_tensor);
     return post_processor_.schedule(output_tensor);
   }
 
+  /**
+   * @brief Start the asynchronous mode. Each stage runs on its own thread, so
+   * that pre-processing of frame N+1, inference of frame N and
+   * post-processing of frame N-1 overlap. The tensors are handed over between
+   * the stages through buffer_count preallocated buffer sets per stage
+   * boundary, which are rotated between the stages. Their content is copied
+   * from the stage outputs, so stages may keep reusing their own output
+   * buffers. The stages must not share mutable state between frames.
+   *
+   * @param callback Called on the post-processing thread with the output of
+   * each frame, in the order the frames were scheduled.
+   * @param buffer_count The number of frames each stage boundary can hold. It
+   * also bounds the queue of frames waiting for the pre-processor.
+   * @throw std::logic_error If the asynchronous mode is already running.
+   * @throw std::invalid_argument If the callback is empty.
+   */
+  void start_async(std::function<void(OutputType)> callback, std::size_t buffer_count = 2U)
+  {
+    if (async_) {
+      throw std::logic_error("start_async: the pipeline is already running in asynchronous mode");
+    }
+    if (!callback) {
+      throw std::invalid_argument("start_async: the result callback is empty");
+    }
+    async_ = std::make_unique<AsyncState>(std::move(callback), buffer_count);
+    AsyncState & state = *async_;
+    state.pre_thread = std::thread([this, &state] {run_pre_processor(state);});
+    state.inference_thread = std::thread([this, &state] {run_inference_engine(state);});
+    state.post_thread = std::thread([this, &state] {run_post_processor(state);});
+  }
+
+  /**
+   * @brief Queue a frame for the asynchronous mode. Does not block: if
+   * buffer_count frames are already waiting for the pre-processor, the frame
+   * is dropped.
+   *
+   * @param input The data to push into the pipeline
+   * @return True if the frame was queued, false if it was dropped.
+   * @throw std::logic_error If the asynchronous mode is not running.
+   * @throw Any exception thrown by a stage since the last call, in which case
+   * the frame that caused it was dropped and the given frame is not queued.
+   */
+  bool schedule_async(const InputType & input)
+  {
+    if (!async_) {
+      throw std::logic_error("schedule_async: the asynchronous mode is not running");
+    }
+    async_->rethrow_error();
+    return async_->input_queue.try_push(input);
+  }
+
+  /**
+   * @brief Stop the asynchronous mode. All queued frames are processed and
+   * their callbacks are called before this function returns. Does nothing if
+   * the asynchronous mode is not running.
+   *
+   * @throw Any exception thrown by a stage and not reported yet.
+   */
+  void stop_async()
+  {
+    if (!async_) {
+      return;
+    }
+    std::unique_ptr<AsyncState> state{std::move(async_)};
+    state->input_queue.close();
+    state->pre_thread.join();
+    state->inference_thread.join();
+    state->post_thread.join();
+    state->rethrow_error();
+  }
+
 private:
+  /**
+   * @brief Queues, buffers and threads of the asynchronous mode. Buffers are
+   * referred to by their index; the free lists hold the indices of the buffers
+   * which can be written by the producing stage.
+   */
+  struct AsyncState
+  {
+    AsyncState(std::function<void(OutputType)> result_callback, std::size_t buffer_count)
+    : callback(std::move(result_callback)),
+      input_queue(buffer_count),
+      input_tensors(buffer_count),
+      output_tensors(buffer_count),
+      free_input_tensors(buffer_count),
+      free_output_tensors(buffer_count),
+      inference_queue(buffer_count),
+      post_queue(buffer_count)
+    {
+      for (std::size_t index = 0; index < input_tensors.size(); ++index) {
+        free_input_tensors.push(index);
+        free_output_tensors.push(index);
+      }
+    }
+
+    void set_error(std::exception_ptr exception)
+    {
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error) {
+        error = exception;
+      }
+    }
+
+    void rethrow_error()
+    {
+      std::exception_ptr exception{};
+      {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        std::swap(exception, error);
+      }
+      if (exception) {
+        std::rethrow_exception(exception);
+      }
+    }
+
+    std::function<void(OutputType)> callback;
+    BoundedQueue<InputType> input_queue;
+    std::vector<TVMArrayContainerVector> input_tensors;
+    std::vector<TVMArrayContainerVector> output_tensors;
+    BoundedQueue<std::size_t> free_input_tensors;
+    BoundedQueue<std::size_t> free_output_tensors;
+    BoundedQueue<std::size_t> inference_queue;
+    BoundedQueue<std::size_t> post_queue;
+    std::mutex error_mutex{};
+    std::exception_ptr error{};
+    std::thread pre_thread{};
+    std::thread inference_thread{};
+    std::thread post_thread{};
+  };
+
+  void run_pre_processor(AsyncState & state)
+  {
+    InputType input{};
+    std::size_t buffer{};
+    while (state.input_queue.pop(input)) {
+      TVMArrayContainerVector tensors{};
+      try {
+        tensors = pre_processor_.schedule(input);
+      } catch (...) {
+        state.set_error(std::current_exception());
+        continue;
+      }
+      state.free_input_tensors.pop(buffer);
+      try {
+        copyTVMArrays(tensors, state.input_tensors[buffer]);
+      } catch (...) {
+        state.free_input_tensors.push(buffer);
+        state.set_error(std::current_exception());
+        continue;
+      }
+      state.inference_queue.push(buffer);
+    }
+    state.inference_queue.close();
+  }
+
+  void run_inference_engine(AsyncState & state)
+  {
+    std::size_t input_buffer{};
+    std::size_t output_buffer{};
+    while (state.inference_queue.pop(input_buffer)) {
+      TVMArrayContainerVector tensors{};
+      try {
+        tensors = inference_engine_.schedule(state.input_tensors[input_buffer]);
+      } catch (...) {
+        state.free_input_tensors.push(input_buffer);
+        state.set_error(std::current_exception());
+        continue;
+      }
+      state.free_input_tensors.push(input_buffer);
+      state.free_output_tensors.pop(output_buffer);
+      try {
+        copyTVMArrays(tensors, state.output_tensors[output_buffer]);
+      } catch (...) {
+        state.free_output_tensors.push(output_buffer);
+        state.set_error(std::current_exception());
+        continue;
+      }
+      state.post_queue.push(output_buffer);
+    }
+    state.post_queue.close();
+  }
+
+  void run_post_processor(AsyncState & state)
+  {
+    std::size_t buffer{};
+    while (state.post_queue.pop(buffer)) {
+      OutputType output{};
+      try {
+        output = post_processor_.schedule(state.output_tensors[buffer]);
+      } catch (...) {
+        state.free_output_tensors.push(buffer);
+        state.set_error(std::current_exception());
+        continue;
+      }
+      state.free_output_tensors.push(buffer);
+      try {
+        state.callback(std::move(output));
+      } catch (...) {
+        state.set_error(std::current_exception());
+      }
+    }
+  }
+
   PreProcessorType pre_processor_{};
   InferenceEngineType inference_engine_{};
   PostProcessorType post_processor_{};
+  std::unique_ptr<AsyncState> async_{};
 };
 
 // Each node should be specificed with a string name and a shape
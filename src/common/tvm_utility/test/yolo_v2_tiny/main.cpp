@@ -15,7 +15,9 @@
 #include <opencv2/opencv.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -290,5 +292,39 @@ TEST(PipelineExamples, SimplePipeline) {
   }
 }
 
+TEST(PipelineExamples, AsyncPipeline) {
+  // Instantiate the pipeline
+  using PrePT = PreProcessorYoloV2Tiny;
+  using IET = tvm_utility::pipeline::InferenceEngineTVM;
+  using PostPT = PostProcessorYoloV2Tiny;
+
+  PrePT PreP{config};
+  IET IE{config};
+  PostPT PostP{config};
+
+  tvm_utility::pipeline::Pipeline<PrePT, IET, PostPT> pipeline(PreP, IE, PostP);
+
+  // Reference output of the synchronous mode
+  const auto expected_output = pipeline.schedule(IMAGE_FILENAME);
+
+  // Push several frames through the staged pipeline, waiting for free space in the queue
+  const size_t num_frames = 5;
+  std::vector<std::vector<float>> outputs{};
+  pipeline.start_async(
+    [&outputs](std::vector<float> output) {outputs.push_back(std::move(output));}, 2);
+  for (size_t i = 0; i < num_frames; ++i) {
+    while (!pipeline.schedule_async(IMAGE_FILENAME)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  pipeline.stop_async();
+
+  // Test: every frame produces the same output as the synchronous mode
+  ASSERT_EQ(num_frames, outputs.size());
+  for (const auto & output : outputs) {
+    EXPECT_EQ(expected_output, output);
+  }
+}
+
 }  // namespace yolo_v2_tiny
 }  // namespace tvm_utility
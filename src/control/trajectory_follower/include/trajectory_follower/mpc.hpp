@@ -247,6 +247,13 @@ private:
    * @brief get total prediction time of mpc
    */
   float64_t getPredictionTime() const;
+  /**
+   * @brief shift an optimized input sequence forward in time by one control period, to be used
+   * as initial guess of the next optimization. Inputs beyond the horizon repeat the last one.
+   * @param [in] Uex optimized input vector
+   * @return shifted input vector
+   */
+  Eigen::VectorXd shiftInputSequence(const Eigen::VectorXd & Uex) const;
   /**
    * @brief add weights related to lateral_jerk, steering_rate, steering_acc into R
    */
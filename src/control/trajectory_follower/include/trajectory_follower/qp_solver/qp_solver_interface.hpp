@@ -55,6 +55,13 @@ public:
     const Eigen::MatrixXd & h_mat, const Eigen::MatrixXd & f_vec, const Eigen::MatrixXd & a,
     const Eigen::VectorXd & lb, const Eigen::VectorXd & ub, const Eigen::VectorXd & lb_a,
     const Eigen::VectorXd & ub_a, Eigen::VectorXd & u) = 0;
+
+  /**
+   * @brief provide an initial guess for the next call to solve(), ignored by solvers which can
+   *        not use it
+   * @param [in] u initial guess of the optimal variable vector
+   */
+  virtual void setWarmStart(const Eigen::VectorXd & u) {(void)u;}
 };
 }  // namespace trajectory_follower
 }  // namespace control
@@ -23,6 +23,9 @@
 #include "rclcpp/rclcpp.hpp"
 #include "trajectory_follower/visibility_control.hpp"
 
+#include <tuple>
+#include <vector>
+
 namespace autoware
 {
 namespace motion
@@ -39,8 +42,13 @@ class TRAJECTORY_FOLLOWER_PUBLIC QPSolverOSQP : public QPSolverInterface
 public:
   /**
    * @brief constructor
+   * @param [in] logger logger used to report solver issues
+   * @param [in] persistent_workspace keep the solver workspace between calls to solve(): the
+   * sparsity pattern is fixed, only the numeric values of the problem are updated and the solver
+   * is warm-started. The workspace is set up again when the problem dimensions or the sparsity
+   * pattern of the constraints change, or when the solver failed.
    */
-  explicit QPSolverOSQP(const rclcpp::Logger & logger);
+  explicit QPSolverOSQP(const rclcpp::Logger & logger, const bool8_t persistent_workspace = false);
 
   /**
    * @brief destructor
@@ -64,9 +72,34 @@ public:
     const Eigen::VectorXd & lb, const Eigen::VectorXd & ub, const Eigen::VectorXd & lb_a,
     const Eigen::VectorXd & ub_a, Eigen::VectorXd & u) override;
 
+  /**
+   * @brief provide an initial guess for the next call to solve(). Only used with a persistent
+   * workspace, the dual variables are taken from the previous solution.
+   * @param [in] u initial guess of the optimal variable vector
+   */
+  void setWarmStart(const Eigen::VectorXd & u) override;
+
 private:
+  using Result =
+    std::tuple<std::vector<float64_t>, std::vector<float64_t>, int64_t, int64_t, int64_t>;
+
+  /**
+   * @brief solve the problem on the persistent workspace, setting it up if needed
+   */
+  Result optimizePersistent(
+    const Eigen::MatrixXd & h_mat, const Eigen::MatrixXd & a, const std::vector<float64_t> & f,
+    const std::vector<float64_t> & lower_bound, const std::vector<float64_t> & upper_bound);
+
   autoware::common::osqp::OSQPInterface osqpsolver_;
   rclcpp::Logger logger_;
+  bool8_t persistent_workspace_;
+  bool8_t workspace_initialized_{false};
+  // problem of the persistent workspace, with a fixed sparsity pattern
+  autoware::common::osqp::CSC_Matrix p_csc_;
+  autoware::common::osqp::CSC_Matrix a_csc_;
+  std::vector<float64_t> a_vals_prev_;
+  std::vector<float64_t> warm_start_primal_;
+  std::vector<float64_t> dual_prev_;
 };
 }  // namespace trajectory_follower
 }  // namespace control
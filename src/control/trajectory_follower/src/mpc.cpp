@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <cmath>
 #include <deque>
 #include <limits>
 #include <memory>
@@ -713,9 +714,31 @@ bool8_t MPC::executeOptimization(
       m_logger, *m_clock, 1000 /*ms*/, "model Uex includes NaN, stop MPC.");
     return false;
   }
+
+  // the next optimization starts one control period later
+  m_qpsolver_ptr->setWarmStart(shiftInputSequence(*Uex));
   return true;
 }
 
+Eigen::VectorXd MPC::shiftInputSequence(const Eigen::VectorXd & Uex) const
+{
+  const int64_t DIM_U = m_vehicle_model_ptr->getDimU();
+  const int64_t N = Uex.size() / DIM_U;
+  const float64_t shift = m_ctrl_period / m_param.prediction_dt;
+
+  Eigen::VectorXd shifted = Uex;
+  for (int64_t i = 0; i < N; ++i) {
+    const float64_t t = std::min(static_cast<float64_t>(i) + shift, static_cast<float64_t>(N - 1));
+    const int64_t i0 = static_cast<int64_t>(std::floor(t));
+    const int64_t i1 = std::min(i0 + 1, N - 1);
+    const float64_t ratio = t - static_cast<float64_t>(i0);
+    for (int64_t j = 0; j < DIM_U; ++j) {
+      shifted(i * DIM_U + j) = (1.0 - ratio) * Uex(i0 * DIM_U + j) + ratio * Uex(i1 * DIM_U + j);
+    }
+  }
+  return shifted;
+}
+
 void MPC::addSteerWeightR(Eigen::MatrixXd * R_ptr) const
 {
   const int64_t N = m_param.prediction_horizon;
@@ -25,8 +25,8 @@ namespace control
 {
 namespace trajectory_follower
 {
-QPSolverOSQP::QPSolverOSQP(const rclcpp::Logger & logger)
-: logger_{logger} {}
+QPSolverOSQP::QPSolverOSQP(const rclcpp::Logger & logger, const bool8_t persistent_workspace)
+: logger_{logger}, persistent_workspace_{persistent_workspace} {}
 bool8_t QPSolverOSQP::solve(
   const Eigen::MatrixXd & h_mat, const Eigen::MatrixXd & f_vec, const Eigen::MatrixXd & a,
   const Eigen::VectorXd & lb, const Eigen::VectorXd & ub, const Eigen::VectorXd & lb_a,
@@ -57,7 +57,9 @@ bool8_t QPSolverOSQP::solve(
   osqpA << Identity, a;
 
   /* execute optimization */
-  auto result = osqpsolver_.optimize(h_mat, osqpA, f, lower_bound, upper_bound);
+  auto result = persistent_workspace_ ?
+    optimizePersistent(h_mat, osqpA, f, lower_bound, upper_bound) :
+    osqpsolver_.optimize(h_mat, osqpA, f, lower_bound, upper_bound);
 
   std::vector<float64_t> U_osqp = std::get<0>(result);
   u =
@@ -77,6 +79,56 @@ bool8_t QPSolverOSQP::solve(
   }
   return true;
 }
+
+void QPSolverOSQP::setWarmStart(const Eigen::VectorXd & u)
+{
+  warm_start_primal_.assign(u.data(), u.data() + u.size());
+}
+
+QPSolverOSQP::Result QPSolverOSQP::optimizePersistent(
+  const Eigen::MatrixXd & h_mat, const Eigen::MatrixXd & a, const std::vector<float64_t> & f,
+  const std::vector<float64_t> & lower_bound, const std::vector<float64_t> & upper_bound)
+{
+  using autoware::common::osqp::calCSCMatrix;
+  using autoware::common::osqp::calCSCMatrixTrapezoidalDense;
+  using autoware::common::osqp::updateCSCMatrixValues;
+
+  // The hessian pattern is dense, so only a change of dimensions requires a new setup. Zero
+  // entries of the constraint matrix are not stored, so its pattern has to be checked.
+  const bool8_t reuse_workspace = workspace_initialized_ &&
+    (dual_prev_.size() == lower_bound.size()) &&
+    updateCSCMatrixValues(h_mat, p_csc_, true) &&
+    updateCSCMatrixValues(a, a_csc_, false);
+
+  if (!reuse_workspace) {
+    p_csc_ = calCSCMatrixTrapezoidalDense(h_mat);
+    a_csc_ = calCSCMatrix(a);
+    a_vals_prev_ = a_csc_.m_vals;
+    workspace_initialized_ =
+      (osqpsolver_.initializeProblem(p_csc_, a_csc_, f, lower_bound, upper_bound) == 0);
+  } else {
+    osqpsolver_.updateCscP(p_csc_);
+    if (a_csc_.m_vals != a_vals_prev_) {
+      osqpsolver_.updateCscA(a_csc_);
+      a_vals_prev_ = a_csc_.m_vals;
+    }
+    osqpsolver_.updateQ(f);
+    osqpsolver_.updateBounds(lower_bound, upper_bound);
+    // Without a guess, OSQP warm-starts from the previous solution
+    if (warm_start_primal_.size() == f.size()) {
+      osqpsolver_.setWarmStart(warm_start_primal_, dual_prev_);
+    }
+  }
+  warm_start_primal_.clear();
+
+  auto result = osqpsolver_.optimize();
+  dual_prev_ = std::get<1>(result);
+  // Start from scratch after a failure, e.g. infeasible or maximum iterations reached
+  if (std::get<3>(result) < 0) {
+    workspace_initialized_ = false;
+  }
+  return result;
+}
 }  // namespace trajectory_follower
 }  // namespace control
 }  // namespace motion
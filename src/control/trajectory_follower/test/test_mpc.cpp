@@ -311,6 +311,43 @@ TEST_F(MPCTest, OsqpCalculateRightTurn) {
   EXPECT_LT(ctrl_cmd.steering_tire_rotation_rate, 0.0f);
 }
 
+TEST_F(MPCTest, OsqpWarmStartCalculateRightTurn) {
+  trajectory_follower::MPC mpc;
+  trajectory_follower::MPC mpc_warm_start;
+  const std::string vehicle_model_type = "kinematics";
+  for (trajectory_follower::MPC * m : {&mpc, &mpc_warm_start}) {
+    initializeMPC(*m);
+    m->setReferenceTrajectory(
+      dummy_right_turn_trajectory, traj_resample_dist, enable_path_smoothing,
+      path_filter_moving_ave_num, enable_yaw_recalculation,
+      curvature_smoothing_num, pose_zero_ptr);
+    std::shared_ptr<trajectory_follower::VehicleModelInterface> vehicle_model_ptr =
+      std::make_shared<trajectory_follower::KinematicsBicycleModel>(
+      wheelbase, steer_limit, steer_tau);
+    m->setVehicleModel(vehicle_model_ptr, vehicle_model_type);
+  }
+  mpc.setQPSolver(std::make_shared<trajectory_follower::QPSolverOSQP>(logger));
+  mpc_warm_start.setQPSolver(std::make_shared<trajectory_follower::QPSolverOSQP>(logger, true));
+
+  // Consecutive cycles reuse the workspace and must match solving from scratch
+  for (int i = 0; i < 5; ++i) {
+    AckermannLateralCommand ctrl_cmd;
+    AckermannLateralCommand ctrl_cmd_warm_start;
+    Trajectory pred_traj;
+    Float32MultiArrayDiagnostic diag;
+    ASSERT_TRUE(
+      mpc.calculateMPC(
+        neutral_steer, default_velocity, pose_zero, ctrl_cmd, pred_traj,
+        diag));
+    ASSERT_TRUE(
+      mpc_warm_start.calculateMPC(
+        neutral_steer, default_velocity, pose_zero, ctrl_cmd_warm_start, pred_traj,
+        diag));
+    EXPECT_LT(ctrl_cmd_warm_start.steering_tire_angle, 0.0f);
+    EXPECT_NEAR(ctrl_cmd_warm_start.steering_tire_angle, ctrl_cmd.steering_tire_angle, 1.0e-3f);
+  }
+}
+
 TEST_F(MPCTest, KinematicsNoDelayCalculate) {
   trajectory_follower::MPC mpc;
   initializeMPC(mpc);
@@ -120,6 +120,8 @@ LateralController::LateralController(const rclcpp::NodeOptions & node_options)
     qpsolver_ptr = std::make_shared<trajectory_follower::QPSolverEigenLeastSquareLLT>();
   } else if (qp_solver_type == "osqp") {
     qpsolver_ptr = std::make_shared<trajectory_follower::QPSolverOSQP>(get_logger());
+  } else if (qp_solver_type == "osqp_warm_start") {
+    qpsolver_ptr = std::make_shared<trajectory_follower::QPSolverOSQP>(get_logger(), true);
   } else {
     RCLCPP_ERROR(get_logger(), "qp_solver_type is undefined");
   }
@@ -27,6 +27,9 @@
 #include <velodyne_driver/vlp16_data.hpp>
 #include <velodyne_driver/vlp32c_data.hpp>
 #include <velodyne_driver/vls128_data.hpp>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 #include <vector>
 
 namespace autoware
@@ -110,7 +113,18 @@ private:
   void convert(const Packet & pkt, std::vector<autoware::common::types::PointXYZIF> & output)
   {
     output.clear();
+    convert_each(pkt, [&output](const PointXYZIF & pt) {output.push_back(pt);});
+  }
 
+  /// \brief Convert a packet into cartesian points without collecting them, so the caller can
+  ///        write them straight into its own storage
+  /// \param[in] pkt A packet from a VLP16 HiRes sensor for conversion
+  /// \param[in] callback Called with every point and end of scan flag, in the order convert()
+  ///                     would store them
+  /// \tparam PointCallbackT Callable taking a const PointXYZIF &
+  template<typename PointCallbackT>
+  void convert_each(const Packet & pkt, PointCallbackT && callback)
+  {
     for (uint32_t block_id = 0U; block_id < NUM_BLOCKS_PER_PACKET; ++block_id, ++m_block_counter) {
       const DataBlock & block = pkt.blocks[block_id];
       const auto flag_check_result = m_sensor_data.check_flag(block.flag);
@@ -122,20 +136,32 @@ private:
       const auto num_banked_pts = flag_check_result.second;
       const uint32_t azimuth_base = to_uint32(block.azimuth_bytes[1U], block.azimuth_bytes[0U]);
 
+      // Gather the lookup table entries of all channels, then compute the points of the whole
+      // block at once
+      BlockWorkspace ws;
       for (uint16_t pt_id = 0U; pt_id < NUM_POINTS_PER_BLOCK; ++pt_id) {
         const DataChannel & channel = block.channels[pt_id];
         const uint32_t th = (azimuth_base + m_sensor_data.azimuth_offset(
             num_banked_pts, block_id, pt_id)) % AZIMUTH_ROTATION_RESOLUTION;
-        const float32_t r = compute_distance_m(channel.data[1U], channel.data[0U]);
         const uint32_t phi = m_sensor_data.altitude(num_banked_pts, block_id, pt_id);
+        ws.distance[pt_id] =
+          static_cast<float32_t>(to_uint32(channel.data[1U], channel.data[0U]));
+        ws.cos_th[pt_id] = m_cos_table[th];
+        ws.sin_th[pt_id] = m_sin_table[th];
+        ws.cos_phi[pt_id] = m_cos_table[phi];
+        ws.sin_phi[pt_id] = m_sin_table[phi];
+      }
+      polar_to_xyz(ws);
 
-        // Compute the point
+      for (uint16_t pt_id = 0U; pt_id < NUM_POINTS_PER_BLOCK; ++pt_id) {
         PointXYZIF pt;
-        polar_to_xyz(pt, r, th, phi);
-        pt.intensity = m_intensity_table[channel.data[2U]];
+        pt.x = ws.x[pt_id];
+        pt.y = ws.y[pt_id];
+        pt.z = ws.z[pt_id];
+        pt.intensity = m_intensity_table[block.channels[pt_id].data[2U]];
         pt.id = m_sensor_data.seq_id(m_block_counter, pt_id);
 
-        output.push_back(pt);
+        callback(pt);
       }
 
       if (static_cast<float32_t>(m_block_counter) > m_sensor_data.num_blocks_per_revolution()) {
@@ -143,7 +169,7 @@ private:
         PointXYZIF pt;
         pt.id =
           static_cast<uint16_t>(PointXYZIF::END_OF_SCAN_ID);
-        output.push_back(pt);
+        callback(pt);
         m_block_counter = uint16_t{0U};
       }
     }
@@ -160,32 +186,61 @@ private:
     ((NUM_POINTS_PER_BLOCK * NUM_BLOCKS_PER_PACKET) + 1U),
     "Number of points from one VLP16 packet cannot fit into a point block");
 
-  /// \brief converts polar coordinates into cartesian (xyz), not threadsafe: modifies a
-  ///        preallocated workspace member variable (m_point)
-  /// \param[out] pt Gets filled with the requisite cartesian information
-  /// \param[in] r_m the radius in meters
-  /// \param[in] th_ind the index of the azimuth in lookup tables (angle about the z-axis)
-  /// \param[in] phi_ind the altitude angle index from lookup tables(angle orthogonal to z-axis)
-  inline void polar_to_xyz(
-    autoware::common::types::PointXYZIF & pt,
-    const float32_t r_m,
-    const uint32_t th_ind,
-    const uint32_t phi_ind) const
+  /// \brief Structure of arrays holding the inputs and outputs of polar_to_xyz() for one block
+  struct BlockWorkspace
   {
-    const float32_t r_xy = r_m * m_cos_table[phi_ind];
-    pt.x = r_xy * m_cos_table[th_ind];  // y (vlp-frame)
-    pt.y = -r_xy * m_sin_table[th_ind];  // -x (vlp-frame)
-    pt.z = r_m * m_sin_table[phi_ind];
-  }
+    /// raw distances, i.e. in units of the distance resolution
+    float32_t distance[NUM_POINTS_PER_BLOCK];
+    float32_t cos_th[NUM_POINTS_PER_BLOCK];
+    float32_t sin_th[NUM_POINTS_PER_BLOCK];
+    float32_t cos_phi[NUM_POINTS_PER_BLOCK];
+    float32_t sin_phi[NUM_POINTS_PER_BLOCK];
+    float32_t x[NUM_POINTS_PER_BLOCK];
+    float32_t y[NUM_POINTS_PER_BLOCK];
+    float32_t z[NUM_POINTS_PER_BLOCK];
+  };
 
-  /// \brief converts the two byte representation of distance into meters
-  /// \param[in] first the byte representing the most significant bits
-  /// \param[in] second the byte representing the least significant bits
-  /// \return the radial distance in meters
-  inline float32_t compute_distance_m(const uint8_t first, const uint8_t second) const
+  /// \brief converts the polar coordinates of all channels of a block into cartesian (xyz).
+  ///        Uses AVX or SSE when enabled at compile time. Every lane performs the same
+  ///        multiplications in the same order as the scalar fallback, so all paths give
+  ///        bit-identical results.
+  /// \param[in,out] ws Workspace with distances and trigonometric lookups of the azimuth (th)
+  ///                   and altitude (phi) angles, gets filled with the cartesian coordinates
+  inline void polar_to_xyz(BlockWorkspace & ws) const
   {
-    const uint32_t dist_scaled = to_uint32(first, second);
-    return static_cast<float32_t>(dist_scaled) * m_sensor_data.distance_resolution();
+    const float32_t resolution = m_sensor_data.distance_resolution();
+    uint32_t idx = 0U;
+#if defined(__AVX__)
+    const __m256 res8 = _mm256_set1_ps(resolution);
+    const __m256 sign8 = _mm256_set1_ps(-0.0F);
+    for (; (idx + 8U) <= NUM_POINTS_PER_BLOCK; idx += 8U) {
+      const __m256 r_m = _mm256_mul_ps(_mm256_loadu_ps(&ws.distance[idx]), res8);
+      const __m256 r_xy = _mm256_mul_ps(r_m, _mm256_loadu_ps(&ws.cos_phi[idx]));
+      _mm256_storeu_ps(&ws.x[idx], _mm256_mul_ps(r_xy, _mm256_loadu_ps(&ws.cos_th[idx])));
+      _mm256_storeu_ps(
+        &ws.y[idx], _mm256_mul_ps(_mm256_xor_ps(r_xy, sign8), _mm256_loadu_ps(&ws.sin_th[idx])));
+      _mm256_storeu_ps(&ws.z[idx], _mm256_mul_ps(r_m, _mm256_loadu_ps(&ws.sin_phi[idx])));
+    }
+#elif defined(__SSE2__)
+    const __m128 res4 = _mm_set1_ps(resolution);
+    const __m128 sign4 = _mm_set1_ps(-0.0F);
+    for (; (idx + 4U) <= NUM_POINTS_PER_BLOCK; idx += 4U) {
+      const __m128 r_m = _mm_mul_ps(_mm_loadu_ps(&ws.distance[idx]), res4);
+      const __m128 r_xy = _mm_mul_ps(r_m, _mm_loadu_ps(&ws.cos_phi[idx]));
+      _mm_storeu_ps(&ws.x[idx], _mm_mul_ps(r_xy, _mm_loadu_ps(&ws.cos_th[idx])));
+      _mm_storeu_ps(
+        &ws.y[idx], _mm_mul_ps(_mm_xor_ps(r_xy, sign4), _mm_loadu_ps(&ws.sin_th[idx])));
+      _mm_storeu_ps(&ws.z[idx], _mm_mul_ps(r_m, _mm_loadu_ps(&ws.sin_phi[idx])));
+    }
+#endif
+    // Scalar fallback, also handles any remainder
+    for (; idx < NUM_POINTS_PER_BLOCK; ++idx) {
+      const float32_t r_m = ws.distance[idx] * resolution;
+      const float32_t r_xy = r_m * ws.cos_phi[idx];
+      ws.x[idx] = r_xy * ws.cos_th[idx];  // y (vlp-frame)
+      ws.y[idx] = -r_xy * ws.sin_th[idx];  // -x (vlp-frame)
+      ws.z[idx] = r_m * ws.sin_phi[idx];
+    }
   }
 
   template<typename T>
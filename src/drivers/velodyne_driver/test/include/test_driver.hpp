@@ -24,6 +24,9 @@
 #include <vector>
 #include <limits>
 #include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
 
 #include "common/types.hpp"
 #include "velodyne_driver/velodyne_translator.hpp"
@@ -272,4 +275,123 @@ TEST_F(VelodyneDriver, Benchmark)
   std::cerr << "convert() average runtime: " << duration.count() / num_runs << " µs\n";
 }
 
+/// Scalar reference of the original per-point conversion, used to check that the block-wise
+/// (possibly vectorized) conversion is bit-identical
+template<typename SensorT>
+class ReferenceTranslator
+{
+public:
+  using Packet = typename autoware::drivers::velodyne_driver::VelodyneTranslator<SensorT>::Packet;
+
+  explicit ReferenceTranslator(const float32_t rpm)
+  : m_sensor_data(rpm)
+  {
+    const float32_t tau = 6.283185307179586476925286766559F;
+    const float32_t idx2rad =
+      tau / static_cast<float32_t>(autoware::drivers::velodyne_driver::AZIMUTH_ROTATION_RESOLUTION);
+    for (uint32_t idx = 0U; idx < m_cos_table.size(); ++idx) {
+      m_cos_table[idx] = cosf(static_cast<float32_t>(idx) * idx2rad);
+      m_sin_table[idx] = sinf(static_cast<float32_t>(idx) * idx2rad);
+    }
+  }
+
+  void convert(const Packet & pkt, std::vector<autoware::common::types::PointXYZIF> & output)
+  {
+    using autoware::drivers::velodyne_driver::to_uint32;
+    output.clear();
+    for (uint32_t block_id = 0U; block_id < NUM_BLOCKS_PER_PACKET; ++block_id, ++m_block_counter) {
+      const auto & block = pkt.blocks[block_id];
+      const auto flag_check_result = m_sensor_data.check_flag(block.flag);
+      if (!flag_check_result.first) {
+        continue;
+      }
+      const auto num_banked_pts = flag_check_result.second;
+      const uint32_t azimuth_base = to_uint32(block.azimuth_bytes[1U], block.azimuth_bytes[0U]);
+      for (uint16_t pt_id = 0U; pt_id < NUM_POINTS_PER_BLOCK; ++pt_id) {
+        const auto & channel = block.channels[pt_id];
+        const uint32_t th = (azimuth_base + m_sensor_data.azimuth_offset(
+            num_banked_pts, block_id, pt_id)) %
+          autoware::drivers::velodyne_driver::AZIMUTH_ROTATION_RESOLUTION;
+        const uint32_t phi = m_sensor_data.altitude(num_banked_pts, block_id, pt_id);
+        const float32_t r = static_cast<float32_t>(to_uint32(channel.data[1U], channel.data[0U])) *
+          m_sensor_data.distance_resolution();
+        autoware::common::types::PointXYZIF pt;
+        const float32_t r_xy = r * m_cos_table[phi];
+        pt.x = r_xy * m_cos_table[th];
+        pt.y = -r_xy * m_sin_table[th];
+        pt.z = r * m_sin_table[phi];
+        pt.intensity = static_cast<float32_t>(channel.data[2U]);
+        pt.id = m_sensor_data.seq_id(m_block_counter, pt_id);
+        output.push_back(pt);
+      }
+      if (static_cast<float32_t>(m_block_counter) > m_sensor_data.num_blocks_per_revolution()) {
+        autoware::common::types::PointXYZIF pt;
+        pt.id = static_cast<uint16_t>(autoware::common::types::PointXYZIF::END_OF_SCAN_ID);
+        output.push_back(pt);
+        m_block_counter = uint16_t{0U};
+      }
+    }
+  }
+
+private:
+  SensorT m_sensor_data;
+  std::array<float32_t, autoware::drivers::velodyne_driver::AZIMUTH_ROTATION_RESOLUTION> m_cos_table;
+  std::array<float32_t, autoware::drivers::velodyne_driver::AZIMUTH_ROTATION_RESOLUTION> m_sin_table;
+  uint16_t m_block_counter{0U};
+};
+
+template<typename SensorT>
+class VelodyneTranslatorReference : public ::testing::Test
+{
+};
+
+using SensorTypes = ::testing::Types<
+  autoware::drivers::velodyne_driver::VLP16Data,
+  autoware::drivers::velodyne_driver::VLP32CData,
+  autoware::drivers::velodyne_driver::VLS128Data>;
+TYPED_TEST_CASE(VelodyneTranslatorReference, SensorTypes);
+
+/// Random packets, including all block flags, must convert bit-identically to the reference
+TYPED_TEST(VelodyneTranslatorReference, BitIdentical)
+{
+  using Translator = autoware::drivers::velodyne_driver::VelodyneTranslator<TypeParam>;
+  using Packet = typename Translator::Packet;
+  const float32_t rpm = 600.0F;
+  Translator driver{typename Translator::Config{rpm}};
+  ReferenceTranslator<TypeParam> reference{rpm};
+  std::vector<autoware::common::types::PointXYZIF> out;
+  std::vector<autoware::common::types::PointXYZIF> expected;
+  std::mt19937 gen{42U};
+  std::uniform_int_distribution<uint32_t> byte_dist{0U, 255U};
+  const uint8_t flags[4U] = {0xEEU, 0xDDU, 0xCCU, 0xBBU};
+  uint32_t num_points = 0U;
+  for (uint32_t pkt_id = 0U; pkt_id < 200U; ++pkt_id) {
+    Packet pkt;
+    uint8_t * const bytes = reinterpret_cast<uint8_t *>(&pkt);
+    for (std::size_t idx = 0U; idx < sizeof(pkt); ++idx) {
+      bytes[idx] = static_cast<uint8_t>(byte_dist(gen));
+    }
+    for (uint32_t block_id = 0U; block_id < NUM_BLOCKS_PER_PACKET; ++block_id) {
+      pkt.blocks[block_id].flag[0U] = 0xFFU;
+      pkt.blocks[block_id].flag[1U] = flags[(pkt_id + block_id) % 4U];
+      // Keep the azimuth within one rotation
+      const uint32_t azimuth = (byte_dist(gen) * 256U + byte_dist(gen)) % 36000U;
+      pkt.blocks[block_id].azimuth_bytes[0U] = static_cast<uint8_t>(azimuth & 0xFFU);
+      pkt.blocks[block_id].azimuth_bytes[1U] = static_cast<uint8_t>(azimuth >> 8U);
+    }
+    driver.convert(pkt, out);
+    reference.convert(pkt, expected);
+    ASSERT_EQ(out.size(), expected.size());
+    for (std::size_t idx = 0U; idx < out.size(); ++idx) {
+      EXPECT_EQ(memcmp(&out[idx].x, &expected[idx].x, sizeof(float32_t)), 0);
+      EXPECT_EQ(memcmp(&out[idx].y, &expected[idx].y, sizeof(float32_t)), 0);
+      EXPECT_EQ(memcmp(&out[idx].z, &expected[idx].z, sizeof(float32_t)), 0);
+      EXPECT_EQ(out[idx].intensity, expected[idx].intensity);
+      EXPECT_EQ(out[idx].id, expected[idx].id);
+    }
+    num_points += static_cast<uint32_t>(out.size());
+  }
+  EXPECT_GT(num_points, 0U);
+}
+
 #endif  // TEST_DRIVER_HPP_
@@ -0,0 +1,96 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+/// \file
+/// \brief This file defines a UDP receiver which drains datagrams in batches
+
+#ifndef VELODYNE_NODES__UDP_BATCH_RECEIVER_HPP_
+#define VELODYNE_NODES__UDP_BATCH_RECEIVER_HPP_
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "velodyne_nodes/visibility_control.hpp"
+
+namespace autoware
+{
+namespace drivers
+{
+namespace velodyne_nodes
+{
+
+/// Blocking UDP receiver which fetches all queued datagrams, up to a batch size, with a single
+/// recvmmsg() system call. All buffers are allocated on construction.
+class VELODYNE_NODES_PUBLIC UdpBatchReceiver
+{
+public:
+  /// \brief Open a socket and bind it to the given address
+  /// \param[in] ip Address to bind to
+  /// \param[in] port Port to bind to
+  /// \param[in] batch_size Maximum number of datagrams fetched per call to receive()
+  /// \param[in] max_packet_size Size of the buffer for each datagram, longer datagrams are
+  ///                            truncated
+  /// \param[in] timeout Maximum time receive() waits for the first datagram
+  /// \throw std::domain_error If batch_size or max_packet_size is zero
+  /// \throw std::runtime_error If the address is invalid or the socket cannot be bound
+  UdpBatchReceiver(
+    const std::string & ip,
+    const uint16_t port,
+    const std::size_t batch_size,
+    const std::size_t max_packet_size,
+    const std::chrono::milliseconds timeout);
+
+  /// \brief Close the socket
+  ~UdpBatchReceiver();
+
+  UdpBatchReceiver(const UdpBatchReceiver &) = delete;
+  UdpBatchReceiver & operator=(const UdpBatchReceiver &) = delete;
+
+  /// \brief Wait for at least one datagram, then fetch all queued datagrams up to the batch size
+  ///        without waiting further. Invalidates the datagrams of the previous call.
+  /// \return The number of datagrams received, zero if the timeout expired or the call was
+  ///         interrupted
+  /// \throw std::runtime_error On socket errors
+  std::size_t receive();
+
+  /// \brief Get a datagram of the last call to receive()
+  /// \param[in] idx Index of the datagram, must be less than the last result of receive()
+  /// \return Pointer to the datagram data
+  const uint8_t * packet(const std::size_t idx) const;
+
+  /// \brief Get the size of a datagram of the last call to receive()
+  /// \param[in] idx Index of the datagram, must be less than the last result of receive()
+  /// \return Size of the datagram in bytes, or the buffer size plus one if it was truncated
+  std::size_t packet_size(const std::size_t idx) const;
+
+private:
+  int m_socket;
+  std::size_t m_max_packet_size;
+  std::vector<uint8_t> m_buffer;
+  std::vector<struct iovec> m_iovecs;
+  std::vector<struct mmsghdr> m_headers;
+};  // class UdpBatchReceiver
+
+}  // namespace velodyne_nodes
+}  // namespace drivers
+}  // namespace autoware
+
+#endif  // VELODYNE_NODES__UDP_BATCH_RECEIVER_HPP_
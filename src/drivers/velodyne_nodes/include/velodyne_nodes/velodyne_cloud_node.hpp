@@ -23,13 +23,17 @@
 #ifndef VELODYNE_NODES__VELODYNE_CLOUD_NODE_HPP_
 #define VELODYNE_NODES__VELODYNE_CLOUD_NODE_HPP_
 
+#include <atomic>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include "common/types.hpp"
 #include "lidar_utils/point_cloud_utils.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "udp_driver/udp_driver.hpp"
 #include "velodyne_driver/velodyne_translator.hpp"
+#include "velodyne_nodes/udp_batch_receiver.hpp"
 #include "velodyne_nodes/visibility_control.hpp"
 #include "sensor_msgs/msg/point_cloud2.hpp"
 
@@ -56,6 +60,9 @@ public:
 
   VelodyneCloudNode(const std::string & node_name, const rclcpp::NodeOptions & options);
 
+  /// Stops the batch receive thread, if any.
+  ~VelodyneCloudNode() override;
+
   /// Handle data packet from the udp driver
   /// \param buffer Data from the udp driver
   void receiver_callback(const std::vector<uint8_t> & buffer);
@@ -70,9 +77,27 @@ protected:
 private:
   void init_udp_driver();
 
+  /// Start a thread which drains the socket in batches with a UdpBatchReceiver instead of
+  /// using the udp driver.
+  /// \param batch_size Maximum number of packets received per system call
+  void init_batch_receiver(const std::size_t batch_size);
+
+  /// Receive packets in batches until the node is destroyed.
+  void batch_receive_loop();
+
+  /// Convert a packet and publish all completed clouds.
+  /// \param data Raw packet data
+  /// \param size Size of the raw packet data
+  void handle_packet(const uint8_t * data, const std::size_t size);
+
+  /// Publish the completed cloud. If there are intra-process subscribers, the cloud buffer is
+  /// handed over to them and a new one is prepared, otherwise it is reused for the next cloud.
+  void publish_output();
+
   IoContext m_io_cxt;
   ::drivers::udp_driver::UdpDriver m_udp_driver;
   VelodyneTranslatorT m_translator;
+  // Points of the last packet which start the next point cloud
   std::vector<autoware::common::types::PointXYZIF> m_point_block;
 
   std::string m_ip;
@@ -80,13 +105,12 @@ private:
   rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr m_pc2_pub_ptr;
   sensor_msgs::msg::PointCloud2 m_pc2_msg{};
   bool m_published_cloud = false;
-  // Keeps track of where you left off on the converted point block in case you needed to publish
-  // a point cloud in the middle of processing it
-  uint32_t m_remainder_start_idx;
-  // keeps track of the constructed point cloud to continue growing it with new data
-  uint32_t m_point_cloud_idx;
   const std::string m_frame_id;
   const std::uint32_t m_cloud_size;
+  // Batch receive mode, used instead of m_udp_driver when set
+  std::unique_ptr<UdpBatchReceiver> m_batch_receiver;
+  std::atomic<bool8_t> m_stop_batch_receiver{false};
+  std::thread m_batch_receiver_thread;
 };  // class VelodyneCloudNode
 
 class VELODYNE_NODES_PUBLIC VelodyneCloudWrapperNode : public rclcpp::Node
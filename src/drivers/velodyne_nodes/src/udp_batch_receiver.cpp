@@ -0,0 +1,122 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "velodyne_nodes/udp_batch_receiver.hpp"
+
+namespace autoware
+{
+namespace drivers
+{
+namespace velodyne_nodes
+{
+
+UdpBatchReceiver::UdpBatchReceiver(
+  const std::string & ip,
+  const uint16_t port,
+  const std::size_t batch_size,
+  const std::size_t max_packet_size,
+  const std::chrono::milliseconds timeout)
+: m_socket(-1),
+  m_max_packet_size(max_packet_size),
+  m_buffer(batch_size * max_packet_size),
+  m_iovecs(batch_size),
+  m_headers(batch_size)
+{
+  if ((batch_size == 0U) || (max_packet_size == 0U)) {
+    throw std::domain_error("UdpBatchReceiver: batch and packet size must be positive");
+  }
+  struct sockaddr_in addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1) {
+    throw std::runtime_error("UdpBatchReceiver: invalid IPv4 address " + ip);
+  }
+
+  m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+  if (m_socket < 0) {
+    throw std::runtime_error(
+            std::string("UdpBatchReceiver: cannot open socket: ") + std::strerror(errno));
+  }
+  const int reuse = 1;
+  struct timeval tv;
+  tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+  tv.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+  if ((setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0) ||
+    (setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0) ||
+    (bind(m_socket, reinterpret_cast<const struct sockaddr *>(&addr), sizeof(addr)) != 0))
+  {
+    const std::string error{std::strerror(errno)};
+    (void)close(m_socket);
+    throw std::runtime_error("UdpBatchReceiver: cannot bind socket: " + error);
+  }
+
+  for (std::size_t idx = 0U; idx < batch_size; ++idx) {
+    m_iovecs[idx].iov_base = &m_buffer[idx * max_packet_size];
+    m_iovecs[idx].iov_len = max_packet_size;
+    std::memset(&m_headers[idx], 0, sizeof(m_headers[idx]));
+    m_headers[idx].msg_hdr.msg_iov = &m_iovecs[idx];
+    m_headers[idx].msg_hdr.msg_iovlen = 1U;
+  }
+}
+
+UdpBatchReceiver::~UdpBatchReceiver()
+{
+  (void)close(m_socket);
+}
+
+std::size_t UdpBatchReceiver::receive()
+{
+  // MSG_WAITFORONE: block for the first datagram only, then take what is already queued
+  const int num_received = recvmmsg(
+    m_socket, m_headers.data(), static_cast<unsigned int>(m_headers.size()), MSG_WAITFORONE,
+    nullptr);
+  if (num_received < 0) {
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) {
+      return 0U;
+    }
+    throw std::runtime_error(
+            std::string("UdpBatchReceiver: receive failed: ") + std::strerror(errno));
+  }
+  return static_cast<std::size_t>(num_received);
+}
+
+const uint8_t * UdpBatchReceiver::packet(const std::size_t idx) const
+{
+  return &m_buffer[idx * m_max_packet_size];
+}
+
+std::size_t UdpBatchReceiver::packet_size(const std::size_t idx) const
+{
+  const auto & header = m_headers[idx];
+  if ((header.msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+    return m_max_packet_size + 1U;
+  }
+  return static_cast<std::size_t>(header.msg_len);
+}
+
+}  // namespace velodyne_nodes
+}  // namespace drivers
+}  // namespace autoware
@@ -16,7 +16,9 @@
 
 #include <string>
 #include <chrono>
+#include <cstring>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "common/types.hpp"
@@ -50,8 +52,6 @@ VelodyneCloudNode<T>::VelodyneCloudNode(
   m_pc2_pub_ptr(create_publisher<sensor_msgs::msg::PointCloud2>(
       declare_parameter("topic").template
       get<std::string>(), rclcpp::QoS{10})),
-  m_remainder_start_idx(0U),
-  m_point_cloud_idx(0),
   m_frame_id(this->declare_parameter("frame_id").template get<std::string>().c_str()),
   m_cloud_size(static_cast<std::uint32_t>(
       this->declare_parameter("cloud_size").template get<std::uint32_t>()))
@@ -62,8 +62,22 @@ VelodyneCloudNode<T>::VelodyneCloudNode(
     throw std::runtime_error("VelodyneCloudNode: cloud_size must be > PointBlock::CAPACITY");
   }
 
-  init_udp_driver();
   init_output(m_pc2_msg);
+  if (declare_parameter("batch_receive.enabled", false)) {
+    init_batch_receiver(static_cast<std::size_t>(
+        declare_parameter("batch_receive.batch_size", 32)));
+  } else {
+    init_udp_driver();
+  }
+}
+
+template<typename T>
+VelodyneCloudNode<T>::~VelodyneCloudNode()
+{
+  m_stop_batch_receiver = true;
+  if (m_batch_receiver_thread.joinable()) {
+    m_batch_receiver_thread.join();
+  }
 }
 
 template<typename T>
@@ -76,17 +90,52 @@ void VelodyneCloudNode<T>::init_udp_driver()
     std::bind(&VelodyneCloudNode<T>::receiver_callback, this, std::placeholders::_1));
 }
 
+template<typename T>
+void VelodyneCloudNode<T>::init_batch_receiver(const std::size_t batch_size)
+{
+  // Receive timeout bounds how long the destructor waits for the thread
+  m_batch_receiver = std::make_unique<UdpBatchReceiver>(
+    m_ip, m_port, batch_size, sizeof(Packet), std::chrono::milliseconds{100});
+  m_batch_receiver_thread = std::thread{[this] {batch_receive_loop();}};
+}
+
+template<typename T>
+void VelodyneCloudNode<T>::batch_receive_loop()
+{
+  while (!m_stop_batch_receiver && rclcpp::ok()) {
+    std::size_t num_packets = 0U;
+    try {
+      num_packets = m_batch_receiver->receive();
+    } catch (const std::exception & e) {
+      RCLCPP_WARN(this->get_logger(), e.what());
+    }
+    for (std::size_t idx = 0U; idx < num_packets; ++idx) {
+      handle_packet(m_batch_receiver->packet(idx), m_batch_receiver->packet_size(idx));
+    }
+  }
+}
+
 template<typename T>
 void VelodyneCloudNode<T>::receiver_callback(const std::vector<uint8_t> & buffer)
 {
+  handle_packet(buffer.data(), buffer.size());
+}
+
+template<typename T>
+void VelodyneCloudNode<T>::handle_packet(const uint8_t * const data, const std::size_t size)
+{
+  if (size != sizeof(Packet)) {
+    RCLCPP_WARN(this->get_logger(), "VelodyneCloudNode: dropping packet of unexpected size");
+    return;
+  }
   Packet pkt{};
-  std::memcpy(&pkt, &buffer[0], buffer.size());
+  std::memcpy(&pkt, data, size);
   try {
     // message received, convert and publish
     if (this->convert(pkt, m_pc2_msg)) {
-      m_pc2_pub_ptr->publish(m_pc2_msg);
+      publish_output();
       while (this->get_output_remainder(m_pc2_msg)) {
-        m_pc2_pub_ptr->publish(m_pc2_msg);
+        publish_output();
       }
     }
   } catch (const std::exception & e) {
@@ -98,13 +147,30 @@ void VelodyneCloudNode<T>::receiver_callback(const std::vector<uint8_t> & buffer
     throw;
   }
 }
+////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+void VelodyneCloudNode<T>::publish_output()
+{
+  if (m_pc2_pub_ptr->get_intra_process_subscription_count() == 0U) {
+    // Inter-process publishing only serializes the cloud, so the buffer is kept for the next one
+    m_pc2_pub_ptr->publish(m_pc2_msg);
+    return;
+  }
+  // Hand the filled buffer over instead of copying it, intra-process subscribers take ownership
+  m_pc2_pub_ptr->publish(
+    std::make_unique<sensor_msgs::msg::PointCloud2>(std::move(m_pc2_msg)));
+  m_pc2_msg = sensor_msgs::msg::PointCloud2{};
+  init_output(m_pc2_msg);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 template<typename T>
 void VelodyneCloudNode<T>::init_output(sensor_msgs::msg::PointCloud2 & output)
 {
   using autoware::common::types::PointXYZI;
+  // A cloud is completed within a packet, so it can exceed cloud_size by up to a point block
   point_cloud_msg_wrapper::PointCloud2Modifier<PointXYZI>{
-    output, m_frame_id}.reserve(m_cloud_size);
+    output, m_frame_id}.reserve(m_cloud_size + VelodyneTranslatorT::POINT_BLOCK_CAPACITY);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -113,42 +179,44 @@ bool8_t VelodyneCloudNode<T>::convert(
   const Packet & pkt,
   sensor_msgs::msg::PointCloud2 & output)
 {
-  // This handles the case when the below loop exited due to containing extra points
   using autoware::common::types::PointXYZI;
+  using autoware::common::types::PointXYZIF;
   point_cloud_msg_wrapper::PointCloud2Modifier<PointXYZI> modifier{output};
   if (m_published_cloud) {
-    // reset the pointcloud
+    // reset the pointcloud, clearing keeps the reserved buffer
     modifier.clear();
-    modifier.reserve(m_cloud_size);
-    m_point_cloud_idx = 0;
-
-    // deserialize remainder into pointcloud
     m_published_cloud = false;
-    for (uint32_t idx = m_remainder_start_idx; idx < m_point_block.size(); ++idx) {
-      const autoware::common::types::PointXYZIF & pt = m_point_block[idx];
+
+    // start the new pointcloud with the points left over from the previous packet
+    for (const PointXYZIF & pt : m_point_block) {
       modifier.push_back(PointXYZI{pt.x, pt.y, pt.z, pt.intensity});
-      m_point_cloud_idx++;
     }
+    m_point_block.clear();
   }
-  m_translator.convert(pkt, m_point_block);
-  for (uint32_t idx = 0U; idx < m_point_block.size(); ++idx) {
-    const autoware::common::types::PointXYZIF & pt = m_point_block[idx];
-    if (static_cast<uint16_t>(autoware::common::types::PointXYZIF::END_OF_SCAN_ID) != pt.id) {
-      modifier.push_back(PointXYZI{pt.x, pt.y, pt.z, pt.intensity});
-      m_point_cloud_idx++;
-      if (modifier.size() >= m_cloud_size) {
+
+  // Points are decoded straight into the pointcloud. Once it is complete, the points starting
+  // the next pointcloud are kept in the point block: everything from an end of scan flag on, or
+  // else the last point of an oversized pointcloud.
+  bool8_t end_of_scan = false;
+  m_translator.convert_each(
+    pkt, [this, &modifier, &end_of_scan](const PointXYZIF & pt) {
+      if (end_of_scan) {
+        m_point_block.push_back(pt);
+      } else if (static_cast<uint16_t>(PointXYZIF::END_OF_SCAN_ID) == pt.id) {
+        end_of_scan = true;
         m_published_cloud = true;
-        m_remainder_start_idx = idx;
+        m_point_block.clear();
+        m_point_block.push_back(pt);
+      } else {
+        modifier.push_back(PointXYZI{pt.x, pt.y, pt.z, pt.intensity});
+        if (modifier.size() >= m_cloud_size) {
+          m_published_cloud = true;
+          m_point_block.clear();
+          m_point_block.push_back(pt);
+        }
       }
-    } else {
-      m_published_cloud = true;
-      m_remainder_start_idx = idx;
-      break;
-    }
-  }
+    });
   if (m_published_cloud) {
-    // resize pointcloud down to its actual size
-    modifier.resize(m_point_cloud_idx);
     output.header.stamp = this->now();
   }
 
@@ -69,6 +69,7 @@ struct VelodyneNodeTestParam
   uint32_t expected_size;
   float32_t expected_period_ms;
   bool8_t is_cloud;
+  bool8_t batch_receive{false};
 };  // VelodyneNodeTestParam
 
 class VelodyneNodeIntegration : public ::testing::TestWithParam<VelodyneNodeTestParam>
@@ -96,6 +97,7 @@ TEST_P(VelodyneNodeIntegration, Test)
   velodyne_params.emplace_back("cloud_size", static_cast<int64_t>(param.reserved_size));
   velodyne_params.emplace_back("rpm", static_cast<int>(config.get_rpm()));
   velodyne_params.emplace_back("topic", topic);
+  velodyne_params.emplace_back("batch_receive.enabled", param.batch_receive);
   // TODO(esteve): replace this with std::format once we migrate to Galactic
   rclcpp::NodeOptions velodyne_options = rclcpp::NodeOptions().arguments({"-r __node:=" + name});
   velodyne_options.parameter_overrides(velodyne_params);
@@ -163,3 +165,9 @@ INSTANTIATE_TEST_CASE_P(
   VelodyneNodeIntegration,
   // cppcheck-suppress syntaxError
   ::testing::Values(VelodyneNodeTestParam{10700U, 10700U, 50.0F, true}), );
+
+INSTANTIATE_TEST_CASE_P(
+  BatchReceiveCloud,
+  VelodyneNodeIntegration,
+  // cppcheck-suppress syntaxError
+  ::testing::Values(VelodyneNodeTestParam{55000U, 30000U, 100.0F, true, true}), );
@@ -0,0 +1,179 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+/// \copyright Copyright 2021 the Autoware Foundation
+/// \file
+/// \brief Header for a runtime sized assigner for sparse linear assignment problems
+#ifndef HUNGARIAN_ASSIGNER__SPARSE_ASSIGNER_HPP_
+#define HUNGARIAN_ASSIGNER__SPARSE_ASSIGNER_HPP_
+
+#include <hungarian_assigner/hungarian_assigner.hpp>
+#include <hungarian_assigner/visibility_control.hpp>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "common/types.hpp"
+
+namespace autoware
+{
+namespace fusion
+{
+namespace hungarian_assigner
+{
+
+using autoware::common::types::float64_t;
+
+/// \brief Minimum weight assignment for problems where only some of the weights are set.
+///
+/// This is a drop-in replacement for hungarian_assigner_c without a capacity: the size is only
+/// known at runtime, and only the weights that were set are stored and visited. A row that does
+/// not get a column costs MAX_WEIGHT, which is the same as the weight the dense assigner uses for
+/// unset entries, so the result minimizes the same cost. The storage only grows, so an assigner
+/// that is reused for problems of similar size does not allocate.
+class HUNGARIAN_ASSIGNER_PUBLIC sparse_assigner_c
+{
+public:
+  /// \brief The algorithm used to solve the assignment problem
+  enum class algorithm_t : uint8_t
+  {
+    /// Shortest augmenting paths with Dijkstra on the set weights, as in the Jonker-Volgenant
+    /// algorithm. Gives the optimal assignment.
+    SHORTEST_AUGMENTING_PATH,
+    /// Auction with epsilon scaling. The total weight is within (rows + columns) * epsilon of
+    /// the optimal one, which can be faster for large problems with many competing rows.
+    AUCTION
+  };
+
+  /// \brief This index denotes a worker for which no job assignment was possible
+  static constexpr index_t UNASSIGNED = std::numeric_limits<index_t>::max();
+  /// \brief Weights must be smaller than this, and a row without a column costs this much
+  static constexpr float32_t MAX_WEIGHT = 10000.F;
+
+  /// \brief constructor
+  /// \param[in] algorithm the algorithm used by assign()
+  /// \param[in] auction_epsilon the final bidding increment of the auction algorithm, which
+  ///            bounds how far the result can be from the optimal assignment
+  /// \throw std::domain_error if auction_epsilon is not positive
+  explicit sparse_assigner_c(
+    const algorithm_t algorithm = algorithm_t::SHORTEST_AUGMENTING_PATH,
+    const float32_t auction_epsilon = 1.0e-3F);
+
+  /// \brief set the size of the problem. This should be done before set_weight() calls.
+  ///        Unlike hungarian_assigner_c, there can be more rows than columns.
+  /// \param[in] num_rows number of rows/jobs
+  /// \param[in] num_cols number of columns/workers
+  /// \throw std::domain_error if a size is negative
+  void set_size(const index_t num_rows, const index_t num_cols);
+
+  /// \brief set weight for the assignment of a job to a worker. If the weight of a pair is set
+  ///        multiple times, the smallest one is used.
+  /// \param[in] weight the weight for assignment of job idx to worker jdx
+  /// \param[in] idx the index of the job
+  /// \param[in] jdx the index of the worker
+  /// \throw std::out_of_range if idx or jdx are outside of range specified by set_size(), or if
+  ///        the weight is not smaller than MAX_WEIGHT
+  void set_weight(const float32_t weight, const index_t idx, const index_t jdx);
+
+  /// \brief reset the size and the weights, must be called after assign(), and before
+  ///        set_weight()
+  void reset();
+
+  /// \brief reset and set_size, equivalent to reset(); set_size(num_rows, num_cols);
+  /// \param[in] num_rows number of rows/jobs
+  /// \param[in] num_cols number of columns/workers
+  void reset(const index_t num_rows, const index_t num_cols);
+
+  /// \brief compute minimum cost assignment
+  /// \return true if every row got a column. Otherwise get_assignment() returns UNASSIGNED for
+  ///         the rows without one
+  bool8_t assign();
+
+  /// \brief dictate what the assignment for a given row/task is, should be called after assign().
+  /// \param[in] idx the index for the task, starting at 0
+  /// \return the index for the assigned worker, starting at 0, or UNASSIGNED
+  /// \throw std::range_error if idx is out of bounds
+  index_t get_assignment(const index_t idx) const;
+
+  /// \brief says what workers/columns have not been assigned to any task
+  /// \param[in] idx the i'th unassigned column, starting from 0
+  /// \return the index of the i'th unassigned column in increasing order
+  /// \throw std::range_error if there are not more than idx unassigned columns
+  index_t get_unassigned(const index_t idx) const;
+
+private:
+  /// \brief An entry of the weight matrix set by set_weight()
+  struct weight_t
+  {
+    index_t row;
+    index_t col;
+    float32_t weight;
+  };
+
+  /// \brief sort the weights by row into m_row_offsets, m_edge_cols and m_edge_costs, and add
+  ///        the edges that model not assigning a row
+  HUNGARIAN_ASSIGNER_LOCAL void build_graph();
+
+  /// \brief solve with shortest augmenting paths
+  HUNGARIAN_ASSIGNER_LOCAL void assign_shortest_augmenting_path();
+
+  /// \brief relax the edges of a row during the shortest path search
+  HUNGARIAN_ASSIGNER_LOCAL void scan_row(const index_t row, const float64_t distance);
+
+  /// \brief solve with an auction
+  HUNGARIAN_ASSIGNER_LOCAL void assign_auction();
+
+  algorithm_t m_algorithm;
+  float64_t m_auction_epsilon;
+  index_t m_num_rows;
+  index_t m_num_cols;
+  std::vector<weight_t> m_weights;
+
+  // Compressed sparse rows of the graph that is solved
+  index_t m_num_graph_rows;
+  index_t m_num_graph_cols;
+  std::vector<index_t> m_row_offsets;
+  std::vector<index_t> m_edge_cols;
+  std::vector<float64_t> m_edge_costs;
+
+  // Matching of the graph
+  std::vector<index_t> m_row_to_col;
+  std::vector<index_t> m_col_to_row;
+
+  // Dual variables: potentials for the shortest augmenting path, prices for the auction
+  std::vector<float64_t> m_row_duals;
+  std::vector<float64_t> m_col_duals;
+
+  // Shortest path book-keeping
+  std::vector<float64_t> m_distances;
+  std::vector<index_t> m_predecessors;
+  std::vector<bool8_t> m_is_finalized;
+  std::vector<index_t> m_touched_cols;
+  std::vector<index_t> m_finalized_cols;
+  std::vector<std::pair<float64_t, index_t>> m_heap;
+
+  // Auction book-keeping
+  std::vector<index_t> m_unassigned_rows;
+
+  // Result
+  std::vector<index_t> m_assignments;
+  std::vector<index_t> m_unassigned_cols;
+};  // class sparse_assigner_c
+
+}  // namespace hungarian_assigner
+}  // namespace fusion
+}  // namespace autoware
+#endif  // HUNGARIAN_ASSIGNER__SPARSE_ASSIGNER_HPP_
@@ -0,0 +1,369 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include "hungarian_assigner/sparse_assigner.hpp"
+
+namespace autoware
+{
+namespace fusion
+{
+namespace hungarian_assigner
+{
+
+namespace
+{
+constexpr float64_t INF = std::numeric_limits<float64_t>::infinity();
+constexpr index_t NONE = -1;
+/// \brief how much epsilon is reduced between auction phases
+constexpr float64_t AUCTION_EPSILON_FACTOR = 5.0;
+}  // namespace
+
+constexpr index_t sparse_assigner_c::UNASSIGNED;
+constexpr float32_t sparse_assigner_c::MAX_WEIGHT;
+
+///
+sparse_assigner_c::sparse_assigner_c(
+  const algorithm_t algorithm,
+  const float32_t auction_epsilon)
+: m_algorithm(algorithm),
+  m_auction_epsilon(static_cast<float64_t>(auction_epsilon)),
+  m_num_rows(index_t()),
+  m_num_cols(index_t()),
+  m_num_graph_rows(index_t()),
+  m_num_graph_cols(index_t())
+{
+  if (!(auction_epsilon > 0.0F)) {
+    throw std::domain_error("Auction epsilon must be positive");
+  }
+}
+
+///
+void sparse_assigner_c::set_size(const index_t num_rows, const index_t num_cols)
+{
+  if ((num_rows < index_t()) || (num_cols < index_t())) {
+    throw std::domain_error("Cannot make sparse assigner with a negative size");
+  }
+  m_num_rows = num_rows;
+  m_num_cols = num_cols;
+}
+
+///
+void sparse_assigner_c::set_weight(const float32_t weight, const index_t idx, const index_t jdx)
+{
+  if ((idx < index_t()) || (idx >= m_num_rows) || (jdx < index_t()) || (jdx >= m_num_cols)) {
+    throw std::out_of_range("Cannot set weight outside of range");
+  }
+  if (!(weight < MAX_WEIGHT)) {
+    throw std::out_of_range("Cannot set weight greater than or equal to MAX_WEIGHT");
+  }
+  m_weights.push_back({idx, jdx, weight});
+}
+
+///
+void sparse_assigner_c::reset()
+{
+  m_weights.clear();
+  m_num_rows = index_t();
+  m_num_cols = index_t();
+}
+
+///
+void sparse_assigner_c::reset(const index_t num_rows, const index_t num_cols)
+{
+  reset();
+  set_size(num_rows, num_cols);
+}
+
+///
+bool8_t sparse_assigner_c::assign()
+{
+  build_graph();
+  m_row_to_col.assign(static_cast<std::size_t>(m_num_graph_rows), NONE);
+  m_col_to_row.assign(static_cast<std::size_t>(m_num_graph_cols), NONE);
+  if (m_algorithm == algorithm_t::AUCTION) {
+    assign_auction();
+  } else {
+    assign_shortest_augmenting_path();
+  }
+
+  // Only the columns below m_num_cols are real, the others model an unassigned row
+  bool8_t ret = true;
+  m_assignments.resize(static_cast<std::size_t>(m_num_rows));
+  for (index_t row = index_t(); row < m_num_rows; ++row) {
+    const auto col = m_row_to_col[static_cast<std::size_t>(row)];
+    if ((col == NONE) || (col >= m_num_cols)) {
+      m_assignments[static_cast<std::size_t>(row)] = UNASSIGNED;
+      ret = false;
+    } else {
+      m_assignments[static_cast<std::size_t>(row)] = col;
+    }
+  }
+  m_unassigned_cols.clear();
+  for (index_t col = index_t(); col < m_num_cols; ++col) {
+    const auto row = m_col_to_row[static_cast<std::size_t>(col)];
+    if ((row == NONE) || (row >= m_num_rows)) {
+      m_unassigned_cols.push_back(col);
+    }
+  }
+  return ret;
+}
+
+///
+index_t sparse_assigner_c::get_assignment(const index_t idx) const
+{
+  if ((idx < index_t()) || (static_cast<std::size_t>(idx) >= m_assignments.size())) {
+    throw std::range_error("Querying out of bounds assignment index");
+  }
+  return m_assignments[static_cast<std::size_t>(idx)];
+}
+
+///
+index_t sparse_assigner_c::get_unassigned(const index_t idx) const
+{
+  if ((idx < index_t()) || (static_cast<std::size_t>(idx) >= m_unassigned_cols.size())) {
+    throw std::range_error("Querying out of bounds assignment index");
+  }
+  return m_unassigned_cols[static_cast<std::size_t>(idx)];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// private methods
+////////////////////////////////////////////////////////////////////////////////
+void sparse_assigner_c::build_graph()
+{
+  // Every row r gets a private column m_num_cols + r with weight MAX_WEIGHT that stands for
+  // leaving the row unassigned, so that all rows can always be assigned. For the auction, which
+  // needs a square problem, every column c also gets a row m_num_rows + c that can take either
+  // that column or, for every weight set for (r, c), the private column of row r. Both cost
+  // nothing, so a solution of the square problem costs as much as the assignment it contains.
+  const auto is_auction = (m_algorithm == algorithm_t::AUCTION);
+  m_num_graph_rows = is_auction ? (m_num_rows + m_num_cols) : m_num_rows;
+  m_num_graph_cols = m_num_cols + m_num_rows;
+
+  // Counting sort of the edges by row
+  m_row_offsets.assign(static_cast<std::size_t>(m_num_graph_rows + 1), index_t());
+  for (const auto & w : m_weights) {
+    ++m_row_offsets[static_cast<std::size_t>(w.row + 1)];
+    if (is_auction) {
+      ++m_row_offsets[static_cast<std::size_t>(m_num_rows + w.col + 1)];
+    }
+  }
+  for (index_t row = index_t(); row < m_num_rows; ++row) {
+    ++m_row_offsets[static_cast<std::size_t>(row + 1)];
+  }
+  if (is_auction) {
+    for (index_t col = index_t(); col < m_num_cols; ++col) {
+      ++m_row_offsets[static_cast<std::size_t>(m_num_rows + col + 1)];
+    }
+  }
+  for (std::size_t idx = 1U; idx < m_row_offsets.size(); ++idx) {
+    m_row_offsets[idx] += m_row_offsets[idx - 1U];
+  }
+  const auto num_edges = static_cast<std::size_t>(m_row_offsets.back());
+  m_edge_cols.resize(num_edges);
+  m_edge_costs.resize(num_edges);
+  // Use the offsets as insertion cursors, afterwards each one points at the end of its row
+  const auto add_edge = [this](const index_t row, const index_t col, const float64_t cost) {
+      const auto edge = static_cast<std::size_t>(m_row_offsets[static_cast<std::size_t>(row)]++);
+      m_edge_cols[edge] = col;
+      m_edge_costs[edge] = cost;
+    };
+  for (const auto & w : m_weights) {
+    add_edge(w.row, w.col, static_cast<float64_t>(w.weight));
+    if (is_auction) {
+      add_edge(m_num_rows + w.col, m_num_cols + w.row, 0.0);
+    }
+  }
+  for (index_t row = index_t(); row < m_num_rows; ++row) {
+    add_edge(row, m_num_cols + row, static_cast<float64_t>(MAX_WEIGHT));
+  }
+  if (is_auction) {
+    for (index_t col = index_t(); col < m_num_cols; ++col) {
+      add_edge(m_num_rows + col, col, 0.0);
+    }
+  }
+  // The end of each row is the beginning of the next one
+  for (std::size_t idx = m_row_offsets.size() - 1U; idx > 0U; --idx) {
+    m_row_offsets[idx] = m_row_offsets[idx - 1U];
+  }
+  m_row_offsets[0U] = index_t();
+}
+
+///
+void sparse_assigner_c::assign_shortest_augmenting_path()
+{
+  // Potentials such that every reduced cost (cost - row dual - col dual) is non-negative. The
+  // shortest path only finds the cheapest free column if all free columns have the same dual, so
+  // start with a row reduction and keep the column duals at zero.
+  m_row_duals.resize(static_cast<std::size_t>(m_num_graph_rows));
+  for (index_t row = index_t(); row < m_num_graph_rows; ++row) {
+    const auto begin = m_edge_costs.begin() + m_row_offsets[static_cast<std::size_t>(row)];
+    const auto end = m_edge_costs.begin() + m_row_offsets[static_cast<std::size_t>(row + 1)];
+    m_row_duals[static_cast<std::size_t>(row)] = *std::min_element(begin, end);
+  }
+  m_col_duals.assign(static_cast<std::size_t>(m_num_graph_cols), 0.0);
+
+  m_distances.assign(static_cast<std::size_t>(m_num_graph_cols), INF);
+  m_predecessors.assign(static_cast<std::size_t>(m_num_graph_cols), NONE);
+  m_is_finalized.assign(static_cast<std::size_t>(m_num_graph_cols), false);
+  for (index_t source = index_t(); source < m_num_graph_rows; ++source) {
+    m_touched_cols.clear();
+    m_finalized_cols.clear();
+    m_heap.clear();
+    scan_row(source, 0.0);
+    // Dijkstra until a free column is reached, which always happens through the private column
+    index_t sink = NONE;
+    float64_t sink_distance = INF;
+    while (!m_heap.empty()) {
+      std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<>());
+      const auto top = m_heap.back();
+      m_heap.pop_back();
+      const auto col = static_cast<std::size_t>(top.second);
+      if (m_is_finalized[col] || (top.first > m_distances[col])) {
+        continue;
+      }
+      m_is_finalized[col] = true;
+      m_finalized_cols.push_back(top.second);
+      if (m_col_to_row[col] == NONE) {
+        sink = top.second;
+        sink_distance = top.first;
+        break;
+      }
+      scan_row(m_col_to_row[col], top.first);
+    }
+    if (sink == NONE) {
+      throw std::logic_error("Sparse assigner could not find an augmenting path");
+    }
+    // Update the potentials so that the reduced costs stay non-negative and become zero along
+    // the shortest path
+    m_row_duals[static_cast<std::size_t>(source)] += sink_distance;
+    for (const auto col : m_finalized_cols) {
+      if (col != sink) {
+        const auto delta = sink_distance - m_distances[static_cast<std::size_t>(col)];
+        m_col_duals[static_cast<std::size_t>(col)] -= delta;
+        m_row_duals[static_cast<std::size_t>(m_col_to_row[static_cast<std::size_t>(col)])] += delta;
+      }
+    }
+    // Augment along the path
+    for (index_t col = sink; col != NONE; ) {
+      const auto row = m_predecessors[static_cast<std::size_t>(col)];
+      const auto next_col = m_row_to_col[static_cast<std::size_t>(row)];
+      m_col_to_row[static_cast<std::size_t>(col)] = row;
+      m_row_to_col[static_cast<std::size_t>(row)] = col;
+      col = (row == source) ? NONE : next_col;
+    }
+    for (const auto col : m_touched_cols) {
+      m_distances[static_cast<std::size_t>(col)] = INF;
+      m_is_finalized[static_cast<std::size_t>(col)] = false;
+    }
+  }
+}
+
+///
+void sparse_assigner_c::scan_row(const index_t row, const float64_t distance)
+{
+  const auto row_dual = m_row_duals[static_cast<std::size_t>(row)];
+  const auto end = static_cast<std::size_t>(m_row_offsets[static_cast<std::size_t>(row + 1)]);
+  for (auto edge = static_cast<std::size_t>(m_row_offsets[static_cast<std::size_t>(row)]);
+    edge < end; ++edge)
+  {
+    const auto col = static_cast<std::size_t>(m_edge_cols[edge]);
+    if (m_is_finalized[col]) {
+      continue;
+    }
+    const auto col_distance = distance + m_edge_costs[edge] - row_dual - m_col_duals[col];
+    if (col_distance < m_distances[col]) {
+      if (m_distances[col] == INF) {
+        m_touched_cols.push_back(m_edge_cols[edge]);
+      }
+      m_distances[col] = col_distance;
+      m_predecessors[col] = row;
+      m_heap.emplace_back(col_distance, m_edge_cols[edge]);
+      std::push_heap(m_heap.begin(), m_heap.end(), std::greater<>());
+    }
+  }
+}
+
+///
+void sparse_assigner_c::assign_auction()
+{
+  // Rows bid for the columns with the highest value, which is -cost - price
+  float64_t max_abs_cost = 0.0;
+  for (const auto cost : m_edge_costs) {
+    max_abs_cost = std::max(max_abs_cost, std::abs(cost));
+  }
+  m_col_duals.assign(static_cast<std::size_t>(m_num_graph_cols), 0.0);
+  auto epsilon = std::max(max_abs_cost / AUCTION_EPSILON_FACTOR, m_auction_epsilon);
+  // Prices are kept between the phases, assignments are not
+  while (true) {
+    std::fill(m_row_to_col.begin(), m_row_to_col.end(), NONE);
+    std::fill(m_col_to_row.begin(), m_col_to_row.end(), NONE);
+    m_unassigned_rows.clear();
+    for (index_t row = m_num_graph_rows - 1; row >= index_t(); --row) {
+      m_unassigned_rows.push_back(row);
+    }
+    while (!m_unassigned_rows.empty()) {
+      const auto row = m_unassigned_rows.back();
+      m_unassigned_rows.pop_back();
+      index_t best_col = NONE;
+      float64_t best_value = -INF;
+      float64_t second_value = -INF;
+      const auto end = static_cast<std::size_t>(m_row_offsets[static_cast<std::size_t>(row + 1)]);
+      for (auto edge = static_cast<std::size_t>(m_row_offsets[static_cast<std::size_t>(row)]);
+        edge < end; ++edge)
+      {
+        const auto value =
+          -m_edge_costs[edge] - m_col_duals[static_cast<std::size_t>(m_edge_cols[edge])];
+        if (value > best_value) {
+          second_value = best_value;
+          best_value = value;
+          best_col = m_edge_cols[edge];
+        } else if (value > second_value) {
+          second_value = value;
+        }
+      }
+      if (best_col == NONE) {
+        throw std::logic_error("Sparse assigner found a row without any column");
+      }
+      if (second_value == -INF) {
+        // Nothing else to compete with, any increment keeps the row happy with its column
+        second_value = best_value - max_abs_cost;
+      }
+      const auto col = static_cast<std::size_t>(best_col);
+      m_col_duals[col] += (best_value - second_value) + epsilon;
+      const auto previous_row = m_col_to_row[col];
+      if (previous_row != NONE) {
+        m_row_to_col[static_cast<std::size_t>(previous_row)] = NONE;
+        m_unassigned_rows.push_back(previous_row);
+      }
+      m_col_to_row[col] = row;
+      m_row_to_col[static_cast<std::size_t>(row)] = best_col;
+    }
+    if (epsilon <= m_auction_epsilon) {
+      break;
+    }
+    epsilon = std::max(epsilon / AUCTION_EPSILON_FACTOR, m_auction_epsilon);
+  }
+}
+
+}  // namespace hungarian_assigner
+}  // namespace fusion
+}  // namespace autoware
@@ -0,0 +1,259 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#ifndef TEST_SPARSE_ASSIGNER_HPP_
+#define TEST_SPARSE_ASSIGNER_HPP_
+
+#include <hungarian_assigner/sparse_assigner.hpp>
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+#include "common/types.hpp"
+
+using autoware::common::types::float32_t;
+using autoware::common::types::float64_t;
+using autoware::fusion::hungarian_assigner::index_t;
+using autoware::fusion::hungarian_assigner::sparse_assigner_c;
+
+class SparseAssigner : public ::testing::TestWithParam<sparse_assigner_c::algorithm_t>
+{
+protected:
+  // Weights of a problem, NaN for weights that are not set
+  using weights_t = std::vector<std::vector<float32_t>>;
+
+  static void set_weights(sparse_assigner_c & assign, const weights_t & weights)
+  {
+    for (std::size_t idx = 0U; idx < weights.size(); ++idx) {
+      for (std::size_t jdx = 0U; jdx < weights[idx].size(); ++jdx) {
+        if (!std::isnan(weights[idx][jdx])) {
+          assign.set_weight(weights[idx][jdx], static_cast<index_t>(idx), static_cast<index_t>(jdx));
+        }
+      }
+    }
+  }
+
+  // Cost of the assignment, where an unassigned row costs MAX_WEIGHT
+  static float64_t cost(const sparse_assigner_c & assign, const weights_t & weights)
+  {
+    float64_t ret = 0.0;
+    for (std::size_t idx = 0U; idx < weights.size(); ++idx) {
+      const auto jdx = assign.get_assignment(static_cast<index_t>(idx));
+      ret += (jdx == sparse_assigner_c::UNASSIGNED) ?
+        static_cast<float64_t>(sparse_assigner_c::MAX_WEIGHT) :
+        static_cast<float64_t>(weights[idx][static_cast<std::size_t>(jdx)]);
+    }
+    return ret;
+  }
+
+  // Optimal cost by dynamic programming over the subsets of used columns
+  static float64_t optimal_cost(const weights_t & weights, const std::size_t num_cols)
+  {
+    const std::size_t num_subsets = 1U << num_cols;
+    std::vector<float64_t> best(num_subsets, std::numeric_limits<float64_t>::infinity());
+    best[0U] = 0.0;
+    for (const auto & row : weights) {
+      std::vector<float64_t> next(num_subsets, std::numeric_limits<float64_t>::infinity());
+      for (std::size_t used = 0U; used < num_subsets; ++used) {
+        if (std::isinf(best[used])) {
+          continue;
+        }
+        next[used] = std::min(
+          next[used], best[used] + static_cast<float64_t>(sparse_assigner_c::MAX_WEIGHT));
+        for (std::size_t jdx = 0U; jdx < num_cols; ++jdx) {
+          const auto bit = 1U << jdx;
+          if (((used & bit) == 0U) && !std::isnan(row[jdx])) {
+            next[used | bit] =
+              std::min(next[used | bit], best[used] + static_cast<float64_t>(row[jdx]));
+          }
+        }
+      }
+      best = next;
+    }
+    return *std::min_element(best.begin(), best.end());
+  }
+
+  // How far from the optimal cost the algorithm is allowed to be
+  float64_t tolerance(const std::size_t num_rows, const std::size_t num_cols) const
+  {
+    return (GetParam() == sparse_assigner_c::algorithm_t::AUCTION) ?
+           static_cast<float64_t>(num_rows + num_cols) * 1.0e-3 + 1.0e-6 : 1.0e-6;
+  }
+};
+
+TEST_P(SparseAssigner, Minimal)
+{
+  sparse_assigner_c assign{GetParam()};
+  ASSERT_THROW(assign.set_size(-1, 4), std::domain_error);
+  assign.set_size(3U, 3U);
+  assign.set_weight(1.0F, 0U, 1U);
+  assign.set_weight(1.0F, 1U, 2U);
+  assign.set_weight(1.0F, 2U, 0U);
+  ASSERT_THROW(assign.set_weight(1.0F, 2U, 3U), std::out_of_range);
+  ASSERT_THROW(assign.set_weight(1.0F, 3U, 0U), std::out_of_range);
+  ASSERT_THROW(
+    assign.set_weight(sparse_assigner_c::MAX_WEIGHT, 0U, 0U), std::out_of_range);
+  ASSERT_TRUE(assign.assign());
+  EXPECT_EQ(assign.get_assignment(0U), 1);
+  EXPECT_EQ(assign.get_assignment(1U), 2);
+  EXPECT_EQ(assign.get_assignment(2U), 0);
+  EXPECT_THROW(assign.get_unassigned(0U), std::range_error);
+  EXPECT_THROW(assign.get_assignment(3U), std::range_error);
+  // reset and make sure the previous weights are gone
+  assign.reset(2U, 3U);
+  assign.set_weight(1.0F, 1U, 1U);
+  EXPECT_FALSE(assign.assign());
+  EXPECT_EQ(assign.get_assignment(0U), sparse_assigner_c::UNASSIGNED);
+  EXPECT_EQ(assign.get_assignment(1U), 1);
+  EXPECT_EQ(assign.get_unassigned(0U), 0);
+  EXPECT_EQ(assign.get_unassigned(1U), 2);
+  EXPECT_THROW(assign.get_unassigned(2U), std::range_error);
+}
+
+// exercise unbalanced logic in a complicated case, same as for the dense assigner
+TEST_P(SparseAssigner, Unbalanced)
+{
+  sparse_assigner_c assign{GetParam()};
+  assign.set_size(4U, 5U);
+  const weights_t weights =
+  {
+    {4, 3, 6, 2, 7},
+    {10, 12, 11, 14, 16},
+    {4, 3, 2, 1, 5},
+    {8, 7, 6, 9, 6}
+  };
+  set_weights(assign, weights);
+
+  ASSERT_TRUE(assign.assign());
+  // There are several assignments with the optimal weight of 20, e.g. 1, 0, 3, 2
+  EXPECT_NEAR(cost(assign, weights), 20.0, tolerance(4U, 5U));
+  EXPECT_NO_THROW(assign.get_unassigned(0U));
+  EXPECT_THROW(assign.get_unassigned(1U), std::range_error);
+}
+
+// More rows than columns, which the dense assigner does not support
+TEST_P(SparseAssigner, Tall)
+{
+  sparse_assigner_c assign{GetParam()};
+  const auto nan = std::numeric_limits<float32_t>::quiet_NaN();
+  const weights_t weights =
+  {
+    {1, 2},
+    {nan, 1},
+    {0, nan},
+  };
+  assign.set_size(3U, 2U);
+  set_weights(assign, weights);
+  EXPECT_FALSE(assign.assign());
+  EXPECT_EQ(assign.get_assignment(0U), sparse_assigner_c::UNASSIGNED);
+  EXPECT_EQ(assign.get_assignment(1U), 1);
+  EXPECT_EQ(assign.get_assignment(2U), 0);
+}
+
+// The assignment with the most rows wins over a cheaper one with fewer rows, as long as the
+// weights are small compared to MAX_WEIGHT
+/*
+1 X
+0 X
+X 5
+*/
+TEST_P(SparseAssigner, PreferMoreAssignments)
+{
+  sparse_assigner_c assign{GetParam()};
+  assign.set_size(3U, 3U);
+  assign.set_weight(1.0F, 0U, 0U);
+  assign.set_weight(0.0F, 1U, 0U);
+  assign.set_weight(5.0F, 2U, 1U);
+  // Setting a weight again keeps the smallest one
+  assign.set_weight(7.0F, 2U, 1U);
+  EXPECT_FALSE(assign.assign());
+  EXPECT_EQ(assign.get_assignment(0U), sparse_assigner_c::UNASSIGNED);
+  EXPECT_EQ(assign.get_assignment(1U), 0);
+  EXPECT_EQ(assign.get_assignment(2U), 1);
+  EXPECT_EQ(assign.get_unassigned(0U), 2);
+}
+
+// Compare with the optimal cost on random sparse problems
+TEST_P(SparseAssigner, Random)
+{
+  std::mt19937 gen{1234U};
+  std::uniform_int_distribution<std::size_t> size(0U, 7U);
+  std::uniform_real_distribution<float32_t> weight(-5.0F, 20.0F);
+  std::uniform_real_distribution<float32_t> fill(0.0F, 1.0F);
+  sparse_assigner_c assign{GetParam()};
+  for (auto iteration = 0; iteration < 300; ++iteration) {
+    const auto num_rows = size(gen);
+    const auto num_cols = size(gen);
+    const auto density = fill(gen);
+    weights_t weights(num_rows, std::vector<float32_t>(num_cols));
+    for (auto & row : weights) {
+      for (auto & w : row) {
+        w = (fill(gen) < density) ? weight(gen) : std::numeric_limits<float32_t>::quiet_NaN();
+      }
+    }
+    assign.reset(static_cast<index_t>(num_rows), static_cast<index_t>(num_cols));
+    set_weights(assign, weights);
+    (void)assign.assign();
+    EXPECT_NEAR(
+      cost(assign, weights), optimal_cost(weights, num_cols),
+      tolerance(num_rows, num_cols)) << "iteration " << iteration;
+    // Every column is either assigned once or listed as unassigned
+    std::vector<std::size_t> uses(num_cols, 0U);
+    for (std::size_t idx = 0U; idx < num_rows; ++idx) {
+      const auto jdx = assign.get_assignment(static_cast<index_t>(idx));
+      if (jdx != sparse_assigner_c::UNASSIGNED) {
+        ASSERT_FALSE(std::isnan(weights[idx][static_cast<std::size_t>(jdx)]));
+        ++uses[static_cast<std::size_t>(jdx)];
+      }
+    }
+    const auto num_assigned = static_cast<std::size_t>(std::count(uses.begin(), uses.end(), 1U));
+    for (std::size_t idx = 0U; idx < num_cols - num_assigned; ++idx) {
+      ++uses[static_cast<std::size_t>(assign.get_unassigned(static_cast<index_t>(idx)))];
+    }
+    EXPECT_THROW(
+      assign.get_unassigned(static_cast<index_t>(num_cols - num_assigned)), std::range_error);
+    for (const auto count : uses) {
+      EXPECT_EQ(count, 1U);
+    }
+  }
+}
+
+// Large problem that does not fit in any dense assigner: a band of weights around the diagonal
+TEST_P(SparseAssigner, Large)
+{
+  const index_t size = 1000;
+  sparse_assigner_c assign{GetParam()};
+  assign.set_size(size, size + 1);
+  for (index_t idx = 0; idx < size; ++idx) {
+    for (index_t jdx = std::max(idx - 2, index_t()); jdx <= std::min(idx + 2, size); ++jdx) {
+      // The diagonal shifted by one is the cheapest
+      assign.set_weight((jdx == idx + 1) ? 0.0F : 1.0F, idx, jdx);
+    }
+  }
+  ASSERT_TRUE(assign.assign());
+  for (index_t idx = 0; idx < size; ++idx) {
+    EXPECT_EQ(assign.get_assignment(idx), idx + 1);
+  }
+  EXPECT_EQ(assign.get_unassigned(0), 0);
+}
+
+INSTANTIATE_TEST_CASE_P(
+  Algorithms, SparseAssigner,
+  ::testing::Values(
+    sparse_assigner_c::algorithm_t::SHORTEST_AUGMENTING_PATH,
+    sparse_assigner_c::algorithm_t::AUCTION), );
+
+#endif  // TEST_SPARSE_ASSIGNER_HPP_
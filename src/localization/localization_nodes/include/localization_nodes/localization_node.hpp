@@ -23,6 +23,7 @@
 #include <tf2/buffer_core.h>
 #include <tf2_ros/transform_listener.h>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
+#include <geometry_msgs/msg/point.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <time_utils/time_utils.hpp>
 #include <helper_functions/message_adapters.hpp>
@@ -324,6 +325,10 @@ private:
 /// Process the registration summary. By default does nothing.
   virtual void handle_registration_summary(const RegistrationSummary &) {}
 
+  /// Process a new position of the vehicle in the map frame, given either by a published pose
+  /// estimate or by an initial pose. By default does nothing.
+  virtual void handle_position_update(const geometry_msgs::msg::Point &) {}
+
   /// Callback that registers each received observation and outputs the result.
   /// \param msg_ptr Pointer to the observation message.
   void observation_callback(typename ObservationMsgT::ConstSharedPtr msg_ptr)
@@ -369,6 +374,7 @@ private:
         }
 
         handle_registration_summary(summary);
+        handle_position_update(pose_out.pose.pose.position);
       } else {
         on_invalid_output(pose_out);
       }
@@ -479,6 +485,11 @@ private:
     // We'd need to know the current time before it can be published, and set the
     // time in the header to a recent time.
     m_pose_initializer.set_fallback_pose(transformed_pose_stamped);
+
+    const auto & translation = transformed_pose_stamped.transform.translation;
+    handle_position_update(
+      geometry_msgs::msg::Point{}.set__x(translation.x).set__y(translation.y).
+      set__z(translation.z));
   }
 
   std::unique_ptr<LocalizerT> m_localizer_ptr;
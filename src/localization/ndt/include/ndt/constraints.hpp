@@ -77,6 +77,12 @@ struct P2DNDTOptimizationMapConstraint
   template<typename Map>
   using call_cell = decltype(std::declval<Map>().cell(std::declval<const Point &>()));
 
+  /// \brief  This expression requires a method that looks up the cells at the given location
+  /// into a given vector and is safe to call concurrently.
+  template<typename Map>
+  using call_cell_into = decltype(std::declval<const Map>().cell(
+      std::declval<const Point &>(), std::declval<VoxelViewVector &>()));
+
   /// \brief  This expression requires a method that returns the (std::chrono) timestamp of the
   /// \return Map frame ID.
   template<typename Map>
@@ -87,6 +93,10 @@ struct P2DNDTOptimizationMapConstraint
     const VoxelViewVector &>::value,
     "The map should provide a `cell(...)` method");
 
+  static_assert(
+    common::helper_functions::expression_valid<call_cell_into, MapT>::value,
+    "The map should provide a `cell(point, cells_out)` method");
+
   static_assert(
     common::helper_functions::expression_valid_with_return<call_cell_size, MapT,
     const perception::filters::voxel_grid::PointXYZ &>::value,
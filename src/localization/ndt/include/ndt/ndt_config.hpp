@@ -17,8 +17,11 @@
 #ifndef NDT__NDT_CONFIG_HPP_
 #define NDT__NDT_CONFIG_HPP_
 
+#include <helper_functions/thread_pool.hpp>
 #include <ndt/ndt_common.hpp>
 #include <voxel_grid/config.hpp>
+#include <memory>
+#include <stdexcept>
 #include <utility>
 
 namespace autoware
@@ -54,18 +57,45 @@ private:
 class NDT_PUBLIC P2DNDTOptimizationConfig
 {
 public:
+  using ThreadPool = common::helper_functions::ThreadPool;
+
   /// Constructor
   /// \param outlier_ratio Outlier ratio to be used in the gaussian distribution variation used
   /// in (eq. 6.7) [Magnusson 2009]
-  explicit P2DNDTOptimizationConfig(Real outlier_ratio)
-  : m_outlier_ratio{outlier_ratio} {}
+  /// \param num_threads Number of threads used to evaluate the objective. The worker threads are
+  /// created here and shared by all copies of this config, hence objectives using copies of the
+  /// same config must not be evaluated concurrently.
+  /// \throws std::domain_error if num_threads is zero.
+  explicit P2DNDTOptimizationConfig(Real outlier_ratio, std::size_t num_threads = 1U)
+  : m_outlier_ratio{outlier_ratio},
+    m_thread_pool{make_thread_pool(num_threads)} {}
 
   /// Get outlier ratio.
   /// \return outlier ratio.
   Real outlier_ratio() const noexcept {return m_outlier_ratio;}
 
+  /// Get number of threads used to evaluate the objective.
+  /// \return number of threads.
+  std::size_t num_threads() const noexcept
+  {
+    return m_thread_pool ? m_thread_pool->size() : 1U;
+  }
+
+  /// Get the worker threads to evaluate the objective with.
+  /// \return Thread pool, or nullptr if the objective is to be evaluated on the calling thread.
+  ThreadPool * thread_pool() const noexcept {return m_thread_pool.get();}
+
 private:
+  static std::shared_ptr<ThreadPool> make_thread_pool(std::size_t num_threads)
+  {
+    if (num_threads == 0U) {
+      throw std::domain_error("P2DNDTOptimizationConfig: number of threads must be positive");
+    }
+    return (num_threads > 1U) ? std::make_shared<ThreadPool>(num_threads) : nullptr;
+  }
+
   Real m_outlier_ratio;
+  std::shared_ptr<ThreadPool> m_thread_pool;
 };
 
 
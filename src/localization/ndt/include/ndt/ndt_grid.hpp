@@ -80,15 +80,24 @@ public:
   /// \return A vector containing the cell at given coordinates. A vector is used to support
   /// near-neighbour cell queries in the future.
   const VoxelViewVector & cell(const Point & pt) const
+  {
+    cell(pt, m_output_vector);
+    return m_output_vector;
+  }
+
+  /// Lookup the cell at location into a caller provided vector. Unlike the other overloads,
+  /// this one does not modify the grid and can be called concurrently.
+  /// \param pt point to lookup
+  /// \param cells_out Vector to be cleared and filled with the cells at given coordinates.
+  void cell(const Point & pt, VoxelViewVector & cells_out) const
   {
     // TODO(yunus.caliskan): revisit after multi-cell lookup support. #985
-    m_output_vector.clear();
+    cells_out.clear();
     const auto vx_it = m_map.find(m_config.index(pt));
     // Only return a voxel if it's occupied (i.e. has enough points to compute covariance.)
     if (vx_it != m_map.end() && vx_it->second.usable()) {
-      m_output_vector.emplace_back(vx_it->second);
+      cells_out.emplace_back(vx_it->second);
     }
-    return m_output_vector;
   }
 
   /// Get size of the map
@@ -178,6 +187,22 @@ public:
     m_map[index(pt)].add_observation(pt);
   }
 
+  /// \brief Get the voxel with the given index, inserting an empty voxel if there is none.
+  /// \param idx Voxel index
+  /// \return Reference to the voxel
+  VoxelT & voxel(uint64_t idx)
+  {
+    return m_map[idx];
+  }
+
+  /// \brief Find the voxel with the given index.
+  /// \param idx Voxel index
+  /// \return Iterator to the voxel or `end()` if there is no voxel with this index.
+  typename Grid::iterator find(uint64_t idx)
+  {
+    return m_map.find(idx);
+  }
+
   /// \brief Set the configuration
   /// \param config Config object to be set.
   void set_config(const Config & config)
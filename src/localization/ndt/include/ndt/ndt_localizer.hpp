@@ -246,13 +246,19 @@ public:
   using PoseWithCovarianceStamped = typename ParentT::PoseWithCovarianceStamped;
   using ScanT = P2DNDTScan;
 
+  /// Constructor
+  /// \param config Localizer config.
+  /// \param optimizer Optimizer to use during optimization.
+  /// \param outlier_ratio Outlier ratio of the optimization problem.
+  /// \param num_threads Number of threads used to evaluate the optimization problem.
   explicit P2DNDTLocalizer(
     const P2DNDTLocalizerConfig & config,
     const OptimizerT & optimizer,
-    const Real outlier_ratio)
+    const Real outlier_ratio,
+    const std::size_t num_threads = 1U)
   : ParentT{
       config,
-      P2DNDTOptimizationConfig{outlier_ratio},
+      P2DNDTOptimizationConfig{outlier_ratio, num_threads},
       optimizer,
       ScanT{config.scan_capacity()}} {}
 
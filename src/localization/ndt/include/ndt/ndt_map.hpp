@@ -21,8 +21,12 @@
 #include <ndt/ndt_voxel.hpp>
 #include <ndt/ndt_voxel_view.hpp>
 #include <ndt/ndt_grid.hpp>
+#include <ndt/utils.hpp>
+#include <helper_functions/thread_pool.hpp>
 #include <sensor_msgs/point_cloud2_iterator.hpp>
 #include <time_utils/time_utils.hpp>
+#include <atomic>
+#include <mutex>
 #include <vector>
 #include <limits>
 #include <unordered_map>
@@ -39,9 +43,12 @@ namespace ndt
 {
 /// Ndt Map for a dynamic voxel type. This map representation is only to be used
 /// when a dense point cloud is intended to be represented as a map. (i.e. by the map publisher)
+/// The map keeps track of the voxels changed since their covariance was last stabilized, so that
+/// only those are stabilized again instead of the whole map.
 class NDT_PUBLIC DynamicNDTMap
 {
 public:
+  using ThreadPool = common::helper_functions::ThreadPool;
   using Voxel = DynamicNDTVoxel;
   using Config = autoware::perception::filters::voxel_grid::Config;
   using Point = Eigen::Vector3d;
@@ -54,7 +61,24 @@ public:
   /// Min point, max point and the voxel size.
   static constexpr uint32_t kNumConfigPoints = 3U;
 
-  explicit DynamicNDTMap(const Config & voxel_grid_config);
+  /// Constructor
+  /// \param voxel_grid_config Voxel grid config to configure the underlying voxel grid.
+  /// \param defer_stabilization If false, `insert(...)` stabilizes the voxels it changed before
+  /// returning. If true, they are stabilized by `stabilize(...)` or at the latest by the next
+  /// lookup, so that several insertions only stabilize a voxel once.
+  /// \param max_voxel_points Number of points after which a voxel is saturated. Further points
+  /// falling into a saturated voxel are ignored, as they barely change its distribution.
+  /// \throws std::domain_error if max_voxel_points is smaller than the number of points a voxel
+  /// needs to be usable.
+  explicit DynamicNDTMap(
+    const Config & voxel_grid_config,
+    bool8_t defer_stabilization = false,
+    uint64_t max_voxel_points = std::numeric_limits<uint64_t>::max());
+
+  // The stabilization lock cannot be moved, the moved-to map gets its own.
+  DynamicNDTMap(DynamicNDTMap && other);
+
+  DynamicNDTMap & operator=(DynamicNDTMap && other);
 
   /// \brief Set the contents of the pointcloud as the new map.
   /// \param msg Pointcloud to be inserted.
@@ -65,6 +89,15 @@ public:
   /// \param msg PointCloud2 message to add.
   void insert(const sensor_msgs::msg::PointCloud2 & msg);
 
+  /// Stabilize the covariances of the voxels changed since their last stabilization.
+  /// \param thread_pool Worker threads to share the voxels with, or nullptr to stabilize them on
+  /// the calling thread. Must not be used by a lookup in progress.
+  void stabilize(ThreadPool * thread_pool = nullptr);
+
+  /// Get the number of voxels waiting for stabilization.
+  /// \return Number of voxels changed since their last stabilization.
+  std::size_t num_unstable() const noexcept;
+
   /// Iterate over the map representation and convert it into a PointCloud2 message where each
   /// voxel in the map corresponds to a single point in the PointCloud2 field.
   /// \tparam DeserializingMapT The map type that can deserialize the serialized message.
@@ -79,6 +112,13 @@ public:
   /// near-neighbour cell queries in the future.
   const VoxelViewVector & cell(const Point & pt) const;
 
+  /// Lookup the cell at location into a caller provided vector. Unlike the other overloads,
+  /// this one does not modify the map and can be called concurrently. Voxels waiting for
+  /// stabilization are stabilized by the first of the concurrent calls while the others wait.
+  /// \param pt point to lookup
+  /// \param cells_out Vector to be cleared and filled with the cells at given coordinates.
+  void cell(const Point & pt, VoxelViewVector & cells_out) const;
+
   /// Lookup the cell at location.
   /// \param x x coordinate
   /// \param y y coordinate
@@ -108,9 +148,10 @@ public:
   /// enough numbers to be used yet.
   std::size_t size() const noexcept;
 
-  /// \brief Returns an const iterator to the first element of the map
+  /// \brief Returns an const iterator to the first element of the map. Voxels waiting for
+  /// stabilization are stabilized first.
   /// \return Iterator
-  typename VoxelGrid::const_iterator begin() const noexcept;
+  typename VoxelGrid::const_iterator begin() const;
 
   /// \brief Returns a const iterator to one past the last element of the map
   /// \return Iterator
@@ -120,7 +161,21 @@ public:
   void clear() noexcept;
 
 private:
+  /// Stabilize the voxels waiting for it if there are any. Called by the const accessors, hence
+  /// it is guarded against concurrent lookups.
+  void stabilize_pending() const;
+
+  /// Stabilize the voxels waiting for it. m_stabilize_mutex has to be held by the caller.
+  /// \param thread_pool Worker threads to share the voxels with, may be nullptr.
+  void stabilize_locked(ThreadPool * thread_pool);
+
   NDTGrid<DynamicNDTVoxel> m_grid;
+  bool8_t m_defer_stabilization;
+  uint64_t m_max_voxel_points;
+  /// Indices of the voxels changed since their last stabilization, each listed once.
+  std::vector<uint64_t> m_unstable_voxels{};
+  std::atomic<bool8_t> m_has_unstable_voxels{false};
+  mutable std::mutex m_stabilize_mutex{};
   TimePoint m_stamp{};
   std::string m_frame_id{};
 };
@@ -155,6 +210,12 @@ public:
   /// near-neighbour cell queries in the future.
   const VoxelViewVector & cell(const Point & pt) const;
 
+  /// Lookup the cell at location into a caller provided vector. Unlike the other overloads,
+  /// this one does not modify the map and can be called concurrently.
+  /// \param pt point to lookup
+  /// \param cells_out Vector to be cleared and filled with the cells at given coordinates.
+  void cell(const Point & pt, VoxelViewVector & cells_out) const;
+
   /// Lookup the cell at location.
   /// \param x x coordinate
   /// \param y y coordinate
@@ -203,6 +264,133 @@ private:
   TimePoint m_stamp{};
   std::string m_frame_id{};
 };
+
+/// NDT map using StaticNDTVoxels which is optimized for the lookups of the localization loop.
+/// It accepts the same serialized messages as `StaticNDTMap` and returns the same cells, but on
+/// `set(...)` it drops unusable voxels and packs the remaining ones into a single contiguous
+/// array. The array is addressed by an open addressing table with a low load factor, so a cell
+/// lookup usually takes one probe and no pointer chasing, unlike the node based
+/// `std::unordered_map` of `NDTGrid`. The map is immutable after `set(...)`.
+class NDT_PUBLIC CompactStaticNDTMap
+{
+public:
+  using Voxel = StaticNDTVoxel;
+  using Config = autoware::perception::filters::voxel_grid::Config;
+  using TimePoint = std::chrono::system_clock::time_point;
+  using Point = Eigen::Vector3d;
+  using VoxelViewVector = std::vector<VoxelView<Voxel>>;
+  using VoxelVector = std::vector<std::pair<uint64_t, Voxel>>;
+  using ConfigPoint = NDTGrid<Voxel>::ConfigPoint;
+
+  CompactStaticNDTMap();
+
+  /// Set point cloud message representing the map to the map representation instance. See
+  /// `StaticNDTMap::set(...)` for the expected format.
+  /// \param msg PointCloud2 message to add. Each point in this cloud should correspond to a
+  /// single voxel in the underlying voxel grid.
+  /// \throws std::runtime_error on an invalid or empty message.
+  void set(const sensor_msgs::msg::PointCloud2 & msg);
+
+  /// Clear the map and prepare it for the insertion of serialized voxels that are not wrapped in
+  /// a message, e.g. voxels read from map tiles.
+  /// \param config Voxel grid configuration of the serialized voxels.
+  /// \param capacity Maximum number of voxels that will be inserted.
+  /// \param stamp Time stamp of the map.
+  /// \param frame_id Frame id of the map.
+  void reset(
+    const Config & config, std::size_t capacity, TimePoint stamp,
+    const std::string & frame_id);
+
+  /// Insert a serialized voxel. Unusable voxels are dropped. Only valid after `reset(...)`.
+  /// \param voxel_point Serialized voxel.
+  /// \throws std::length_error if the capacity given to `reset(...)` is exceeded.
+  void insert(const PointWithCovariances & voxel_point);
+
+  /// Lookup the cell at location.
+  /// \param pt point to lookup
+  /// \return A vector containing the cell at given coordinates. A vector is used to support
+  /// near-neighbour cell queries in the future.
+  const VoxelViewVector & cell(const Point & pt) const;
+
+  /// Lookup the cell at location into a caller provided vector. Unlike the other overloads,
+  /// this one does not modify the map and can be called concurrently.
+  /// \param pt point to lookup
+  /// \param cells_out Vector to be cleared and filled with the cells at given coordinates.
+  void cell(const Point & pt, VoxelViewVector & cells_out) const;
+
+  /// Lookup the cell at location.
+  /// \param x x coordinate
+  /// \param y y coordinate
+  /// \param z z coordinate
+  /// \return A vector containing the cell at given coordinates. A vector is used to support
+  /// near-neighbour cell queries in the future.
+  const VoxelViewVector & cell(float32_t x, float32_t y, float32_t z) const;
+
+  /// Get map's frame id.
+  /// \return Frame id of the map.
+  const std::string & frame_id() const noexcept;
+
+  /// Get map's time stamp.
+  /// \return map's time stamp.
+  TimePoint stamp() const noexcept;
+
+  /// \brief Check if the map is valid.
+  /// \return True if the map and frame ID are not empty and the stamp is initialized.
+  bool valid() const noexcept;
+
+  /// Get size of the cell.
+  /// \return A point representing the dimensions of the cell.
+  const ConfigPoint & cell_size() const;
+
+  /// Get size of the map
+  /// \return Number of usable voxels in the map.
+  std::size_t size() const noexcept;
+
+  /// \brief Returns an const iterator to the first (voxel index, voxel) pair of the map
+  /// \return Iterator
+  typename VoxelVector::const_iterator begin() const noexcept;
+
+  /// \brief Returns a const iterator to one past the last element of the map
+  /// \return Iterator
+  typename VoxelVector::const_iterator end() const noexcept;
+
+  /// Clear all voxels in the map
+  void clear() noexcept;
+
+private:
+  /// Entry of the lookup table, mapping a voxel grid index to a position in m_voxels.
+  struct Bucket
+  {
+    uint64_t key;
+    uint64_t slot;
+  };
+
+  static constexpr uint64_t EMPTY_KEY = std::numeric_limits<uint64_t>::max();
+
+  /// Get the table bucket a voxel index hashes to.
+  /// \param key Voxel grid index.
+  /// \return Position of the first bucket to probe.
+  std::size_t home_bucket(uint64_t key) const noexcept;
+
+  /// Find the voxel with the given voxel grid index.
+  /// \param key Voxel grid index.
+  /// \return Pointer to the voxel or nullptr if there is no voxel with this index.
+  const Voxel * find(uint64_t key) const noexcept;
+
+  /// Insert a voxel, replacing an existing voxel with the same index.
+  /// \param key Voxel grid index.
+  /// \param voxel Voxel to insert.
+  void insert(uint64_t key, const Voxel & voxel);
+
+  mutable VoxelViewVector m_output_vector;
+  std::experimental::optional<Config> m_config{};
+  VoxelVector m_voxels{};
+  std::vector<Bucket> m_table{};
+  std::size_t m_capacity{0U};
+  uint32_t m_hash_shift{0U};
+  TimePoint m_stamp{};
+  std::string m_frame_id{};
+};
 }  // namespace ndt
 }  // namespace localization
 }  // namespace autoware
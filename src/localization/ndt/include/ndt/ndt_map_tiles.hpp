@@ -0,0 +1,278 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#ifndef NDT__NDT_MAP_TILES_HPP_
+#define NDT__NDT_MAP_TILES_HPP_
+
+#include <ndt/ndt_map.hpp>
+#include <ndt/utils.hpp>
+#include <ndt/visibility_control.hpp>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace autoware
+{
+namespace localization
+{
+namespace ndt
+{
+/// Entry of the tile index of a tiled ndt map file. A tile covers the square
+/// [x * tile_size, (x + 1) * tile_size) x [y * tile_size, (y + 1) * tile_size) of the map frame
+/// and holds the voxels whose centroids fall into it.
+struct NDTMapTileIndexEntry
+{
+  int32_t x;
+  int32_t y;
+  /// Position of the first voxel of the tile in the voxel section of the file.
+  uint64_t first_voxel;
+  uint64_t num_voxels;
+};
+
+/// Split a serialized static ndt map into square tiles in the x-y plane and write it to a file.
+/// The file consists of a header with the voxel grid configuration, the tile index sorted by
+/// tile coordinates and the voxels of all tiles stored tile by tile as `PointWithCovariances`.
+/// All values are written in native byte order.
+/// \param serialized_map Map serialized by `DynamicNDTMap::serialize_as<StaticNDTMap>(...)`.
+/// \param tile_size Edge length of a tile in meters.
+/// \param file_name Name of the file to write.
+/// \throws std::domain_error on a non-positive tile size or a too long frame id.
+/// \throws std::runtime_error on an invalid map or if the file cannot be written.
+void NDT_PUBLIC write_ndt_map_tiles(
+  const sensor_msgs::msg::PointCloud2 & serialized_map,
+  float64_t tile_size,
+  const std::string & file_name);
+
+/// Read-only view of a tiled ndt map file written by `write_ndt_map_tiles(...)`. The file is
+/// memory mapped, so opening it only reads the header and the tile index. Voxels are paged in by
+/// the operating system when a tile is first accessed.
+class NDT_PUBLIC NDTMapTileFile
+{
+public:
+  using Config = CompactStaticNDTMap::Config;
+  using TimePoint = CompactStaticNDTMap::TimePoint;
+
+  /// Constructor
+  /// \param file_name Name of the tiled map file.
+  /// \throws std::runtime_error if the file cannot be mapped or is not a valid tiled map.
+  explicit NDTMapTileFile(const std::string & file_name);
+  ~NDTMapTileFile();
+
+  NDTMapTileFile(const NDTMapTileFile &) = delete;
+  NDTMapTileFile & operator=(const NDTMapTileFile &) = delete;
+
+  /// Get the voxel grid configuration of the tiled map.
+  /// \param capacity Capacity of the returned configuration.
+  /// \return Voxel grid configuration.
+  Config config(std::size_t capacity) const;
+
+  /// Get the edge length of the tiles.
+  /// \return Tile size in meters.
+  float64_t tile_size() const noexcept;
+
+  /// Get the tile coordinate of a position along the x or y axis.
+  /// \param position Position in meters.
+  /// \return Tile coordinate, saturated to the range of the coordinate type.
+  int32_t tile_coordinate(float64_t position) const noexcept;
+
+  /// Get the frame id of the map.
+  /// \return Frame id.
+  const std::string & frame_id() const noexcept;
+
+  /// Get the time stamp of the map.
+  /// \return Time stamp.
+  TimePoint stamp() const noexcept;
+
+  /// Get the number of tiles in the map.
+  /// \return Number of tiles.
+  std::size_t num_tiles() const noexcept;
+
+  /// Look up the tiles in a rectangle of tile coordinates. Tiles without voxels are not stored,
+  /// so the number of visited index entries does not depend on the size of the rectangle.
+  /// \param x_min Minimum tile coordinate along the x axis.
+  /// \param x_max Maximum tile coordinate along the x axis.
+  /// \param y_min Minimum tile coordinate along the y axis.
+  /// \param y_max Maximum tile coordinate along the y axis.
+  /// \param tiles_out Vector to be cleared and filled with the index entries of the found tiles,
+  /// sorted by their coordinates.
+  void find_tiles(
+    int32_t x_min, int32_t x_max, int32_t y_min, int32_t y_max,
+    std::vector<const NDTMapTileIndexEntry *> & tiles_out) const;
+
+  /// Get the voxels of a tile.
+  /// \param tile Index entry of the tile.
+  /// \return Pointer to the first of `tile.num_voxels` voxels.
+  const PointWithCovariances * voxels(const NDTMapTileIndexEntry & tile) const noexcept;
+
+  /// Hint that the voxels of a tile will be read soon, so they can be read ahead.
+  /// \param tile Index entry of the tile.
+  void will_need(const NDTMapTileIndexEntry & tile) const noexcept;
+
+  /// Hint that the voxels of a tile are no longer needed, so the memory can be reclaimed.
+  /// \param tile Index entry of the tile.
+  void dont_need(const NDTMapTileIndexEntry & tile) const noexcept;
+
+private:
+  /// Forward a hint about the voxels of a tile to the operating system.
+  void advise(const NDTMapTileIndexEntry & tile, int32_t advice) const noexcept;
+
+  const uint8_t * m_data{nullptr};
+  std::size_t m_size{0U};
+  const NDTMapTileIndexEntry * m_tiles{nullptr};
+  std::size_t m_num_tiles{0U};
+  const PointWithCovariances * m_voxels{nullptr};
+  float64_t m_tile_size{0.0};
+  float64_t m_min_point[3U];
+  float64_t m_max_point[3U];
+  float64_t m_voxel_size[3U];
+  TimePoint m_stamp{};
+  std::string m_frame_id{};
+};
+
+/// NDT map which only keeps the tiles of a tiled map file around the vehicle in memory.
+/// The resident tiles are all tiles within the paging radius of any point in the tile
+/// containing the last position given to `update(...)`. When this position moves to another
+/// tile, a background thread pages the new tiles in, builds a `CompactStaticNDTMap` from them
+/// and pages the tiles that left the radius out. The finished map is swapped in by a later call
+/// to `update(...)` in constant time, so lookups never wait for tiles being loaded. The lookups
+/// and `update(...)` must be called from the same thread, e.g. between registrations.
+class NDT_PUBLIC PagedNDTMap
+{
+public:
+  using Voxel = CompactStaticNDTMap::Voxel;
+  using TimePoint = CompactStaticNDTMap::TimePoint;
+  using Point = CompactStaticNDTMap::Point;
+  using VoxelViewVector = CompactStaticNDTMap::VoxelViewVector;
+  using ConfigPoint = CompactStaticNDTMap::ConfigPoint;
+
+  /// Constructor. No tiles are resident until the first call to `update(...)`.
+  /// \param file_name Name of the tiled map file.
+  /// \param paging_radius Radius around the vehicle in which the tiles are kept in memory.
+  /// \throws std::domain_error on a negative paging radius.
+  /// \throws std::runtime_error if the file is not a valid tiled map.
+  PagedNDTMap(const std::string & file_name, float64_t paging_radius);
+  ~PagedNDTMap();
+
+  PagedNDTMap(const PagedNDTMap &) = delete;
+  PagedNDTMap & operator=(const PagedNDTMap &) = delete;
+
+  /// Paged maps are only read from tiled map files, setting them from a message is not supported.
+  /// \throws std::logic_error always.
+  void set(const sensor_msgs::msg::PointCloud2 & msg);
+
+  /// Swap in the tiles loaded in the background, if any, and request the tiles around a new
+  /// position. Does not wait for tiles to be loaded.
+  /// \param position Current position of the vehicle in the map frame.
+  void update(const Point & position);
+
+  /// Block until the tiles around the last position given to `update(...)` are loaded and swap
+  /// them in. Meant for initialization, as the regular `update(...)` never blocks.
+  /// \param timeout Maximum time to wait.
+  /// \return True if the requested tiles are resident.
+  bool wait_until_loaded(std::chrono::milliseconds timeout);
+
+  /// Lookup the cell at location.
+  /// \param pt point to lookup
+  /// \return A vector containing the cell at given coordinates. A vector is used to support
+  /// near-neighbour cell queries in the future.
+  const VoxelViewVector & cell(const Point & pt) const;
+
+  /// Lookup the cell at location into a caller provided vector. Unlike the other overloads,
+  /// this one does not modify the map and can be called concurrently.
+  /// \param pt point to lookup
+  /// \param cells_out Vector to be cleared and filled with the cells at given coordinates.
+  void cell(const Point & pt, VoxelViewVector & cells_out) const;
+
+  /// Lookup the cell at location.
+  /// \param x x coordinate
+  /// \param y y coordinate
+  /// \param z z coordinate
+  /// \return A vector containing the cell at given coordinates. A vector is used to support
+  /// near-neighbour cell queries in the future.
+  const VoxelViewVector & cell(float32_t x, float32_t y, float32_t z) const;
+
+  /// Get map's frame id.
+  /// \return Frame id of the map.
+  const std::string & frame_id() const noexcept;
+
+  /// Get map's time stamp.
+  /// \return map's time stamp.
+  TimePoint stamp() const noexcept;
+
+  /// \brief Check if the map is valid.
+  /// \return True if the resident tiles contain usable voxels.
+  bool valid() const noexcept;
+
+  /// Get size of the cell.
+  /// \return A point representing the dimensions of the cell.
+  const ConfigPoint & cell_size() const noexcept;
+
+  /// Get the number of resident voxels.
+  /// \return Number of usable voxels in the resident tiles.
+  std::size_t size() const noexcept;
+
+private:
+  using TileCoordinates = std::pair<int32_t, int32_t>;
+  using Snapshot = std::shared_ptr<const CompactStaticNDTMap>;
+
+  /// Wait for requests and load the tiles around them until the map is destroyed.
+  void load_tiles();
+
+  /// Build a map from the tiles around a tile and page out the tiles no longer needed.
+  /// \param center Coordinates of the tile containing the vehicle.
+  /// \param resident_tiles Tiles paged in by the previous call, updated to the new ones.
+  /// \return Map of the tiles around center.
+  Snapshot build_snapshot(
+    const TileCoordinates & center,
+    std::vector<const NDTMapTileIndexEntry *> & resident_tiles) const;
+
+  /// Swap in a loaded map if one is ready. Must be called with m_mutex held.
+  void swap_in_ready_snapshot();
+
+  NDTMapTileFile m_file;
+  int32_t m_tile_radius;
+  ConfigPoint m_cell_size;
+  Snapshot m_active{};
+  VoxelViewVector m_empty_cells{};
+  TileCoordinates m_requested{};
+  bool m_has_requested{false};
+  // Shared with the loader thread, guarded by m_mutex.
+  std::mutex m_mutex{};
+  std::condition_variable m_loader_cv{};
+  std::condition_variable m_loaded_cv{};
+  bool m_stop{false};
+  bool m_has_request{false};
+  TileCoordinates m_request{};
+  Snapshot m_ready{};
+  TileCoordinates m_ready_tile{};
+  TileCoordinates m_active_tile{};
+  bool m_has_active_tile{false};
+  // Replaced maps are released by the loader thread so large deallocations stay off the caller.
+  Snapshot m_retired{};
+  std::thread m_loader;
+};
+}  // namespace ndt
+}  // namespace localization
+}  // namespace autoware
+
+#endif  // NDT__NDT_MAP_TILES_HPP_
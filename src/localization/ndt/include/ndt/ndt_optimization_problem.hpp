@@ -67,8 +67,12 @@
 #include <experimental/optional>
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <algorithm>
+#include <array>
 #include <limits>
 #include <tuple>
+#include <vector>
 #include "common/types.hpp"
 
 using autoware::common::types::bool8_t;
@@ -91,7 +95,8 @@ bool8_t is_valid_probability(ScalarT p)
 }
 
 /// P2D ndt objective. This class implements the P2D ndt score function, its analytical
-/// jacobian and hessian values.
+/// jacobian and hessian values. The scan is evaluated in fixed size chunks, optionally on the
+/// worker threads given in the config, and the results of the chunks are summed up in order.
 /// \tparam MapT Type of map to be used. This type should conform the interface specified in
 /// `P2DNDTOptimizationMapConstraint`
 template<typename MapT,
@@ -114,6 +119,15 @@ public:
   using ComputeMode = common::optimization::ComputeMode;
   using PointGrad = Eigen::Matrix<float64_t, 3, 6>;
   using PointHessian = Eigen::Matrix<float64_t, 18, 6>;
+  using Transform = Eigen::Transform<float64_t, 3, Eigen::Affine, Eigen::ColMajor>;
+  using VoxelViewVector = typename traits::P2DNDTOptimizationMapConstraint<MapT>::VoxelViewVector;
+  using ThreadPool = P2DNDTOptimizationConfig::ThreadPool;
+
+  /// Number of scan points per unit of work. The partial sums of the chunks are reduced in a
+  /// fixed order, so the objective is bit-reproducible for any number of threads.
+  static constexpr std::size_t CHUNK_SIZE = 256U;
+  /// Number of point-cell pairs that are gathered before their terms are evaluated.
+  static constexpr std::size_t MATCH_BATCH_SIZE = 64U;
 
   /// Constructor.
   ///
@@ -127,103 +141,68 @@ public:
   ///
   P2DNDTObjective(
     const P2DNDTScan & scan, const Map & map, const P2DNDTOptimizationConfig config)
-  : m_scan_ref(scan), m_map_ref(map)
+  : m_scan_ref(scan), m_map_ref(map), m_thread_pool{config.thread_pool()}
   {
     init(config.outlier_ratio());
+    m_chunks.resize((m_scan_ref.size() + CHUNK_SIZE - 1U) / CHUNK_SIZE);
   }
 
   void evaluate_(const DomainValue & x, const ComputeMode & mode)
   {
     // Convert pose vector to transform matrix for easy point transformation
-    Eigen::Transform<float64_t, 3, Eigen::Affine, Eigen::ColMajor> transform;
+    Transform transform;
     transform.setIdentity();
     transform_adapters::pose_to_transform(x, transform);
 
-    Value score{0.0};
-
-    Jacobian jacobian;
     std::experimental::optional<GradientAngleParameters> grad_params;
-
-    Hessian hessian;
     std::experimental::optional<HessianAngleParameters> hessian_params;
-
     {
       // Angle parameters to be used by all elements (eq. 6.12) [Magnusson 2009]
       const AngleParameters angle_params{x};
       // Only construct jacobian/hessian variables if they are needed.
       if (mode.jacobian() || mode.hessian()) {
-        jacobian.setZero();
         grad_params.emplace(angle_params);
       }
       if (mode.hessian()) {
-        hessian.setZero();
         hessian_params.emplace(angle_params);
       }
     }
 
-    for (const auto & pt : m_scan_ref) {
-      PointGrad point_gradient;
-      PointHessian point_hessian;
-
-      if (mode.jacobian() || mode.hessian()) {
-        point_gradient.setZero();
-        point_gradient.block<3, 3>(0, 0).setIdentity();
-        compute_point_gradients(grad_params.value(), pt, point_gradient);
-
-        if (mode.hessian()) {
-          point_hessian.setZero();
-          compute_point_hessians(hessian_params.value(), pt, point_hessian);
-        }
+    const auto num_chunks = (m_scan_ref.size() + CHUNK_SIZE - 1U) / CHUNK_SIZE;
+    if (m_chunks.size() < num_chunks) {
+      m_chunks.resize(num_chunks);
+    }
+    const auto evaluate_chunk_at = [&](std::size_t chunk_idx) {
+        evaluate_chunk(
+          chunk_idx, transform, grad_params ? &grad_params.value() : nullptr,
+          hessian_params ? &hessian_params.value() : nullptr, mode);
+      };
+    if (m_thread_pool != nullptr) {
+      m_thread_pool->run(num_chunks, evaluate_chunk_at);
+    } else {
+      for (auto chunk_idx = 0U; chunk_idx < num_chunks; ++chunk_idx) {
+        evaluate_chunk_at(chunk_idx);
       }
+    }
 
-      const Point pt_trans = transform * pt;
-      const auto & cells = m_map_ref.cell(pt_trans);
-
-      for (const auto & cell : cells) {
-        const Point pt_trans_norm = pt_trans - cell.centroid();
-        // Cell iteration used for compatibility with maps with multi-cell lookup
-        if (!cell.usable()) {
-          continue;
-        }
-        const auto & inv_cov = cell.inverse_covariance();
-        // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
-        Real e_minus_half_d2_x_cov_x =
-          std::exp(-m_gauss_d2 * pt_trans_norm.dot(inv_cov * pt_trans_norm) / 2.0);
-
-        if (mode.score()) {
-          score += -m_gauss_d1 * e_minus_half_d2_x_cov_x;
-        }
-
-        if (!mode.jacobian() && !mode.hessian()) {
-          continue;
-        }
-        const auto d2_e_minus_half_d2_x_cov_x = m_gauss_d2 * e_minus_half_d2_x_cov_x;
-
-        // Error checking for invalid values.
-        if (!is_valid_probability(d2_e_minus_half_d2_x_cov_x)) {
-          continue;
-        }
-
-        // Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
-        const auto d1_d2_e_minus_half_d2_x_cov_x = m_gauss_d1 * d2_e_minus_half_d2_x_cov_x;
-
-        for (auto i = 0U; i < jacobian.rows(); ++i) {
-          const Point cov_dxd_pi = inv_cov * point_gradient.col(i);
-          if (mode.jacobian()) {
-            jacobian(i) += pt_trans_norm.dot(cov_dxd_pi) * d1_d2_e_minus_half_d2_x_cov_x;
-          }
-          if (mode.hessian()) {
-            for (auto j = 0U; j < hessian.cols(); ++j) {
-              hessian(i, j) += d1_d2_e_minus_half_d2_x_cov_x *
-                (-m_gauss_d2 * pt_trans_norm.dot(cov_dxd_pi) *
-                pt_trans_norm.dot(inv_cov * point_gradient.col(j)) +
-                pt_trans_norm.dot(inv_cov * point_hessian.block<3, 1>(3 * i, j)) +
-                point_gradient.col(j).dot(cov_dxd_pi));
-            }
-          }
-        }
+    // Reduce the partial sums in chunk order, which keeps the result independent of the number
+    // of threads and the order in which the chunks were evaluated.
+    Value score{0.0};
+    Jacobian jacobian;
+    jacobian.setZero();
+    Hessian hessian;
+    hessian.setZero();
+    for (auto chunk_idx = 0U; chunk_idx < num_chunks; ++chunk_idx) {
+      const auto & chunk = m_chunks[chunk_idx];
+      score += chunk.score;
+      if (mode.jacobian()) {
+        jacobian += chunk.jacobian;
+      }
+      if (mode.hessian()) {
+        hessian += chunk.hessian;
       }
     }
+
     if (mode.score()) {
       this->set_score(score);
     }
@@ -437,6 +416,146 @@ public:
     point_hessian.block<3, 1>(15, 5) = f;
   }
 
+  /// Partial sums of the objective over a contiguous chunk of the scan.
+  struct ChunkSum
+  {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Value score{0.0};
+    Jacobian jacobian;
+    Hessian hessian;
+    // Cell lookup buffer, kept here so that lookups do not allocate.
+    VoxelViewVector cells;
+  };
+
+  /// Point-cell pairs of a chunk which are gathered before evaluating their terms, so that the
+  /// exponentials and the derivatives are computed in tight loops over contiguous arrays.
+  struct CellMatches
+  {
+    std::size_t size{0U};
+    std::array<std::size_t, MATCH_BATCH_SIZE> point_idx;
+    std::array<Point, MATCH_BATCH_SIZE> pt_trans_norm;
+    std::array<Eigen::Matrix3d, MATCH_BATCH_SIZE> inv_cov;
+    std::array<Real, MATCH_BATCH_SIZE> exponent;
+  };
+
+  /// Compute the partial sums of the score, jacobian and hessian over a chunk of the scan.
+  /// Different chunks can be evaluated concurrently.
+  /// \param chunk_idx Index of the chunk.
+  /// \param transform Transform of the current pose.
+  /// \param grad_params Gradient angle parameters, or nullptr if neither jacobian nor hessian
+  /// are computed.
+  /// \param hessian_params Hessian angle parameters, or nullptr if the hessian is not computed.
+  /// \param mode Compute mode.
+  void evaluate_chunk(
+    std::size_t chunk_idx,
+    const Transform & transform,
+    const GradientAngleParameters * grad_params,
+    const HessianAngleParameters * hessian_params,
+    const ComputeMode & mode)
+  {
+    auto & chunk = m_chunks[chunk_idx];
+    chunk.score = 0.0;
+    chunk.jacobian.setZero();
+    chunk.hessian.setZero();
+
+    const auto first = chunk_idx * CHUNK_SIZE;
+    const auto last = std::min(first + CHUNK_SIZE, m_scan_ref.size());
+    const auto scan_begin = m_scan_ref.begin();
+    CellMatches matches;
+    for (auto point_idx = first; point_idx < last; ++point_idx) {
+      const Point pt_trans = transform * (*(scan_begin + static_cast<std::ptrdiff_t>(point_idx)));
+      m_map_ref.cell(pt_trans, chunk.cells);
+      // Cell iteration used for compatibility with maps with multi-cell lookup
+      for (const auto & cell : chunk.cells) {
+        if (!cell.usable()) {
+          continue;
+        }
+        const auto match_idx = matches.size;
+        matches.point_idx[match_idx] = point_idx;
+        matches.pt_trans_norm[match_idx] = pt_trans - cell.centroid();
+        matches.inv_cov[match_idx] = cell.inverse_covariance();
+        ++matches.size;
+        if (matches.size == MATCH_BATCH_SIZE) {
+          accumulate_matches(matches, grad_params, hessian_params, mode, chunk);
+        }
+      }
+    }
+    accumulate_matches(matches, grad_params, hessian_params, mode, chunk);
+  }
+
+  /// Add the terms of the gathered point-cell pairs to the partial sums of a chunk and reset
+  /// the matches.
+  /// \param matches Point-cell pairs.
+  /// \param grad_params Gradient angle parameters, or nullptr if neither jacobian nor hessian
+  /// are computed.
+  /// \param hessian_params Hessian angle parameters, or nullptr if the hessian is not computed.
+  /// \param mode Compute mode.
+  /// \param chunk Partial sums to update.
+  void accumulate_matches(
+    CellMatches & matches,
+    const GradientAngleParameters * grad_params,
+    const HessianAngleParameters * hessian_params,
+    const ComputeMode & mode,
+    ChunkSum & chunk)
+  {
+    // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
+    for (auto idx = 0U; idx < matches.size; ++idx) {
+      matches.exponent[idx] = matches.pt_trans_norm[idx].dot(
+        matches.inv_cov[idx] * matches.pt_trans_norm[idx]);
+    }
+    for (auto idx = 0U; idx < matches.size; ++idx) {
+      matches.exponent[idx] = std::exp(-m_gauss_d2 * matches.exponent[idx] / 2.0);
+    }
+    if (mode.score()) {
+      for (auto idx = 0U; idx < matches.size; ++idx) {
+        chunk.score += -m_gauss_d1 * matches.exponent[idx];
+      }
+    }
+
+    if (mode.jacobian() || mode.hessian()) {
+      const auto scan_begin = m_scan_ref.begin();
+      PointGrad point_gradient;
+      PointHessian point_hessian;
+      point_gradient.setZero();
+      point_gradient.block<3, 3>(0, 0).setIdentity();
+      point_hessian.setZero();
+      for (auto idx = 0U; idx < matches.size; ++idx) {
+        const auto d2_e_minus_half_d2_x_cov_x = m_gauss_d2 * matches.exponent[idx];
+        // Error checking for invalid values.
+        if (!is_valid_probability(d2_e_minus_half_d2_x_cov_x)) {
+          continue;
+        }
+        // Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
+        const auto d1_d2_e_minus_half_d2_x_cov_x = m_gauss_d1 * d2_e_minus_half_d2_x_cov_x;
+
+        const auto & pt = *(scan_begin + static_cast<std::ptrdiff_t>(matches.point_idx[idx]));
+        const auto & pt_trans_norm = matches.pt_trans_norm[idx];
+        const auto & inv_cov = matches.inv_cov[idx];
+        compute_point_gradients(*grad_params, pt, point_gradient);
+        // Sigma_k^-1 * dx/dp_i for all i, shared by Equation 6.12 and 6.13 [Magnusson 2009]
+        const PointGrad cov_dxd_p = inv_cov * point_gradient;
+        const Eigen::Matrix<float64_t, 6, 1> x_cov_dxd_p = cov_dxd_p.transpose() * pt_trans_norm;
+        if (mode.jacobian()) {
+          chunk.jacobian += d1_d2_e_minus_half_d2_x_cov_x * x_cov_dxd_p;
+        }
+        if (mode.hessian()) {
+          compute_point_hessians(*hessian_params, pt, point_hessian);
+          const Point cov_x = inv_cov * pt_trans_norm;
+          const Hessian dxd_p_cov_dxd_p = point_gradient.transpose() * cov_dxd_p;
+          for (auto i = 0U; i < chunk.hessian.rows(); ++i) {
+            for (auto j = 0U; j < chunk.hessian.cols(); ++j) {
+              chunk.hessian(i, j) += d1_d2_e_minus_half_d2_x_cov_x *
+                (-m_gauss_d2 * x_cov_dxd_p(i) * x_cov_dxd_p(j) +
+                cov_x.dot(point_hessian.block<3, 1>(3 * i, j)) +
+                dxd_p_cov_dxd_p(j, i));
+            }
+          }
+        }
+      }
+    }
+    matches.size = 0U;
+  }
+
   /// Initializes the guassian fitting parameters (eq. 6.8) [Magnusson 2009]
   /// \param outlier_ratio Outlier ratio to be used in the gaussian distribution variation
   /// used in (eq. 6.7) [Magnusson 2009]
@@ -460,11 +579,18 @@ public:
   // references as class members to be initialized at constructor.
   const Scan & m_scan_ref;
   const Map & m_map_ref;
+  ThreadPool * m_thread_pool;
+  std::vector<ChunkSum, Eigen::aligned_allocator<ChunkSum>> m_chunks;
   // States:
   Real m_gauss_d1{0.0};
   Real m_gauss_d2{0.0};
 };
 
+template<typename MapT, Requires RequiresT>
+constexpr std::size_t P2DNDTObjective<MapT, RequiresT>::CHUNK_SIZE;
+template<typename MapT, Requires RequiresT>
+constexpr std::size_t P2DNDTObjective<MapT, RequiresT>::MATCH_BATCH_SIZE;
+
 template<typename MapT>
 using P2DNDTOptimizationProblem =
   common::optimization::UnconstrainedOptimizationProblem<P2DNDTObjective<MapT>, EigenPose<Real>,
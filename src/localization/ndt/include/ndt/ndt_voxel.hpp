@@ -65,6 +65,10 @@ public:
   /// \return True if stabilization succeeds and covariance is invertible
   bool8_t try_stabilize();
 
+  /// Check if the covariance was stabilized after the last observation was added.
+  /// \return True if `try_stabilize()` was called after the last `add_observation(...)`
+  bool8_t stabilized() const noexcept;
+
   /// Check if the cell contains enough points to be used in ndt matching
   /// \return True if cell has more points than NUM_POINT_THRESHOLD
   bool8_t usable() const noexcept;
@@ -19,7 +19,10 @@
 #include <sensor_msgs/point_cloud2_iterator.hpp>
 #include <point_cloud_msg_wrapper/point_cloud_msg_wrapper.hpp>
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace autoware
 {
@@ -27,8 +30,95 @@ namespace localization
 {
 namespace ndt
 {
-DynamicNDTMap::DynamicNDTMap(const Config & voxel_grid_config)
-: m_grid{voxel_grid_config} {}
+namespace
+{
+/// Reconstruct the voxel grid configuration stored in the first points of a serialized map.
+/// \param msg_view View of the serialized map.
+/// \return Voxel grid configuration of the serialized map.
+/// \throws std::runtime_error if the message does not contain the configuration.
+StaticNDTMap::Config config_from_serialized_map(const NdtMapCloudView & msg_view)
+{
+  using PointXYZ = geometry_msgs::msg::Point32;
+  if (msg_view.size() < DynamicNDTMap::kNumConfigPoints) {
+    throw std::runtime_error("StaticNDTMap: Point cloud representing the ndt map is empty.");
+  }
+
+  const auto map_size = msg_view.size() - DynamicNDTMap::kNumConfigPoints;
+  const auto & min_point = msg_view[0U];
+  const auto & max_point = msg_view[1U];
+  const auto & voxel_size = msg_view[2U];
+
+  return StaticNDTMap::Config{
+    PointXYZ{}.set__x(static_cast<float>(min_point.x)).set__y(static_cast<float>(min_point.y)).
+    set__z(static_cast<float>(min_point.z)),
+    PointXYZ{}.set__x(static_cast<float>(max_point.x)).set__y(static_cast<float>(max_point.y)).
+    set__z(static_cast<float>(max_point.z)),
+    PointXYZ{}.set__x(static_cast<float>(voxel_size.x)).set__y(static_cast<float>(voxel_size.y)).
+    set__z(static_cast<float>(voxel_size.z)),
+    map_size};
+}
+
+/// Construct a voxel from a point of a serialized map.
+/// \param voxel_point Serialized voxel.
+/// \return Voxel with the serialized centroid and inverse covariance.
+StaticNDTVoxel voxel_from_serialized_point(const PointWithCovariances & voxel_point)
+{
+  const StaticNDTVoxel::Point centroid{voxel_point.x, voxel_point.y, voxel_point.z};
+  StaticNDTVoxel::Cov inv_covariance;
+  inv_covariance <<
+    voxel_point.icov_xx, voxel_point.icov_xy, voxel_point.icov_xz,
+    voxel_point.icov_xy, voxel_point.icov_yy, voxel_point.icov_yz,
+    voxel_point.icov_xz, voxel_point.icov_yz, voxel_point.icov_zz;
+  return StaticNDTVoxel{centroid, inv_covariance};
+}
+
+/// Number of voxels stabilized by a single task of the thread pool.
+constexpr std::size_t STABILIZATION_CHUNK_SIZE{256U};
+}  // namespace
+
+DynamicNDTMap::DynamicNDTMap(
+  const Config & voxel_grid_config,
+  bool8_t defer_stabilization,
+  uint64_t max_voxel_points)
+: m_grid{voxel_grid_config},
+  m_defer_stabilization{defer_stabilization},
+  m_max_voxel_points{max_voxel_points}
+{
+  if (m_max_voxel_points < Voxel::NUM_POINT_THRESHOLD) {
+    throw std::domain_error(
+            "DynamicNDTMap: A voxel needs to be able to hold at least " +
+            std::to_string(Voxel::NUM_POINT_THRESHOLD) + " points.");
+  }
+}
+
+DynamicNDTMap::DynamicNDTMap(DynamicNDTMap && other)
+: m_grid{std::move(other.m_grid)},
+  m_defer_stabilization{other.m_defer_stabilization},
+  m_max_voxel_points{other.m_max_voxel_points},
+  m_unstable_voxels{std::move(other.m_unstable_voxels)},
+  m_has_unstable_voxels{other.m_has_unstable_voxels.load()},
+  m_stamp{other.m_stamp},
+  m_frame_id{std::move(other.m_frame_id)}
+{
+  other.m_unstable_voxels.clear();
+  other.m_has_unstable_voxels = false;
+}
+
+DynamicNDTMap & DynamicNDTMap::operator=(DynamicNDTMap && other)
+{
+  if (this != &other) {
+    m_grid = std::move(other.m_grid);
+    m_defer_stabilization = other.m_defer_stabilization;
+    m_max_voxel_points = other.m_max_voxel_points;
+    m_unstable_voxels = std::move(other.m_unstable_voxels);
+    m_has_unstable_voxels = other.m_has_unstable_voxels.load();
+    m_stamp = other.m_stamp;
+    m_frame_id = std::move(other.m_frame_id);
+    other.m_unstable_voxels.clear();
+    other.m_has_unstable_voxels = false;
+  }
+  return *this;
+}
 
 const std::string & DynamicNDTMap::frame_id() const noexcept
 {
@@ -52,7 +142,7 @@ const DynamicNDTMap::ConfigPoint & DynamicNDTMap::cell_size() const noexcept
 
 void DynamicNDTMap::set(const sensor_msgs::msg::PointCloud2 & msg)
 {
-  m_grid.clear();
+  clear();
   insert(msg);
 }
 
@@ -61,19 +151,84 @@ void DynamicNDTMap::insert(const sensor_msgs::msg::PointCloud2 & msg)
   using PointXYZI = autoware::common::types::PointXYZI;
   point_cloud_msg_wrapper::PointCloud2View<PointXYZI> msg_view{msg};
 
-  for (const auto & point : msg_view) {
-    m_grid.add_observation({point.x, point.y, point.z});
-  }
+  {
+    std::lock_guard<std::mutex> lock{m_stabilize_mutex};
+    for (const auto & point : msg_view) {
+      const Point pt{point.x, point.y, point.z};
+      const auto voxel_idx = m_grid.index(pt);
+      auto & vx = m_grid.voxel(voxel_idx);
+      if (vx.count() >= m_max_voxel_points) {
+        // Saturated voxel
+        continue;
+      }
+      // A voxel that is not stabilized and not empty is already listed.
+      if ((vx.count() == 0U) || vx.stabilized()) {
+        m_unstable_voxels.push_back(voxel_idx);
+      }
+      vx.add_observation(pt);
+    }
+    m_has_unstable_voxels = !m_unstable_voxels.empty();
 
-  // try to stabilizie the covariance after inserting all the points
-  for (auto & vx_it : m_grid) {
-    auto & vx = vx_it.second;
-    (void) vx.try_stabilize();
+    // try to stabilizie the covariance after inserting all the points
+    if (!m_defer_stabilization) {
+      stabilize_locked(nullptr);
+    }
   }
   m_stamp = ::time_utils::from_message(msg.header.stamp);
   m_frame_id = msg.header.frame_id;
 }
 
+void DynamicNDTMap::stabilize(ThreadPool * thread_pool)
+{
+  std::lock_guard<std::mutex> lock{m_stabilize_mutex};
+  stabilize_locked(thread_pool);
+}
+
+std::size_t DynamicNDTMap::num_unstable() const noexcept
+{
+  return m_unstable_voxels.size();
+}
+
+void DynamicNDTMap::stabilize_pending() const
+{
+  if (!m_has_unstable_voxels.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock{m_stabilize_mutex};
+  // Stabilization only completes the voxels' state from the points already inserted, so it is
+  // done on demand even through a const map.
+  const_cast<DynamicNDTMap *>(this)->stabilize_locked(nullptr);
+}
+
+void DynamicNDTMap::stabilize_locked(ThreadPool * thread_pool)
+{
+  if (m_unstable_voxels.empty()) {
+    return;
+  }
+  // Every voxel is listed once, so the tasks work on distinct voxels and only read the grid.
+  const auto stabilize_chunk = [this](std::size_t chunk_idx) {
+      const auto first = chunk_idx * STABILIZATION_CHUNK_SIZE;
+      const auto last = std::min(first + STABILIZATION_CHUNK_SIZE, m_unstable_voxels.size());
+      for (auto idx = first; idx < last; ++idx) {
+        const auto vx_it = m_grid.find(m_unstable_voxels[idx]);
+        if (vx_it != m_grid.end()) {
+          (void) vx_it->second.try_stabilize();
+        }
+      }
+    };
+  const auto num_chunks =
+    (m_unstable_voxels.size() + STABILIZATION_CHUNK_SIZE - 1U) / STABILIZATION_CHUNK_SIZE;
+  if (thread_pool != nullptr) {
+    thread_pool->run(num_chunks, stabilize_chunk);
+  } else {
+    for (std::size_t chunk_idx = 0U; chunk_idx < num_chunks; ++chunk_idx) {
+      stabilize_chunk(chunk_idx);
+    }
+  }
+  m_unstable_voxels.clear();
+  m_has_unstable_voxels.store(false, std::memory_order_release);
+}
+
 /// The resulting point cloud has the following fields: x, y, z, cov_xx, cov_xy, cov_xz, cov_yy,
 /// cov_yz, cov_zz, cell_id.
 /// \param msg_out Reference to the pointcloud message that will store
@@ -81,6 +236,7 @@ void DynamicNDTMap::insert(const sensor_msgs::msg::PointCloud2 & msg)
 template<>
 void DynamicNDTMap::serialize_as<StaticNDTMap>(sensor_msgs::msg::PointCloud2 & msg_out) const
 {
+  stabilize_pending();
   ndt::NdtMapCloudModifier msg_modifier{msg_out, frame_id()};
 
   msg_out.header.stamp = time_utils::to_message(m_stamp);
@@ -131,9 +287,16 @@ void DynamicNDTMap::serialize_as<StaticNDTMap>(sensor_msgs::msg::PointCloud2 & m
 
 const DynamicNDTMap::VoxelViewVector & DynamicNDTMap::cell(const Point & pt) const
 {
+  stabilize_pending();
   return m_grid.cell(pt);
 }
 
+void DynamicNDTMap::cell(const Point & pt, VoxelViewVector & cells_out) const
+{
+  stabilize_pending();
+  m_grid.cell(pt, cells_out);
+}
+
 const DynamicNDTMap::VoxelViewVector & DynamicNDTMap::cell(float32_t x, float32_t y, float32_t z)
 const
 {
@@ -145,8 +308,9 @@ std::size_t DynamicNDTMap::size() const noexcept
   return m_grid.size();
 }
 
-typename DynamicNDTMap::VoxelGrid::const_iterator DynamicNDTMap::begin() const noexcept
+typename DynamicNDTMap::VoxelGrid::const_iterator DynamicNDTMap::begin() const
 {
+  stabilize_pending();
   return m_grid.cbegin();
 }
 
@@ -158,6 +322,8 @@ typename DynamicNDTMap::VoxelGrid::const_iterator DynamicNDTMap::end() const noe
 void DynamicNDTMap::clear() noexcept
 {
   m_grid.clear();
+  m_unstable_voxels.clear();
+  m_has_unstable_voxels = false;
 }
 
 const std::string & StaticNDTMap::frame_id() const noexcept
@@ -195,26 +361,8 @@ void StaticNDTMap::set(const sensor_msgs::msg::PointCloud2 & msg)
 
 void StaticNDTMap::deserialize_from(const sensor_msgs::msg::PointCloud2 & msg)
 {
-  using PointXYZ = geometry_msgs::msg::Point32;
-  constexpr auto num_config_fields = 3U;
   NdtMapCloudView msg_view{msg};
-  if (msg_view.size() < num_config_fields) {
-    throw std::runtime_error("StaticNDTMap: Point cloud representing the ndt map is empty.");
-  }
-
-  const auto map_size = msg_view.size() - num_config_fields;
-  const auto & min_point = msg_view[0U];
-  const auto & max_point = msg_view[1U];
-  const auto & voxel_size = msg_view[2U];
-
-  const Config config{
-    PointXYZ{}.set__x(static_cast<float>(min_point.x)).set__y(static_cast<float>(min_point.y)).
-    set__z(static_cast<float>(min_point.z)),
-    PointXYZ{}.set__x(static_cast<float>(max_point.x)).set__y(static_cast<float>(max_point.y)).
-    set__z(static_cast<float>(max_point.z)),
-    PointXYZ{}.set__x(static_cast<float>(voxel_size.x)).set__y(static_cast<float>(voxel_size.y)).
-    set__z(static_cast<float>(voxel_size.z)),
-    map_size};
+  const auto config = config_from_serialized_map(msg_view);
 
   // Either update the map config or initialize the map.
   if (m_grid) {
@@ -223,19 +371,13 @@ void StaticNDTMap::deserialize_from(const sensor_msgs::msg::PointCloud2 & msg)
     m_grid.emplace(config);
   }
 
-  for (auto it = std::next(msg_view.begin(), num_config_fields); it != msg_view.end(); ++it) {
-    const auto & voxel_point = *it;
-    const Point centroid{voxel_point.x, voxel_point.y, voxel_point.z};
-    const auto voxel_idx = m_grid->index(centroid);
-
-    Eigen::Matrix3d inv_covariance;
-    inv_covariance <<
-      voxel_point.icov_xx, voxel_point.icov_xy, voxel_point.icov_xz,
-      voxel_point.icov_xy, voxel_point.icov_yy, voxel_point.icov_yz,
-      voxel_point.icov_xz, voxel_point.icov_yz, voxel_point.icov_zz;
-    const Voxel vx{centroid, inv_covariance};
+  for (auto it = std::next(msg_view.begin(), DynamicNDTMap::kNumConfigPoints);
+    it != msg_view.end(); ++it)
+  {
+    const Voxel vx = voxel_from_serialized_point(*it);
+    const auto voxel_idx = m_grid->index(vx.centroid());
 
-    const auto insert_res = m_grid->emplace_voxel(voxel_idx, Voxel{centroid, inv_covariance});
+    const auto insert_res = m_grid->emplace_voxel(voxel_idx, vx);
     if (!insert_res.second) {
       // if a voxel already exist at this point, replace.
       insert_res.first->second = vx;
@@ -250,6 +392,14 @@ const StaticNDTMap::VoxelViewVector & StaticNDTMap::cell(const Point & pt) const
   return m_grid->cell(pt);
 }
 
+void StaticNDTMap::cell(const Point & pt, VoxelViewVector & cells_out) const
+{
+  if (!m_grid) {
+    throw std::runtime_error("Static ndt map was attempted to be used before a map was set.");
+  }
+  m_grid->cell(pt, cells_out);
+}
+
 const StaticNDTMap::VoxelViewVector & StaticNDTMap::cell(float32_t x, float32_t y, float32_t z)
 const
 {
@@ -287,6 +437,174 @@ void StaticNDTMap::clear()
   }
   m_grid->clear();
 }
+
+constexpr uint64_t CompactStaticNDTMap::EMPTY_KEY;
+
+CompactStaticNDTMap::CompactStaticNDTMap()
+{
+  m_output_vector.reserve(1U);
+}
+
+const std::string & CompactStaticNDTMap::frame_id() const noexcept
+{
+  return m_frame_id;
+}
+
+CompactStaticNDTMap::TimePoint CompactStaticNDTMap::stamp() const noexcept
+{
+  return m_stamp;
+}
+
+bool CompactStaticNDTMap::valid() const noexcept
+{
+  return m_config && (!m_voxels.empty()) && (!m_frame_id.empty());
+}
+
+const CompactStaticNDTMap::ConfigPoint & CompactStaticNDTMap::cell_size() const
+{
+  if (!m_config) {
+    throw std::runtime_error("Static ndt map was attempted to be used before a map was set.");
+  }
+  return m_config->get_voxel_size();
+}
+
+void CompactStaticNDTMap::set(const sensor_msgs::msg::PointCloud2 & msg)
+{
+  NdtMapCloudView msg_view{msg};
+  const auto config = config_from_serialized_map(msg_view);
+  const auto map_size = msg_view.size() - DynamicNDTMap::kNumConfigPoints;
+
+  reset(config, map_size, ::time_utils::from_message(msg.header.stamp), msg.header.frame_id);
+  for (auto it = std::next(msg_view.begin(), DynamicNDTMap::kNumConfigPoints);
+    it != msg_view.end(); ++it)
+  {
+    insert(*it);
+  }
+}
+
+void CompactStaticNDTMap::reset(
+  const Config & config, std::size_t capacity, TimePoint stamp,
+  const std::string & frame_id)
+{
+  clear();
+  if (m_config) {
+    *m_config = config;
+  } else {
+    m_config.emplace(config);
+  }
+
+  // Keep the load factor at or below 0.5 so that almost all lookups hit their home bucket.
+  std::size_t table_size = 2U;
+  m_hash_shift = 63U;
+  while (table_size < (2U * capacity)) {
+    table_size *= 2U;
+    --m_hash_shift;
+  }
+  m_table.assign(table_size, Bucket{EMPTY_KEY, 0U});
+  m_voxels.reserve(capacity);
+  m_capacity = capacity;
+  m_stamp = stamp;
+  m_frame_id = frame_id;
+}
+
+void CompactStaticNDTMap::insert(const PointWithCovariances & voxel_point)
+{
+  if (!m_config) {
+    throw std::runtime_error("Static ndt map was attempted to be used before a map was set.");
+  }
+  const Voxel vx = voxel_from_serialized_point(voxel_point);
+  if (vx.usable()) {
+    const auto key = m_config->index(vx.centroid());
+    // A full table would make probing for missing keys loop forever.
+    if ((m_voxels.size() >= m_capacity) && (find(key) == nullptr)) {
+      throw std::length_error("CompactStaticNDTMap: Capacity exceeded.");
+    }
+    insert(key, vx);
+  }
+}
+
+std::size_t CompactStaticNDTMap::home_bucket(uint64_t key) const noexcept
+{
+  // Fibonacci hashing: spreads the consecutive indices of neighbouring voxels over the table.
+  return static_cast<std::size_t>((key * 11400714819323198485ULL) >> m_hash_shift);
+}
+
+const CompactStaticNDTMap::Voxel * CompactStaticNDTMap::find(uint64_t key) const noexcept
+{
+  const std::size_t mask = m_table.size() - 1U;
+  for (auto idx = home_bucket(key); m_table[idx].key != EMPTY_KEY; idx = (idx + 1U) & mask) {
+    if (m_table[idx].key == key) {
+      return &m_voxels[m_table[idx].slot].second;
+    }
+  }
+  return nullptr;
+}
+
+void CompactStaticNDTMap::insert(uint64_t key, const Voxel & voxel)
+{
+  const std::size_t mask = m_table.size() - 1U;
+  auto idx = home_bucket(key);
+  for (; m_table[idx].key != EMPTY_KEY; idx = (idx + 1U) & mask) {
+    if (m_table[idx].key == key) {
+      // if a voxel already exist at this point, replace.
+      m_voxels[m_table[idx].slot].second = voxel;
+      return;
+    }
+  }
+  m_table[idx] = Bucket{key, m_voxels.size()};
+  m_voxels.emplace_back(key, voxel);
+}
+
+const CompactStaticNDTMap::VoxelViewVector & CompactStaticNDTMap::cell(const Point & pt) const
+{
+  cell(pt, m_output_vector);
+  return m_output_vector;
+}
+
+void CompactStaticNDTMap::cell(const Point & pt, VoxelViewVector & cells_out) const
+{
+  if (!m_config) {
+    throw std::runtime_error("Static ndt map was attempted to be used before a map was set.");
+  }
+  cells_out.clear();
+  if (!m_table.empty()) {
+    const auto * const vx = find(m_config->index(pt));
+    if (vx != nullptr) {
+      cells_out.emplace_back(*vx);
+    }
+  }
+}
+
+const CompactStaticNDTMap::VoxelViewVector & CompactStaticNDTMap::cell(
+  float32_t x, float32_t y, float32_t z) const
+{
+  return cell(Point({x, y, z}));
+}
+
+std::size_t CompactStaticNDTMap::size() const noexcept
+{
+  return m_voxels.size();
+}
+
+typename CompactStaticNDTMap::VoxelVector::const_iterator CompactStaticNDTMap::begin()
+const noexcept
+{
+  return m_voxels.cbegin();
+}
+
+typename CompactStaticNDTMap::VoxelVector::const_iterator CompactStaticNDTMap::end()
+const noexcept
+{
+  return m_voxels.cend();
+}
+
+void CompactStaticNDTMap::clear() noexcept
+{
+  m_voxels.clear();
+  m_table.clear();
+  m_capacity = 0U;
+  m_output_vector.clear();
+}
 }  // namespace ndt
 }  // namespace localization
 }  // namespace autoware
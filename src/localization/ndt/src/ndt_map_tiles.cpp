@@ -0,0 +1,537 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <ndt/ndt_map_tiles.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace autoware
+{
+namespace localization
+{
+namespace ndt
+{
+namespace
+{
+constexpr char kTilesMagic[8U] = {'N', 'D', 'T', 'T', 'I', 'L', 'E', 'S'};
+constexpr uint32_t kTilesVersion = 1U;
+constexpr std::size_t kMaxFrameIdLength = 63U;
+
+/// Header at the start of a tiled ndt map file.
+struct NDTMapTilesHeader
+{
+  char magic[8U];
+  uint32_t version;
+  uint32_t num_tiles;
+  float64_t tile_size;
+  int64_t stamp_ns;
+  uint64_t num_voxels;
+  float64_t min_point[3U];
+  float64_t max_point[3U];
+  float64_t voxel_size[3U];
+  char frame_id[kMaxFrameIdLength + 1U];
+};
+
+// The sections are read in place from the mapped file, so every section has to start at an
+// offset that is suitably aligned for the following one.
+static_assert(sizeof(NDTMapTilesHeader) % alignof(NDTMapTileIndexEntry) == 0U, "Bad alignment");
+static_assert(sizeof(NDTMapTileIndexEntry) % alignof(PointWithCovariances) == 0U, "Bad alignment");
+static_assert(sizeof(NDTMapTilesHeader) % alignof(PointWithCovariances) == 0U, "Bad alignment");
+static_assert(sizeof(PointWithCovariances) == 9U * sizeof(float64_t), "Unexpected padding");
+
+/// Get the tile coordinate of a position along the x or y axis.
+/// \param position Position in meters.
+/// \param tile_size Edge length of a tile.
+/// \return Tile coordinate, saturated to the range of the coordinate type.
+int32_t to_tile_coordinate(float64_t position, float64_t tile_size) noexcept
+{
+  const auto coordinate = std::floor(position / tile_size);
+  if (!(coordinate > static_cast<float64_t>(std::numeric_limits<int32_t>::min()))) {
+    return std::numeric_limits<int32_t>::min();
+  }
+  if (coordinate >= static_cast<float64_t>(std::numeric_limits<int32_t>::max())) {
+    return std::numeric_limits<int32_t>::max();
+  }
+  return static_cast<int32_t>(coordinate);
+}
+
+bool tile_less(const NDTMapTileIndexEntry & tile, const std::pair<int32_t, int32_t> & coordinates)
+{
+  return std::make_pair(tile.x, tile.y) < coordinates;
+}
+}  // namespace
+
+void write_ndt_map_tiles(
+  const sensor_msgs::msg::PointCloud2 & serialized_map,
+  float64_t tile_size,
+  const std::string & file_name)
+{
+  if (!(tile_size > 0.0)) {
+    throw std::domain_error("write_ndt_map_tiles: Tile size must be positive.");
+  }
+  if (serialized_map.header.frame_id.size() > kMaxFrameIdLength) {
+    throw std::domain_error("write_ndt_map_tiles: Frame id is too long.");
+  }
+  NdtMapCloudView msg_view{serialized_map};
+  if (msg_view.size() < DynamicNDTMap::kNumConfigPoints) {
+    throw std::runtime_error("write_ndt_map_tiles: Point cloud representing the ndt map is empty.");
+  }
+
+  NDTMapTilesHeader header{};
+  std::copy(std::begin(kTilesMagic), std::end(kTilesMagic), std::begin(header.magic));
+  header.version = kTilesVersion;
+  header.tile_size = tile_size;
+  header.stamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    ::time_utils::from_message(serialized_map.header.stamp).time_since_epoch()).count();
+  header.num_voxels = msg_view.size() - DynamicNDTMap::kNumConfigPoints;
+  const auto copy_point = [](const PointWithCovariances & pt, float64_t (& out)[3U]) {
+      out[0U] = pt.x;
+      out[1U] = pt.y;
+      out[2U] = pt.z;
+    };
+  copy_point(msg_view[0U], header.min_point);
+  copy_point(msg_view[1U], header.max_point);
+  copy_point(msg_view[2U], header.voxel_size);
+  std::copy(
+    serialized_map.header.frame_id.begin(), serialized_map.header.frame_id.end(),
+    std::begin(header.frame_id));
+
+  // Group the voxels by tile, keeping the serialized order within each tile.
+  using TiledVoxel = std::pair<std::pair<int32_t, int32_t>, std::size_t>;
+  std::vector<TiledVoxel> tiled_voxels;
+  tiled_voxels.reserve(header.num_voxels);
+  for (std::size_t idx = DynamicNDTMap::kNumConfigPoints; idx < msg_view.size(); ++idx) {
+    const auto & voxel_point = msg_view[idx];
+    tiled_voxels.emplace_back(
+      std::make_pair(
+        to_tile_coordinate(voxel_point.x, tile_size),
+        to_tile_coordinate(voxel_point.y, tile_size)), idx);
+  }
+  std::stable_sort(
+    tiled_voxels.begin(), tiled_voxels.end(),
+    [](const TiledVoxel & lhs, const TiledVoxel & rhs) {return lhs.first < rhs.first;});
+
+  std::vector<NDTMapTileIndexEntry> tiles;
+  for (std::size_t idx = 0U; idx < tiled_voxels.size(); ++idx) {
+    const auto & coordinates = tiled_voxels[idx].first;
+    if (tiles.empty() || (std::make_pair(tiles.back().x, tiles.back().y) != coordinates)) {
+      tiles.push_back(NDTMapTileIndexEntry{coordinates.first, coordinates.second, idx, 0U});
+    }
+    ++tiles.back().num_voxels;
+  }
+  header.num_tiles = static_cast<uint32_t>(tiles.size());
+
+  std::ofstream file{file_name, std::ios::binary | std::ios::trunc};
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(
+    reinterpret_cast<const char *>(tiles.data()),
+    static_cast<std::streamsize>(tiles.size() * sizeof(NDTMapTileIndexEntry)));
+  for (const auto & tiled_voxel : tiled_voxels) {
+    const PointWithCovariances voxel_point = msg_view[tiled_voxel.second];
+    file.write(reinterpret_cast<const char *>(&voxel_point), sizeof(voxel_point));
+  }
+  file.close();
+  if (!file) {
+    throw std::runtime_error("write_ndt_map_tiles: Could not write " + file_name);
+  }
+}
+
+NDTMapTileFile::NDTMapTileFile(const std::string & file_name)
+{
+  const int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("NDTMapTileFile: Could not open " + file_name);
+  }
+  struct stat file_stat {};
+  if (::fstat(fd, &file_stat) != 0) {
+    ::close(fd);
+    throw std::runtime_error("NDTMapTileFile: Could not stat " + file_name);
+  }
+  m_size = static_cast<std::size_t>(file_stat.st_size);
+  if (m_size < sizeof(NDTMapTilesHeader)) {
+    ::close(fd);
+    throw std::runtime_error("NDTMapTileFile: File is too small to be a tiled map.");
+  }
+  void * const data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the descriptor is closed.
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("NDTMapTileFile: Could not map " + file_name);
+  }
+  m_data = static_cast<const uint8_t *>(data);
+
+  NDTMapTilesHeader header;
+  std::memcpy(&header, m_data, sizeof(header));
+  const auto index_size = static_cast<std::size_t>(header.num_tiles) *
+    sizeof(NDTMapTileIndexEntry);
+  const bool8_t valid_header =
+    std::equal(std::begin(kTilesMagic), std::end(kTilesMagic), std::begin(header.magic)) &&
+    (header.version == kTilesVersion) && (header.tile_size > 0.0) &&
+    (header.frame_id[kMaxFrameIdLength] == '\0') &&
+    (header.num_voxels <= (std::numeric_limits<std::size_t>::max() -
+    sizeof(header) - index_size) / sizeof(PointWithCovariances)) &&
+    (m_size == (sizeof(header) + index_size +
+    (header.num_voxels * sizeof(PointWithCovariances))));
+  if (!valid_header) {
+    ::munmap(const_cast<uint8_t *>(m_data), m_size);
+    throw std::runtime_error("NDTMapTileFile: " + file_name + " is not a valid tiled map.");
+  }
+  m_tiles = reinterpret_cast<const NDTMapTileIndexEntry *>(m_data + sizeof(header));
+  m_num_tiles = header.num_tiles;
+  m_voxels = reinterpret_cast<const PointWithCovariances *>(m_data + sizeof(header) + index_size);
+  for (std::size_t idx = 0U; idx < m_num_tiles; ++idx) {
+    const auto & tile = m_tiles[idx];
+    const bool8_t sorted = (idx == 0U) || tile_less(m_tiles[idx - 1U], {tile.x, tile.y});
+    if (!sorted || (tile.first_voxel > header.num_voxels) ||
+      (tile.num_voxels > (header.num_voxels - tile.first_voxel)))
+    {
+      ::munmap(const_cast<uint8_t *>(m_data), m_size);
+      throw std::runtime_error("NDTMapTileFile: " + file_name + " has an invalid tile index.");
+    }
+  }
+  m_tile_size = header.tile_size;
+  std::copy(std::begin(header.min_point), std::end(header.min_point), std::begin(m_min_point));
+  std::copy(std::begin(header.max_point), std::end(header.max_point), std::begin(m_max_point));
+  std::copy(std::begin(header.voxel_size), std::end(header.voxel_size), std::begin(m_voxel_size));
+  m_stamp = TimePoint{std::chrono::duration_cast<TimePoint::duration>(
+      std::chrono::nanoseconds{header.stamp_ns})};
+  m_frame_id = header.frame_id;
+}
+
+NDTMapTileFile::~NDTMapTileFile()
+{
+  ::munmap(const_cast<uint8_t *>(m_data), m_size);
+}
+
+NDTMapTileFile::Config NDTMapTileFile::config(std::size_t capacity) const
+{
+  using PointXYZ = geometry_msgs::msg::Point32;
+  const auto to_point = [](const float64_t (& pt)[3U]) {
+      return PointXYZ{}.set__x(static_cast<float32_t>(pt[0U])).
+             set__y(static_cast<float32_t>(pt[1U])).set__z(static_cast<float32_t>(pt[2U]));
+    };
+  return Config{to_point(m_min_point), to_point(m_max_point), to_point(m_voxel_size), capacity};
+}
+
+float64_t NDTMapTileFile::tile_size() const noexcept
+{
+  return m_tile_size;
+}
+
+int32_t NDTMapTileFile::tile_coordinate(float64_t position) const noexcept
+{
+  return to_tile_coordinate(position, m_tile_size);
+}
+
+const std::string & NDTMapTileFile::frame_id() const noexcept
+{
+  return m_frame_id;
+}
+
+NDTMapTileFile::TimePoint NDTMapTileFile::stamp() const noexcept
+{
+  return m_stamp;
+}
+
+std::size_t NDTMapTileFile::num_tiles() const noexcept
+{
+  return m_num_tiles;
+}
+
+void NDTMapTileFile::find_tiles(
+  int32_t x_min, int32_t x_max, int32_t y_min, int32_t y_max,
+  std::vector<const NDTMapTileIndexEntry *> & tiles_out) const
+{
+  tiles_out.clear();
+  const auto * const last = m_tiles + m_num_tiles;
+  auto * tile = std::lower_bound(m_tiles, last, std::make_pair(x_min, y_min), tile_less);
+  while ((tile != last) && (tile->x <= x_max)) {
+    if (tile->y < y_min) {
+      // Skip to the first tile of this column inside the rectangle.
+      tile = std::lower_bound(tile, last, std::make_pair(tile->x, y_min), tile_less);
+    } else if (tile->y > y_max) {
+      // Skip the rest of this column.
+      if (tile->x == std::numeric_limits<int32_t>::max()) {
+        break;
+      }
+      tile = std::lower_bound(tile, last, std::make_pair(tile->x + 1, y_min), tile_less);
+    } else {
+      tiles_out.push_back(tile);
+      ++tile;
+    }
+  }
+}
+
+const PointWithCovariances * NDTMapTileFile::voxels(const NDTMapTileIndexEntry & tile) const
+noexcept
+{
+  return m_voxels + tile.first_voxel;
+}
+
+void NDTMapTileFile::will_need(const NDTMapTileIndexEntry & tile) const noexcept
+{
+  advise(tile, MADV_WILLNEED);
+}
+
+void NDTMapTileFile::dont_need(const NDTMapTileIndexEntry & tile) const noexcept
+{
+  advise(tile, MADV_DONTNEED);
+}
+
+void NDTMapTileFile::advise(const NDTMapTileIndexEntry & tile, int32_t advice) const noexcept
+{
+  if (tile.num_voxels == 0U) {
+    return;
+  }
+  // madvise works on whole pages. Only pages entirely inside the tile are released, so the
+  // neighbouring tiles sharing the boundary pages are unaffected.
+  const auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  auto first = static_cast<std::size_t>(reinterpret_cast<const uint8_t *>(voxels(tile)) - m_data);
+  auto last = first + (tile.num_voxels * sizeof(PointWithCovariances));
+  if (advice == MADV_DONTNEED) {
+    first = ((first + page_size - 1U) / page_size) * page_size;
+  } else {
+    first = (first / page_size) * page_size;
+    last = std::min(((last + page_size - 1U) / page_size) * page_size, m_size);
+  }
+  if (first < last) {
+    // The hint is best effort; a failure only affects memory usage.
+    (void) ::madvise(const_cast<uint8_t *>(m_data + first), last - first, advice);
+  }
+}
+
+PagedNDTMap::PagedNDTMap(const std::string & file_name, float64_t paging_radius)
+: m_file{file_name},
+  m_tile_radius{0},
+  m_cell_size{m_file.config(0U).get_voxel_size()}
+{
+  if (!(paging_radius >= 0.0)) {
+    throw std::domain_error("PagedNDTMap: Paging radius must not be negative.");
+  }
+  m_tile_radius = static_cast<int32_t>(
+    std::min(
+      std::ceil(paging_radius / m_file.tile_size()),
+      static_cast<float64_t>(std::numeric_limits<int32_t>::max())));
+  m_loader = std::thread{[this] {load_tiles();}};
+}
+
+PagedNDTMap::~PagedNDTMap()
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop = true;
+  }
+  m_loader_cv.notify_one();
+  m_loader.join();
+}
+
+void PagedNDTMap::set(const sensor_msgs::msg::PointCloud2 &)
+{
+  throw std::logic_error(
+          "PagedNDTMap: The map is paged in from a tiled map file and cannot be set from a "
+          "message.");
+}
+
+void PagedNDTMap::update(const Point & position)
+{
+  const TileCoordinates tile{
+    m_file.tile_coordinate(position(0U)), m_file.tile_coordinate(position(1U))};
+  bool8_t notify = false;
+  {
+    // The loader thread only holds the lock to exchange pointers, never while loading.
+    std::lock_guard<std::mutex> lock{m_mutex};
+    notify = static_cast<bool8_t>(m_ready);
+    swap_in_ready_snapshot();
+    if (!m_has_requested || (tile != m_requested)) {
+      m_requested = tile;
+      m_has_requested = true;
+      m_request = tile;
+      m_has_request = true;
+      notify = true;
+    }
+  }
+  if (notify) {
+    m_loader_cv.notify_one();
+  }
+}
+
+bool PagedNDTMap::wait_until_loaded(std::chrono::milliseconds timeout)
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+  const bool8_t loaded = m_loaded_cv.wait_for(
+    lock, timeout, [this] {
+      return m_has_requested &&
+      ((m_ready && (m_ready_tile == m_requested)) ||
+      (m_has_active_tile && (m_active_tile == m_requested)));
+    });
+  const bool8_t retire = static_cast<bool8_t>(m_ready);
+  swap_in_ready_snapshot();
+  lock.unlock();
+  if (retire) {
+    m_loader_cv.notify_one();
+  }
+  return loaded;
+}
+
+void PagedNDTMap::swap_in_ready_snapshot()
+{
+  if (m_ready) {
+    m_retired = std::move(m_active);
+    m_active = std::move(m_ready);
+    m_active_tile = m_ready_tile;
+    m_has_active_tile = true;
+  }
+}
+
+void PagedNDTMap::load_tiles()
+{
+  std::vector<const NDTMapTileIndexEntry *> resident_tiles;
+  std::unique_lock<std::mutex> lock{m_mutex};
+  while (true) {
+    m_loader_cv.wait(lock, [this] {return m_stop || m_has_request || m_retired;});
+    if (m_stop) {
+      return;
+    }
+    Snapshot retired{std::move(m_retired)};
+    const bool8_t has_request = m_has_request;
+    const TileCoordinates request = m_request;
+    m_has_request = false;
+    lock.unlock();
+    retired.reset();
+    Snapshot snapshot{};
+    if (has_request) {
+      try {
+        snapshot = build_snapshot(request, resident_tiles);
+      } catch (const std::exception &) {
+        // Keep the current tiles; the next request retries.
+      }
+    }
+    lock.lock();
+    if (snapshot) {
+      // An unconsumed older map is released outside the lock below.
+      retired = std::move(m_ready);
+      m_ready = std::move(snapshot);
+      m_ready_tile = request;
+      lock.unlock();
+      retired.reset();
+      m_loaded_cv.notify_all();
+      lock.lock();
+    }
+  }
+}
+
+PagedNDTMap::Snapshot PagedNDTMap::build_snapshot(
+  const TileCoordinates & center,
+  std::vector<const NDTMapTileIndexEntry *> & resident_tiles) const
+{
+  // Clamp the window to the coordinate range instead of overflowing.
+  const auto clamp_coordinate = [](int64_t coordinate) {
+      return static_cast<int32_t>(std::min(
+               std::max(coordinate, static_cast<int64_t>(std::numeric_limits<int32_t>::min())),
+               static_cast<int64_t>(std::numeric_limits<int32_t>::max())));
+    };
+  std::vector<const NDTMapTileIndexEntry *> tiles;
+  m_file.find_tiles(
+    clamp_coordinate(static_cast<int64_t>(center.first) - m_tile_radius),
+    clamp_coordinate(static_cast<int64_t>(center.first) + m_tile_radius),
+    clamp_coordinate(static_cast<int64_t>(center.second) - m_tile_radius),
+    clamp_coordinate(static_cast<int64_t>(center.second) + m_tile_radius),
+    tiles);
+  std::size_t num_voxels = 0U;
+  for (const auto * const tile : tiles) {
+    m_file.will_need(*tile);
+    num_voxels += tile->num_voxels;
+  }
+
+  auto snapshot = std::make_shared<CompactStaticNDTMap>();
+  snapshot->reset(m_file.config(num_voxels), num_voxels, m_file.stamp(), m_file.frame_id());
+  for (const auto * const tile : tiles) {
+    const auto * const voxels = m_file.voxels(*tile);
+    for (std::size_t idx = 0U; idx < tile->num_voxels; ++idx) {
+      snapshot->insert(voxels[idx]);
+    }
+  }
+
+  // Both vectors hold pointers into the sorted tile index, so they are sorted as well.
+  std::vector<const NDTMapTileIndexEntry *> paged_out;
+  std::set_difference(
+    resident_tiles.begin(), resident_tiles.end(), tiles.begin(), tiles.end(),
+    std::back_inserter(paged_out));
+  for (const auto * const tile : paged_out) {
+    m_file.dont_need(*tile);
+  }
+  resident_tiles = std::move(tiles);
+  return snapshot;
+}
+
+const PagedNDTMap::VoxelViewVector & PagedNDTMap::cell(const Point & pt) const
+{
+  return m_active ? m_active->cell(pt) : m_empty_cells;
+}
+
+void PagedNDTMap::cell(const Point & pt, VoxelViewVector & cells_out) const
+{
+  if (m_active) {
+    m_active->cell(pt, cells_out);
+  } else {
+    cells_out.clear();
+  }
+}
+
+const PagedNDTMap::VoxelViewVector & PagedNDTMap::cell(float32_t x, float32_t y, float32_t z)
+const
+{
+  return cell(Point({x, y, z}));
+}
+
+const std::string & PagedNDTMap::frame_id() const noexcept
+{
+  return m_file.frame_id();
+}
+
+PagedNDTMap::TimePoint PagedNDTMap::stamp() const noexcept
+{
+  return m_file.stamp();
+}
+
+bool PagedNDTMap::valid() const noexcept
+{
+  return m_active && m_active->valid();
+}
+
+const PagedNDTMap::ConfigPoint & PagedNDTMap::cell_size() const noexcept
+{
+  return m_cell_size;
+}
+
+std::size_t PagedNDTMap::size() const noexcept
+{
+  return m_active ? m_active->size() : 0U;
+}
+}  // namespace ndt
+}  // namespace localization
+}  // namespace autoware
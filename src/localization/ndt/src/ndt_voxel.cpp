@@ -72,6 +72,11 @@ bool8_t DynamicNDTVoxel::try_stabilize()
   return invertible;
 }
 
+bool8_t DynamicNDTVoxel::stabilized() const noexcept
+{
+  return m_invertible != Invertibility::UNKNOWN;
+}
+
 bool8_t DynamicNDTVoxel::usable() const noexcept
 {
   return m_num_points >= NUM_POINT_THRESHOLD;
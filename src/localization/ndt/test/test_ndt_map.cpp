@@ -15,9 +15,12 @@
 // Co-developed by Tier IV, Inc. and Apex.AI, Inc.
 
 #include <gtest/gtest.h>
+#include <ndt/ndt_map_tiles.hpp>
 #include <ndt/utils.hpp>
 #include <Eigen/LU>
 #include <point_cloud_msg_wrapper/point_cloud_msg_wrapper.hpp>
+#include <chrono>
+#include <cstdio>
 #include <vector>
 #include <limits>
 #include <string>
@@ -33,6 +36,11 @@ using autoware::localization::ndt::StaticNDTVoxel;
 using autoware::localization::ndt::Real;
 using autoware::localization::ndt::try_stabilize_covariance;
 using autoware::localization::ndt::StaticNDTMap;
+using autoware::localization::ndt::CompactStaticNDTMap;
+using autoware::localization::ndt::NDTMapTileFile;
+using autoware::localization::ndt::NDTMapTileIndexEntry;
+using autoware::localization::ndt::PagedNDTMap;
+using autoware::localization::ndt::write_ndt_map_tiles;
 using autoware::perception::filters::voxel_grid::Config;
 constexpr std::uint32_t DenseNDTMapContext::NUM_POINTS;
 
@@ -183,6 +191,199 @@ TEST_F(DenseNDTMapTest, MapLookup) {
   }
 }
 
+TEST_F(DenseNDTMapTest, DeferredStabilizationMatchesEager) {
+  auto grid_config = Config(m_min_point, m_max_point, m_voxel_size, m_capacity);
+  DynamicNDTMap eager_map(grid_config);
+  DynamicNDTMap deferred_map(grid_config, true);
+  build_pc(grid_config);
+
+  eager_map.insert(m_pc);
+  deferred_map.insert(m_pc);
+  EXPECT_EQ(eager_map.num_unstable(), 0U);
+  // Every voxel changed, but is listed only once.
+  EXPECT_EQ(deferred_map.num_unstable(), 125U);
+
+  // The first lookup stabilizes all changed voxels.
+  EXPECT_FALSE(deferred_map.cell(1.0F, 1.0F, 1.0F).empty());
+  EXPECT_EQ(deferred_map.num_unstable(), 0U);
+
+  // Insert again, this time stabilizing explicitly with worker threads.
+  eager_map.insert(m_pc);
+  deferred_map.insert(m_pc);
+  EXPECT_EQ(deferred_map.num_unstable(), 125U);
+  DynamicNDTMap::ThreadPool thread_pool{2U};
+  deferred_map.stabilize(&thread_pool);
+  EXPECT_EQ(deferred_map.num_unstable(), 0U);
+
+  for (const auto & voxel_it : eager_map) {
+    const auto & centroid = voxel_it.second.centroid();
+    const auto & expected_cells = eager_map.cell(centroid);
+    ASSERT_EQ(expected_cells.size(), 1U);
+    const auto expected_inverse = expected_cells[0U].inverse_covariance();
+    const auto & cells = deferred_map.cell(centroid);
+    ASSERT_EQ(cells.size(), 1U);
+    EXPECT_EQ(cells[0U].get().count(), 14U);
+    EXPECT_EQ(cells[0U].centroid(), centroid);
+    EXPECT_EQ(cells[0U].inverse_covariance(), expected_inverse);
+  }
+}
+
+TEST_F(DenseNDTMapTest, SaturatedVoxelsIgnoreObservations) {
+  auto grid_config = Config(m_min_point, m_max_point, m_voxel_size, m_capacity);
+  EXPECT_THROW(
+    DynamicNDTMap(grid_config, false, DynamicNDTVoxel::NUM_POINT_THRESHOLD - 1U),
+    std::domain_error);
+  // Each cell of the point cloud has 7 points
+  DynamicNDTMap ndt_map(grid_config, false, 10U);
+  build_pc(grid_config);
+
+  ndt_map.insert(m_pc);
+  ndt_map.insert(m_pc);
+  // Only the first 3 points of the second insertion are added before the voxels saturate
+  for (const auto & voxel_it : ndt_map) {
+    EXPECT_EQ(voxel_it.second.count(), 10U);
+  }
+
+  ndt_map.insert(m_pc);
+  EXPECT_EQ(ndt_map.num_unstable(), 0U);
+  for (const auto & voxel_it : ndt_map) {
+    EXPECT_EQ(voxel_it.second.count(), 10U);
+    EXPECT_TRUE(voxel_it.second.stabilized());
+  }
+}
+
+TEST_F(DenseNDTMapTest, CompactMapMatchesStaticMap) {
+  auto grid_config = Config(m_min_point, m_max_point, m_voxel_size, m_capacity);
+  DynamicNDTMap dynamic_map(grid_config);
+  build_pc(grid_config);
+  dynamic_map.insert(m_pc);
+
+  sensor_msgs::msg::PointCloud2 serialized_map;
+  dynamic_map.serialize_as<StaticNDTMap>(serialized_map);
+
+  StaticNDTMap static_map{};
+  CompactStaticNDTMap compact_map{};
+  // No map is added, so a lookup should result in an exception
+  EXPECT_THROW(compact_map.cell(0.0F, 0.0F, 0.0F), std::runtime_error);
+  EXPECT_FALSE(compact_map.valid());
+
+  static_map.set(serialized_map);
+  compact_map.set(serialized_map);
+  EXPECT_TRUE(compact_map.valid());
+  EXPECT_EQ(compact_map.size(), static_map.size());
+  EXPECT_EQ(compact_map.frame_id(), static_map.frame_id());
+  for (const auto & voxel_it : compact_map) {
+    EXPECT_EQ(voxel_it.first, grid_config.index(voxel_it.second.centroid()));
+  }
+
+  // Query a finer grid which also covers the clamped region outside of the map bounds.
+  for (auto x = -1.0F; x <= POINTS_PER_DIM + 2.0F; x += 0.25F) {
+    for (auto y = -1.0F; y <= POINTS_PER_DIM + 2.0F; y += 0.25F) {
+      for (auto z = -1.0F; z <= POINTS_PER_DIM + 2.0F; z += 0.25F) {
+        const auto & expected_cells = static_map.cell(x, y, z);
+        const auto & cells = compact_map.cell(x, y, z);
+        ASSERT_EQ(cells.size(), expected_cells.size());
+        if (!cells.empty()) {
+          EXPECT_EQ(cells[0U].centroid(), expected_cells[0U].centroid());
+          EXPECT_EQ(cells[0U].inverse_covariance(), expected_cells[0U].inverse_covariance());
+        }
+      }
+    }
+  }
+
+  compact_map.clear();
+  EXPECT_EQ(compact_map.size(), 0U);
+  EXPECT_TRUE(compact_map.cell(1.0F, 1.0F, 1.0F).empty());
+}
+
+TEST_F(DenseNDTMapTest, PagedMapMatchesCompactMapAroundPosition) {
+  auto grid_config = Config(m_min_point, m_max_point, m_voxel_size, m_capacity);
+  DynamicNDTMap dynamic_map(grid_config);
+  build_pc(grid_config);
+  dynamic_map.insert(m_pc);
+
+  sensor_msgs::msg::PointCloud2 serialized_map;
+  dynamic_map.serialize_as<StaticNDTMap>(serialized_map);
+  CompactStaticNDTMap compact_map{};
+  compact_map.set(serialized_map);
+
+  const std::string file_name{"test_ndt_map_tiles.bin"};
+  constexpr float64_t tile_size = 2.0;
+  EXPECT_THROW(write_ndt_map_tiles(serialized_map, 0.0, file_name), std::domain_error);
+  write_ndt_map_tiles(serialized_map, tile_size, file_name);
+
+  {
+    // Voxel centers are at 1...5, so they fall into the tiles 0...2 along x and y.
+    NDTMapTileFile tile_file{file_name};
+    EXPECT_EQ(tile_file.num_tiles(), 9U);
+    EXPECT_EQ(tile_file.frame_id(), compact_map.frame_id());
+    EXPECT_EQ(tile_file.stamp(), compact_map.stamp());
+    std::vector<const NDTMapTileIndexEntry *> tiles;
+    tile_file.find_tiles(1, 1, -5, 5, tiles);
+    ASSERT_EQ(tiles.size(), 3U);
+    for (const auto * tile : tiles) {
+      EXPECT_EQ(tile->x, 1);
+      for (auto idx = 0U; idx < tile->num_voxels; ++idx) {
+        const auto & voxel = tile_file.voxels(*tile)[idx];
+        EXPECT_EQ(tile_file.tile_coordinate(voxel.x), tile->x);
+        EXPECT_EQ(tile_file.tile_coordinate(voxel.y), tile->y);
+      }
+    }
+    tile_file.find_tiles(3, 5, 0, 2, tiles);
+    EXPECT_TRUE(tiles.empty());
+  }
+
+  // With a radius of one tile, the tiles -1...1 around the origin are resident.
+  PagedNDTMap paged_map{file_name, 1.0};
+  EXPECT_THROW(paged_map.set(serialized_map), std::logic_error);
+  EXPECT_FALSE(paged_map.valid());
+  EXPECT_TRUE(paged_map.cell(1.0F, 1.0F, 1.0F).empty());
+  EXPECT_EQ(paged_map.cell_size().x, m_voxel_size.x);
+
+  const auto expect_resident = [&compact_map, &paged_map](float32_t min, float32_t max) {
+      for (auto x = 1.0F; x <= POINTS_PER_DIM; x += 0.5F) {
+        for (auto y = 1.0F; y <= POINTS_PER_DIM; y += 0.5F) {
+          for (auto z = 1.0F; z <= POINTS_PER_DIM; z += 0.5F) {
+            const auto & cells = paged_map.cell(x, y, z);
+            const auto & expected_cells = compact_map.cell(x, y, z);
+            ASSERT_EQ(expected_cells.size(), 1U);
+            // Voxels belong to the tile their centroid falls into.
+            const auto & centroid = expected_cells[0U].centroid();
+            if ((centroid(0U) < min) || (centroid(0U) >= max) ||
+              (centroid(1U) < min) || (centroid(1U) >= max))
+            {
+              EXPECT_TRUE(cells.empty());
+              continue;
+            }
+            ASSERT_EQ(cells.size(), 1U);
+            EXPECT_EQ(cells[0U].centroid(), centroid);
+            EXPECT_EQ(cells[0U].inverse_covariance(), expected_cells[0U].inverse_covariance());
+          }
+        }
+      }
+    };
+
+  paged_map.update(Eigen::Vector3d{0.5, 0.5, 0.0});
+  ASSERT_TRUE(paged_map.wait_until_loaded(std::chrono::seconds(10)));
+  EXPECT_TRUE(paged_map.valid());
+  EXPECT_EQ(paged_map.frame_id(), compact_map.frame_id());
+  EXPECT_EQ(paged_map.stamp(), compact_map.stamp());
+  expect_resident(-2.0F, 4.0F);
+
+  // Moving within the tile does not change the resident tiles.
+  const auto num_voxels = paged_map.size();
+  paged_map.update(Eigen::Vector3d{1.5, 1.9, 0.0});
+  ASSERT_TRUE(paged_map.wait_until_loaded(std::chrono::seconds(10)));
+  EXPECT_EQ(paged_map.size(), num_voxels);
+
+  // The old tiles stay in use until the new ones are loaded and swapped in.
+  paged_map.update(Eigen::Vector3d{5.0, 5.0, 0.0});
+  ASSERT_TRUE(paged_map.wait_until_loaded(std::chrono::seconds(10)));
+  expect_resident(2.0F, 8.0F);
+
+  std::remove(file_name.c_str());
+}
+
 ///////////////////////////////////////
 
 TEST(StaticNDTVoxelTest, NdtMapVoxelBasics) {
@@ -29,6 +29,8 @@ using autoware::common::types::float64_t;
 using autoware::localization::ndt::P2DNDTScan;
 using autoware::localization::ndt::P2DNDTOptimizationProblem;
 using autoware::localization::ndt::P2DNDTOptimizationConfig;
+using autoware::localization::ndt::P2DNDTObjective;
+using autoware::localization::ndt::StaticNDTMap;
 using autoware::localization::ndt::transform_adapters::pose_to_transform;
 
 using P2DProblem = P2DNDTOptimizationProblem<autoware::localization::ndt::StaticNDTMap>;
@@ -122,6 +124,39 @@ TEST_P(P2DOptimizationNumericalTest, NumericalAnalysis) {
     }
   }
 }
+/// @test       The objective evaluated on worker threads is bit-identical to the objective
+///             evaluated on the calling thread.
+TEST_F(P2DOptimizationTest, ParallelEvaluationIsReproducible) {
+  // Use the dense cloud so that the scan is split into multiple chunks.
+  P2DNDTScan scan(m_pc, m_pc.width);
+  ASSERT_GT(scan.size(), 2U * P2DNDTObjective<StaticNDTMap>::CHUNK_SIZE);
+  const auto mode = autoware::common::optimization::ComputeMode{true, true, true};
+  EigenPose<Real> pose;
+  pose << 0.1, -0.2, 0.05, 0.01, -0.02, 0.03;
+
+  P2DProblem serial_problem{scan, m_static_map, P2DNDTOptimizationConfig{0.55}};
+  serial_problem.evaluate(pose, mode);
+  P2DProblem::Jacobian serial_jacobian;
+  P2DProblem::Hessian serial_hessian;
+  serial_problem.jacobian(pose, serial_jacobian);
+  serial_problem.hessian(pose, serial_hessian);
+
+  for (auto num_threads = 2U; num_threads <= 4U; ++num_threads) {
+    const P2DNDTOptimizationConfig config{0.55, num_threads};
+    EXPECT_EQ(config.num_threads(), num_threads);
+    P2DProblem problem{scan, m_static_map, config};
+    problem.evaluate(pose, mode);
+    P2DProblem::Jacobian jacobian;
+    P2DProblem::Hessian hessian;
+    problem.jacobian(pose, jacobian);
+    problem.hessian(pose, hessian);
+    EXPECT_EQ(problem(pose), serial_problem(pose));
+    EXPECT_EQ(jacobian, serial_jacobian);
+    EXPECT_EQ(hessian, serial_hessian);
+  }
+  EXPECT_THROW(P2DNDTOptimizationConfig(0.55, 0U), std::domain_error);
+}
+
 /// @test       The shape is fitting exactly into a single voxel. Its copy is moved in different
 ///             directions and aligned with the original.
 TEST_P(AlignmentXyzTest, AlignShapesWithinOneVoxel) {
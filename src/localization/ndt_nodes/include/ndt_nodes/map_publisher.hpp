@@ -59,6 +59,8 @@ public:
   /// 2. Load the PCD file into a PointCloud2 message.
   /// 3. Apply the normal distribution transform loaded PointCloud2 message.
   /// 4. Convert the resulting map representation into a `PointCloud2` message and publish.
+  /// If a tiled map file is configured, the map is written to that file instead of being
+  /// published.
   void run();
 
 private:
@@ -93,6 +95,8 @@ private:
   const std::string m_pcl_file_name;
   const std::string m_yaml_file_name;
   const bool8_t m_viz_map;
+  const std::string m_map_tiles_file_name;
+  const float64_t m_map_tile_size;
   rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr m_viz_pub;
   std::unique_ptr<MapConfig> m_map_config_ptr;
   std::unique_ptr<MapConfig> m_viz_map_config_ptr;
@@ -20,6 +20,7 @@
 #include <common/types.hpp>
 #include <ndt_nodes/visibility_control.hpp>
 #include <ndt/ndt_localizer.hpp>
+#include <ndt/ndt_map_tiles.hpp>
 #include <localization_nodes/localization_node.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <optimization/newtons_method_optimizer.hpp>
@@ -49,22 +50,25 @@ using PoseInitializer_ = localization_common::BestEffortInitializer;
 /// P2D NDT localizer node. Currently uses the hard coded optimizer and pose initializers.
 /// \tparam OptimizerT Hard coded for Newton optimizer. TODO(yunus.caliskan): Make Configurable
 /// \tparam PoseInitializerT Hard coded for Best effort. TODO(yunus.caliskan): Make Configurable
-template<typename OptimizerT = Optimizer_, typename PoseInitializerT = PoseInitializer_>
+/// \tparam MapT `ndt::CompactStaticNDTMap` to receive the whole map on the map topic or
+/// `ndt::PagedNDTMap` to page the tiles around the vehicle in from a tiled map file.
+template<typename OptimizerT = Optimizer_, typename PoseInitializerT = PoseInitializer_,
+  typename MapT = ndt::CompactStaticNDTMap>
 class NDT_NODES_PUBLIC P2DNDTLocalizerNode
   : public localization_nodes::RelativeLocalizerNode<
     sensor_msgs::msg::PointCloud2,
     sensor_msgs::msg::PointCloud2,
-    ndt::StaticNDTMap,
-    ndt::P2DNDTLocalizer<OptimizerT>,
+    MapT,
+    ndt::P2DNDTLocalizer<OptimizerT, MapT>,
     PoseInitializerT>
 {
 public:
-  using Localizer = ndt::P2DNDTLocalizer<OptimizerT>;
+  using Localizer = ndt::P2DNDTLocalizer<OptimizerT, MapT>;
   using RegistrationSummary = localization_common::OptimizedRegistrationSummary;
   using ParentT = localization_nodes::RelativeLocalizerNode<
     sensor_msgs::msg::PointCloud2,
     sensor_msgs::msg::PointCloud2,
-    ndt::StaticNDTMap,
+    MapT,
     Localizer,
     PoseInitializerT>;
   using PoseWithCovarianceStamped = typename Localizer::PoseWithCovarianceStamped;
@@ -133,7 +137,59 @@ protected:
     return ret;
   }
 
+  void on_observation_with_invalid_map(
+    typename sensor_msgs::msg::PointCloud2::ConstSharedPtr msg) override
+  {
+    // Tiles requested around the last position may have been loaded in the meantime.
+    if (m_has_position) {
+      update_map(*m_map_ptr, m_position);
+    }
+    ParentT::on_observation_with_invalid_map(msg);
+  }
+
 private:
+  void handle_position_update(const geometry_msgs::msg::Point & position) override
+  {
+    m_position = Eigen::Vector3d{position.x, position.y, position.z};
+    m_has_position = true;
+    update_map(*m_map_ptr, m_position);
+  }
+
+  /// Create a map which is set by the messages of the map topic.
+  std::unique_ptr<ndt::CompactStaticNDTMap> create_map(const ndt::CompactStaticNDTMap *)
+  {
+    return std::make_unique<ndt::CompactStaticNDTMap>();
+  }
+
+  /// Create a map which pages the tiles around the vehicle in from a tiled map file.
+  std::unique_ptr<ndt::PagedNDTMap> create_map(const ndt::PagedNDTMap *)
+  {
+    auto map_ptr = std::make_unique<ndt::PagedNDTMap>(
+      this->declare_parameter("map_tiles.file").template get<std::string>(),
+      this->declare_parameter("map_tiles.paging_radius").template get<float64_t>());
+    // The base class only reads the initial pose on construction, so request its tiles here.
+    if (this->has_parameter("load_initial_pose_from_parameters") &&
+      this->get_parameter("load_initial_pose_from_parameters").template get_value<bool>())
+    {
+      m_position = Eigen::Vector3d{
+        this->get_parameter("initial_pose.translation.x").template get_value<float64_t>(),
+        this->get_parameter("initial_pose.translation.y").template get_value<float64_t>(),
+        this->get_parameter("initial_pose.translation.z").template get_value<float64_t>()};
+      m_has_position = true;
+      map_ptr->update(m_position);
+    }
+    return map_ptr;
+  }
+
+  /// Static maps do not depend on the vehicle position.
+  void update_map(ndt::CompactStaticNDTMap &, const Eigen::Vector3d &) {}
+
+  /// Swap in loaded tiles and request the tiles around the vehicle position.
+  void update_map(ndt::PagedNDTMap & map, const Eigen::Vector3d & position)
+  {
+    map.update(position);
+  }
+
   virtual bool on_non_convergence(
     const RegistrationSummary &,
     const PoseWithCovarianceStamped &, const Transform &)
@@ -194,6 +250,9 @@ private:
 
     const auto outlier_ratio{this->declare_parameter(
         "localizer.optimization.outlier_ratio").template get<float64_t>()};
+    const auto num_threads{this->declare_parameter(
+        "localizer.optimization.num_threads",
+        rclcpp::ParameterValue{1}).template get<std::size_t>()};
 
     common::optimization::OptimizationOptions optimizer_options{
       static_cast<uint64_t>(
@@ -220,8 +279,10 @@ private:
               common::optimization::MoreThuenteLineSearch::OptimizationDirection::kMaximization},
             optimizer_options
           },
-      outlier_ratio);
-    auto map_ptr = std::make_unique<ndt::StaticNDTMap>();
+      outlier_ratio,
+      num_threads);
+    auto map_ptr = create_map(static_cast<const MapT *>(nullptr));
+    m_map_ptr = map_ptr.get();
 
     this->set_localizer(std::move(localizer_ptr));
     this->set_map(std::move(map_ptr));
@@ -229,6 +290,10 @@ private:
 
   ndt::Real m_predict_translation_threshold;
   ndt::Real m_predict_rotation_threshold;
+  // Owned by the base class.
+  MapT * m_map_ptr{nullptr};
+  Eigen::Vector3d m_position{Eigen::Vector3d::Zero()};
+  bool m_has_position{false};
 };
 }  // namespace ndt_nodes
 }  // namespace localization
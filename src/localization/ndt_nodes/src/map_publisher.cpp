@@ -16,6 +16,7 @@
 
 #include <common/types.hpp>
 #include <ndt_nodes/map_publisher.hpp>
+#include <ndt/ndt_map_tiles.hpp>
 #include <rclcpp_components/register_node_macro.hpp>
 #include <point_cloud_msg_wrapper/point_cloud_msg_wrapper.hpp>
 #include <tf2_geometry_msgs/tf2_geometry_msgs.h>
@@ -47,7 +48,9 @@ NDTMapPublisherNode::NDTMapPublisherNode(
 : Node("ndt_map_publisher_node", node_options),
   m_pcl_file_name(declare_parameter("map_pcd_file").get<std::string>()),
   m_yaml_file_name(declare_parameter("map_yaml_file").get<std::string>()),
-  m_viz_map(declare_parameter("viz_map", false))
+  m_viz_map(declare_parameter("viz_map", false)),
+  m_map_tiles_file_name(declare_parameter("map_tiles.file", std::string{})),
+  m_map_tile_size(declare_parameter("map_tiles.tile_size", 100.0))
 {
   using PointXYZ = perception::filters::voxel_grid::PointXYZ;
   PointXYZ min_point;
@@ -144,6 +147,14 @@ void NDTMapPublisherNode::run()
   m_ndt_map_ptr->insert(m_source_pc);
   m_ndt_map_ptr->serialize_as<SerializedMap>(m_map_pc);
 
+  if (!m_map_tiles_file_name.empty()) {
+    // Localizers page the tiles in themselves, so the whole map is not published.
+    ndt::write_ndt_map_tiles(m_map_pc, m_map_tile_size, m_map_tiles_file_name);
+    RCLCPP_INFO(
+      get_logger(), "Wrote the tiled ndt map to %s", m_map_tiles_file_name.c_str());
+    reset_pc_msg(m_map_pc);
+  }
+
   if (m_viz_map) {
     reset_pc_msg(m_downsampled_pc);
     downsample_pc();
@@ -33,8 +33,23 @@ struct P2DNDTLocalizerNodeComponent
   {
   }
 };
+
+struct P2DNDTPagedLocalizerNodeComponent
+  : public autoware::localization::ndt_nodes::P2DNDTLocalizerNode<
+    Optimizer_, PoseInitializer_, ndt::PagedNDTMap>
+{
+  explicit P2DNDTPagedLocalizerNodeComponent(const rclcpp::NodeOptions & node_options)
+  : autoware::localization::ndt_nodes::P2DNDTLocalizerNode<
+      Optimizer_, PoseInitializer_, ndt::PagedNDTMap>(
+      "p2d_ndt_paged_localizer_node", node_options,
+      autoware::localization::ndt_nodes::PoseInitializer_{})
+  {
+  }
+};
 }  // namespace ndt_nodes
 }  // namespace localization
 }  // namespace autoware
 
 RCLCPP_COMPONENTS_REGISTER_NODE(autoware::localization::ndt_nodes::P2DNDTLocalizerNodeComponent)
+RCLCPP_COMPONENTS_REGISTER_NODE(
+  autoware::localization::ndt_nodes::P2DNDTPagedLocalizerNodeComponent)
@@ -0,0 +1,89 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \copyright Copyright 2021 the Autoware Foundation
+/// \file
+/// \brief This file defines the DriveableGeometryIndex class.
+
+#ifndef LANELET2_MAP_PROVIDER__DRIVEABLE_GEOMETRY_INDEX_HPP_
+#define LANELET2_MAP_PROVIDER__DRIVEABLE_GEOMETRY_INDEX_HPP_
+
+#include <common/types.hpp>
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet2_map_provider/visibility_control.hpp>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace autoware
+{
+namespace lanelet2_map_provider
+{
+
+/// \class DriveableGeometryIndex
+/// \brief Spatial index over the primitives making up the driveable geometry of a map:
+/// lanelets, areas and the parking related line strings. All primitives are collected and
+/// their bounding boxes are put into a single R-tree once, so a geometric sub-map request
+/// costs one tree query instead of a search per layer followed by attribute filtering.
+class LANELET2_MAP_PROVIDER_PUBLIC DriveableGeometryIndex
+{
+public:
+  /// \brief Build the index
+  /// \param map The full map, primitives are shared with it
+  explicit DriveableGeometryIndex(const lanelet::LaneletMapPtr & map);
+
+  /// \brief Sub-map holding all driveable geometry of the map
+  lanelet::LaneletMapPtr sub_map() const;
+
+  /// \brief Sub-map holding the driveable geometry whose bounding box intersects a box
+  /// \param box The requested region
+  lanelet::LaneletMapPtr sub_map(const lanelet::BoundingBox2d & box) const;
+
+  /// \brief Sub-map holding the driveable geometry that intersects a box but did not
+  /// intersect a previously requested box, i.e. what a client holding the previous sub-map
+  /// is missing
+  /// \param box The requested region
+  /// \param previous The region the client already has
+  lanelet::LaneletMapPtr sub_map_delta(
+    const lanelet::BoundingBox2d & box,
+    const lanelet::BoundingBox2d & previous) const;
+
+  /// \brief Number of indexed primitives
+  std::size_t size() const;
+
+private:
+  using Point = boost::geometry::model::point<
+    common::types::float64_t, 2, boost::geometry::cs::cartesian>;
+  using Box = boost::geometry::model::box<Point>;
+  /// Box and position in the concatenation of lanelets, areas and line strings
+  using Value = std::pair<Box, std::size_t>;
+  using RTree = boost::geometry::index::rtree<Value, boost::geometry::index::rstar<16U>>;
+
+  static Box to_box(const lanelet::BoundingBox2d & box);
+  lanelet::LaneletMapPtr make_map(const std::vector<Value> & values) const;
+
+  lanelet::Lanelets m_lanelets;
+  lanelet::Areas m_areas;
+  lanelet::LineStrings3d m_line_strings;
+  RTree m_tree;
+};
+
+}  // namespace lanelet2_map_provider
+}  // namespace autoware
+
+#endif  // LANELET2_MAP_PROVIDER__DRIVEABLE_GEOMETRY_INDEX_HPP_
@@ -21,8 +21,12 @@
 
 #include <rclcpp/rclcpp.hpp>
 
+#include <lanelet2_map_provider/driveable_geometry_index.hpp>
 #include <lanelet2_map_provider/lanelet2_map_provider.hpp>
+#include <list>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "autoware_auto_mapping_msgs/srv/had_map_service.hpp"
 #include "autoware_auto_mapping_msgs/msg/had_map_bin.hpp"
@@ -50,7 +54,11 @@ public:
   /// \throw runtime error if failed to start threads or configure driver
   explicit Lanelet2MapProviderNode(const rclcpp::NodeOptions & options);
 
-  /// \brief Handles the node service requests
+  /// \brief Handles the node service requests. Geometric requests are answered from a
+  /// spatial index of the driveable geometry and recent responses are cached. If both
+  /// geometric bounds carry six instead of three values, the last three describe the box of
+  /// a previous response held by the client and only primitives that newly intersect the
+  /// requested box are sent.
   /// \param request Service request message for map data specifying map content and geom. bounds
   /// \param response Service repsone to request, containing a sub-set of map data
   /// but nethertheless containing a complete and valid lanelet2 map
@@ -58,6 +66,9 @@ public:
     std::shared_ptr<autoware_auto_mapping_msgs::srv::HADMapService_Request> request,
     std::shared_ptr<autoware_auto_mapping_msgs::srv::HADMapService_Response> response);
 
+  /// \brief Number of responses currently held in the response cache
+  std::size_t response_cache_length() const noexcept;
+
 private:
   /// If the origin is not defined by parameters, get the transform describing
   /// the map origin (earth->map transform, set by the pcd
@@ -65,7 +76,34 @@ private:
   /// \return The map origin in ECEF ENU transform
   geometry_msgs::msg::TransformStamped get_map_origin();
 
+  /// Serialize a map in the format selected by the use_flat_map_format parameter
+  void to_binary_msg(
+    const lanelet::LaneletMapPtr & map,
+    autoware_auto_mapping_msgs::msg::HADMapBin & msg) const;
+
+  /// Grow a box outwards to the tile grid so that nearby requests share a cache entry
+  lanelet::BoundingBox2d snap_to_tiles(const lanelet::BoundingBox2d & box) const;
+
+  /// Look up a previously sent response, marking it as most recently used
+  /// \return True if a response was found and copied into msg
+  autoware::common::types::bool8_t find_cached_response(
+    const std::vector<float64_t> & key,
+    autoware_auto_mapping_msgs::msg::HADMapBin & msg);
+
+  /// Remember a response, evicting the least recently used one if the cache is full
+  void store_response(
+    std::vector<float64_t> && key,
+    const autoware_auto_mapping_msgs::msg::HADMapBin & msg);
+
+  using CachedResponse = std::pair<std::vector<float64_t>,
+      autoware_auto_mapping_msgs::msg::HADMapBin>;
+
   std::unique_ptr<Lanelet2MapProvider> m_map_provider;
+  std::unique_ptr<DriveableGeometryIndex> m_driveable_geometry;
+  autoware::common::types::bool8_t m_use_flat_map_format{false};
+  float64_t m_tile_size{0.0};
+  std::size_t m_response_cache_size{0U};
+  std::list<CachedResponse> m_response_cache;
   rclcpp::Service<autoware_auto_mapping_msgs::srv::HADMapService>::SharedPtr m_map_service;
 };
 
@@ -0,0 +1,136 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \copyright Copyright 2021 the Autoware Foundation
+
+#include "lanelet2_map_provider/driveable_geometry_index.hpp"
+
+#include <lanelet2_core/geometry/Area.h>
+#include <lanelet2_core/geometry/Lanelet.h>
+#include <lanelet2_core/geometry/LineString.h>
+#include <had_map_utils/had_map_query.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+namespace autoware
+{
+namespace lanelet2_map_provider
+{
+
+namespace bgi = boost::geometry::index;
+
+namespace
+{
+/// Line string subtypes that are part of the driveable geometry
+constexpr const char * kLineStringSubtypes[] = {
+  "parking_spot", "parking_access", "parking_spot,drop_off,pick_up"};
+}  // namespace
+
+DriveableGeometryIndex::DriveableGeometryIndex(const lanelet::LaneletMapPtr & map)
+: m_lanelets(common::had_map_utils::getLaneletLayer(map)),
+  m_areas(common::had_map_utils::getAreaLayer(map))
+{
+  const auto line_strings = common::had_map_utils::getLineStringLayer(map);
+  for (const auto subtype : kLineStringSubtypes) {
+    const auto matching = common::had_map_utils::subtypeLineStrings(line_strings, subtype);
+    m_line_strings.insert(m_line_strings.end(), matching.begin(), matching.end());
+  }
+
+  std::vector<Value> values;
+  values.reserve(size());
+  for (const auto & lanelet : m_lanelets) {
+    values.emplace_back(to_box(lanelet::geometry::boundingBox2d(lanelet)), values.size());
+  }
+  for (const auto & area : m_areas) {
+    values.emplace_back(to_box(lanelet::geometry::boundingBox2d(area)), values.size());
+  }
+  for (const auto & line_string : m_line_strings) {
+    values.emplace_back(to_box(lanelet::geometry::boundingBox2d(line_string)), values.size());
+  }
+  // Bulk loading packs the tree, which is both faster to build and to query
+  m_tree = RTree{values.begin(), values.end()};
+}
+
+lanelet::LaneletMapPtr DriveableGeometryIndex::sub_map() const
+{
+  lanelet::LaneletMapPtr map = lanelet::utils::createMap(m_lanelets, m_areas);
+  for (const auto & line_string : m_line_strings) {
+    map->add(line_string);
+  }
+  return map;
+}
+
+lanelet::LaneletMapPtr DriveableGeometryIndex::sub_map(const lanelet::BoundingBox2d & box) const
+{
+  std::vector<Value> values;
+  m_tree.query(bgi::intersects(to_box(box)), std::back_inserter(values));
+  return make_map(values);
+}
+
+lanelet::LaneletMapPtr DriveableGeometryIndex::sub_map_delta(
+  const lanelet::BoundingBox2d & box,
+  const lanelet::BoundingBox2d & previous) const
+{
+  std::vector<Value> values;
+  m_tree.query(
+    bgi::intersects(to_box(box)) && !bgi::intersects(to_box(previous)),
+    std::back_inserter(values));
+  return make_map(values);
+}
+
+std::size_t DriveableGeometryIndex::size() const
+{
+  return m_lanelets.size() + m_areas.size() + m_line_strings.size();
+}
+
+DriveableGeometryIndex::Box DriveableGeometryIndex::to_box(const lanelet::BoundingBox2d & box)
+{
+  return Box{Point{box.min().x(), box.min().y()}, Point{box.max().x(), box.max().y()}};
+}
+
+lanelet::LaneletMapPtr DriveableGeometryIndex::make_map(const std::vector<Value> & values) const
+{
+  // Tree order is arbitrary, restore the layer order for a deterministic response
+  std::vector<std::size_t> positions;
+  positions.reserve(values.size());
+  for (const auto & value : values) {
+    positions.push_back(value.second);
+  }
+  std::sort(positions.begin(), positions.end());
+
+  const auto area_begin = m_lanelets.size();
+  const auto line_string_begin = area_begin + m_areas.size();
+  lanelet::Lanelets lanelets;
+  lanelet::Areas areas;
+  lanelet::LineStrings3d line_strings;
+  for (const auto position : positions) {
+    if (position < area_begin) {
+      lanelets.push_back(m_lanelets[position]);
+    } else if (position < line_string_begin) {
+      areas.push_back(m_areas[position - area_begin]);
+    } else {
+      line_strings.push_back(m_line_strings[position - line_string_begin]);
+    }
+  }
+  lanelet::LaneletMapPtr map = lanelet::utils::createMap(lanelets, areas);
+  for (const auto & line_string : line_strings) {
+    map->add(line_string);
+  }
+  return map;
+}
+
+}  // namespace lanelet2_map_provider
+}  // namespace autoware
@@ -28,10 +28,14 @@
 #include <rclcpp/time_source.hpp>
 #include <rclcpp_components/register_node_macro.hpp>
 #include <common/types.hpp>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <stdexcept>
 #include <string>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "autoware_auto_mapping_msgs/srv/had_map_service.hpp"
 #include "autoware_auto_mapping_msgs/msg/had_map_bin.hpp"
@@ -50,6 +54,13 @@ Lanelet2MapProviderNode::Lanelet2MapProviderNode(const rclcpp::NodeOptions & opt
   const std::string map_filename = declare_parameter("map_osm_file").get<std::string>();
   const float64_t origin_offset_lat = declare_parameter("origin_offset_lat", 0.0);
   const float64_t origin_offset_lon = declare_parameter("origin_offset_lon", 0.0);
+  m_use_flat_map_format = declare_parameter("use_flat_map_format", false);
+  m_tile_size = declare_parameter("tile_size", 0.0);
+  const auto response_cache_size = declare_parameter("response_cache_size", 16);
+  if (response_cache_size < 0) {
+    throw std::domain_error("response_cache_size must not be negative");
+  }
+  m_response_cache_size = static_cast<std::size_t>(response_cache_size);
   if (has_parameter("latitude") && has_parameter("longitude") && has_parameter("elevation")) {
     const float64_t origin_lat = declare_parameter("latitude").get<float64_t>();
     const float64_t origin_lon = declare_parameter("longitude").get<float64_t>();
@@ -64,6 +75,7 @@ Lanelet2MapProviderNode::Lanelet2MapProviderNode(const rclcpp::NodeOptions & opt
       map_filename, std::move(
         earth_from_map), origin_offset_lat, origin_offset_lon);
   }
+  m_driveable_geometry = std::make_unique<DriveableGeometryIndex>(m_map_provider->m_map);
 
   m_map_service =
     this->create_service<autoware_auto_mapping_msgs::srv::HADMapService>(
@@ -108,85 +120,143 @@ void Lanelet2MapProviderNode::handle_request(
   std::shared_ptr<autoware_auto_mapping_msgs::srv::HADMapService_Request> request,
   std::shared_ptr<autoware_auto_mapping_msgs::srv::HADMapService_Response> response)
 {
-  autoware_auto_mapping_msgs::msg::HADMapBin msg;
-  msg.header.frame_id = "map";
+  using autoware_auto_mapping_msgs::srv::HADMapService_Request;
 
   // TODO(simon) add map version and format information to message header
   // msg.format_version = format_version;
   // msg.map_version = map_version;
 
-  auto primitive_sequence = request->requested_primitives;
-
+  const auto & primitive_sequence = request->requested_primitives;
   // special case where we send existing map as is
-  if (primitive_sequence.size() == 1 && *(primitive_sequence.begin()) ==
-    autoware_auto_mapping_msgs::srv::HADMapService_Request::FULL_MAP)
-  {
-    autoware::common::had_map_utils::toBinaryMsg(m_map_provider->m_map, msg);
-    response->map = msg;
-    return;
-  }
+  const bool8_t full_map_requested = (primitive_sequence.size() == 1) &&
+    (primitive_sequence.front() == HADMapService_Request::FULL_MAP);
+  const bool8_t driveable_geometry_requested = std::any_of(
+    primitive_sequence.begin(), primitive_sequence.end(),
+    [](const uint8_t primitive) {
+      return primitive == HADMapService_Request::DRIVEABLE_GEOMETRY;
+    });
 
-  // check if geom bounds are set in request (ie - they are non zero)
-  auto upper_bound = request->geom_upper_bound;
-  auto lower_bound = request->geom_lower_bound;
-  bool8_t geom_bound_requested = (upper_bound.size() == 3) && (lower_bound.size() == 3);
+  // check if geom bounds are set in request (ie - they are non zero). Three more values per
+  // bound describe the box the client already holds and turn the request into a delta request.
+  const auto & upper_bound = request->geom_upper_bound;
+  const auto & lower_bound = request->geom_lower_bound;
+  const bool8_t geom_bound_requested = (upper_bound.size() == lower_bound.size()) &&
+    ((upper_bound.size() == 3U) || (upper_bound.size() == 6U));
+  const bool8_t delta_requested = geom_bound_requested && (upper_bound.size() == 6U);
 
-  lanelet::LaneletMapPtr requested_map;
-  lanelet::Lanelets requested_lanelets;
-  lanelet::Areas requested_areas;
-  lanelet::LineStrings3d requested_linestrings;
   lanelet::BoundingBox2d geom_bbox;
-
+  lanelet::BoundingBox2d previous_bbox;
   if (geom_bound_requested) {
-    geom_bbox = lanelet::BoundingBox2d(
-      lanelet::BasicPoint2d(lower_bound[0], lower_bound[1]),
-      lanelet::BasicPoint2d(upper_bound[0], upper_bound[1]));
+    geom_bbox = snap_to_tiles(
+      lanelet::BoundingBox2d(
+        lanelet::BasicPoint2d(lower_bound[0], lower_bound[1]),
+        lanelet::BasicPoint2d(upper_bound[0], upper_bound[1])));
+  }
+  if (delta_requested) {
+    previous_bbox = snap_to_tiles(
+      lanelet::BoundingBox2d(
+        lanelet::BasicPoint2d(lower_bound[3], lower_bound[4]),
+        lanelet::BasicPoint2d(upper_bound[3], upper_bound[4])));
   }
 
-  for (auto primitive : primitive_sequence) {
-    if (primitive == autoware_auto_mapping_msgs::srv::HADMapService_Request::DRIVEABLE_GEOMETRY) {
-      lanelet::LineStrings3d linestrings;
-
-      if (!geom_bound_requested) {
-        requested_lanelets =
-          autoware::common::had_map_utils::getLaneletLayer(m_map_provider->m_map);
-        requested_areas = autoware::common::had_map_utils::getAreaLayer(m_map_provider->m_map);
-        linestrings = autoware::common::had_map_utils::getLineStringLayer(
-          m_map_provider->m_map);
-      } else {
-        requested_lanelets = m_map_provider->m_map->laneletLayer.search(geom_bbox);
-        requested_areas = m_map_provider->m_map->areaLayer.search(geom_bbox);
-        linestrings = m_map_provider->m_map->lineStringLayer.search(geom_bbox);
-      }
-      lanelet::LineStrings3d parking_linestrings =
-        autoware::common::had_map_utils::subtypeLineStrings(
-        linestrings, "parking_spot");
-      lanelet::LineStrings3d parking_access_linestrings =
-        autoware::common::had_map_utils::subtypeLineStrings(
-        linestrings, "parking_access");
-      lanelet::LineStrings3d pickup_dropoff_linestrings =
-        autoware::common::had_map_utils::subtypeLineStrings(
-        linestrings, "parking_spot,drop_off,pick_up");
-      requested_linestrings.insert(
-        requested_linestrings.end(),
-        parking_linestrings.begin(),
-        parking_linestrings.end());
-      requested_linestrings.insert(
-        requested_linestrings.end(),
-        parking_access_linestrings.begin(),
-        parking_access_linestrings.end());
-      requested_linestrings.insert(
-        requested_linestrings.end(),
-        pickup_dropoff_linestrings.begin(),
-        pickup_dropoff_linestrings.end());
+  // The map never changes after loading, so responses stay valid for the node's lifetime
+  std::vector<float64_t> cache_key;
+  cache_key.push_back(full_map_requested ? 1.0 : 0.0);
+  cache_key.push_back(driveable_geometry_requested ? 1.0 : 0.0);
+  const auto add_to_key = [&cache_key](const lanelet::BoundingBox2d & box) {
+      cache_key.insert(
+        cache_key.end(), {box.min().x(), box.min().y(), box.max().x(), box.max().y()});
+    };
+  if (!full_map_requested && geom_bound_requested) {
+    add_to_key(geom_bbox);
+    if (delta_requested) {
+      add_to_key(previous_bbox);
     }
   }
-  requested_map = lanelet::utils::createMap({requested_lanelets}, {requested_areas});
-  for (auto i = requested_linestrings.begin(); i != requested_linestrings.end(); i++) {
-    requested_map->add(*i);
+  if (find_cached_response(cache_key, response->map)) {
+    return;
+  }
+
+  lanelet::LaneletMapPtr requested_map;
+  if (full_map_requested) {
+    requested_map = m_map_provider->m_map;
+  } else if (!driveable_geometry_requested) {
+    requested_map = std::make_shared<lanelet::LaneletMap>();
+  } else if (!geom_bound_requested) {
+    requested_map = m_driveable_geometry->sub_map();
+  } else if (delta_requested) {
+    requested_map = m_driveable_geometry->sub_map_delta(geom_bbox, previous_bbox);
+  } else {
+    requested_map = m_driveable_geometry->sub_map(geom_bbox);
+  }
+
+  autoware_auto_mapping_msgs::msg::HADMapBin msg;
+  msg.header.frame_id = "map";
+  to_binary_msg(requested_map, msg);
+  store_response(std::move(cache_key), msg);
+  response->map = std::move(msg);
+}
+
+std::size_t Lanelet2MapProviderNode::response_cache_length() const noexcept
+{
+  return m_response_cache.size();
+}
+
+lanelet::BoundingBox2d Lanelet2MapProviderNode::snap_to_tiles(
+  const lanelet::BoundingBox2d & box) const
+{
+  if (m_tile_size <= 0.0) {
+    return box;
+  }
+  const auto snap_down = [this](const float64_t value) {
+      return std::floor(value / m_tile_size) * m_tile_size;
+    };
+  const auto snap_up = [this](const float64_t value) {
+      return std::ceil(value / m_tile_size) * m_tile_size;
+    };
+  return lanelet::BoundingBox2d(
+    lanelet::BasicPoint2d(snap_down(box.min().x()), snap_down(box.min().y())),
+    lanelet::BasicPoint2d(snap_up(box.max().x()), snap_up(box.max().y())));
+}
+
+bool8_t Lanelet2MapProviderNode::find_cached_response(
+  const std::vector<float64_t> & key,
+  autoware_auto_mapping_msgs::msg::HADMapBin & msg)
+{
+  const auto it = std::find_if(
+    m_response_cache.begin(), m_response_cache.end(),
+    [&key](const CachedResponse & entry) {return entry.first == key;});
+  if (it == m_response_cache.end()) {
+    return false;
+  }
+  // Keep the cache in most recently used order
+  m_response_cache.splice(m_response_cache.begin(), m_response_cache, it);
+  msg = m_response_cache.front().second;
+  return true;
+}
+
+void Lanelet2MapProviderNode::store_response(
+  std::vector<float64_t> && key,
+  const autoware_auto_mapping_msgs::msg::HADMapBin & msg)
+{
+  if (m_response_cache_size == 0U) {
+    return;
+  }
+  m_response_cache.emplace_front(std::move(key), msg);
+  if (m_response_cache.size() > m_response_cache_size) {
+    m_response_cache.pop_back();
+  }
+}
+
+void Lanelet2MapProviderNode::to_binary_msg(
+  const lanelet::LaneletMapPtr & map,
+  autoware_auto_mapping_msgs::msg::HADMapBin & msg) const
+{
+  if (m_use_flat_map_format) {
+    autoware::common::had_map_utils::toFlatBinaryMsg(map, msg);
+  } else {
+    autoware::common::had_map_utils::toBinaryMsg(map, msg);
   }
-  autoware::common::had_map_utils::toBinaryMsg(requested_map, msg);
-  response->map = msg;
 }
 
 }  // namespace lanelet2_map_provider
@@ -12,18 +12,24 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <lanelet2_core/geometry/Lanelet.h>
 #include <lanelet2_io/Io.h>
 #include <lanelet2_io/io_handlers/Factory.h>
 #include <lanelet2_io/io_handlers/Writer.h>
+#include <lanelet2_projection/UTM.h>
 
 #include <chrono>
+#include <cstdio>
 #include <utility>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "rclcpp/rclcpp.hpp"
+#include "lanelet2_map_provider/driveable_geometry_index.hpp"
 #include "lanelet2_map_provider/lanelet2_map_provider.hpp"
 #include "lanelet2_map_provider/lanelet2_map_provider_node.hpp"
+#include "had_map_utils/had_map_conversion.hpp"
 #include "gtest/gtest.h"
 
 using namespace std::chrono_literals;
@@ -42,6 +48,61 @@ lanelet::LaneletMap getALaneletMap()
   return std::move(*lanelet::utils::createMap({ll}));
 }
 
+// A straight road of ten 10 m long lanelets along x starting at x_offset, a parking spot and a
+// road marking
+lanelet::LaneletMapPtr getARoadMap(const double x_offset = 0.0)
+{
+  lanelet::Lanelets lanelets;
+  auto make_bound = [x_offset](const double x, const double y) {
+      return lanelet::LineString3d(lanelet::utils::getId(),
+               {lanelet::Point3d{lanelet::utils::getId(), x_offset + x, y, 0},
+                 lanelet::Point3d{lanelet::utils::getId(), x_offset + x + 10.0, y, 0}});
+    };
+  for (int i = 0; i < 10; i++) {
+    lanelets.emplace_back(
+      lanelet::utils::getId(), make_bound(10.0 * i, 1.0), make_bound(10.0 * i, -1.0));
+  }
+  auto map = lanelet::utils::createMap(lanelets);
+  auto parking_spot = make_bound(100.0, 5.0);
+  parking_spot.setAttribute(lanelet::AttributeName::Subtype, "parking_spot");
+  map->add(parking_spot);
+  auto marking = make_bound(100.0, 6.0);
+  marking.setAttribute(lanelet::AttributeName::Subtype, "solid");
+  map->add(marking);
+  return map;
+}
+
+TEST(TestDriveableGeometryIndex, BoxAndDeltaQueries) {
+  const lanelet::LaneletMapPtr map = getARoadMap();
+  const autoware::lanelet2_map_provider::DriveableGeometryIndex index(map);
+  EXPECT_EQ(index.size(), 11U);
+
+  const auto full = index.sub_map();
+  EXPECT_EQ(full->laneletLayer.size(), 10U);
+  // 20 lanelet bounds and the parking spot, but not the road marking
+  EXPECT_EQ(full->lineStringLayer.size(), 21U);
+
+  const lanelet::BoundingBox2d box(lanelet::BasicPoint2d(15.0, -1.0),
+    lanelet::BasicPoint2d(35.0, 1.0));
+  EXPECT_EQ(index.sub_map(box)->laneletLayer.size(), 3U);
+
+  const lanelet::BoundingBox2d previous(lanelet::BasicPoint2d(0.0, -1.0),
+    lanelet::BasicPoint2d(25.0, 1.0));
+  const auto delta = index.sub_map_delta(box, previous);
+  ASSERT_EQ(delta->laneletLayer.size(), 1U);
+  EXPECT_DOUBLE_EQ(
+    lanelet::geometry::boundingBox2d(*delta->laneletLayer.begin()).min().x(), 30.0);
+
+  const lanelet::BoundingBox2d parking(lanelet::BasicPoint2d(101.0, 4.0),
+    lanelet::BasicPoint2d(102.0, 7.0));
+  const auto parking_map = index.sub_map(parking);
+  EXPECT_EQ(parking_map->laneletLayer.size(), 0U);
+  ASSERT_EQ(parking_map->lineStringLayer.size(), 1U);
+  EXPECT_EQ(
+    parking_map->lineStringLayer.begin()->attribute(lanelet::AttributeName::Subtype).value(),
+    "parking_spot");
+}
+
 TEST(TestLanelet2MapProvider, BasicTest) {
   std::cerr << "basic test\n";
 
@@ -116,3 +177,100 @@ TEST(TestLanelet2MapProviderNode, TestService) {
   */
   rclcpp::shutdown();
 }
+
+class TestLanelet2MapProviderNodeRequests : public ::testing::Test
+{
+protected:
+  using HADMapService = autoware_auto_mapping_msgs::srv::HADMapService;
+
+  void SetUp() override
+  {
+    ASSERT_FALSE(rclcpp::ok());
+    rclcpp::init(0, nullptr);
+    ASSERT_TRUE(rclcpp::ok());
+
+    // The road starts at x = 5 m, so no lanelet ends on the 20 m tile grid
+    const lanelet::GPSPoint origin_gps{37.380811523812845, -121.90840595108715, 16.0};
+    const lanelet::projection::UtmProjector projector(lanelet::Origin{origin_gps});
+    lanelet::write(m_map_file, *getARoadMap(5.0), projector);
+
+    rclcpp::NodeOptions node_options{};
+    node_options.append_parameter_override("map_osm_file", m_map_file);
+    node_options.append_parameter_override("latitude", origin_gps.lat);
+    node_options.append_parameter_override("longitude", origin_gps.lon);
+    node_options.append_parameter_override("elevation", origin_gps.ele);
+    node_options.append_parameter_override("tile_size", 20.0);
+    node_options.append_parameter_override("response_cache_size", 2);
+    m_node = std::make_shared<autoware::lanelet2_map_provider::Lanelet2MapProviderNode>(
+      node_options);
+  }
+
+  void TearDown() override
+  {
+    m_node.reset();
+    std::remove(m_map_file.c_str());
+    (void)rclcpp::shutdown();
+  }
+
+  // Request the driveable geometry between two x values of the road. If previous_x_min and
+  // previous_x_max differ, the request is a delta request to a client holding that range.
+  std::shared_ptr<HADMapService::Response> request(
+    const double x_min, const double x_max,
+    const double previous_x_min = 0.0, const double previous_x_max = 0.0)
+  {
+    auto request = std::make_shared<HADMapService::Request>();
+    request->requested_primitives.push_back(HADMapService::Request::DRIVEABLE_GEOMETRY);
+    request->geom_lower_bound = {x_min, -1.0, 0.0};
+    request->geom_upper_bound = {x_max, 1.0, 0.0};
+    if (previous_x_min != previous_x_max) {
+      request->geom_lower_bound.insert(
+        request->geom_lower_bound.end(), {previous_x_min, -1.0, 0.0});
+      request->geom_upper_bound.insert(
+        request->geom_upper_bound.end(), {previous_x_max, 1.0, 0.0});
+    }
+    auto response = std::make_shared<HADMapService::Response>();
+    m_node->handle_request(request, response);
+    return response;
+  }
+
+  static std::size_t count_lanelets(const HADMapService::Response & response)
+  {
+    auto map = std::make_shared<lanelet::LaneletMap>();
+    autoware::common::had_map_utils::fromBinaryMsg(response.map, map);
+    return map->laneletLayer.size();
+  }
+
+  std::string m_map_file{"lanelet2_node_test.osm"};
+  std::shared_ptr<autoware::lanelet2_map_provider::Lanelet2MapProviderNode> m_node;
+};
+
+TEST_F(TestLanelet2MapProviderNodeRequests, SnapsRequestsToTiles) {
+  // Only the lanelet [25, 35] intersects the request, but the request grows to the tile
+  // [20, 40], which also covers the lanelets [15, 25] and [35, 45]
+  EXPECT_EQ(count_lanelets(*request(26.0, 34.0)), 3U);
+}
+
+TEST_F(TestLanelet2MapProviderNodeRequests, CachesResponses) {
+  const auto first = request(26.0, 34.0);
+  EXPECT_EQ(m_node->response_cache_length(), 1U);
+
+  // Another box within the same tiles is answered from the cache
+  const auto second = request(22.0, 38.0);
+  EXPECT_EQ(m_node->response_cache_length(), 1U);
+  EXPECT_EQ(first->map.data, second->map.data);
+
+  // Boxes in other tiles are added until the cache is full
+  request(42.0, 58.0);
+  EXPECT_EQ(m_node->response_cache_length(), 2U);
+  request(62.0, 78.0);
+  EXPECT_EQ(m_node->response_cache_length(), 2U);
+}
+
+TEST_F(TestLanelet2MapProviderNodeRequests, AnswersDeltaRequests) {
+  // The tile [40, 60] covers the lanelets [35, 45], [45, 55] and [55, 65]. A client already
+  // holding the tile [20, 40] has the lanelet [35, 45].
+  EXPECT_EQ(count_lanelets(*request(42.0, 58.0)), 3U);
+  EXPECT_EQ(count_lanelets(*request(42.0, 58.0, 22.0, 38.0)), 2U);
+  // Both responses are cached separately
+  EXPECT_EQ(m_node->response_cache_length(), 2U);
+}
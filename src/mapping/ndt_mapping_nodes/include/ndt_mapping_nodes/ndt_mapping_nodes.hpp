@@ -106,9 +106,10 @@ public:
   {
     if (m_map_ptr->size() > 0U) {
       const auto & file_name_prefix = m_prefix_generator.get(m_base_fn_prefix);
-      RCLCPP_DEBUG(get_logger(), "The map is written to" + file_name_prefix + ".pcd");
-      m_map_ptr->write(file_name_prefix);
+      m_map_ptr->write(file_name_prefix, m_map_writer);
     }
+    // Finish the queued writes while they can still be reported.
+    m_map_writer.wait();
   }
 
 private:
@@ -172,9 +173,14 @@ private:
             optimization_options},
       outlier_ratio);
     const auto & map_frame_id = this->declare_parameter("map.frame_id").template get<std::string>();
+    const auto localizer_map_config = parse_grid_config("localizer.map");
+    const auto max_voxel_points = static_cast<uint64_t>(
+      this->declare_parameter("localizer.map.max_voxel_points").template get<uint64_t>());
     m_map_ptr = std::make_unique<VoxelMap>(
       parse_grid_config("map"), map_frame_id,
-      NDTMap{parse_grid_config("localizer.map")});
+      NDTMap{localizer_map_config,
+        this->declare_parameter("localizer.map.defer_stabilization").template get<bool8_t>(),
+        max_voxel_points});
 
     if (this->declare_parameter("publish_map_increment").template get<bool8_t>()) {
       m_increment_publisher = this->template create_publisher<sensor_msgs::msg::PointCloud2>(
@@ -229,9 +235,11 @@ private:
         publish_tf(pose_to_transform(pose_out, msg_ptr->header.frame_id));
       }
       if (m_write_trigger.ready(*m_map_ptr)) {
+        // The map is written on the writer thread, so the following scans are not held up by it.
         const auto & file_name_prefix = m_prefix_generator.get(m_base_fn_prefix);
-        m_map_ptr->write(file_name_prefix);
-        RCLCPP_DEBUG(get_logger(), "The map is written to" + file_name_prefix + ".pcd");
+        m_map_ptr->write(file_name_prefix, m_map_writer);
+        RCLCPP_DEBUG(
+          get_logger(), "The map is queued to be written to " + file_name_prefix + ".pcd");
       }
       if (m_clear_trigger.ready(*m_map_ptr)) {
         RCLCPP_DEBUG(get_logger(), "The map is cleared.");
@@ -290,6 +298,18 @@ private:
     return m_cached_increment;
   }
 
+  /// Report the outcome of a map write. Called on the writer thread.
+  void report_write(const mapping::point_cloud_mapping::MapWriteResult & result)
+  {
+    if (result.success) {
+      RCLCPP_DEBUG(get_logger(), "The map is written to " + result.file_name);
+    } else {
+      RCLCPP_ERROR(
+        get_logger(), "Failed to write the map to %s: %s", result.file_name.c_str(),
+        result.error.c_str());
+    }
+  }
+
   /// Publish the given transform
   void publish_tf(const geometry_msgs::msg::TransformStamped & transform)
   {
@@ -364,6 +384,8 @@ private:
   PrefixGeneratorT m_prefix_generator{};
   bool8_t m_map_initialized{false};
   std::string m_base_fn_prefix;
+  mapping::point_cloud_mapping::AsyncMapWriter m_map_writer{
+    [this](const mapping::point_cloud_mapping::MapWriteResult & result) {report_write(result);}};
 };
 
 }  // namespace ndt_mapping_nodes
@@ -0,0 +1,141 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#ifndef POINT_CLOUD_MAPPING__MAP_WRITER_HPP_
+#define POINT_CLOUD_MAPPING__MAP_WRITER_HPP_
+
+#include <point_cloud_mapping/visibility_control.hpp>
+#include <common/types.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace autoware
+{
+namespace mapping
+{
+namespace point_cloud_mapping
+{
+using common::types::bool8_t;
+using common::types::float32_t;
+
+/// Writes x, y, z, intensity points into a binary pcd file through a fixed-size buffer, so
+/// that no intermediate cloud of the whole map is needed.
+class POINT_CLOUD_MAPPING_PUBLIC BinaryPcdWriter
+{
+public:
+  /// Number of points that are buffered before they are written to the file.
+  static constexpr std::size_t CHUNK_SIZE{4096U};
+
+  /// Open the file and write the header.
+  /// \param file_name Name of the file to create.
+  /// \param num_points Number of points that will be added.
+  /// \throws std::runtime_error if the file cannot be opened.
+  BinaryPcdWriter(const std::string & file_name, const std::size_t num_points);
+
+  /// Add a point to the file.
+  /// \throws std::length_error if more points than announced are added.
+  /// \throws std::runtime_error if writing fails.
+  void add(const float32_t x, const float32_t y, const float32_t z, const float32_t intensity);
+
+  /// Write the buffered points and close the file.
+  /// \throws std::length_error if fewer points than announced were added.
+  /// \throws std::runtime_error if writing fails.
+  void close();
+
+private:
+  void flush();
+
+  std::string m_file_name;
+  std::ofstream m_file;
+  std::vector<float32_t> m_chunk;
+  std::size_t m_num_points;
+  std::size_t m_num_added{0U};
+};
+
+/// Outcome of a map write.
+struct POINT_CLOUD_MAPPING_PUBLIC MapWriteResult
+{
+  std::string file_name;
+  std::size_t num_points;
+  bool8_t success;
+  /// Reason of the failure, empty on success.
+  std::string error;
+};
+
+/// Writes maps into files on a background thread, one after the other in the order they were
+/// queued. Completion of each write is reported to a callback that is called on the writer
+/// thread.
+class POINT_CLOUD_MAPPING_PUBLIC AsyncMapWriter
+{
+public:
+  using Callback = std::function<void (const MapWriteResult &)>;
+  /// Writes a map into the given file and returns the number of written points. Failures are
+  /// reported by throwing.
+  using WriteFunction = std::function<std::size_t(const std::string &)>;
+
+  /// Constructor, starts the writer thread.
+  /// \param callback Called on the writer thread after each write, may be empty.
+  explicit AsyncMapWriter(Callback callback = Callback{});
+
+  AsyncMapWriter(const AsyncMapWriter &) = delete;
+  AsyncMapWriter & operator=(const AsyncMapWriter &) = delete;
+
+  /// Destructor, finishes the queued writes and joins the writer thread.
+  ~AsyncMapWriter();
+
+  /// Queue a write and return immediately.
+  /// \param file_name Name of the file to write.
+  /// \param write_function Function doing the actual writing. It owns everything it needs, e.g.
+  /// a snapshot of the map.
+  void write(const std::string & file_name, WriteFunction write_function);
+
+  /// Block until all queued writes are finished.
+  void wait();
+
+  /// Number of writes that are queued or in progress.
+  std::size_t pending() const;
+
+private:
+  struct Job
+  {
+    std::string file_name;
+    WriteFunction write_function;
+  };
+
+  void writer_loop();
+
+  Callback m_callback;
+  mutable std::mutex m_mutex{};
+  std::condition_variable m_work_cv{};
+  std::condition_variable m_done_cv{};
+  std::deque<Job> m_jobs{};
+  /// Number of jobs that are queued or running, guarded by m_mutex.
+  std::size_t m_num_pending{0U};
+  bool8_t m_stop{false};
+  std::thread m_writer;
+};
+}  // namespace point_cloud_mapping
+}  // namespace mapping
+}  // namespace autoware
+
+#endif  // POINT_CLOUD_MAPPING__MAP_WRITER_HPP_
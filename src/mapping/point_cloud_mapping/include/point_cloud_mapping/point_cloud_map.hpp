@@ -17,6 +17,7 @@
 #ifndef POINT_CLOUD_MAPPING__POINT_CLOUD_MAP_HPP_
 #define POINT_CLOUD_MAPPING__POINT_CLOUD_MAP_HPP_
 
+#include <point_cloud_mapping/map_writer.hpp>
 #include <point_cloud_mapping/visibility_control.hpp>
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <voxel_grid/voxel_grid.hpp>
@@ -26,13 +27,8 @@
 #include <helper_functions/template_utils.hpp>
 #include <common/types.hpp>
 #include <time_utils/time_utils.hpp>
-#pragma GCC diagnostic push
-// silence unsafe signed <-> unsigned conversion
-#pragma GCC diagnostic ignored "-Wconversion"
-#pragma GCC diagnostic ignored "-Wsign-conversion"
-#pragma GCC diagnostic ignored "-Wuseless-cast"
-#include <pcl/io/pcd_io.h>
-#pragma GCC diagnostic pop
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -96,12 +92,16 @@ struct LocalizationMapConstraint
 /// A voxel grid is used for accumulating the lidar scans in a downsampled manner. A separate
 /// map is stored for the localizer implementation. The expected interface is defined via the
 /// `Requires` keyword.
+/// The voxel grid is shared copy-on-write with the snapshots taken for asynchronous writes, so
+/// queuing a write does not copy the grid, and clearing the map right after it does not either.
 template<typename LocalizerMapT, Requires = LocalizationMapConstraint<LocalizerMapT>::value>
 class POINT_CLOUD_MAPPING_PUBLIC DualVoxelMap
 {
 public:
   static constexpr auto NUM_FIELDS{4U};
   using Cloud = sensor_msgs::msg::PointCloud2;
+  using Grid = std::unordered_map<uint64_t,
+      perception::filters::voxel_grid::CentroidVoxel<common::types::PointXYZI>>;
 
   /// Constructor
   /// \param grid_config Grid configuration of the underlying voxel grid.
@@ -112,7 +112,7 @@ public:
     const std::string & frame_id,
     LocalizerMapT && localizer_map
   )
-  : m_grid_config{grid_config}, m_frame_id{frame_id},
+  : m_grid_config{grid_config}, m_grid{std::make_shared<Grid>()}, m_frame_id{frame_id},
     m_localizer_map{std::forward<LocalizerMapT>(localizer_map)} {}
 
   /// Try to extend the map with the given point cloud.
@@ -129,12 +129,13 @@ public:
     using PointXYZI = autoware::common::types::PointXYZI;
     point_cloud_msg_wrapper::PointCloud2View<PointXYZI> observation_view{observation};
 
-    ret.update_type = m_grid.empty() ? MapUpdateType::NEW : MapUpdateType::UPDATE;
+    auto & grid = mutable_grid();
+    ret.update_type = grid.empty() ? MapUpdateType::NEW : MapUpdateType::UPDATE;
     auto obs_idx = 0U;
     for (const auto & pt : observation_view) {
       const auto pt_key = m_grid_config.index(pt);
-      if (m_grid.size() >= capacity() &&
-        m_grid.find(pt_key) == m_grid.end())
+      if (grid.size() >= capacity() &&
+        grid.find(pt_key) == grid.end())
       {
         if (obs_idx == 0U) {
           ret.update_type = MapUpdateType::NO_CHANGE;
@@ -143,7 +144,7 @@ public:
         }
         break;
       }
-      m_grid[pt_key].add_observation(pt);
+      grid[pt_key].add_observation(pt);
       ++obs_idx;
     }
 
@@ -152,31 +153,30 @@ public:
     return ret;
   }
 
-  /// Convert the voxel grid to a point cloud and write it to a pcd file.
+  /// Write the voxel centroids to a binary pcd file.
   /// \param file_name_prefix File name prefix of the file.
   void write(const std::string & file_name_prefix) const
   {
-    // TODO(yunus.caliskan) Remove dynamic allocations.
-    // pcl cloud is constructed here and the map is copied to it for sake
-    // of simplicity to be able to use the pcl library's pcd writer.
-    pcl::PointCloud<pcl::PointXYZI> cloud;
-    cloud.reserve(m_grid.size());
-    for (const auto & vx : m_grid) {
-      pcl::PointXYZI pt;
-      const auto & vx_pt = vx.second.get();
-      pt.x = vx_pt.x;
-      pt.y = vx_pt.y;
-      pt.z = vx_pt.z;
-      pt.intensity = vx_pt.intensity;
-      cloud.push_back(pt);
-    }
-    pcl::io::savePCDFile(file_name_prefix + ".pcd", cloud);
+    write_grid(*m_grid, file_name_prefix + ".pcd");
+  }
+
+  /// Queue writing the voxel centroids to a binary pcd file and return without waiting for it.
+  /// The written map is a snapshot of the current one, later changes are not part of the file.
+  /// \param file_name_prefix File name prefix of the file.
+  /// \param writer Writer that writes the snapshot on its own thread and reports the result.
+  void write(const std::string & file_name_prefix, AsyncMapWriter & writer) const
+  {
+    std::shared_ptr<const Grid> snapshot{m_grid};
+    writer.write(
+      file_name_prefix + ".pcd", [snapshot](const std::string & file_name) {
+        return write_grid(*snapshot, file_name);
+      });
   }
 
   /// Size of the voxel grid.
   std::size_t size() const noexcept
   {
-    return m_grid.size();
+    return m_grid->size();
   }
   /// Capacity of the voxel grid.
   std::size_t capacity() const noexcept
@@ -186,7 +186,12 @@ public:
   /// Clear the voxel grid.
   void clear()
   {
-    m_grid.clear();
+    if (is_shared()) {
+      // Leave the grid to the snapshots instead of copying it just to clear it.
+      m_grid = std::make_shared<Grid>();
+    } else {
+      m_grid->clear();
+    }
     m_localizer_map.clear();
   }
   /// Get the localizer map
@@ -203,13 +208,44 @@ public:
   /// Get if the map is empty
   bool empty()
   {
-    return m_grid.empty();
+    return m_grid->empty();
   }
 
 private:
+  /// Write the centroids of a grid to a binary pcd file in chunks.
+  /// \return Number of written points.
+  static std::size_t write_grid(const Grid & grid, const std::string & file_name)
+  {
+    BinaryPcdWriter writer{file_name, grid.size()};
+    for (const auto & vx : grid) {
+      const auto & vx_pt = vx.second.get();
+      writer.add(vx_pt.x, vx_pt.y, vx_pt.z, vx_pt.intensity);
+    }
+    writer.close();
+    return grid.size();
+  }
+
+  /// Check if a snapshot still refers to the grid.
+  bool is_shared() const noexcept
+  {
+    const auto shared = (m_grid.use_count() > 1);
+    // Snapshots are released on the writer thread. Make its reads of the grid happen before
+    // any modification here once the count has dropped.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return shared;
+  }
+
+  /// Get the grid for modification, copying it first if a snapshot still refers to it.
+  Grid & mutable_grid()
+  {
+    if (is_shared()) {
+      m_grid = std::make_shared<Grid>(*m_grid);
+    }
+    return *m_grid;
+  }
+
   perception::filters::voxel_grid::Config m_grid_config;
-  std::unordered_map<uint64_t,
-    perception::filters::voxel_grid::CentroidVoxel<common::types::PointXYZI>> m_grid;
+  std::shared_ptr<Grid> m_grid;
   std::string m_frame_id;
   LocalizerMapT m_localizer_map;
 };
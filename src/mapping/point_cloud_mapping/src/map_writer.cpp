@@ -0,0 +1,172 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <point_cloud_mapping/map_writer.hpp>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace autoware
+{
+namespace mapping
+{
+namespace point_cloud_mapping
+{
+namespace
+{
+constexpr std::size_t NUM_FIELDS{4U};
+}  // namespace
+
+constexpr std::size_t BinaryPcdWriter::CHUNK_SIZE;
+
+BinaryPcdWriter::BinaryPcdWriter(const std::string & file_name, const std::size_t num_points)
+: m_file_name{file_name},
+  m_file{file_name, std::ios::out | std::ios::binary | std::ios::trunc},
+  m_num_points{num_points}
+{
+  if (!m_file) {
+    throw std::runtime_error("Could not open " + m_file_name + " for writing.");
+  }
+  m_chunk.reserve(CHUNK_SIZE * NUM_FIELDS);
+  m_file <<
+    "# .PCD v0.7 - Point Cloud Data file format\n"
+    "VERSION 0.7\n"
+    "FIELDS x y z intensity\n"
+    "SIZE 4 4 4 4\n"
+    "TYPE F F F F\n"
+    "COUNT 1 1 1 1\n"
+    "WIDTH " << m_num_points << "\n"
+    "HEIGHT 1\n"
+    "VIEWPOINT 0 0 0 1 0 0 0\n"
+    "POINTS " << m_num_points << "\n"
+    "DATA binary\n";
+}
+
+void BinaryPcdWriter::add(
+  const float32_t x, const float32_t y, const float32_t z, const float32_t intensity)
+{
+  if (m_num_added >= m_num_points) {
+    throw std::length_error("More points were added to " + m_file_name + " than announced.");
+  }
+  m_chunk.push_back(x);
+  m_chunk.push_back(y);
+  m_chunk.push_back(z);
+  m_chunk.push_back(intensity);
+  ++m_num_added;
+  if (m_chunk.size() >= CHUNK_SIZE * NUM_FIELDS) {
+    flush();
+  }
+}
+
+void BinaryPcdWriter::close()
+{
+  if (m_num_added != m_num_points) {
+    throw std::length_error("Fewer points were added to " + m_file_name + " than announced.");
+  }
+  flush();
+  m_file.close();
+  if (!m_file) {
+    throw std::runtime_error("Could not close " + m_file_name + ".");
+  }
+}
+
+void BinaryPcdWriter::flush()
+{
+  m_file.write(
+    reinterpret_cast<const char *>(m_chunk.data()),
+    static_cast<std::streamsize>(m_chunk.size() * sizeof(float32_t)));
+  m_chunk.clear();
+  if (!m_file) {
+    throw std::runtime_error("Could not write to " + m_file_name + ".");
+  }
+}
+
+AsyncMapWriter::AsyncMapWriter(Callback callback)
+: m_callback{std::move(callback)},
+  m_writer{[this] {writer_loop();}}
+{
+}
+
+AsyncMapWriter::~AsyncMapWriter()
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stop = true;
+  }
+  m_work_cv.notify_one();
+  m_writer.join();
+}
+
+void AsyncMapWriter::write(const std::string & file_name, WriteFunction write_function)
+{
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_jobs.push_back({file_name, std::move(write_function)});
+    ++m_num_pending;
+  }
+  m_work_cv.notify_one();
+}
+
+void AsyncMapWriter::wait()
+{
+  std::unique_lock<std::mutex> lock{m_mutex};
+  m_done_cv.wait(lock, [this] {return m_num_pending == 0U;});
+}
+
+std::size_t AsyncMapWriter::pending() const
+{
+  std::lock_guard<std::mutex> lock{m_mutex};
+  return m_num_pending;
+}
+
+void AsyncMapWriter::writer_loop()
+{
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      // Queued writes are finished before stopping so that no map is lost on shutdown.
+      m_work_cv.wait(lock, [this] {return m_stop || !m_jobs.empty();});
+      if (m_jobs.empty()) {
+        return;
+      }
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+    MapWriteResult result{job.file_name, 0U, false, ""};
+    try {
+      result.num_points = job.write_function(job.file_name);
+      result.success = true;
+    } catch (const std::exception & e) {
+      result.error = e.what();
+    }
+    // Release what the job owns, e.g. a map snapshot, before the write is reported as done.
+    job.write_function = nullptr;
+    if (m_callback) {
+      m_callback(result);
+    }
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      --m_num_pending;
+    }
+    m_done_cv.notify_all();
+  }
+}
+
+}  // namespace point_cloud_mapping
+}  // namespace mapping
+}  // namespace autoware
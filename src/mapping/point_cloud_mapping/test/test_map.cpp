@@ -33,6 +33,9 @@ using autoware::mapping::point_cloud_mapping::MapUpdateType;
 using autoware::mapping::point_cloud_mapping::PclCloud;
 using autoware::mapping::point_cloud_mapping::VoxelMapContext;
 using autoware::mapping::point_cloud_mapping::DualVoxelMap;
+using autoware::mapping::point_cloud_mapping::AsyncMapWriter;
+using autoware::mapping::point_cloud_mapping::BinaryPcdWriter;
+using autoware::mapping::point_cloud_mapping::MapWriteResult;
 
 class VoxelMapTest : public ::testing::Test, public VoxelMapContext {};
 
@@ -93,6 +96,71 @@ TEST_F(VoxelMapTest, BasicIo) {
   EXPECT_THROW(add_update(2U, MapUpdateType::NEW, false_frame), std::runtime_error);
 }
 
+TEST_F(VoxelMapTest, AsyncWrite) {
+  constexpr auto map_frame = "map";
+  const auto grid_config = autoware::perception::filters::voxel_grid::Config(
+    m_min_point, m_max_point, m_voxel_size, m_capacity);
+  DualVoxelMap<DummyLocalizationMap> map{grid_config, map_frame, DummyLocalizationMap{}};
+
+  // The callback runs on the writer thread, wait() makes its results visible here.
+  std::vector<MapWriteResult> results;
+  AsyncMapWriter writer{[&results](const MapWriteResult & result) {results.push_back(result);}};
+
+  using autoware::mapping::point_cloud_mapping::make_pc_deviated;
+  map.update(make_pc_deviated(5U, 0U, map_frame, FIXED_DEVIATION));
+  const std::string fname_prefix{"map_test_async_fname"};
+  const auto fname = fname_prefix + ".pcd";
+  map.write(fname_prefix, writer);
+  // Changing the map after queuing the write does not change what is written.
+  map.update(make_pc_deviated(3U, 5U, map_frame, FIXED_DEVIATION));
+  EXPECT_EQ(map.size(), 8U);
+  map.clear();
+  map.update(make_pc_deviated(2U, 0U, map_frame, FIXED_DEVIATION));
+  EXPECT_EQ(map.size(), 2U);
+
+  writer.wait();
+  EXPECT_EQ(writer.pending(), 0U);
+  ASSERT_EQ(results.size(), 1U);
+  EXPECT_TRUE(results[0].success);
+  EXPECT_EQ(results[0].file_name, fname);
+  EXPECT_EQ(results[0].num_points, 5U);
+  PclCloud pcl_cloud;
+  pcl::io::loadPCDFile(fname, pcl_cloud);
+  autoware::mapping::point_cloud_mapping::check_pc(pcl_cloud, 5U);
+  remove(fname.c_str());
+
+  // Failures are reported through the callback as well.
+  map.write("/non/existent/directory/map", writer);
+  writer.wait();
+  ASSERT_EQ(results.size(), 2U);
+  EXPECT_FALSE(results[1].success);
+  EXPECT_FALSE(results[1].error.empty());
+}
+
+TEST_F(VoxelMapTest, ChunkedPcdWriter) {
+  const std::string fname{"map_test_chunked.pcd"};
+  // More points than fit into a chunk.
+  const auto num_points = BinaryPcdWriter::CHUNK_SIZE + 10U;
+  {
+    BinaryPcdWriter writer{fname, num_points};
+    for (auto idx = 0U; idx < num_points; ++idx) {
+      const auto val = static_cast<float32_t>(idx);
+      writer.add(val, val, val, val);
+    }
+    EXPECT_THROW(writer.add(0.0F, 0.0F, 0.0F, 0.0F), std::length_error);
+    writer.close();
+  }
+  PclCloud pcl_cloud;
+  pcl::io::loadPCDFile(fname, pcl_cloud);
+  autoware::mapping::point_cloud_mapping::check_pc(pcl_cloud, num_points);
+  remove(fname.c_str());
+
+  BinaryPcdWriter short_writer{fname, 2U};
+  short_writer.add(0.0F, 0.0F, 0.0F, 0.0F);
+  EXPECT_THROW(short_writer.close(), std::length_error);
+  remove(fname.c_str());
+}
+
 //////////////////////// helper function implementations ///////////////////////
 
 void autoware::mapping::point_cloud_mapping::check_pc(PclCloud & pc, std::size_t size)
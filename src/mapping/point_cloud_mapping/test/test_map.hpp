@@ -23,6 +23,13 @@
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <common/types.hpp>
 #include <point_cloud_mapping/point_cloud_map.hpp>
+#pragma GCC diagnostic push
+// silence unsafe signed <-> unsigned conversion
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wuseless-cast"
+#include <pcl/io/pcd_io.h>
+#pragma GCC diagnostic pop
 #include <vector>
 #include <string>
 
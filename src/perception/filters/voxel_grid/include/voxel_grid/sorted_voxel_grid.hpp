@@ -0,0 +1,259 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+/// \file
+/// \brief This file defines a voxel grid which reduces points to voxels by sorting them
+
+#ifndef VOXEL_GRID__SORTED_VOXEL_GRID_HPP_
+#define VOXEL_GRID__SORTED_VOXEL_GRID_HPP_
+
+#include <voxel_grid/config.hpp>
+#include <voxel_grid/voxels.hpp>
+#include <common/types.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace autoware
+{
+namespace perception
+{
+namespace filters
+{
+namespace voxel_grid
+{
+using autoware::common::types::bool8_t;
+
+/// \brief A voxel grid data structure for downsampling point clouds which does not allocate
+///        memory after construction.
+///
+/// Instead of looking up a voxel for every inserted point, points are buffered together with
+/// their voxel index. On reduce(), the buffered indices are radix sorted and the voxels are built
+/// in a single linear pass over the sorted points. The sort is stable, so every voxel observes its
+/// points in insertion order and ends up bit-identical to the same voxel of a VoxelGrid fed with
+/// the same points. Voxels are iterated in ascending order of their index.
+/// \tparam VoxelT The underlying voxel type, assumed to be a child class of Voxel with the
+///                addition of the add_observation(PointT) and configure(Config, uint64_t) methods
+template<typename VoxelT>
+class VOXEL_GRID_PUBLIC SortedVoxelGrid
+{
+  using Grid = std::vector<std::pair<uint64_t, VoxelT>>;
+  using IT = typename Grid::const_iterator;
+
+public:
+  using point_t = typename VoxelT::point_t;
+
+  /// \brief Constructor, preallocates all memory
+  /// \param[in] cfg The configuration class, its capacity bounds the number of voxels
+  /// \param[in] point_capacity The maximum number of points buffered between calls to clear()
+  /// \throw std::domain_error If point_capacity cannot be indexed with 32 bits
+  SortedVoxelGrid(const Config & cfg, const std::size_t point_capacity)
+  : m_config(cfg),
+    m_points(),
+    m_entries(),
+    m_scratch(),
+    m_histogram(),
+    m_voxels(),
+    m_max_index{0U}
+  {
+    if (point_capacity > static_cast<std::size_t>(std::numeric_limits<uint32_t>::max())) {
+      throw std::domain_error{"SortedVoxelGrid: point capacity exceeds 32 bit indices"};
+    }
+    m_points.reserve(point_capacity);
+    m_entries.reserve(point_capacity);
+    m_scratch.resize(point_capacity);
+    m_voxels.reserve(m_config.get_capacity());
+  }
+
+  /// \brief Buffers a point for the next call to reduce()
+  /// \param[in] pt The point to insert
+  /// \throw std::length_error If the point capacity is exhausted
+  void insert(const point_t & pt)
+  {
+    if (m_points.size() >= point_capacity()) {
+      throw std::length_error{"SortedVoxelGrid: insertion would overrun point capacity"};
+    }
+    const uint64_t idx = m_config.index(pt);
+    m_max_index = (idx > m_max_index) ? idx : m_max_index;
+    m_entries.push_back(Entry{idx, static_cast<uint32_t>(m_points.size())});
+    m_points.push_back(pt);
+  }
+  /// \brief Buffers many points, dispatches to the core insert method.
+  /// \tparam PointIT The iterator type
+  /// \param[in] begin The starting iterator
+  /// \param[in] end An iterator pointing one past the last element to be inserted.
+  template<typename PointIT>
+  void insert(const PointIT begin, const PointIT end)
+  {
+    for (PointIT it = begin; it != end; ++it) {
+      insert(*it);
+    }
+  }
+
+  /// \brief Builds the voxels from all points inserted since the last call to clear(). Voxels of
+  ///        a previous call are replaced.
+  /// \throw std::length_error If the points occupy more voxels than the configured capacity. The
+  ///                          grid is cleared in this case.
+  void reduce()
+  {
+    sort();
+    m_voxels.clear();
+    for (const Entry & entry : m_entries) {
+      if (m_voxels.empty() || (m_voxels.back().first != entry.index)) {
+        if (m_voxels.size() >= capacity()) {
+          clear();
+          throw std::length_error{"SortedVoxelGrid: reduction would overrun capacity"};
+        }
+        m_voxels.emplace_back(entry.index, VoxelT{});
+        //lint -e{523} NOLINT This is to support multiple voxel implementations
+        m_voxels.back().second.configure(m_config, entry.index);
+      }
+      m_voxels.back().second.add_observation(m_points[entry.point]);
+    }
+  }
+
+  /// \brief Returns an iterator to the first voxel built by the last call to reduce()
+  /// \return Iterator
+  IT begin() const
+  {
+    return cbegin();
+  }
+  /// \brief Returns an iterator to the first voxel built by the last call to reduce()
+  /// \return Iterator
+  IT cbegin() const
+  {
+    return m_voxels.cbegin();
+  }
+  /// \brief Returns an iterator to one past the last voxel built by the last call to reduce()
+  /// \return Iterator
+  IT end() const
+  {
+    return cend();
+  }
+  /// \brief Returns an iterator to one past the last voxel built by the last call to reduce()
+  /// \return Iterator
+  IT cend() const
+  {
+    return m_voxels.cend();
+  }
+  /// \brief Drops all buffered points and voxels, keeps the preallocated memory
+  void clear()
+  {
+    m_points.clear();
+    m_entries.clear();
+    m_voxels.clear();
+    m_max_index = 0U;
+  }
+  /// \brief Returns the number of voxels built by the last call to reduce()
+  std::size_t size() const
+  {
+    return m_voxels.size();
+  }
+  /// \brief Returns the preallocated voxel capacity of the voxel grid
+  /// \return The preallocated capacity
+  std::size_t capacity() const
+  {
+    return m_config.get_capacity();
+  }
+  /// \brief Returns the number of points buffered since the last call to clear()
+  std::size_t num_points() const
+  {
+    return m_points.size();
+  }
+  /// \brief Returns the preallocated point capacity of the voxel grid
+  /// \return The preallocated capacity
+  std::size_t point_capacity() const
+  {
+    return m_scratch.size();
+  }
+  /// \brief Whether the last call to reduce() built no voxels
+  /// \return True or false
+  bool8_t empty() const
+  {
+    return m_voxels.empty();
+  }
+
+private:
+  /// \brief A voxel index along with the position of its point in the point buffer
+  struct Entry
+  {
+    uint64_t index;
+    uint32_t point;
+  };
+
+  static constexpr uint32_t RADIX_BITS = 8U;
+  static constexpr std::size_t RADIX_SIZE = 1U << RADIX_BITS;
+
+  /// \brief Stable least significant digit radix sort of the entries by voxel index. Only the
+  ///        digits below the largest index are sorted, and digits shared by all entries are
+  ///        skipped.
+  void sort()
+  {
+    const std::size_t num_entries = m_entries.size();
+    for (uint32_t shift = 0U; (shift < 64U) && ((m_max_index >> shift) != 0U);
+      shift += RADIX_BITS)
+    {
+      m_histogram.fill(0U);
+      for (const Entry & entry : m_entries) {
+        ++m_histogram[digit(entry.index, shift)];
+      }
+      if (m_histogram[digit(m_entries.front().index, shift)] == num_entries) {
+        continue;
+      }
+      std::size_t offset = 0U;
+      for (std::size_t & count : m_histogram) {
+        const std::size_t bucket_size = count;
+        count = offset;
+        offset += bucket_size;
+      }
+      for (const Entry & entry : m_entries) {
+        m_scratch[m_histogram[digit(entry.index, shift)]++] = entry;
+      }
+      const auto scratch_end = m_scratch.cbegin() + static_cast<std::ptrdiff_t>(num_entries);
+      (void)std::copy(m_scratch.cbegin(), scratch_end, m_entries.begin());
+    }
+  }
+
+  /// \brief Extract a radix digit of a voxel index
+  static std::size_t digit(const uint64_t index, const uint32_t shift)
+  {
+    return static_cast<std::size_t>((index >> shift) & (RADIX_SIZE - 1U));
+  }
+
+  const Config m_config;
+  std::vector<point_t> m_points;
+  std::vector<Entry> m_entries;
+  std::vector<Entry> m_scratch;
+  std::array<std::size_t, RADIX_SIZE> m_histogram;
+  Grid m_voxels;
+  uint64_t m_max_index;
+};  // class SortedVoxelGrid
+
+template<typename VoxelT>
+constexpr uint32_t SortedVoxelGrid<VoxelT>::RADIX_BITS;
+template<typename VoxelT>
+constexpr std::size_t SortedVoxelGrid<VoxelT>::RADIX_SIZE;
+
+}  // namespace voxel_grid
+}  // namespace filters
+}  // namespace perception
+}  // namespace autoware
+
+#endif  // VOXEL_GRID__SORTED_VOXEL_GRID_HPP_
@@ -18,8 +18,12 @@
 #define TEST_VOXEL_GRID_HPP_
 
 #include <common/types.hpp>
+#include <algorithm>
 #include <memory>
 #include <limits>
+#include <random>
+#include <vector>
+#include "voxel_grid/sorted_voxel_grid.hpp"
 #include "voxel_grid/voxel_grid.hpp"
 
 using autoware::perception::filters::voxel_grid::PointXYZ;
@@ -28,6 +32,7 @@ using autoware::perception::filters::voxel_grid::Voxel;
 using autoware::perception::filters::voxel_grid::ApproximateVoxel;
 using autoware::perception::filters::voxel_grid::CentroidVoxel;
 using autoware::perception::filters::voxel_grid::VoxelGrid;
+using autoware::perception::filters::voxel_grid::SortedVoxelGrid;
 using autoware::perception::filters::voxel_grid::PointXYZIF;
 using autoware::common::types::bool8_t;
 using autoware::common::types::float32_t;
@@ -762,4 +767,140 @@ TYPED_TEST(TypedVoxelGridTest, approximate_voxel_grid)
   EXPECT_THROW(grid.insert(*(this->obs_points1.end() - 1)), std::length_error);
   EXPECT_THROW(grid.insert(*(this->obs_points1.end() - 2)), std::length_error);
 }
+
+/// sorted voxel grid yields the same voxels as the hashed voxel grid
+TYPED_TEST(TypedVoxelGridTest, sorted_centroid_voxel_grid)
+{
+  VoxelGrid<CentroidVoxel<TypeParam>> ref_grid{*this->cfg_ptr};
+  SortedVoxelGrid<CentroidVoxel<TypeParam>> grid{*this->cfg_ptr, this->obs_points1.size()};
+  EXPECT_TRUE(grid.empty());
+  EXPECT_EQ(grid.capacity(), this->capacity);
+  EXPECT_EQ(grid.point_capacity(), this->obs_points1.size());
+  // Scan 0
+  grid.insert(this->obs_points2.begin(), this->obs_points2.end());
+  EXPECT_EQ(grid.num_points(), this->obs_points2.size());
+  EXPECT_TRUE(grid.empty());
+  grid.reduce();
+  EXPECT_EQ(grid.size(), 4U);
+  // Voxels are in ascending order
+  uint64_t last_idx = 0U;
+  for (const auto & it : grid) {
+    EXPECT_LE(last_idx, it.first);
+    last_idx = it.first;
+    EXPECT_TRUE(this->check(it.second.get(), this->obs_points2));
+  }
+  grid.clear();
+  EXPECT_TRUE(grid.empty());
+  EXPECT_EQ(grid.num_points(), 0U);
+  // Scan 1, shuffled so voxels are hit in interleaved order
+  std::vector<TypeParam> scan(this->obs_points1.begin(), this->obs_points1.end() - 2);
+  std::mt19937 gen{42U};
+  std::shuffle(scan.begin(), scan.end(), gen);
+  ref_grid.insert(scan.begin(), scan.end());
+  grid.insert(scan.begin(), scan.end());
+  grid.reduce();
+  ASSERT_EQ(grid.size(), ref_grid.size());
+  for (const auto & it : grid) {
+    const auto ref_it = ref_grid.begin();
+    const auto ref = std::find_if(
+      ref_it, ref_grid.end(), [&it](const auto & ref_vx) {return ref_vx.first == it.first;});
+    ASSERT_NE(ref, ref_grid.end());
+    // Points are reduced in insertion order, so the centroids are bit-identical
+    EXPECT_EQ(it.second.count(), ref->second.count());
+    EXPECT_EQ(it.second.get().x, ref->second.get().x);
+    EXPECT_EQ(it.second.get().y, ref->second.get().y);
+    EXPECT_EQ(it.second.get().z, ref->second.get().z);
+  }
+  // Reducing again after more insertions accounts for all points
+  const auto first_count = grid.begin()->second.count();
+  grid.insert(this->obs_points1[0U]);
+  grid.reduce();
+  EXPECT_EQ(grid.size(), ref_grid.size());
+  EXPECT_EQ(grid.begin()->second.count(), first_count + 1U);
+  // Bad case: too many points
+  grid.insert(this->obs_points1[1U]);
+  EXPECT_EQ(grid.num_points(), grid.point_capacity());
+  EXPECT_THROW(grid.insert(this->obs_points1[2U]), std::length_error);
+  // Bad case: too many voxels, grid is cleared
+  grid.clear();
+  grid.insert(this->obs_points1.begin(), this->obs_points1.end());
+  EXPECT_THROW(grid.reduce(), std::length_error);
+  EXPECT_TRUE(grid.empty());
+  EXPECT_EQ(grid.num_points(), 0U);
+}
+
+/// sorted approximate voxel grid
+TYPED_TEST(TypedVoxelGridTest, sorted_approximate_voxel_grid)
+{
+  SortedVoxelGrid<ApproximateVoxel<TypeParam>> grid{*this->cfg_ptr, this->obs_points1.size()};
+  this->ref_points1[0U] = this->make(-0.5F, -0.5F, -0.5F);
+  this->ref_points1[1U] = this->make(0.5F, -0.5F, -0.5F);
+  this->ref_points1[2U] = this->make(-0.5F, 0.5F, -0.5F);
+  this->ref_points1[3U] = this->make(0.5F, 0.5F, -0.5F);
+  this->ref_points1[4U] = this->make(-0.5F, -0.5F, 0.5F);
+  this->ref_points1[5U] = this->make(0.5F, -0.5F, 0.5F);
+  this->ref_points1[6U] = this->make(-0.5F, 0.5F, 0.5F);
+  this->ref_points1[7U] = this->make(0.5F, 0.5F, 0.5F);
+  // Insert in reverse so the sort has to reorder the voxels
+  for (auto it = this->obs_points1.rbegin() + 2; it != this->obs_points1.rend(); ++it) {
+    grid.insert(*it);
+  }
+  grid.reduce();
+  ASSERT_EQ(grid.size(), this->ref_points1.size() - 1U);
+  std::size_t idx = 0U;
+  for (const auto & it : grid) {
+    EXPECT_EQ(it.first, idx);
+    EXPECT_TRUE(this->check(it.second.get(), this->ref_points1[idx]));
+    EXPECT_EQ(it.second.count(), 2U);
+    ++idx;
+  }
+}
+
+/// sorting large voxel indices over several radix digits
+TYPED_TEST(TypedVoxelGridTest, sorted_voxel_grid_large_indices)
+{
+  this->min_point.x = -130.0F;
+  this->min_point.y = -130.0F;
+  this->min_point.z = -3.0F;
+  this->max_point.x = 130.0F;
+  this->max_point.y = 130.0F;
+  this->max_point.z = 10.0F;
+  this->voxel_size.x = 0.1F;
+  this->voxel_size.y = 0.1F;
+  this->voxel_size.z = 0.1F;
+  constexpr std::size_t num_points = 5000U;
+  const Config cfg{this->min_point, this->max_point, this->voxel_size, num_points};
+  VoxelGrid<CentroidVoxel<TypeParam>> ref_grid{cfg};
+  SortedVoxelGrid<CentroidVoxel<TypeParam>> grid{cfg, num_points};
+  std::mt19937 gen{1234U};
+  std::uniform_real_distribution<float32_t> xy_dist{-140.0F, 140.0F};
+  std::uniform_real_distribution<float32_t> z_dist{-4.0F, 11.0F};
+  // Repeat to make sure the reused buffers are reset properly
+  for (std::size_t iter = 0U; iter < 3U; ++iter) {
+    for (std::size_t idx = 0U; idx < num_points; ++idx) {
+      // Visit some voxels several times
+      const float32_t scale = (idx % 4U == 0U) ? 0.01F : 1.0F;
+      const auto pt = this->make(scale * xy_dist(gen), scale * xy_dist(gen), scale * z_dist(gen));
+      ref_grid.insert(pt);
+      grid.insert(pt);
+    }
+    grid.reduce();
+    ASSERT_EQ(grid.size(), ref_grid.size());
+    uint64_t last_idx = 0U;
+    for (const auto & it : grid) {
+      EXPECT_LE(last_idx, it.first);
+      last_idx = it.first;
+      const auto ref = ref_grid.begin();
+      const auto found = std::find_if(
+        ref, ref_grid.end(), [&it](const auto & ref_vx) {return ref_vx.first == it.first;});
+      ASSERT_NE(found, ref_grid.end());
+      EXPECT_EQ(it.second.count(), found->second.count());
+      EXPECT_EQ(it.second.get().x, found->second.get().x);
+      EXPECT_EQ(it.second.get().y, found->second.get().y);
+      EXPECT_EQ(it.second.get().z, found->second.get().z);
+    }
+    ref_grid.clear();
+    grid.clear();
+  }
+}
 #endif  // TEST_VOXEL_GRID_HPP_
@@ -0,0 +1,74 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+/// \file
+/// \brief This file defines an instance of the VoxelCloudBase interface backed by a sorted grid
+#ifndef VOXEL_GRID_NODES__ALGORITHM__VOXEL_CLOUD_SORTED_HPP_
+#define VOXEL_GRID_NODES__ALGORITHM__VOXEL_CLOUD_SORTED_HPP_
+
+#include <voxel_grid/sorted_voxel_grid.hpp>
+#include <voxel_grid_nodes/algorithm/voxel_cloud_base.hpp>
+
+namespace autoware
+{
+namespace perception
+{
+namespace filters
+{
+namespace voxel_grid_nodes
+{
+namespace algorithm
+{
+/// \brief An instantiation of VoxelCloudBase for a SortedVoxelGrid, which does not allocate
+///        memory for voxels after construction.
+/// \tparam VoxelT The voxel type, CentroidVoxel or ApproximateVoxel of PointXYZIF
+template<typename VoxelT>
+class VOXEL_GRID_NODES_PUBLIC VoxelCloudSorted : public VoxelCloudBase
+{
+public:
+  /// \brief Constructor
+  /// \param[in] cfg Configuration struct for the voxel grid
+  /// \param[in] point_capacity Maximum number of points inserted between calls to get()
+  VoxelCloudSorted(const voxel_grid::Config & cfg, const std::size_t point_capacity);
+
+  /// \brief Inserts points into the voxel grid data structure, overwrites internal header
+  /// \param[in] msg A point cloud to insert into the voxel grid. Assumed to have the structure XYZI
+  /// \throw std::length_error If the points would overrun the point capacity, in which case
+  ///                          none of them are inserted
+  void insert(const sensor_msgs::msg::PointCloud2 & msg) override;
+
+  /// \brief Get accumulated downsampled points. Internally resets the internal grid. Header is
+  ///        taken from last insert
+  /// \return The downsampled point cloud
+  const sensor_msgs::msg::PointCloud2 & get() override;
+
+private:
+  sensor_msgs::msg::PointCloud2 m_cloud;
+  voxel_grid::SortedVoxelGrid<VoxelT> m_grid;
+};  // VoxelCloudSorted
+
+/// \brief Sorted counterpart of VoxelCloudCentroid
+using VoxelCloudSortedCentroid =
+  VoxelCloudSorted<voxel_grid::CentroidVoxel<voxel_grid::PointXYZIF>>;
+/// \brief Sorted counterpart of VoxelCloudApproximate
+using VoxelCloudSortedApproximate =
+  VoxelCloudSorted<voxel_grid::ApproximateVoxel<voxel_grid::PointXYZIF>>;
+}  // namespace algorithm
+}  // namespace voxel_grid_nodes
+}  // namespace filters
+}  // namespace perception
+}  // namespace autoware
+
+#endif  // VOXEL_GRID_NODES__ALGORITHM__VOXEL_CLOUD_SORTED_HPP_
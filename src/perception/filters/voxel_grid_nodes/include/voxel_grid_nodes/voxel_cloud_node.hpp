@@ -56,7 +56,14 @@ private:
   /// \brief Initialize state transition callbacks and voxel grid
   /// \param[in] cfg Configuration object for voxel grid
   /// \param[in] is_approximate whether to instantiate an approximate or centroid voxel grid
-  void VOXEL_GRID_NODES_LOCAL init(const voxel_grid::Config & cfg, const bool8_t is_approximate);
+  /// \param[in] use_sorted_grid whether to instantiate a sorted voxel grid, which does not
+  ///                            allocate memory after construction
+  /// \param[in] point_capacity maximum number of points per cloud for a sorted voxel grid
+  void VOXEL_GRID_NODES_LOCAL init(
+    const voxel_grid::Config & cfg,
+    const bool8_t is_approximate,
+    const bool8_t use_sorted_grid,
+    const std::size_t point_capacity);
 
   using Message = sensor_msgs::msg::PointCloud2;
 
@@ -20,6 +20,7 @@
 #include <voxel_grid_nodes/voxel_cloud_node.hpp>
 #include <voxel_grid_nodes/algorithm/voxel_cloud_approximate.hpp>
 #include <voxel_grid_nodes/algorithm/voxel_cloud_centroid.hpp>
+#include <voxel_grid_nodes/algorithm/voxel_cloud_sorted.hpp>
 #include <common/types.hpp>
 #include <rclcpp_components/register_node_macro.hpp>
 
@@ -84,8 +85,11 @@ VoxelCloudNode::VoxelCloudNode(
   const std::size_t capacity =
     static_cast<std::size_t>(declare_parameter("config.capacity").get<std::size_t>());
   const voxel_grid::Config cfg{min_point, max_point, voxel_size, capacity};
+  const bool8_t use_sorted_grid = declare_parameter("use_sorted_grid", false);
+  const std::size_t point_capacity = static_cast<std::size_t>(
+    declare_parameter("config.point_capacity", 100000));
   // Init
-  init(cfg, declare_parameter("is_approximate").get<bool8_t>());
+  init(cfg, declare_parameter("is_approximate").get<bool8_t>(), use_sorted_grid, point_capacity);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -107,10 +111,21 @@ void VoxelCloudNode::callback(const sensor_msgs::msg::PointCloud2::SharedPtr msg
   }
 }
 ////////////////////////////////////////////////////////////////////////////////
-void VoxelCloudNode::init(const voxel_grid::Config & cfg, const bool8_t is_approximate)
+void VoxelCloudNode::init(
+  const voxel_grid::Config & cfg,
+  const bool8_t is_approximate,
+  const bool8_t use_sorted_grid,
+  const std::size_t point_capacity)
 {
   // construct voxel grid
-  if (is_approximate) {
+  if (use_sorted_grid) {
+    if (is_approximate) {
+      m_voxelgrid_ptr = std::make_unique<algorithm::VoxelCloudSortedApproximate>(
+        cfg, point_capacity);
+    } else {
+      m_voxelgrid_ptr = std::make_unique<algorithm::VoxelCloudSortedCentroid>(cfg, point_capacity);
+    }
+  } else if (is_approximate) {
     m_voxelgrid_ptr = std::make_unique<algorithm::VoxelCloudApproximate>(cfg);
   } else {
     m_voxelgrid_ptr = std::make_unique<algorithm::VoxelCloudCentroid>(cfg);
@@ -19,10 +19,12 @@
 #include <rclcpp/rclcpp.hpp>
 #include <voxel_grid_nodes/algorithm/voxel_cloud_approximate.hpp>
 #include <voxel_grid_nodes/algorithm/voxel_cloud_centroid.hpp>
+#include <voxel_grid_nodes/algorithm/voxel_cloud_sorted.hpp>
 #include <voxel_grid_nodes/voxel_cloud_node.hpp>
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -32,6 +34,8 @@ using autoware::perception::filters::voxel_grid::Config;
 using autoware::perception::filters::voxel_grid_nodes::algorithm::VoxelCloudBase;
 using autoware::perception::filters::voxel_grid_nodes::algorithm::VoxelCloudApproximate;
 using autoware::perception::filters::voxel_grid_nodes::algorithm::VoxelCloudCentroid;
+using autoware::perception::filters::voxel_grid_nodes::algorithm::VoxelCloudSortedApproximate;
+using autoware::perception::filters::voxel_grid_nodes::algorithm::VoxelCloudSortedCentroid;
 
 using autoware::common::types::PointXYZI;
 using autoware::common::types::bool8_t;
@@ -201,6 +205,69 @@ TEST_F(CloudAlgorithm, Centroid)
   EXPECT_EQ(alg_ptr->get().width, 0U);
 }
 
+TEST_F(CloudAlgorithm, SortedApproximate)
+{
+  this->ref_points1[0U] = this->make(-0.5F, -0.5F, -0.5F);
+  this->ref_points1[1U] = this->make(0.5F, -0.5F, -0.5F);
+  this->ref_points1[2U] = this->make(-0.5F, 0.5F, -0.5F);
+  this->ref_points1[3U] = this->make(0.5F, 0.5F, -0.5F);
+  this->ref_points1[4U] = this->make(-0.5F, -0.5F, 0.5F);
+  this->ref_points1[5U] = this->make(0.5F, -0.5F, 0.5F);
+  this->ref_points1[6U] = this->make(-0.5F, 0.5F, 0.5F);
+  this->ref_points1[7U] = this->make(0.5F, 0.5F, 0.5F);
+  // initialize
+  alg_ptr = std::make_unique<VoxelCloudSortedApproximate>(*cfg_ptr, 2U * obs_points1.size());
+  // check initial
+  EXPECT_EQ(alg_ptr->get().width, 0U);
+  // add points
+  alg_ptr->insert(cloud1);
+  // get
+  EXPECT_EQ(alg_ptr->get().width, 4U);
+  alg_ptr->insert(cloud1);
+  EXPECT_TRUE(check(alg_ptr->get(), 4U));
+  // check empty
+  EXPECT_EQ(alg_ptr->get().width, 0U);
+  // add more points
+  alg_ptr->insert(cloud1);
+  alg_ptr->insert(cloud2);
+  // get again
+  EXPECT_TRUE(check(alg_ptr->get(), ref_points1.size()));
+  // check empty
+  EXPECT_EQ(alg_ptr->get().width, 0U);
+}
+
+TEST_F(CloudAlgorithm, SortedCentroid)
+{
+  // Sorted grid must reproduce the centroids of the hashed grid exactly
+  VoxelCloudCentroid ref_alg{*cfg_ptr};
+  alg_ptr = std::make_unique<VoxelCloudSortedCentroid>(*cfg_ptr, obs_points1.size() + 8U);
+  // check empty
+  EXPECT_EQ(alg_ptr->get().width, 0U);
+  for (std::size_t iter = 0U; iter < 2U; ++iter) {
+    alg_ptr->insert(cloud1);
+    alg_ptr->insert(cloud2);
+    ref_alg.insert(cloud1);
+    ref_alg.insert(cloud2);
+    const auto & cloud = alg_ptr->get();
+    const auto & ref_cloud = ref_alg.get();
+    ASSERT_EQ(cloud.width, ref_cloud.width);
+    point_cloud_msg_wrapper::PointCloud2View<PointXYZI> view{cloud};
+    point_cloud_msg_wrapper::PointCloud2View<PointXYZI> ref_view{ref_cloud};
+    for (const auto & pt : view) {
+      const auto found = std::find_if(
+        ref_view.begin(), ref_view.end(), [&pt](const PointXYZI & ref) {
+          return (pt.x == ref.x) && (pt.y == ref.y) && (pt.z == ref.z) &&
+          (pt.intensity == ref.intensity);
+        });
+      EXPECT_NE(found, ref_view.end());
+    }
+  }
+  // Bad case: too many points, none are inserted
+  alg_ptr->insert(cloud2);
+  EXPECT_THROW(alg_ptr->insert(cloud2), std::length_error);
+  EXPECT_EQ(alg_ptr->get().width, ref_points1.size());
+}
+
 TEST(VoxelGridNodes, Instantiate)
 {
   // Basic test to ensure that VoxelCloudNode can be instantiated
@@ -258,4 +325,9 @@ TEST(VoxelGridNodes, Instantiate)
   params.emplace_back("config.voxel_size.z", 1.0);
   node_options.parameter_overrides(params);
   ASSERT_NO_THROW(VoxelCloudNode{node_options});
+
+  params.emplace_back("use_sorted_grid", true);
+  params.emplace_back("config.point_capacity", 1000);
+  node_options.parameter_overrides(params);
+  ASSERT_NO_THROW(VoxelCloudNode{node_options});
 }
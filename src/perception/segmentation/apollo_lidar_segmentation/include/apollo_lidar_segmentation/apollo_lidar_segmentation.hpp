@@ -32,6 +32,7 @@
 #include <pcl_conversions/pcl_conversions.h>
 #include <pcl/common/transforms.h>
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -62,12 +63,15 @@ public:
   /// \param[in] use_constant_feature Enable input channel constant feature.
   /// \param[in] min_height The minimum height.
   /// \param[in] max_height The maximum height.
+  /// \param[in] num_threads The number of threads generating the features.
+  /// \throw std::domain_error If num_threads is zero.
   explicit ApolloLidarSegmentationPreProcessor(
     const tvm_utility::pipeline::InferenceEngineTVMConfig & config, int32_t range,
     bool8_t use_intensity_feature, bool8_t use_constant_feature, float32_t min_height,
-    float32_t max_height);
+    float32_t max_height, std::size_t num_threads = 1U);
 
-  /// \brief Transfer the input data to a TVM array.
+  /// \brief Transfer the input data to a TVM array. If the array is a float array in host
+  ///        memory, the features are generated directly into it.
   /// \param[in] pc_ptr Input pointcloud.
   /// \return A TVM array containing the pointcloud data.
   /// \throw std::runtime_error If the features are incorrectly configured.
@@ -78,6 +82,7 @@ private:
   const int64_t input_width;
   const int64_t input_height;
   const int64_t datatype_bytes;
+  const bool8_t direct_output;
   const std::shared_ptr<FeatureGenerator> feature_generator;
   TVMArrayContainer output;
 };
@@ -143,11 +148,13 @@ public:
   /// \param[in] height_thresh If it is non-negative, the points that are higher than the predicted
   ///                          object height by height_thresh are filtered out in the
   ///                          post-processing step.
+  /// \param[in] num_threads The number of threads generating the input features of the network.
+  /// \throw std::domain_error If num_threads is zero.
   explicit ApolloLidarSegmentation(
     int32_t range, float32_t score_threshold,
     bool8_t use_intensity_feature, bool8_t use_constant_feature, float32_t z_offset,
     float32_t min_height, float32_t max_height, float32_t objectness_thresh, int32_t min_pts_num,
-    float32_t height_thresh);
+    float32_t height_thresh, std::size_t num_threads = 1U);
 
   /// \brief Detect obstacles.
   /// \param[in] input Input pointcloud.
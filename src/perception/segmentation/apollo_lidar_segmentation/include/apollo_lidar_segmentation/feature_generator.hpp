@@ -23,7 +23,11 @@
 #include <apollo_lidar_segmentation/util.hpp>
 #include <apollo_lidar_segmentation/visibility_control.hpp>
 
+#include <helper_functions/thread_pool.hpp>
+
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 namespace autoware
 {
@@ -37,6 +41,12 @@ using autoware::common::types::bool8_t;
 using autoware::common::types::float32_t;
 
 /// \brief A FeatureMap generator based on channel feature information.
+///
+/// The grid is split into bands of rows, one per thread. The grid cell of every point is computed
+/// once and the points are sorted into their bands, keeping their input order within each band.
+/// Each band then accumulates only its own points and normalizes its cells, so the total work
+/// stays linear in the number of points. No partial grids need to be merged and the result does
+/// not depend on the number of threads.
 class APOLLO_LIDAR_SEGMENTATION_LOCAL FeatureGenerator
 {
 private:
@@ -45,6 +55,42 @@ private:
   const float32_t min_height_;
   const float32_t max_height_;
   std::shared_ptr<FeatureMapInterface> map_ptr_;
+  std::unique_ptr<common::helper_functions::ThreadPool> thread_pool_;
+  /// Number of point chunks and row bands, one per thread
+  std::size_t num_tasks_;
+  std::vector<int32_t> point_cells_;
+  /// Band of every grid row
+  std::vector<std::size_t> row_bands_;
+  /// Number of points of every band in every chunk, indexed by chunk * num_tasks_ + band, and
+  /// then the position of these points in band_points_
+  std::vector<std::size_t> chunk_band_counts_;
+  /// Indices of the points inside the grid, sorted by band and in input order within a band
+  std::vector<std::size_t> band_points_;
+  /// Start of every band in band_points_, followed by the total number of sorted points
+  std::vector<std::size_t> band_offsets_;
+
+  /// \brief The channels written by the point accumulation, a channel is nullptr if it is not
+  ///        configured.
+  struct Channels
+  {
+    float32_t * max_height_data;
+    float32_t * mean_height_data;
+    float32_t * count_data;
+    float32_t * top_intensity_data;
+    float32_t * mean_intensity_data;
+    float32_t * nonempty_data;
+  };
+
+  /// \brief First row of a band, band num_tasks_ gives the number of rows.
+  int32_t bandBegin(std::size_t band) const;
+
+  /// \brief Compute the grid cell of every point, -1 for points outside of the grid or the
+  ///        height limits, and sort the points inside the grid into their bands.
+  void computePointCells(const pcl::PointCloud<pcl::PointXYZI> & pc);
+
+  /// \brief Accumulate the points of a band of rows and normalize the rows of the band.
+  void generateBand(
+    const pcl::PointCloud<pcl::PointXYZI> & pc, const Channels & out, std::size_t band) const;
 
 public:
   /// \brief Constructor
@@ -55,15 +101,34 @@ public:
   /// \param[in] use_constant_feature Enable input channel constant feature.
   /// \param[in] min_height The minimum height.
   /// \param[in] max_height The maximum height.
+  /// \param[in] num_threads The number of threads generating the features, including the calling
+  ///                        thread.
+  /// \throw std::domain_error If num_threads is zero.
   explicit FeatureGenerator(
     int32_t width, int32_t height, int32_t range, bool8_t use_intensity_feature,
-    bool8_t use_constant_feature, float32_t min_height, float32_t max_height);
+    bool8_t use_constant_feature, float32_t min_height, float32_t max_height,
+    std::size_t num_threads = 1U);
 
   /// \brief Generate a FeatureMap based on the configured features of this object.
   /// \param[in] pc_ptr Pointcloud used to populate the generated FeatureMap.
   /// \return A shared pointer to the generated FeatureMap.
   std::shared_ptr<FeatureMapInterface> generate(
     const pcl::PointCloud<pcl::PointXYZI>::ConstPtr & pc_ptr);
+
+  /// \brief Generate the features directly into an external buffer, e.g. the input tensor of the
+  ///        network, instead of the FeatureMap owned by this object.
+  /// \param[in] pc_ptr Pointcloud used to populate the features.
+  /// \param[out] data Buffer receiving the first num_channels channels of the feature map, in the
+  ///                  same layout as FeatureMapInterface::map_data.
+  /// \param[in] num_channels The number of channels the buffer holds.
+  /// \throw std::runtime_error If num_channels exceeds the number of configured channels.
+  void generate(
+    const pcl::PointCloud<pcl::PointXYZI>::ConstPtr & pc_ptr, float32_t * data,
+    int32_t num_channels);
+
+  /// \brief Get the number of channels of the generated features.
+  /// \return The number of channels.
+  int32_t channels() const {return map_ptr_->channels;}
 };
 }  // namespace apollo_lidar_segmentation
 }  // namespace segmentation
@@ -23,6 +23,7 @@
 
 using autoware::common::types::bool8_t;
 using autoware::common::types::float32_t;
+using autoware::common::types::uchar8_t;
 using autoware_auto_perception_msgs::msg::BoundingBoxArray;
 using model_zoo::perception::lidar_obstacle_detection::baidu_cnn::onnx_bcnn::config;
 
@@ -37,14 +38,17 @@ namespace apollo_lidar_segmentation
 ApolloLidarSegmentationPreProcessor::ApolloLidarSegmentationPreProcessor(
   const tvm_utility::pipeline::InferenceEngineTVMConfig & config, int32_t range,
   bool8_t use_intensity_feature, bool8_t use_constant_feature, float32_t min_height,
-  float32_t max_height)
+  float32_t max_height, std::size_t num_threads)
 : input_channels(config.network_inputs[0].second[1]),
   input_width(config.network_inputs[0].second[2]),
   input_height(config.network_inputs[0].second[3]),
   datatype_bytes(config.tvm_dtype_bits / 8),
+  direct_output(
+    (config.tvm_device_type == kDLCPU) && (config.tvm_dtype_code == kDLFloat) &&
+    (datatype_bytes == sizeof(float32_t)) && (config.tvm_dtype_lanes == 1)),
   feature_generator(std::make_shared<FeatureGenerator>(
       input_width, input_height, range,
-      use_intensity_feature, use_constant_feature, min_height, max_height))
+      use_intensity_feature, use_constant_feature, min_height, max_height, num_threads))
 {
   // Allocate input variable
   std::vector<int64_t> shape_x{1, input_channels, input_width, input_height};
@@ -60,13 +64,23 @@ ApolloLidarSegmentationPreProcessor::ApolloLidarSegmentationPreProcessor(
 TVMArrayContainerVector ApolloLidarSegmentationPreProcessor::schedule(
   const pcl::PointCloud<pcl::PointXYZI>::ConstPtr & pc_ptr)
 {
-  // generate feature map
-  std::shared_ptr<FeatureMapInterface> feature_map_ptr = feature_generator->generate(pc_ptr);
-
-  if (feature_map_ptr->channels < input_channels) {
+  if (feature_generator->channels() < input_channels) {
     throw std::runtime_error("schedule: incorrect feature configuration");
   }
 
+  // generate the features in place if the input tensor lives in host memory
+  if (direct_output) {
+    const DLTensor * const tensor = output.getArray();
+    feature_generator->generate(
+      pc_ptr,
+      reinterpret_cast<float32_t *>(static_cast<uchar8_t *>(tensor->data) + tensor->byte_offset),
+      static_cast<int32_t>(input_channels));
+    return {output};
+  }
+
+  // generate feature map
+  std::shared_ptr<FeatureMapInterface> feature_map_ptr = feature_generator->generate(pc_ptr);
+
   TVMArrayCopyFromBytes(
     output.getArray(), feature_map_ptr->map_data.data(),
     input_channels * input_height * input_width * datatype_bytes);
@@ -113,7 +127,7 @@ ApolloLidarSegmentation::ApolloLidarSegmentation(
   int32_t range, float32_t score_threshold,
   bool8_t use_intensity_feature, bool8_t use_constant_feature, float32_t z_offset,
   float32_t min_height, float32_t max_height, float32_t objectness_thresh, int32_t min_pts_num,
-  float32_t height_thresh)
+  float32_t height_thresh, std::size_t num_threads)
 : range_(range),
   score_threshold_(score_threshold),
   z_offset_(z_offset),
@@ -122,7 +136,8 @@ ApolloLidarSegmentation::ApolloLidarSegmentation(
   height_thresh_(height_thresh),
   pcl_pointcloud_ptr_(new pcl::PointCloud<pcl::PointXYZI>),
   PreP(std::make_shared<PrePT>(
-      config, range, use_intensity_feature, use_constant_feature, min_height, max_height)),
+      config, range, use_intensity_feature, use_constant_feature, min_height, max_height,
+      num_threads)),
   IE(std::make_shared<IET>(config)),
   PostP(std::make_shared<PostPT>(
       config, pcl_pointcloud_ptr_, range, objectness_thresh, score_threshold, height_thresh,
@@ -16,7 +16,12 @@
 #include <apollo_lidar_segmentation/log_table.hpp>
 #include <common/types.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <initializer_list>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
 using autoware::common::types::bool8_t;
@@ -39,12 +44,20 @@ inline float32_t normalizeIntensity(float32_t intensity) {return intensity / 255
 FeatureGenerator::FeatureGenerator(
   const int32_t width, const int32_t height, const int32_t range,
   const bool8_t use_intensity_feature, const bool8_t use_constant_feature,
-  const float32_t min_height, const float32_t max_height)
+  const float32_t min_height, const float32_t max_height, const std::size_t num_threads)
 : use_intensity_feature_(use_intensity_feature),
   use_constant_feature_(use_constant_feature),
   min_height_(min_height),
-  max_height_(max_height)
+  max_height_(max_height),
+  num_tasks_(num_threads)
 {
+  if (num_threads == 0U) {
+    throw std::domain_error("FeatureGenerator: number of threads must be positive");
+  }
+  if (num_threads > 1U) {
+    thread_pool_ = std::make_unique<common::helper_functions::ThreadPool>(num_threads);
+  }
+
   // select feature map type
   if (use_constant_feature && use_intensity_feature) {
     map_ptr_ = std::make_shared<FeatureMapWithConstantAndIntensity>(width, height, range);
@@ -56,62 +69,197 @@ FeatureGenerator::FeatureGenerator(
     map_ptr_ = std::make_shared<FeatureMap>(width, height, range);
   }
   map_ptr_->initializeMap(map_ptr_->map_data);
+
+  row_bands_.resize(static_cast<std::size_t>(height));
+  for (std::size_t band = 0U; band < num_tasks_; ++band) {
+    for (int32_t row = bandBegin(band); row < bandBegin(band + 1U); ++row) {
+      row_bands_[static_cast<std::size_t>(row)] = band;
+    }
+  }
+  chunk_band_counts_.resize(num_tasks_ * num_tasks_);
+  band_offsets_.resize(num_tasks_ + 1U);
+}
+
+int32_t FeatureGenerator::bandBegin(const std::size_t band) const
+{
+  return static_cast<int32_t>(
+    (static_cast<std::size_t>(map_ptr_->height) * band) / num_tasks_);
 }
 
 std::shared_ptr<FeatureMapInterface> FeatureGenerator::generate(
   const pcl::PointCloud<pcl::PointXYZI>::ConstPtr & pc_ptr)
 {
-  const float64_t epsilon = 1e-6;
-  map_ptr_->resetMap(map_ptr_->map_data);
+  generate(pc_ptr, map_ptr_->map_data.data(), map_ptr_->channels);
+  return map_ptr_;
+}
+
+void FeatureGenerator::generate(
+  const pcl::PointCloud<pcl::PointXYZI>::ConstPtr & pc_ptr, float32_t * data,
+  const int32_t num_channels)
+{
+  if (num_channels > map_ptr_->channels) {
+    throw std::runtime_error("generate: more channels requested than configured");
+  }
+  const std::ptrdiff_t size = map_ptr_->height * map_ptr_->width;
+  float32_t * const map_begin = map_ptr_->map_data.data();
+
+  // Channels which are part of the output buffer are written there, the others to the own map
+  const auto channel = [map_begin, data, num_channels, size](float32_t * map_channel) {
+      if (map_channel == nullptr) {
+        return map_channel;
+      }
+      const std::ptrdiff_t offset = map_channel - map_begin;
+      return (offset < num_channels * size) ? (data + offset) : map_channel;
+    };
+  const Channels out{
+    channel(map_ptr_->max_height_data),
+    channel(map_ptr_->mean_height_data),
+    channel(map_ptr_->count_data),
+    channel(map_ptr_->top_intensity_data),
+    channel(map_ptr_->mean_intensity_data),
+    channel(map_ptr_->nonempty_data)};
+
+  // The constant channels only need to be copied to an external buffer
+  for (float32_t * constant_data : {map_ptr_->direction_data, map_ptr_->distance_data}) {
+    float32_t * const out_data = channel(constant_data);
+    if (out_data != constant_data) {
+      (void)std::copy(constant_data, constant_data + size, out_data);
+    }
+  }
+
+  computePointCells(*pc_ptr);
+
+  const auto generate_band = [this, &pc_ptr, &out](const std::size_t band) {
+      generateBand(*pc_ptr, out, band);
+    };
+  if (thread_pool_) {
+    thread_pool_->run(num_tasks_, generate_band);
+  } else {
+    generate_band(0U);
+  }
+}
 
-  const int32_t size = map_ptr_->height * map_ptr_->width;
+void FeatureGenerator::computePointCells(const pcl::PointCloud<pcl::PointXYZI> & pc)
+{
+  const std::size_t num_points = pc.points.size();
+  point_cells_.resize(num_points);
+  band_points_.resize(num_points);
 
+  const float32_t range = static_cast<float32_t>(map_ptr_->range);
   const float32_t inv_res_x = 0.5f * map_ptr_->width / map_ptr_->range;
   const float32_t inv_res_y = 0.5f * map_ptr_->height / map_ptr_->range;
+  const auto chunk_begin = [this, num_points](const std::size_t chunk) {
+      return (num_points * chunk) / num_tasks_;
+    };
+
+  const auto compute_chunk = [this, &pc, &chunk_begin, range, inv_res_x,
+      inv_res_y](const std::size_t chunk) {
+      std::size_t * const counts = &chunk_band_counts_[chunk * num_tasks_];
+      std::fill(counts, counts + num_tasks_, 0U);
+      for (std::size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1U); ++i) {
+        point_cells_[i] = -1;
+        const pcl::PointXYZI & pt = pc.points[i];
+        if (pt.z <= min_height_ || max_height_ <= pt.z) {continue;}
+
+        // x on grid
+        const int32_t pos_x = static_cast<int32_t>(std::floor((range - pt.y) * inv_res_x));
+        // y on grid
+        const int32_t pos_y = static_cast<int32_t>(std::floor((range - pt.x) * inv_res_y));
+        if (pos_x < 0 || map_ptr_->width <= pos_x || pos_y < 0 || map_ptr_->height <= pos_y) {
+          continue;
+        }
+        point_cells_[i] = pos_y * map_ptr_->width + pos_x;
+        ++counts[row_bands_[static_cast<std::size_t>(pos_y)]];
+      }
+    };
+
+  // Counting sort of the points by band. Ordering by band first and chunk second keeps the
+  // points of a band in input order.
+  const auto sort_chunk = [this, &chunk_begin](const std::size_t chunk) {
+      std::size_t * const cursors = &chunk_band_counts_[chunk * num_tasks_];
+      for (std::size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1U); ++i) {
+        const int32_t idx = point_cells_[i];
+        if (idx < 0) {continue;}
+        const std::size_t band = row_bands_[static_cast<std::size_t>(idx / map_ptr_->width)];
+        band_points_[cursors[band]++] = i;
+      }
+    };
+
+  if (thread_pool_) {
+    thread_pool_->run(num_tasks_, compute_chunk);
+  } else {
+    compute_chunk(0U);
+  }
+  // Turn the counts into the position of every chunk's part of a band in band_points_
+  std::size_t offset = 0U;
+  for (std::size_t band = 0U; band < num_tasks_; ++band) {
+    band_offsets_[band] = offset;
+    for (std::size_t chunk = 0U; chunk < num_tasks_; ++chunk) {
+      std::size_t & count = chunk_band_counts_[chunk * num_tasks_ + band];
+      const std::size_t chunk_band_size = count;
+      count = offset;
+      offset += chunk_band_size;
+    }
+  }
+  band_offsets_[num_tasks_] = offset;
+  if (thread_pool_) {
+    thread_pool_->run(num_tasks_, sort_chunk);
+  } else {
+    sort_chunk(0U);
+  }
+}
+
+void FeatureGenerator::generateBand(
+  const pcl::PointCloud<pcl::PointXYZI> & pc, const Channels & out, const std::size_t band) const
+{
+  const float64_t epsilon = 1e-6;
+  const int32_t cell_begin = bandBegin(band) * map_ptr_->width;
+  const int32_t cell_end = bandBegin(band + 1U) * map_ptr_->width;
 
-  for (size_t i = 0; i < pc_ptr->points.size(); ++i) {
-    if (pc_ptr->points[i].z <= min_height_ || max_height_ <= pc_ptr->points[i].z) {continue;}
-
-    // x on grid
-    const int32_t pos_x =
-      static_cast<int32_t>(std::floor(
-        (static_cast<float32_t>(map_ptr_->range) -
-        pc_ptr->points[i].y) * inv_res_x));
-    // y on grid
-    const int32_t pos_y =
-      static_cast<int32_t>(std::floor(
-        (static_cast<float32_t>(map_ptr_->range) -
-        pc_ptr->points[i].x) * inv_res_y));
-    if (pos_x < 0 || map_ptr_->width <= pos_x || pos_y < 0 || map_ptr_->height <= pos_y) {continue;}
-
-    const int32_t idx = pos_y * map_ptr_->width + pos_x;
-
-    if (map_ptr_->max_height_data[idx] < pc_ptr->points[i].z) {
-      map_ptr_->max_height_data[idx] = pc_ptr->points[i].z;
-      if (map_ptr_->top_intensity_data != nullptr) {
-        map_ptr_->top_intensity_data[idx] = normalizeIntensity(pc_ptr->points[i].intensity);
+  for (int32_t i = cell_begin; i < cell_end; ++i) {
+    out.max_height_data[i] = -5.0f;
+    out.mean_height_data[i] = 0.0f;
+    out.count_data[i] = 0.0f;
+    out.nonempty_data[i] = 0.0f;
+  }
+  if (out.top_intensity_data != nullptr) {
+    std::fill(out.top_intensity_data + cell_begin, out.top_intensity_data + cell_end, 0.0f);
+  }
+  if (out.mean_intensity_data != nullptr) {
+    std::fill(out.mean_intensity_data + cell_begin, out.mean_intensity_data + cell_end, 0.0f);
+  }
+
+  // Points are visited in input order, so the result is the same for any partition of the rows
+  for (std::size_t j = band_offsets_[band]; j < band_offsets_[band + 1U]; ++j) {
+    const std::size_t i = band_points_[j];
+    const int32_t idx = point_cells_[i];
+    const pcl::PointXYZI & pt = pc.points[i];
+
+    if (out.max_height_data[idx] < pt.z) {
+      out.max_height_data[idx] = pt.z;
+      if (out.top_intensity_data != nullptr) {
+        out.top_intensity_data[idx] = normalizeIntensity(pt.intensity);
       }
     }
-    map_ptr_->mean_height_data[idx] += pc_ptr->points[i].z;
-    if (map_ptr_->mean_intensity_data != nullptr) {
-      map_ptr_->mean_intensity_data[idx] += normalizeIntensity(pc_ptr->points[i].intensity);
+    out.mean_height_data[idx] += pt.z;
+    if (out.mean_intensity_data != nullptr) {
+      out.mean_intensity_data[idx] += normalizeIntensity(pt.intensity);
     }
-    map_ptr_->count_data[idx] += 1.0f;
+    out.count_data[idx] += 1.0f;
   }
 
-  for (int32_t i = 0; i < size; ++i) {
-    if (static_cast<float64_t>(map_ptr_->count_data[i]) < epsilon) {
-      map_ptr_->max_height_data[i] = 0.0f;
+  for (int32_t i = cell_begin; i < cell_end; ++i) {
+    if (static_cast<float64_t>(out.count_data[i]) < epsilon) {
+      out.max_height_data[i] = 0.0f;
     } else {
-      map_ptr_->mean_height_data[i] /= map_ptr_->count_data[i];
-      if (map_ptr_->mean_intensity_data != nullptr) {
-        map_ptr_->mean_intensity_data[i] /= map_ptr_->count_data[i];
+      out.mean_height_data[i] /= out.count_data[i];
+      if (out.mean_intensity_data != nullptr) {
+        out.mean_intensity_data[i] /= out.count_data[i];
       }
-      map_ptr_->nonempty_data[i] = 1.0f;
+      out.nonempty_data[i] = 1.0f;
     }
-    map_ptr_->count_data[i] = calcApproximateLog(map_ptr_->count_data[i]);
+    out.count_data[i] = calcApproximateLog(out.count_data[i]);
   }
-  return map_ptr_;
 }
 }  // namespace apollo_lidar_segmentation
 }  // namespace segmentation
@@ -18,6 +18,7 @@
 #include <apollo_lidar_segmentation/apollo_lidar_segmentation.hpp>
 #include <tvm_utility/pipeline.hpp>
 
+#include <cstddef>
 #include <memory>
 #include <random>
 #include <string>
@@ -27,7 +28,9 @@ using autoware::common::types::float32_t;
 using autoware::common::types::uchar8_t;
 using autoware::perception::segmentation::apollo_lidar_segmentation::ApolloLidarSegmentation;
 
-void test_segmentation(bool use_intensity_feature, bool use_constant_feature, bool expect_throw)
+std::shared_ptr<const autoware_auto_perception_msgs::msg::BoundingBoxArray> test_segmentation(
+  bool use_intensity_feature, bool use_constant_feature, bool expect_throw,
+  std::size_t num_threads = 1U)
 {
   // Instantiate the pipeline
   const int width = 1;
@@ -42,7 +45,7 @@ void test_segmentation(bool use_intensity_feature, bool use_constant_feature, bo
   const float32_t height_thresh = 0.5f;
   ApolloLidarSegmentation segmentation(range, score_threshold, use_intensity_feature,
     use_constant_feature, z_offset, min_height, max_height, objectness_thresh, min_pts_num,
-    height_thresh);
+    height_thresh, num_threads);
 
   std::random_device rd;
   std::mt19937 gen(42);
@@ -80,6 +83,7 @@ void test_segmentation(bool use_intensity_feature, bool use_constant_feature, bo
     has_thrown = true;
   }
   EXPECT_EQ(expect_throw, has_thrown);
+  return output;
 }
 
 // Test configuration matching the default-provided network.
@@ -97,3 +101,12 @@ TEST(apollo_lidar_segmentation, others) {
   test_segmentation(false, true, false);
   test_segmentation(true, true, false);
 }
+
+// Test that the feature generation gives the same result on several threads.
+TEST(apollo_lidar_segmentation, multi_threaded) {
+  const auto expected = test_segmentation(true, false, false);
+  const auto output = test_segmentation(true, false, false, 3U);
+  ASSERT_NE(nullptr, expected);
+  ASSERT_NE(nullptr, output);
+  EXPECT_EQ(*expected, *output);
+}
@@ -0,0 +1,96 @@
+// Copyright 2021 Arm Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <common/types.hpp>
+
+#include <gtest/gtest.h>
+#include <apollo_lidar_segmentation/feature_generator.hpp>
+
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using autoware::common::types::bool8_t;
+using autoware::common::types::float32_t;
+using autoware::perception::segmentation::apollo_lidar_segmentation::FeatureGenerator;
+
+namespace
+{
+pcl::PointCloud<pcl::PointXYZI>::ConstPtr make_cloud(const std::size_t num_points)
+{
+  std::mt19937 gen(42);
+  // Part of the points falls outside of the grid or the height limits
+  std::uniform_real_distribution<float32_t> dis_xy(-80.0f, 80.0f);
+  std::uniform_real_distribution<float32_t> dis_z(-6.0f, 6.0f);
+  std::uniform_real_distribution<float32_t> dis_intensity(0.0f, 255.0f);
+  pcl::PointCloud<pcl::PointXYZI>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZI>);
+  cloud->points.resize(num_points);
+  for (auto & pt : cloud->points) {
+    pt.x = dis_xy(gen);
+    pt.y = dis_xy(gen);
+    pt.z = dis_z(gen);
+    pt.intensity = dis_intensity(gen);
+  }
+  return cloud;
+}
+
+std::vector<float32_t> generate_features(
+  const pcl::PointCloud<pcl::PointXYZI>::ConstPtr & cloud, const bool8_t use_intensity_feature,
+  const bool8_t use_constant_feature, const std::size_t num_threads)
+{
+  FeatureGenerator generator(
+    64, 64, 70, use_intensity_feature, use_constant_feature, -5.0f, 5.0f, num_threads);
+  // Run twice to check that nothing is left over from a previous cloud
+  (void)generator.generate(make_cloud(500U));
+  return generator.generate(cloud)->map_data;
+}
+}  // namespace
+
+// Test that the feature maps do not depend on the number of threads.
+TEST(feature_generator, multi_threaded) {
+  const auto cloud = make_cloud(20000U);
+  for (const bool8_t use_intensity_feature : {false, true}) {
+    for (const bool8_t use_constant_feature : {false, true}) {
+      const auto expected =
+        generate_features(cloud, use_intensity_feature, use_constant_feature, 1U);
+      for (const std::size_t num_threads : {2U, 3U, 7U}) {
+        EXPECT_EQ(
+          expected,
+          generate_features(cloud, use_intensity_feature, use_constant_feature, num_threads)) <<
+          "intensity " << use_intensity_feature << ", constant " << use_constant_feature <<
+          ", threads " << num_threads;
+      }
+    }
+  }
+}
+
+// Test that features generated into an external buffer match the own feature map.
+TEST(feature_generator, external_buffer) {
+  const auto cloud = make_cloud(20000U);
+  FeatureGenerator generator(64, 64, 70, true, true, -5.0f, 5.0f, 3U);
+  const auto expected = generator.generate(cloud)->map_data;
+  const int32_t num_channels = generator.channels() - 1;
+  std::vector<float32_t> buffer(expected.size() / static_cast<std::size_t>(generator.channels()) *
+    static_cast<std::size_t>(num_channels));
+  generator.generate(cloud, buffer.data(), num_channels);
+  EXPECT_EQ(std::vector<float32_t>(expected.begin(), expected.begin() + buffer.size()), buffer);
+  EXPECT_THROW(
+    generator.generate(cloud, buffer.data(), generator.channels() + 1),
+    std::runtime_error);
+}
+
+TEST(feature_generator, zero_threads) {
+  EXPECT_THROW(FeatureGenerator(64, 64, 70, true, false, -5.0f, 5.0f, 0U), std::domain_error);
+}
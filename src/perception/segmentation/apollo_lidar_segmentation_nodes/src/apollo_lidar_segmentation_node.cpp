@@ -17,7 +17,10 @@
 #include <rclcpp_components/register_node_macro.hpp>
 #include <common/types.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
 
 using autoware::common::types::bool8_t;
 using autoware::common::types::float32_t;
@@ -32,6 +35,16 @@ namespace segmentation
 {
 namespace apollo_lidar_segmentation_nodes
 {
+namespace
+{
+std::size_t toNumThreads(const int64_t num_threads)
+{
+  if (num_threads < 1) {
+    throw std::domain_error("num_threads must be at least 1");
+  }
+  return static_cast<std::size_t>(num_threads);
+}
+}  // namespace
 
 ApolloLidarSegmentationNode::ApolloLidarSegmentationNode(const rclcpp::NodeOptions & options)
 : Node("apollo_lidar_segmentation", options),
@@ -55,7 +68,8 @@ m_detector_ptr{std::make_shared<apollo_lidar_segmentation::ApolloLidarSegmentati
     declare_parameter("max_height", rclcpp::ParameterValue{5.0}).get<float32_t>(),
     declare_parameter("objectness_thresh", rclcpp::ParameterValue{0.5}).get<float32_t>(),
     declare_parameter("min_pts_num", rclcpp::ParameterValue{3}).get<int32_t>(),
-    declare_parameter("height_thresh", rclcpp::ParameterValue{0.5}).get<float32_t>())}
+    declare_parameter("height_thresh", rclcpp::ParameterValue{0.5}).get<float32_t>(),
+    toNumThreads(declare_parameter("num_threads", rclcpp::ParameterValue{1}).get<int64_t>()))}
 {
 }
 
@@ -0,0 +1,127 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+/// \file
+/// \brief This file defines a lock-free disjoint set (union-find) data structure
+
+#ifndef EUCLIDEAN_CLUSTER__CONCURRENT_DISJOINT_SET_HPP_
+#define EUCLIDEAN_CLUSTER__CONCURRENT_DISJOINT_SET_HPP_
+
+#include <euclidean_cluster/visibility_control.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace autoware
+{
+namespace perception
+{
+namespace segmentation
+{
+namespace euclidean_cluster
+{
+namespace details
+{
+/// \brief Disjoint set forest over the indices [0, size) which supports concurrent unite() and
+///        find() calls from multiple threads without locks.
+///
+/// Roots are always linked below the smaller root, so the representative of every set is its
+/// lowest index, independent of the order in which sets were merged.
+class EUCLIDEAN_CLUSTER_PUBLIC ConcurrentDisjointSet
+{
+public:
+  /// \brief Constructor, preallocates all memory
+  /// \param[in] capacity The maximum number of elements
+  explicit ConcurrentDisjointSet(const std::size_t capacity)
+  : m_parents(capacity),
+    m_size{0U}
+  {
+  }
+
+  /// \brief Make every element of [0, size) a singleton set. Not thread safe.
+  /// \param[in] size The number of elements
+  /// \throw std::length_error If size exceeds the capacity
+  void reset(const std::size_t size)
+  {
+    if (size > m_parents.size()) {
+      throw std::length_error{"ConcurrentDisjointSet: size exceeds capacity"};
+    }
+    for (std::size_t idx = 0U; idx < size; ++idx) {
+      m_parents[idx].store(idx, std::memory_order_relaxed);
+    }
+    m_size = size;
+  }
+
+  /// \brief Get the number of elements
+  std::size_t size() const
+  {
+    return m_size;
+  }
+
+  /// \brief Find the representative of the set containing an element
+  /// \param[in] idx The element
+  /// \return The lowest index of the set once all concurrent unite() calls have returned
+  std::size_t find(std::size_t idx)
+  {
+    std::size_t parent = m_parents[idx].load(std::memory_order_relaxed);
+    while (parent != idx) {
+      const std::size_t grandparent = m_parents[parent].load(std::memory_order_relaxed);
+      // Path splitting. A non-root only ever points further up its tree, so racing with another
+      // thread doing the same can at worst skip less of the path
+      if (grandparent != parent) {
+        m_parents[idx].store(grandparent, std::memory_order_relaxed);
+      }
+      idx = parent;
+      parent = grandparent;
+    }
+    return idx;
+  }
+
+  /// \brief Merge the sets containing two elements
+  /// \param[in] first An element
+  /// \param[in] second Another element
+  void unite(std::size_t first, std::size_t second)
+  {
+    while (true) {
+      first = find(first);
+      second = find(second);
+      if (first == second) {
+        return;
+      }
+      if (first < second) {
+        std::swap(first, second);
+      }
+      // Only succeeds if first is still a root; otherwise another thread linked it, so retry
+      std::size_t expected = first;
+      if (m_parents[first].compare_exchange_strong(expected, second)) {
+        return;
+      }
+    }
+  }
+
+private:
+  std::vector<std::atomic<std::size_t>> m_parents;
+  std::size_t m_size;
+};  // class ConcurrentDisjointSet
+}  // namespace details
+}  // namespace euclidean_cluster
+}  // namespace segmentation
+}  // namespace perception
+}  // namespace autoware
+
+#endif  // EUCLIDEAN_CLUSTER__CONCURRENT_DISJOINT_SET_HPP_
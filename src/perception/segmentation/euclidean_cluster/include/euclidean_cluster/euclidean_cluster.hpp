@@ -19,13 +19,16 @@
 #ifndef EUCLIDEAN_CLUSTER__EUCLIDEAN_CLUSTER_HPP_
 #define EUCLIDEAN_CLUSTER__EUCLIDEAN_CLUSTER_HPP_
 #include <euclidean_cluster/visibility_control.hpp>
+#include <euclidean_cluster/concurrent_disjoint_set.hpp>
 
 #include <autoware_auto_perception_msgs/msg/bounding_box_array.hpp>
 #include <autoware_auto_perception_msgs/msg/detected_objects.hpp>
 #include <autoware_auto_perception_msgs/msg/point_clusters.hpp>
 #include <geometry/spatial_hash.hpp>
 #include <common/types.hpp>
+#include <helper_functions/thread_pool.hpp>
 #include <limits>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -84,8 +87,10 @@ private:
   float32_t m_r_xy;
 };  // class PointXYZIR
 
-using HashConfig = autoware::common::geometry::spatial_hash::Config2d;
-using Hash = autoware::common::geometry::spatial_hash::SpatialHash2d<PointXYZIR>;
+/// Points are inserted once per scan and then only queried and removed, so the flat, preallocated
+/// spatial hash layout is used
+using HashConfig = autoware::common::geometry::spatial_hash::FlatConfig2d;
+using Hash = autoware::common::geometry::spatial_hash::FlatSpatialHash2d<PointXYZIR>;
 using Clusters = autoware_auto_perception_msgs::msg::PointClusters;
 
 class EUCLIDEAN_CLUSTER_PUBLIC FilterConfig
@@ -150,19 +155,27 @@ public:
   ///                                    r = cluster_threshold_saturation_distance
   /// \param[in] cluster_threshold_saturation_distance_m The distance at which the cluster threshold
   ///                                                    is clamped to the maximum value
+  /// \param[in] num_threads The number of threads used for clustering. With more than one thread,
+  ///                        clusters are found as connected components using a parallel
+  ///                        union-find instead of serial region growing
+  /// \throw std::domain_error If num_threads is zero
   Config(
     const std::string & frame_id,
     const std::size_t min_number_of_points_in_cluster,
     const std::size_t max_num_clusters,
     const float32_t min_cluster_threshold_m,
     const float32_t max_cluster_threshold_m,
-    const float32_t cluster_threshold_saturation_distance_m);
+    const float32_t cluster_threshold_saturation_distance_m,
+    const std::size_t num_threads = 1U);
   /// \brief Gets minimum number of points needed for a cluster to not be considered noise
   /// \return Minimum cluster size
   std::size_t min_number_of_points_in_cluster() const;
   /// \brief Gets maximum preallocated number of clusters
   /// \return Maximum number of clusters
   std::size_t max_num_clusters() const;
+  /// \brief Gets the number of threads used for clustering
+  /// \return Number of threads
+  std::size_t num_threads() const;
   /// \brief Compute the connectivity threshold for a given point
   /// \param[in] pt The point whose connectivity criterion will be calculated
   /// \return The connectivity threshold, in meters
@@ -186,6 +199,7 @@ private:
   const float32_t m_min_thresh_m;
   const float32_t m_max_distance_m;
   const float32_t m_thresh_rate;
+  const std::size_t m_num_threads;
 };  // class Config
 
 /// \brief implementation of euclidean clustering for point cloud segmentation
@@ -232,6 +246,10 @@ public:
   /// \brief Compute the clusters from the inserted points, where the final clusters object lives in
   ///        another scope.
   /// \param[inout] clusters The clusters object
+  ///
+  /// In multi-threaded mode the same clusters are found as in single-threaded mode, but they are
+  /// ordered by their first point in insertion order, and points within a cluster are in insertion
+  /// order. If there are too many clusters, which clusters are dropped may differ between modes.
   void cluster(Clusters & clusters);
 
   /// \brief Gets last error, intended to be used with clustering with internal cluster result
@@ -261,6 +279,15 @@ private:
   };  // struct PointXYZ
   /// \brief Do the clustering process, with no error checking
   EUCLIDEAN_CLUSTER_LOCAL void cluster_impl(Clusters & clusters);
+  /// \brief Do the clustering process as a parallel connected components search
+  EUCLIDEAN_CLUSTER_LOCAL void cluster_impl_parallel(Clusters & clusters);
+  /// \brief Group the indices of the points taken from the hash by spatial hash bin
+  EUCLIDEAN_CLUSTER_LOCAL void bucket_points();
+  /// \brief Unite all connected pairs of points where the first point lies in the given tile, a
+  ///        contiguous range of bins
+  EUCLIDEAN_CLUSTER_LOCAL void connect_tile(const std::size_t tile, const std::size_t num_tiles);
+  /// \brief Write all large enough components to the clusters object, in order of their root
+  EUCLIDEAN_CLUSTER_LOCAL void emit_components(Clusters & clusters);
   /// \brief Compute the next cluster, seeded by the given point, and grown using the remaining
   ///         points still contained in the hash
   EUCLIDEAN_CLUSTER_LOCAL void cluster(Clusters & clusters, const Hash::IT it);
@@ -276,10 +303,19 @@ private:
   EUCLIDEAN_CLUSTER_LOCAL static std::size_t last_cluster_size(const Clusters & clusters);
 
   const Config m_config;
+  const HashConfig m_hash_config;
   Hash m_hash;
   const FilterConfig m_filter_config;
   Error m_last_error;
   std::vector<bool8_t> m_seen;
+  // Multi-threaded mode only
+  std::unique_ptr<common::helper_functions::ThreadPool> m_thread_pool;
+  std::vector<PointXYZIR> m_points;
+  std::vector<std::size_t> m_point_bins;
+  std::vector<std::size_t> m_bin_offsets;
+  std::vector<std::size_t> m_binned_points;
+  std::vector<std::size_t> m_component_offsets;
+  details::ConcurrentDisjointSet m_components;
 };  // class EuclideanCluster
 
 /// \brief Common euclidean cluster functions not intended for external use
@@ -17,6 +17,8 @@
 #include <cstring>
 //lint -e537 NOLINT Repeated include file: pclint vs cpplint
 #include <algorithm>
+#include <limits>
+#include <numeric>
 #include <string>
 //lint -e537 NOLINT Repeated include file: pclint vs cpplint
 #include <utility>
@@ -82,16 +84,21 @@ Config::Config(
   const std::size_t max_num_clusters,
   const float32_t min_cluster_threshold_m,
   const float32_t max_cluster_threshold_m,
-  const float32_t cluster_threshold_saturation_distance_m)
+  const float32_t cluster_threshold_saturation_distance_m,
+  const std::size_t num_threads)
 : m_frame_id(frame_id),
   m_min_number_of_points_in_cluster(min_number_of_points_in_cluster),
   m_max_num_clusters(max_num_clusters),
   m_min_thresh_m(min_cluster_threshold_m),
   m_max_distance_m(cluster_threshold_saturation_distance_m),
   m_thresh_rate((max_cluster_threshold_m - min_cluster_threshold_m) /
-    cluster_threshold_saturation_distance_m)
+    cluster_threshold_saturation_distance_m),
+  m_num_threads(num_threads)
 {
   // TODO(c.ho) sanity checking
+  if (m_num_threads == 0U) {
+    throw std::domain_error{"EuclideanCluster: must use at least one thread"};
+  }
 }
 ////////////////////////////////////////////////////////////////////////////////
 FilterConfig::FilterConfig(
@@ -124,6 +131,11 @@ std::size_t Config::max_num_clusters() const
   return m_max_num_clusters;
 }
 ////////////////////////////////////////////////////////////////////////////////
+std::size_t Config::num_threads() const
+{
+  return m_num_threads;
+}
+////////////////////////////////////////////////////////////////////////////////
 float32_t Config::threshold(const PointXYZIR & pt) const
 {
   return threshold(pt.get_r());
@@ -144,10 +156,29 @@ EuclideanCluster::EuclideanCluster(
   const Config & cfg, const HashConfig & hash_cfg,
   const FilterConfig & filter_cfg)
 : m_config(cfg),
+  m_hash_config(hash_cfg),
   m_hash(hash_cfg),
   m_filter_config(filter_cfg),
-  m_last_error(Error::NONE)
-{}
+  m_last_error(Error::NONE),
+  m_thread_pool(nullptr),
+  m_points(),
+  m_point_bins(),
+  m_bin_offsets(),
+  m_binned_points(),
+  m_component_offsets(),
+  m_components(cfg.num_threads() > 1U ? hash_cfg.get_capacity() : 0U)
+{
+  if (cfg.num_threads() > 1U) {
+    // Preallocate everything so that clustering does not allocate
+    const std::size_t capacity = hash_cfg.get_capacity();
+    m_thread_pool = std::make_unique<common::helper_functions::ThreadPool>(cfg.num_threads());
+    m_points.reserve(capacity);
+    m_point_bins.reserve(capacity);
+    m_bin_offsets.resize(hash_cfg.get_num_bins() + 1U);
+    m_binned_points.reserve(capacity);
+    m_component_offsets.reserve(capacity);
+  }
+}
 ////////////////////////////////////////////////////////////////////////////////
 bool Config::match_clusters_size(const Clusters & clusters) const
 {
@@ -202,7 +233,11 @@ void EuclideanCluster::cluster(Clusters & clusters)
   // Clean the previous clustering result
   clusters.points.clear();
   clusters.cluster_boundary.clear();
-  cluster_impl(clusters);
+  if (m_thread_pool) {
+    cluster_impl_parallel(clusters);
+  } else {
+    cluster_impl(clusters);
+  }
 }
 ////////////////////////////////////////////////////////////////////////////////
 void EuclideanCluster::throw_stored_error() const
@@ -243,6 +278,126 @@ void EuclideanCluster::cluster_impl(Clusters & clusters)
   }
 }
 ////////////////////////////////////////////////////////////////////////////////
+void EuclideanCluster::cluster_impl_parallel(Clusters & clusters)
+{
+  m_last_error = Error::NONE;
+  // Take all points out of the hash, in insertion order
+  m_points.clear();
+  for (const auto & bin_and_point : m_hash) {
+    m_points.push_back(bin_and_point.second);
+  }
+  m_hash.clear();
+  if (m_points.empty()) {
+    return;
+  }
+  bucket_points();
+  m_components.reset(m_points.size());
+  // Several tiles per thread to even out differences in point density
+  constexpr std::size_t TILES_PER_THREAD = 4U;
+  const std::size_t num_tiles = m_thread_pool->size() * TILES_PER_THREAD;
+  m_thread_pool->run(
+    num_tiles, [this, num_tiles](const std::size_t tile) {
+      connect_tile(tile, num_tiles);
+    });
+  emit_components(clusters);
+}
+////////////////////////////////////////////////////////////////////////////////
+void EuclideanCluster::bucket_points()
+{
+  // Counting sort of point indices by bin, the histogram is shifted by one so the prefix sum
+  // yields the start of each bin
+  m_point_bins.clear();
+  std::fill(m_bin_offsets.begin(), m_bin_offsets.end(), 0U);
+  for (const auto & pt : m_points) {
+    const auto & raw = pt.get_point();
+    const std::size_t bin = m_hash_config.bin(raw.x, raw.y, raw.z);
+    m_point_bins.push_back(bin);
+    ++m_bin_offsets[bin + 1U];
+  }
+  std::partial_sum(m_bin_offsets.begin(), m_bin_offsets.end(), m_bin_offsets.begin());
+  // Scatter, which advances the offset of each bin to the start of the next bin
+  m_binned_points.resize(m_points.size());
+  for (std::size_t idx = 0U; idx < m_points.size(); ++idx) {
+    m_binned_points[m_bin_offsets[m_point_bins[idx]]] = idx;
+    ++m_bin_offsets[m_point_bins[idx]];
+  }
+  // Shift back so the offset of each bin is its start again
+  std::copy_backward(m_bin_offsets.begin(), m_bin_offsets.end() - 1, m_bin_offsets.end());
+  m_bin_offsets.front() = 0U;
+}
+////////////////////////////////////////////////////////////////////////////////
+void EuclideanCluster::connect_tile(const std::size_t tile, const std::size_t num_tiles)
+{
+  const std::size_t num_bins = m_bin_offsets.size() - 1U;
+  const std::size_t first = m_bin_offsets[(num_bins * tile) / num_tiles];
+  const std::size_t last = m_bin_offsets[(num_bins * (tile + 1U)) / num_tiles];
+  for (std::size_t pos = first; pos < last; ++pos) {
+    const std::size_t idx = m_binned_points[pos];
+    const auto & pt = m_points[idx].get_point();
+    // Same threshold and distance computations as the serial near neighbor search
+    const float32_t thresh1 = m_config.threshold(sqrtf((pt.x * pt.x) + (pt.y * pt.y)));
+    const float32_t thresh1_2 = thresh1 * thresh1;
+    const auto ref = m_hash_config.index3(pt.x, pt.y, 0.0F);
+    const auto range = m_hash_config.bin_range(ref, thresh1);
+    auto query = range.first;
+    do {
+      if (m_hash_config.is_candidate_bin(ref, query, thresh1_2)) {
+        const std::size_t bin = m_hash_config.index(query);
+        // Each pair of points only needs to be checked once, from the one that is binned first
+        for (std::size_t qpos = std::max(m_bin_offsets[bin], pos + 1U);
+          qpos < m_bin_offsets[bin + 1U]; ++qpos)
+        {
+          const std::size_t jdx = m_binned_points[qpos];
+          const auto & qt = m_points[jdx];
+          const float32_t dist2 = m_hash_config.distance_squared(pt.x, pt.y, 0.0F, qt);
+          if ((dist2 <= thresh1_2) && (sqrtf(dist2) <= m_config.threshold(qt))) {
+            m_components.unite(idx, jdx);
+          }
+        }
+      }
+    } while (m_hash_config.next_bin(range, query));
+  }
+}
+////////////////////////////////////////////////////////////////////////////////
+void EuclideanCluster::emit_components(Clusters & clusters)
+{
+  constexpr std::size_t REJECTED = std::numeric_limits<std::size_t>::max();
+  const std::size_t num_points = m_points.size();
+  // Component sizes, indexed by root
+  m_component_offsets.assign(num_points, 0U);
+  for (std::size_t idx = 0U; idx < num_points; ++idx) {
+    ++m_component_offsets[m_components.find(idx)];
+  }
+  // Roots are the lowest index of their component, so visiting them in index order orders the
+  // clusters by their first point. Turn the sizes into offsets into the clusters' points
+  std::size_t num_cluster_points = 0U;
+  for (std::size_t idx = 0U; idx < num_points; ++idx) {
+    if (m_components.find(idx) != idx) {
+      continue;
+    }
+    const std::size_t size = m_component_offsets[idx];
+    if (clusters.cluster_boundary.size() >= m_config.max_num_clusters()) {
+      m_last_error = Error::TOO_MANY_CLUSTERS;
+      m_component_offsets[idx] = REJECTED;
+    } else if (size < m_config.min_number_of_points_in_cluster()) {
+      m_component_offsets[idx] = REJECTED;
+    } else {
+      m_component_offsets[idx] = num_cluster_points;
+      num_cluster_points += size;
+      clusters.cluster_boundary.emplace_back(static_cast<uint32_t>(num_cluster_points));
+    }
+  }
+  clusters.points.resize(num_cluster_points);
+  for (std::size_t idx = 0U; idx < num_points; ++idx) {
+    std::size_t & offset = m_component_offsets[m_components.find(idx)];
+    if (offset != REJECTED) {
+      clusters.points[offset] =
+        static_cast<autoware_auto_perception_msgs::msg::PointXYZIF>(m_points[idx]);
+      ++offset;
+    }
+  }
+}
+////////////////////////////////////////////////////////////////////////////////
 void EuclideanCluster::cluster(Clusters & clusters, const Hash::IT it)
 {
   // init new cluster
@@ -19,6 +19,8 @@
 
 #include <common/types.hpp>
 
+#include <algorithm>
+#include <random>
 #include <vector>
 #include <utility>
 
@@ -158,4 +160,66 @@ TEST(EuclideanCluster, NoCluster)
   EXPECT_EQ(res.cluster_boundary.size(), 0U);
   EXPECT_EQ(cls.get_error(), EuclideanCluster::Error::NONE);
 }
+
+/// Clusters as sorted lists of points, in a canonical order
+std::vector<std::vector<std::pair<float32_t, float32_t>>> canonical_clusters(
+  const Clusters & clusters)
+{
+  std::vector<std::vector<std::pair<float32_t, float32_t>>> ret;
+  for (uint32_t idx = 0U; idx < clusters.cluster_boundary.size(); ++idx) {
+    std::vector<std::pair<float32_t, float32_t>> cluster;
+    const auto cls_iters = get_cluster(clusters, idx);
+    for (auto pt_it = cls_iters.first; pt_it != cls_iters.second; ++pt_it) {
+      cluster.emplace_back(pt_it->x, pt_it->y);
+    }
+    std::sort(cluster.begin(), cluster.end());
+    ret.push_back(cluster);
+  }
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
+
+/// multi-threaded clustering finds the same clusters as single-threaded clustering
+TEST(EuclideanCluster, ParallelMatchesSerial)
+{
+  HashConfig hcfg{-130.0F, 130.0F, -130.0F, 130.0F, 1.0F, 10000U};
+  FilterConfig fcg{1.0F, 1.0F, 1.0F, 1.0F, 1.0F, 1.0F};
+  EuclideanCluster serial{Config{"bar", 5U, 100U, 0.5F, 1.5F, 60.0F}, hcfg, fcg};
+  EuclideanCluster parallel{Config{"bar", 5U, 100U, 0.5F, 1.5F, 60.0F, 4U}, hcfg, fcg};
+  EXPECT_THROW(Config("bar", 5U, 100U, 0.5F, 1.5F, 60.0F, 0U), std::domain_error);
+  Clusters serial_res;
+  Clusters parallel_res;
+  for (uint32_t scan = 0U; scan < 3U; ++scan) {
+    std::mt19937 gen{scan};
+    std::uniform_real_distribution<float32_t> dist{-100.0F, 100.0F};
+    for (auto cls : {&serial, &parallel}) {
+      std::vector<std::pair<float32_t, float32_t>> output;
+      insert_line(output, *cls, 11.0F, 16.0F, 16.0F, 21.0F, 0.9F);
+      insert_ring(*cls, 70.0F, 300U);
+      insert_mesh(output, *cls, -10.0F, -10.0F, -20.0F, -20.0F, 0.5F, 0.5F);
+      insert_ring(*cls, 90.0F, 500U, 5.0F, -5.0F);
+    }
+    for (uint32_t idx = 0U; idx < 2000U; ++idx) {
+      const float32_t x = dist(gen);
+      const float32_t y = dist(gen);
+      insert_point(serial, x, y);
+      insert_point(parallel, x, y);
+    }
+    serial.cluster(serial_res);
+    parallel.cluster(parallel_res);
+    EXPECT_EQ(parallel.get_error(), EuclideanCluster::Error::NONE);
+    ASSERT_GT(serial_res.cluster_boundary.size(), 3U);
+    EXPECT_EQ(parallel_res.cluster_boundary.size(), serial_res.cluster_boundary.size());
+    EXPECT_EQ(parallel_res.cluster_boundary.back(), serial_res.cluster_boundary.back());
+    EXPECT_EQ(canonical_clusters(parallel_res), canonical_clusters(serial_res));
+  }
+  // Overflowing the maximum number of clusters is reported
+  EuclideanCluster small{Config{"bar", 1U, 2U, 0.5F, 1.5F, 60.0F, 2U}, hcfg, fcg};
+  insert_point(small, 0.0F, 0.0F);
+  insert_point(small, 10.0F, 0.0F);
+  insert_point(small, 20.0F, 0.0F);
+  small.cluster(parallel_res);
+  EXPECT_EQ(parallel_res.cluster_boundary.size(), 2U);
+  EXPECT_EQ(small.get_error(), EuclideanCluster::Error::TOO_MANY_CLUSTERS);
+}
 #endif  // TEST_EUCLIDEAN_CLUSTER_HPP_
@@ -77,7 +77,9 @@ m_cluster_alg{
     static_cast<float32_t>(declare_parameter("cluster.min_cluster_threshold_m").get<float32_t>()),
     static_cast<float32_t>(declare_parameter("cluster.max_cluster_threshold_m").get<float32_t>()),
     static_cast<float32_t>(declare_parameter("cluster.threshold_saturation_distance_m")
-    .get<float32_t>())
+    .get<float32_t>()),
+    static_cast<std::size_t>(declare_parameter(
+      "cluster.num_threads", rclcpp::ParameterValue{1}).get<std::size_t>())
   },
   euclidean_cluster::HashConfig{
     static_cast<float32_t>(declare_parameter("hash.min_x").get<float32_t>()),
@@ -0,0 +1,116 @@
+// Copyright 2021 The Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+/// \copyright Copyright 2021 The Autoware Foundation
+/// \file
+/// \brief This file defines the BatchedKalmanFilter class.
+
+#ifndef TRACKING__BATCHED_KALMAN_FILTER_HPP_
+#define TRACKING__BATCHED_KALMAN_FILTER_HPP_
+
+#include <common/types.hpp>
+#include <state_vector/common_states.hpp>
+#include <tracking/visibility_control.hpp>
+
+#include <Eigen/Core>
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace autoware
+{
+namespace perception
+{
+namespace tracking
+{
+
+/// \brief A Kalman filter engine for many tracks at once, using the same linear constant
+///        acceleration motion model and Wiener noise model as TrackedObject.
+///
+/// The states and covariances of all tracks are stored next to each other in one array, one
+/// column per track, and every prediction or correction is a single sweep over this array with
+/// fixed-size matrix operations. The motion jacobian and the noise covariance are only computed
+/// once per prediction since all the tracks are predicted by the same time step, and the
+/// correction uses the fact that only the position is measured. Storage only grows, so the
+/// filter does not allocate in steady state.
+class TRACKING_PUBLIC BatchedKalmanFilter
+{
+public:
+  using State = autoware::common::state_vector::ConstAccelerationXY64;
+  using StateMatrix = State::Matrix;
+
+  /// \brief Set the number of tracks in the batch. The contents of new tracks are undefined
+  ///        until they are set.
+  void resize(const std::size_t number_of_tracks);
+
+  /// \brief Get the number of tracks in the batch.
+  std::size_t size() const noexcept {return m_size;}
+
+  /// \brief Set the state of a single track.
+  /// \param index Index of the track in the batch.
+  /// \param state The state of the track.
+  /// \param covariance The covariance of the state.
+  /// \param noise_variance The acceleration noise of the track as passed to WienerNoise, used
+  ///                       for both axes.
+  void set(
+    const std::size_t index, const State & state, const StateMatrix & covariance,
+    const common::types::float64_t noise_variance);
+
+  /// \brief Get the state of a single track.
+  /// \param index Index of the track in the batch.
+  /// \param[out] state The state of the track.
+  /// \param[out] covariance The covariance of the state.
+  void get(const std::size_t index, State & state, StateMatrix & covariance) const;
+
+  /// \brief Predict all the tracks forward by the same time step.
+  void predict(const std::chrono::nanoseconds dt);
+
+  /// \brief Queue a position measurement for a track to be applied by the next correct() call.
+  ///        Every track can have at most one measurement per correction.
+  /// \param index Index of the track in the batch.
+  /// \param position Measured x and y position.
+  /// \param covariance Covariance of the measured position.
+  void add_position_measurement(
+    const std::size_t index, const Eigen::Vector2d & position,
+    const Eigen::Matrix2d & covariance);
+
+  /// \brief Correct all the tracks that have a queued measurement and clear the queue.
+  void correct();
+
+private:
+  static constexpr Eigen::Index kStateSize = State::size();
+  static constexpr Eigen::Index kTrackSize = kStateSize + kStateSize * kStateSize;
+  static constexpr Eigen::Index kMeasurementSize = 6;
+
+  /// State followed by the column-major covariance of every track, one column per track.
+  Eigen::Matrix<common::types::float64_t, kTrackSize, Eigen::Dynamic> m_tracks;
+  /// Factors by which the unit noise covariance is scaled for each track.
+  Eigen::RowVectorXd m_noise_scales;
+  /// Number of tracks in the batch. The arrays may have more columns.
+  std::size_t m_size{0U};
+
+  /// Tracks with a queued measurement.
+  std::vector<std::size_t> m_measurement_indices;
+  /// Queued measurements, one column per measurement: x, y and the column-major covariance.
+  Eigen::Matrix<common::types::float64_t, kMeasurementSize, Eigen::Dynamic> m_measurements;
+};
+
+}  // namespace tracking
+}  // namespace perception
+}  // namespace autoware
+
+#endif  // TRACKING__BATCHED_KALMAN_FILTER_HPP_
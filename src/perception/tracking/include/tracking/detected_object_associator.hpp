@@ -18,13 +18,15 @@
 
 #include <autoware_auto_perception_msgs/msg/detected_objects.hpp>
 #include <common/types.hpp>
-#include <hungarian_assigner/hungarian_assigner.hpp>
+#include <hungarian_assigner/sparse_assigner.hpp>
 #include <tracking/objects_with_associations.hpp>
 #include <tracking/tracked_object.hpp>
 #include <tracking/tracker_types.hpp>
 
+#include <cstdint>
 #include <experimental/optional>
 #include <map>
+#include <utility>
 #include <vector>
 
 namespace autoware
@@ -72,10 +74,16 @@ private:
 
 /// \brief Class to perform data association between existing tracks and new detections using
 ///        mahalanobis distance and hungarian assigner
+///
+/// Tracks are binned in a 2D grid with the max distance as cell size, so that only the tracks
+/// near a detection are checked against it. The detections and tracks that can be associated
+/// form a sparse graph whose connected components are independent assignment problems, each of
+/// which is solved by a sparse assigner that only visits the pairs that passed gating.
 class TRACKING_PUBLIC DetectedObjectAssociator
 {
 public:
-  using Assigner = autoware::fusion::hungarian_assigner::hungarian_assigner_c<MAX_NUM_TRACKS>;
+  using Assigner = autoware::fusion::hungarian_assigner::sparse_assigner_c;
+
   /// \brief Constructor
   /// \param association_cfg Config object containing parameters to be used
   explicit DetectedObjectAssociator(const DataAssociationConfig & association_cfg);
@@ -94,33 +102,81 @@ public:
   }
 
 private:
+  /// A detection and a track that passed gating, with the weight of associating them.
+  struct Candidate
+  {
+    std::size_t detection_index;
+    std::size_t track_index;
+    float32_t weight;
+    /// Connected component this pair belongs to, set by solve_components().
+    std::size_t component;
+  };
+
   /// \brief Reset internal states of the associator
   void reset();
 
-  /// \brief Loop through all detections and tracks and set weights between them in the assigner
+  /// \brief Sort the tracks into the cells of the grid
+  void build_track_grid(const TrackedObjects & tracks);
+
+  /// \brief Loop through all detections and the tracks in grid cells near them and store the
+  ///        weights of the pairs that pass gating
   void compute_weights(
     const autoware_auto_perception_msgs::msg::DetectedObjects & detections,
     const TrackedObjects & tracks);
 
+  /// \brief Store the weight between a detection and a track if they pass gating
+  void compute_weight(
+    const autoware_auto_perception_msgs::msg::DetectedObject & detection,
+    const std::size_t detection_index,
+    const TrackedObject & track, const std::size_t track_index);
+
+  /// \brief Squared distance beyond which a track is not associated with the given detection
+  float32_t get_distance_threshold_squared(
+    const autoware_auto_perception_msgs::msg::DetectedObject & detection) const;
+
   /// \brief Check if the given track and detection are similar enough to compute weight
   bool consider_associating(
     const autoware_auto_perception_msgs::msg::DetectedObject & detection,
     const TrackedObject & track) const;
 
-  /// Set weight in the assigner (Has to determine which idx is row and which is column)
-  void set_weight(const float32_t weight, const size_t det_idx, const size_t track_idx);
+  /// \brief Group the candidates into connected components and solve each one of them
+  void solve_components(Associations & object_associations);
+
+  /// \brief Solve the assignment for the candidates in [begin, end), which form one component
+  void solve_component(
+    const std::size_t begin, const std::size_t end, Associations & object_associations);
+
+  /// \brief Find the root of a node in the union-find forest, compressing the path
+  std::size_t find_root(std::size_t node);
 
-  /// \brief Extract result from the assigner and populate the AssociatorResult container
-  Associations extract_result();
+  /// \brief Record an association between a detection and a track
+  void associate(
+    const std::size_t detection_index, const std::size_t track_index,
+    Associations & object_associations);
+
+  /// \brief Get the index of the grid cell that contains a coordinate
+  std::int32_t to_cell(const common::types::float64_t coordinate) const;
 
   DataAssociationConfig m_association_cfg;
   Assigner m_assigner;
-  // Hungarian assigner expects a fat matrix (not tall). Bool tracks if tracks are rows or cols
-  bool m_are_tracks_rows;
   size_t m_num_tracks;
   size_t m_num_detections;
   bool m_had_errors = false;
   Associations m_track_associations;
+
+  /// Side length of the grid cells.
+  common::types::float64_t m_cell_size;
+  /// Cell key and index of every track with a finite position, sorted by key.
+  std::vector<std::pair<std::uint64_t, std::size_t>> m_track_cells;
+  /// Pairs of detections and tracks that passed gating.
+  std::vector<Candidate> m_candidates;
+  /// Union-find parents, detections first and then tracks.
+  std::vector<std::size_t> m_parents;
+  /// Index of a detection or track within its component, in the same order as m_parents.
+  std::vector<std::size_t> m_local_indices;
+  /// Detections and tracks of the component being solved, by their index in the component.
+  std::vector<std::size_t> m_component_detections;
+  std::vector<std::size_t> m_component_tracks;
 };
 
 
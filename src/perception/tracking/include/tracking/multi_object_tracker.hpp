@@ -21,6 +21,7 @@
 #ifndef TRACKING__MULTI_OBJECT_TRACKER_HPP_
 #define TRACKING__MULTI_OBJECT_TRACKER_HPP_
 
+#include <tracking/batched_kalman_filter.hpp>
 #include <tracking/detected_object_associator.hpp>
 #include <tracking/greedy_roi_associator.hpp>
 #include <tracking/track_creator.hpp>
@@ -144,6 +145,10 @@ public:
   ///
   /// @brief      Update the tracks from incoming clusters
   ///
+  /// @details    The clusters are not modified. Each cluster is copied into a buffer owned by the
+  ///             tracker for the box fit, which reorders the points. The buffer keeps its memory
+  ///             across updates.
+  ///
   /// @param[in]  incoming_clusters         The incoming clusters
   /// @param[in]  detection_frame_odometry  An odometry message for the clusters frame in the
   ///                                       tracking frame, which is defined in
@@ -155,11 +160,32 @@ public:
     const ClustersMsg & incoming_clusters,
     const nav_msgs::msg::Odometry & detection_frame_odometry);
 
+  ///
+  /// @brief      Update the tracks from incoming clusters which are no longer needed by the
+  ///             caller. The boxes are fit in place, without copying any point.
+  ///
+  /// @param[in]  incoming_clusters         The incoming clusters, the order of the points within
+  ///                                       each cluster is changed.
+  /// @param[in]  detection_frame_odometry  An odometry message for the clusters frame in the
+  ///                                       tracking frame, which is defined in
+  ///                                       MultiObjectTrackerOptions.
+  ///
+  /// @return     A result object containing tracks, unless an error occurred.
+  ///
+  DetectedObjectsUpdateResult update(
+    ClustersMsg && incoming_clusters,
+    const nav_msgs::msg::Odometry & detection_frame_odometry);
+
   /// \brief Update the tracks with the specified detections
   /// \param[in] rois An array of vision detections.
   void update(const ClassifiedRoiArrayMsg & rois);
 
 private:
+  /// Update the tracks with detections owned by the tracker, which are transformed in place.
+  DetectedObjectsUpdateResult update_with_owned_detections(
+    DetectedObjectsMsg && detections,
+    const nav_msgs::msg::Odometry & detection_frame_odometry);
+
   /// Check that the input data is valid.
   TrackerUpdateStatus validate(
     const DetectedObjectsMsg & detections,
@@ -168,6 +194,9 @@ private:
   /// The tracked objects, also called "tracks".
   TrackedObjects m_tracks;
 
+  /// Batched Kalman filter for predicting and updating all the tracks at once.
+  BatchedKalmanFilter m_track_filter;
+
   /// Timestamp of the last update.
   std::chrono::system_clock::time_point m_last_update;
 
@@ -181,6 +210,9 @@ private:
 
   /// Creator for creating tracks based on unassociated observations
   TrackCreatorT m_track_creator;
+
+  /// Buffer for fitting a box to a cluster which must not be modified.
+  ClustersMsg::_points_type m_cluster_points;
 };
 
 template<>
@@ -88,6 +88,14 @@ public:
     }
   }
 
+  explicit Associated(MsgT && objects, const Associations & associations)
+  : m_objects{std::move(objects)}, m_associations{associations}
+  {
+    if (detail::get_size(m_objects) != m_associations.size()) {
+      throw std::runtime_error("Objects number must match the associations number");
+    }
+  }
+
   explicit Associated(const MsgT & objects)
   : m_objects{objects}, m_associations(detail::get_size(m_objects), {Matched::kNothing, 0UL}) {}
 
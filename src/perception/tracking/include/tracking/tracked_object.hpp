@@ -30,7 +30,9 @@
 #include <state_estimation/kalman_filter/kalman_filter.hpp>
 #include <state_estimation/noise_model/wiener_noise.hpp>
 #include <state_vector/common_states.hpp>
+#include <tracking/batched_kalman_filter.hpp>
 #include <tracking/classification_tracker.hpp>
+#include <tracking/objects_with_associations.hpp>
 #include <tracking/visibility_control.hpp>
 
 #include <chrono>
@@ -55,6 +57,7 @@ public:
   using EKF = autoware::common::state_estimation::KalmanFilter<MotionModel, NoiseModel>;
   using TrackedObjectMsg = autoware_auto_perception_msgs::msg::TrackedObject;
   using DetectedObjectMsg = autoware_auto_perception_msgs::msg::DetectedObject;
+  using DetectedObjectsMsg = autoware_auto_perception_msgs::msg::DetectedObjects;
   using ObjectClassifications =
     autoware_auto_perception_msgs::msg::TrackedObject::_classification_type;
   using ShapeMsg = autoware_auto_perception_msgs::msg::Shape;
@@ -93,6 +96,27 @@ public:
   /// Adjust the track to the detection.
   void update(const DetectedObjectMsg & detection);
 
+  /// \brief Predict many tracks forward with one batched filter sweep. Has the same effect as
+  ///        calling predict on every track.
+  /// \param objects The tracks to predict.
+  /// \param dt The time step to predict by.
+  /// \param filter The batched filter, reused across calls to avoid allocations.
+  static void predict_tracks(
+    std::vector<TrackedObject> & objects, std::chrono::nanoseconds dt,
+    BatchedKalmanFilter & filter);
+
+  /// \brief Update many tracks with their associated detections with one batched filter sweep.
+  ///        Has the same effect as calling update with the detection on every matched track.
+  /// \param objects The tracks to update.
+  /// \param detections The detections.
+  /// \param associations The association of every detection. Only the ones matched to an
+  ///                     existing track are used, each track may be matched at most once.
+  /// \param filter The batched filter, reused across calls to avoid allocations.
+  static void update_tracks(
+    std::vector<TrackedObject> & objects,
+    const DetectedObjectsMsg::_objects_type & detections,
+    const Associations & associations, BatchedKalmanFilter & filter);
+
   /// Update just the classification state of the track
   void update(
     const ObjectClassifications & obj_type, const common::types::float32_t covariance);
@@ -136,6 +160,9 @@ public:
   }
 
 private:
+  /// Update everything but the filter state from a detection.
+  void update_attributes(const DetectedObjectMsg & detection);
+
   /// The final to-be-published object.
   TrackedObjectMsg m_msg;
   /// The state estimator.
@@ -149,6 +176,8 @@ private:
   /// All variables will initially have this variance where the detection
   /// does not contain one.
   common::types::float64_t m_default_variance = -1.0;
+  /// The acceleration noise variance of the state estimator.
+  common::types::float64_t m_noise_variance = -1.0;
   /// Track class classifier.
   ClassificationTracker m_classifier;
 };
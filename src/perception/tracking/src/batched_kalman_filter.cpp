@@ -0,0 +1,149 @@
+// Copyright 2021 The Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include "tracking/batched_kalman_filter.hpp"
+
+#include <motion_model/linear_motion_model.hpp>
+#include <state_estimation/noise_model/wiener_noise.hpp>
+
+#include <Eigen/LU>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace autoware
+{
+namespace perception
+{
+namespace tracking
+{
+
+namespace
+{
+
+using autoware::common::state_vector::variable::X;
+using autoware::common::state_vector::variable::Y;
+using common::types::float64_t;
+
+using State = BatchedKalmanFilter::State;
+using MotionModel = autoware::common::motion_model::LinearMotionModel<State>;
+using NoiseModel = autoware::common::state_estimation::WienerNoise<State>;
+
+constexpr Eigen::Index kN = State::size();
+constexpr Eigen::Index kX = State::index_of<X>();
+constexpr Eigen::Index kY = State::index_of<Y>();
+
+using StateMatrix = BatchedKalmanFilter::StateMatrix;
+using StateVector = State::Vector;
+using StateMap = Eigen::Map<StateVector>;
+using CovarianceMap = Eigen::Map<StateMatrix>;
+
+/// Grow the number of columns of a matrix to at least the given number, keeping the contents.
+template<typename MatrixT>
+void reserve_columns(MatrixT & matrix, const Eigen::Index columns)
+{
+  if (matrix.cols() < columns) {
+    matrix.conservativeResize(Eigen::NoChange, std::max(columns, 2 * matrix.cols()));
+  }
+}
+
+}  // namespace
+
+void BatchedKalmanFilter::resize(const std::size_t number_of_tracks)
+{
+  const auto columns = static_cast<Eigen::Index>(number_of_tracks);
+  reserve_columns(m_tracks, columns);
+  reserve_columns(m_noise_scales, columns);
+  m_size = number_of_tracks;
+}
+
+void BatchedKalmanFilter::set(
+  const std::size_t index, const State & state, const StateMatrix & covariance,
+  const float64_t noise_variance)
+{
+  auto track = m_tracks.col(static_cast<Eigen::Index>(index));
+  StateMap{track.data()} = state.vector();
+  CovarianceMap{track.data() + kN} = covariance;
+  m_noise_scales(static_cast<Eigen::Index>(index)) = noise_variance * noise_variance;
+}
+
+void BatchedKalmanFilter::get(
+  const std::size_t index, State & state, StateMatrix & covariance) const
+{
+  const auto track = m_tracks.col(static_cast<Eigen::Index>(index));
+  state.vector() = Eigen::Map<const StateVector>{track.data()};
+  covariance = Eigen::Map<const StateMatrix>{track.data() + kN};
+}
+
+void BatchedKalmanFilter::predict(const std::chrono::nanoseconds dt)
+{
+  // Equal for all the tracks. The noise covariance of a track is this one scaled by the square of
+  // its noise parameter, see WienerNoise.
+  const StateMatrix jacobian = MotionModel{}.jacobian(State{}, dt);
+  const StateMatrix jacobian_transpose = jacobian.transpose();
+  const StateMatrix unit_noise = NoiseModel{{1.0, 1.0}}.covariance(dt);
+  for (Eigen::Index i = 0; i < static_cast<Eigen::Index>(m_size); ++i) {
+    const auto data = m_tracks.col(i).data();
+    StateMap state{data};
+    CovarianceMap covariance{data + kN};
+    const StateVector predicted_state = jacobian * state;
+    state = predicted_state;
+    const StateMatrix propagated = jacobian * covariance;
+    covariance.noalias() = propagated * jacobian_transpose;
+    covariance += m_noise_scales(i) * unit_noise;
+  }
+}
+
+void BatchedKalmanFilter::add_position_measurement(
+  const std::size_t index, const Eigen::Vector2d & position, const Eigen::Matrix2d & covariance)
+{
+  if (index >= m_size) {
+    throw std::out_of_range("Measurement for a track that is not in the batch.");
+  }
+  const auto column = static_cast<Eigen::Index>(m_measurement_indices.size());
+  reserve_columns(m_measurements, column + 1);
+  m_measurements.col(column) << position, Eigen::Map<const Eigen::Vector4d>{covariance.data()};
+  m_measurement_indices.push_back(index);
+}
+
+void BatchedKalmanFilter::correct()
+{
+  for (auto m = 0U; m < m_measurement_indices.size(); ++m) {
+    const auto measurement = m_measurements.col(static_cast<Eigen::Index>(m));
+    const auto data = m_tracks.col(static_cast<Eigen::Index>(m_measurement_indices[m])).data();
+    StateMap state{data};
+    CovarianceMap covariance{data + kN};
+    // The measurement selects x and y, so H * P and P * H^T are just two rows or columns of P.
+    Eigen::Matrix<float64_t, 2, kN> measured_rows;
+    measured_rows << covariance.row(kX), covariance.row(kY);
+    Eigen::Matrix2d innovation_covariance;
+    innovation_covariance <<
+      covariance(kX, kX), covariance(kX, kY),
+      covariance(kY, kX), covariance(kY, kY);
+    innovation_covariance += Eigen::Map<const Eigen::Matrix2d>{measurement.data() + 2};
+    const Eigen::Vector2d innovation{
+      measurement(0) - state(kX), measurement(1) - state(kY)};
+    const Eigen::Matrix<float64_t, kN, 2> kalman_gain =
+      measured_rows.transpose() * innovation_covariance.inverse();
+    state += kalman_gain * innovation;
+    covariance.noalias() -= kalman_gain * measured_rows;
+  }
+  m_measurement_indices.clear();
+}
+
+}  // namespace tracking
+}  // namespace perception
+}  // namespace autoware
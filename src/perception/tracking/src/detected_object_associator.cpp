@@ -21,6 +21,7 @@
 #include <helper_functions/mahalanobis_distance.hpp>
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <vector>
 
@@ -35,6 +36,23 @@ using autoware_auto_perception_msgs::msg::DetectedObjects;
 using autoware::common::state_vector::variable::X;
 using autoware::common::state_vector::variable::Y;
 using autoware::common::types::float32_t;
+using autoware::common::types::float64_t;
+
+namespace
+{
+/// Smallest grid cell size, used when the configured max distance is not positive.
+constexpr float64_t kMinCellSize = 0.01;
+/// Cell indices are clamped to this range so that far away positions do not overflow.
+constexpr float64_t kMaxCellIndex = 1.0e9;
+/// Marks a detection or track that has not been added to the current component yet.
+constexpr std::size_t kNoLocalIndex = std::numeric_limits<std::size_t>::max();
+
+std::uint64_t to_cell_key(const std::int32_t x, const std::int32_t y)
+{
+  return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32U) |
+         static_cast<std::uint64_t>(static_cast<std::uint32_t>(y));
+}
+}  // namespace
 
 constexpr std::size_t AssociatorResult::UNASSIGNED;
 
@@ -47,7 +65,9 @@ DataAssociationConfig::DataAssociationConfig(
   m_consider_edge_for_big_detections(consider_edge_for_big_detections) {}
 
 DetectedObjectAssociator::DetectedObjectAssociator(const DataAssociationConfig & association_cfg)
-: m_association_cfg(association_cfg) {}
+: m_association_cfg(association_cfg),
+  m_cell_size(std::max(static_cast<float64_t>(association_cfg.get_max_distance()), kMinCellSize))
+{}
 
 Associations DetectedObjectAssociator::assign(
   const DetectedObjects & detections, const TrackedObjects & tracks)
@@ -60,87 +80,139 @@ Associations DetectedObjectAssociator::assign(
   m_track_associations = Associations(tracks.objects.size(), {Matched::kNothing, 0UL});
   m_num_detections = detections.objects.size();
   m_num_tracks = tracks.objects.size();
-  m_are_tracks_rows = (m_num_tracks <= m_num_detections);
-  if (m_are_tracks_rows) {
-    m_assigner.set_size(
-      static_cast<assigner_idx_t>(tracks.objects.size()),
-      static_cast<assigner_idx_t>(detections.objects.size()));
-  } else {
-    m_assigner.set_size(
-      static_cast<assigner_idx_t>(detections.objects.size()),
-      static_cast<assigner_idx_t>(tracks.objects.size()));
-  }
+  build_track_grid(tracks);
   compute_weights(detections, tracks);
-  // TODO(gowtham.ranganathan): Revisit this after #979 since till then assigner will always
-  //  return true
-  (void)m_assigner.assign();
 
-  return extract_result();
+  auto object_associations = Associations(m_num_detections, {Matched::kNothing, 0UL});
+  solve_components(object_associations);
+  return object_associations;
 }
 
 void DetectedObjectAssociator::reset()
 {
-  m_assigner.reset();
-
   m_num_tracks = 0U;
   m_num_detections = 0U;
+  m_candidates.clear();
 
   m_had_errors = false;
 }
 
+std::int32_t DetectedObjectAssociator::to_cell(const float64_t coordinate) const
+{
+  const auto cell = std::floor(coordinate / m_cell_size);
+  return static_cast<std::int32_t>(std::min(std::max(cell, -kMaxCellIndex), kMaxCellIndex));
+}
+
+void DetectedObjectAssociator::build_track_grid(const TrackedObjects & tracks)
+{
+  m_track_cells.clear();
+  for (size_t track_index = 0U; track_index < tracks.objects.size(); ++track_index) {
+    const Eigen::Vector2d centroid = tracks.objects[track_index].centroid();
+    // A track without a finite position can not pass distance gating with any detection
+    if (centroid.allFinite()) {
+      m_track_cells.emplace_back(
+        to_cell_key(to_cell(centroid.x()), to_cell(centroid.y())), track_index);
+    }
+  }
+  std::sort(m_track_cells.begin(), m_track_cells.end());
+}
+
 void DetectedObjectAssociator::compute_weights(
   const DetectedObjects & detections, const TrackedObjects & tracks)
 {
   for (size_t detection_index = 0U; detection_index < detections.objects.size();
     ++detection_index)
   {
-    for (size_t track_index = 0U; track_index < tracks.objects.size(); ++track_index) {
-      const auto & track = tracks.objects[track_index];
-      const auto & detection = detections.objects[detection_index];
+    const auto & detection = detections.objects[detection_index];
+    const auto & position = detection.kinematics.pose_with_covariance.pose.position;
+    if (!std::isfinite(position.x) || !std::isfinite(position.y)) {
+      continue;
+    }
+    const auto radius =
+      std::sqrt(static_cast<float64_t>(get_distance_threshold_squared(detection)));
+    const auto min_x = to_cell(position.x - radius);
+    const auto max_x = to_cell(position.x + radius);
+    const auto min_y = to_cell(position.y - radius);
+    const auto max_y = to_cell(position.y + radius);
+    const auto num_cells = (static_cast<std::int64_t>(max_x) - min_x + 1) *
+      (static_cast<std::int64_t>(max_y) - min_y + 1);
+
+    if (num_cells > static_cast<std::int64_t>(m_track_cells.size())) {
+      // Looking up the cells would take longer than checking every track
+      for (const auto & track_cell : m_track_cells) {
+        compute_weight(
+          detection, detection_index, tracks.objects[track_cell.second], track_cell.second);
+      }
+      continue;
+    }
+    for (auto x = min_x; x <= max_x; ++x) {
+      for (auto y = min_y; y <= max_y; ++y) {
+        const auto key = to_cell_key(x, y);
+        auto it = std::lower_bound(
+          m_track_cells.begin(), m_track_cells.end(), key,
+          [](const auto & track_cell, const std::uint64_t value) {
+            return track_cell.first < value;
+          });
+        for (; (it != m_track_cells.end()) && (it->first == key); ++it) {
+          compute_weight(detection, detection_index, tracks.objects[it->second], it->second);
+        }
+      }
+    }
+  }
+}
 
-      try {
-        if (consider_associating(detection, track)) {
-          Eigen::Matrix<float32_t, NUM_OBJ_POSE_DIM, 1> sample;
-          sample(0, 0) =
-            static_cast<float32_t>(detection.kinematics.pose_with_covariance.pose.position.x);
-          sample(1, 0) =
-            static_cast<float32_t>(detection.kinematics.pose_with_covariance.pose.position.y);
+void DetectedObjectAssociator::compute_weight(
+  const autoware_auto_perception_msgs::msg::DetectedObject & detection,
+  const std::size_t detection_index,
+  const TrackedObject & track, const std::size_t track_index)
+{
+  try {
+    if (consider_associating(detection, track)) {
+      Eigen::Matrix<float32_t, NUM_OBJ_POSE_DIM, 1> sample;
+      sample(0, 0) =
+        static_cast<float32_t>(detection.kinematics.pose_with_covariance.pose.position.x);
+      sample(1, 0) =
+        static_cast<float32_t>(detection.kinematics.pose_with_covariance.pose.position.y);
 
-          Eigen::Matrix<float32_t, NUM_OBJ_POSE_DIM, 1> mean{track.centroid().cast<float32_t>()};
+      Eigen::Matrix<float32_t, NUM_OBJ_POSE_DIM, 1> mean{track.centroid().cast<float32_t>()};
 
-          Eigen::Matrix<float32_t, NUM_OBJ_POSE_DIM,
-            NUM_OBJ_POSE_DIM> cov = track.position_covariance().cast<float32_t>();
+      Eigen::Matrix<float32_t, NUM_OBJ_POSE_DIM,
+        NUM_OBJ_POSE_DIM> cov = track.position_covariance().cast<float32_t>();
 
-          const auto dist = autoware::common::helper_functions::calculate_mahalanobis_distance(
-            sample, mean, cov);
+      const auto dist = autoware::common::helper_functions::calculate_mahalanobis_distance(
+        sample, mean, cov);
 
-          set_weight(dist, detection_index, track_index);
-        }
-      } catch (const std::runtime_error & e) {
-        m_had_errors = true;
-      } catch (const std::domain_error & e) {
-        m_had_errors = true;
-      }
+      m_candidates.push_back({detection_index, track_index, dist, 0U});
     }
+  } catch (const std::runtime_error & e) {
+    m_had_errors = true;
+  } catch (const std::domain_error & e) {
+    m_had_errors = true;
   }
 }
 
+float32_t DetectedObjectAssociator::get_distance_threshold_squared(
+  const autoware_auto_perception_msgs::msg::DetectedObject & detection) const
+{
+  if (!m_association_cfg.consider_edge_for_big_detections()) {
+    return m_association_cfg.get_max_distance_squared();
+  }
+  float32_t shortest_edge_size_squared = std::numeric_limits<float32_t>::max();
+  for (auto current = detection.shape.polygon.points.begin();
+    current != detection.shape.polygon.points.end(); ++current)
+  {
+    auto next = common::geometry::details::circular_next(
+      detection.shape.polygon.points.begin(), detection.shape.polygon.points.end(), current);
+    shortest_edge_size_squared =
+      std::min(shortest_edge_size_squared, common::geometry::squared_distance_2d(*current, *next));
+  }
+  return std::max(m_association_cfg.get_max_distance_squared(), shortest_edge_size_squared);
+}
+
 bool DetectedObjectAssociator::consider_associating(
   const autoware_auto_perception_msgs::msg::DetectedObject & detection,
   const TrackedObject & track) const
 {
-  const auto get_shortest_edge_size_squared = [&]() -> float32_t {
-      float32_t retval = std::numeric_limits<float32_t>::max();
-      for (auto current = detection.shape.polygon.points.begin();
-        current != detection.shape.polygon.points.end(); ++current)
-      {
-        auto next = common::geometry::details::circular_next(
-          detection.shape.polygon.points.begin(), detection.shape.polygon.points.end(), current);
-        retval = std::min(retval, common::geometry::squared_distance_2d(*current, *next));
-      }
-      return retval;
-    };
-
   const float32_t det_area = common::geometry::area_checked_2d(
     detection.shape.polygon.points.begin(), detection.shape.polygon.points.end());
 
@@ -161,19 +233,9 @@ bool DetectedObjectAssociator::consider_associating(
   track_centroid.x = track.centroid().x();
   track_centroid.y = track.centroid().y();
 
-  const auto compute_distance_threshold = [&get_shortest_edge_size_squared, this]() -> float32_t {
-      if (m_association_cfg.consider_edge_for_big_detections()) {
-        return std::max(
-          m_association_cfg.get_max_distance_squared(),
-          get_shortest_edge_size_squared());
-      } else {
-        return m_association_cfg.get_max_distance_squared();
-      }
-    };
-
   if (common::geometry::squared_distance_2d(
       detection.kinematics.pose_with_covariance.pose.position,
-      track_centroid) > compute_distance_threshold())
+      track_centroid) > get_distance_threshold_squared(detection))
   {
     return false;
   }
@@ -186,52 +248,112 @@ bool DetectedObjectAssociator::consider_associating(
   return false;
 }
 
-void DetectedObjectAssociator::set_weight(
-  const float32_t weight,
-  const size_t detection_index, const size_t track_index)
+std::size_t DetectedObjectAssociator::find_root(std::size_t node)
 {
-  if (m_are_tracks_rows) {
-    m_assigner.set_weight(
-      weight, static_cast<assigner_idx_t>(track_index),
-      static_cast<assigner_idx_t>(detection_index));
-  } else {
-    m_assigner.set_weight(
-      weight, static_cast<assigner_idx_t>(detection_index),
-      static_cast<assigner_idx_t>(track_index));
+  while (m_parents[node] != node) {
+    m_parents[node] = m_parents[m_parents[node]];
+    node = m_parents[node];
   }
+  return node;
 }
 
-Associations DetectedObjectAssociator::extract_result()
+void DetectedObjectAssociator::solve_components(Associations & object_associations)
 {
-  auto object_associations = Associations(m_num_detections, {Matched::kNothing, 0UL});
-  if (m_are_tracks_rows) {
-    for (size_t track_index = 0U; track_index < m_num_tracks; track_index++) {
-      const auto detection_index =
-        static_cast<size_t>(m_assigner.get_assignment(static_cast<assigner_idx_t>(track_index)));
-      const auto track_has_detection_assigned = (detection_index != Assigner::UNASSIGNED);
-      if (!track_has_detection_assigned) {continue;}
-      const auto detection_has_no_assignment_yet =
-        (object_associations[detection_index].matched == Matched::kNothing);
-      if (detection_has_no_assignment_yet) {
-        object_associations[detection_index] = {Matched::kExistingTrack, track_index};
-        m_track_associations[track_index] = {Matched::kOtherDetection, detection_index};
-      }
+  // Detections are nodes [0, m_num_detections), tracks follow them
+  const auto num_nodes = m_num_detections + m_num_tracks;
+  m_parents.resize(num_nodes);
+  for (size_t node = 0U; node < num_nodes; ++node) {
+    m_parents[node] = node;
+  }
+  for (const auto & candidate : m_candidates) {
+    const auto detection_root = find_root(candidate.detection_index);
+    const auto track_root = find_root(m_num_detections + candidate.track_index);
+    m_parents[std::max(detection_root, track_root)] = std::min(detection_root, track_root);
+  }
+  for (auto & candidate : m_candidates) {
+    candidate.component = find_root(candidate.detection_index);
+  }
+  std::sort(
+    m_candidates.begin(), m_candidates.end(), [](const Candidate & lhs, const Candidate & rhs) {
+      return lhs.component < rhs.component;
+    });
+
+  m_local_indices.assign(num_nodes, kNoLocalIndex);
+  for (size_t begin = 0U; begin < m_candidates.size(); ) {
+    auto end = begin + 1U;
+    while ((end < m_candidates.size()) &&
+      (m_candidates[end].component == m_candidates[begin].component))
+    {
+      ++end;
     }
-  } else {
-    for (size_t detection_index = 0U; detection_index < m_num_detections; detection_index++) {
-      const auto track_index = static_cast<size_t>(
-        m_assigner.get_assignment(static_cast<assigner_idx_t>(detection_index)));
-      const auto track_got_assigned = (track_index != Assigner::UNASSIGNED);
-      const auto detection_has_no_assignment =
-        (object_associations[detection_index].matched == Matched::kNothing);
-      if (track_got_assigned && detection_has_no_assignment) {
-        object_associations[detection_index] = {Matched::kExistingTrack, track_index};
-        m_track_associations[track_index] = {Matched::kOtherDetection, detection_index};
+    if (end == begin + 1U) {
+      // A single pair, there is nothing to choose
+      associate(
+        m_candidates[begin].detection_index, m_candidates[begin].track_index,
+        object_associations);
+    } else {
+      // Give the detections and tracks of the component contiguous indices
+      m_component_detections.clear();
+      m_component_tracks.clear();
+      for (auto i = begin; i < end; ++i) {
+        auto & detection_local_index = m_local_indices[m_candidates[i].detection_index];
+        if (detection_local_index == kNoLocalIndex) {
+          detection_local_index = m_component_detections.size();
+          m_component_detections.push_back(m_candidates[i].detection_index);
+        }
+        auto & track_local_index =
+          m_local_indices[m_num_detections + m_candidates[i].track_index];
+        if (track_local_index == kNoLocalIndex) {
+          track_local_index = m_component_tracks.size();
+          m_component_tracks.push_back(m_candidates[i].track_index);
+        }
       }
+      solve_component(begin, end, object_associations);
     }
+    begin = end;
   }
+}
 
-  return object_associations;
+void DetectedObjectAssociator::solve_component(
+  const std::size_t begin, const std::size_t end, Associations & object_associations)
+{
+  // Detections are the rows and tracks the columns, the sparse assigner accepts both shapes
+  m_assigner.reset(
+    static_cast<assigner_idx_t>(m_component_detections.size()),
+    static_cast<assigner_idx_t>(m_component_tracks.size()));
+  for (auto i = begin; i < end; ++i) {
+    const auto & candidate = m_candidates[i];
+    // Weights must be below MAX_WEIGHT, which is the cost of leaving a detection unassociated
+    const auto weight = std::min(
+      candidate.weight, std::nextafter(Assigner::MAX_WEIGHT, 0.0F));
+    m_assigner.set_weight(
+      weight, static_cast<assigner_idx_t>(m_local_indices[candidate.detection_index]),
+      static_cast<assigner_idx_t>(m_local_indices[m_num_detections + candidate.track_index]));
+  }
+  // Not every detection gets a track, the ones that do not are left unassociated
+  (void)m_assigner.assign();
+
+  for (size_t row = 0U; row < m_component_detections.size(); ++row) {
+    const auto col = m_assigner.get_assignment(static_cast<assigner_idx_t>(row));
+    if (col == Assigner::UNASSIGNED) {continue;}
+    associate(
+      m_component_detections[row], m_component_tracks[static_cast<std::size_t>(col)],
+      object_associations);
+  }
+  for (const auto detection_index : m_component_detections) {
+    m_local_indices[detection_index] = kNoLocalIndex;
+  }
+  for (const auto track_index : m_component_tracks) {
+    m_local_indices[m_num_detections + track_index] = kNoLocalIndex;
+  }
+}
+
+void DetectedObjectAssociator::associate(
+  const std::size_t detection_index, const std::size_t track_index,
+  Associations & object_associations)
+{
+  object_associations[detection_index] = {Matched::kExistingTrack, track_index};
+  m_track_associations[track_index] = {Matched::kOtherDetection, detection_index};
 }
 
 }  // namespace tracking
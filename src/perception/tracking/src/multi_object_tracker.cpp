@@ -22,13 +22,13 @@
 #include <geometry_msgs/msg/quaternion.hpp>
 #include <lidar_utils/cluster_utils/point_clusters_view.hpp>
 #include <tf2_eigen/tf2_eigen.h>
-#include <tf2_geometry_msgs/tf2_geometry_msgs.h>
 #include <time_utils/time_utils.hpp>
 
 #include <algorithm>
 #include <cmath>
 #include <list>
 #include <memory>
+#include <utility>
 
 
 namespace autoware
@@ -79,81 +79,73 @@ bool is_gravity_aligned(const geometry_msgs::msg::Quaternion & quat)
   return true;
 }
 
-geometry_msgs::msg::TransformStamped to_transform(const Odometry & odometry)
-{
-  geometry_msgs::msg::TransformStamped tfs;
-  tfs.header = odometry.header;
-  tfs.child_frame_id = odometry.child_frame_id;
-  tfs.transform.translation.x = odometry.pose.pose.position.x;
-  tfs.transform.translation.y = odometry.pose.pose.position.y;
-  tfs.transform.translation.z = odometry.pose.pose.position.z;
-  tfs.transform.rotation = odometry.pose.pose.orientation;
-  return tfs;
-}
-
-DetectedObjects transform(
+/// Transform detections from the detection frame into the tracking frame, in place. Positions and
+/// twists of all detections are transformed together as columns of a matrix.
+void transform_in_place(
   const std_msgs::msg::Header::_frame_id_type & target_frame_id,
-  const DetectedObjects & detections,
+  DetectedObjects & detections,
   const Odometry & detection_frame_odometry)
 {
   // Convert the odometry to Eigen objects.
   Eigen::Isometry3d tf__tracking__detection = Eigen::Isometry3d::Identity();
   tf2::fromMsg(detection_frame_odometry.pose.pose, tf__tracking__detection);
   const Eigen::Matrix3d rot_d = tf__tracking__detection.linear();
-  // Convert the odometry to TransformStamped for use with tf2::doTransform.
-  const geometry_msgs::msg::TransformStamped tf_msg__tracking__detection = to_transform(
-    detection_frame_odometry);
-  // Hoisted outside the loop
-  Eigen::Vector3d centroid_detection = Eigen::Vector3d::Zero();
-
-  DetectedObjects result;
-  result.header = detections.header;
-  result.header.frame_id = target_frame_id;
-  result.objects.reserve(detections.objects.size());
-  for (const auto & original_detection : detections.objects) {
-    result.objects.emplace_back(original_detection);
-    auto & detection = result.objects.back();
-    // Transform the pose.
-    tf2::fromMsg(detection.kinematics.pose_with_covariance.pose.position, centroid_detection);
-    const Eigen::Vector3d centroid_tracking = tf__tracking__detection * centroid_detection;
-    detection.kinematics.pose_with_covariance.pose.position = tf2::toMsg(centroid_tracking);
-    if (detection.kinematics.orientation_availability != DetectedObjectKinematics::UNAVAILABLE) {
-      geometry_msgs::msg::QuaternionStamped q_out;
-      // Use quaternion stamped because there is no doTransform for quaternion even though
-      // stamp of QuaternionStamped is not being used for anything
-      tf2::doTransform(
-        geometry_msgs::msg::QuaternionStamped{}.set__quaternion(
-          detection.kinematics.pose_with_covariance.pose.orientation),
-        q_out,
-        tf_msg__tracking__detection);
-      detection.kinematics.pose_with_covariance.pose.orientation = q_out.quaternion;
-    }
-    if (detection.kinematics.has_position_covariance) {
-      // Doing this properly is difficult. We'll ignore the rotational part. This is a practical
-      // solution since only the yaw covariance is relevant, and the yaw covariance is
-      // unaffected by the transformation, which preserves the z axis.
-      // An even more accurate implementation could additionally include the odometry covariance.
-      const Eigen::Map<Eigen::Matrix<double, 6, 6, Eigen::RowMajor>> cov_full(
-        detection.kinematics.pose_with_covariance.covariance.data());
-      // TODO(Maxime CLEMENT): can it be removed ? this is never used.
-      Eigen::Matrix<double, 3, 3> cov(cov_full.block(0, 0, 3, 3));
-      cov = rot_d * cov * rot_d.transpose();
+  const auto & frame_orientation = detection_frame_odometry.pose.pose.orientation;
+  const Eigen::Quaterniond quat_d{
+    frame_orientation.w, frame_orientation.x, frame_orientation.y, frame_orientation.z};
+  const auto & frame_linear = detection_frame_odometry.twist.twist.linear;
+  const Eigen::Vector3d eigen_frame_linear{frame_linear.x, frame_linear.y, frame_linear.z};
+
+  detections.header.frame_id = target_frame_id;
+  auto & objects = detections.objects;
+  const auto num_objects = static_cast<Eigen::Index>(objects.size());
+  Eigen::Matrix3Xd centroids{3, num_objects};
+  Eigen::Matrix3Xd linear_velocities{3, num_objects};
+  for (Eigen::Index idx = 0; idx < num_objects; ++idx) {
+    const auto & kinematics = objects[static_cast<std::size_t>(idx)].kinematics;
+    const auto & position = kinematics.pose_with_covariance.pose.position;
+    const auto & linear = kinematics.twist.twist.linear;
+    centroids.col(idx) << position.x, position.y, position.z;
+    linear_velocities.col(idx) << linear.x, linear.y, linear.z;
+  }
+  // Transform the poses.
+  centroids = (rot_d * centroids).colwise() + tf__tracking__detection.translation();
+  // Transform the twists.
+  // This assumes the detection frame has no angular velocity wrt the tracking frame.
+  // TODO(nikolai.morin): Implement the full formula, to be found in
+  // Craig's "Introduction to robotics" book, third edition, formula 5.13
+  linear_velocities = (rot_d * linear_velocities).colwise() + eigen_frame_linear;
+
+  for (Eigen::Index idx = 0; idx < num_objects; ++idx) {
+    auto & kinematics = objects[static_cast<std::size_t>(idx)].kinematics;
+    auto & pose = kinematics.pose_with_covariance.pose;
+    pose.position = tf2::toMsg(Eigen::Vector3d{centroids.col(idx)});
+    if (kinematics.orientation_availability != DetectedObjectKinematics::UNAVAILABLE) {
+      const Eigen::Quaterniond quat{
+        pose.orientation.w, pose.orientation.x, pose.orientation.y, pose.orientation.z};
+      pose.orientation = tf2::toMsg(quat_d * quat);
     }
-    // Transform the twist.
-    if (detection.kinematics.has_twist) {
-      auto & linear = detection.kinematics.twist.twist.linear;
-      const auto & frame_linear = detection_frame_odometry.twist.twist.linear;
-      const Eigen::Vector3d eigen_linear{linear.x, linear.y, linear.z};
-      const Eigen::Vector3d eigen_linear_transformed = rot_d * eigen_linear;
-      // This assumes the detection frame has no angular velocity wrt the tracking frame.
-      // TODO(nikolai.morin): Implement the full formula, to be found in
-      // Craig's "Introduction to robotics" book, third edition, formula 5.13
-      linear.x = frame_linear.x + eigen_linear_transformed.x();
-      linear.y = frame_linear.y + eigen_linear_transformed.y();
-      linear.z = frame_linear.z + eigen_linear_transformed.z();
+    // The covariance is left untransformed. Doing this properly is difficult. Ignoring the
+    // rotational part is a practical solution since only the yaw covariance is relevant, and the
+    // yaw covariance is unaffected by the transformation, which preserves the z axis.
+    // An even more accurate implementation could additionally include the odometry covariance.
+    if (kinematics.has_twist) {
+      auto & linear = kinematics.twist.twist.linear;
+      linear.x = linear_velocities(0, idx);
+      linear.y = linear_velocities(1, idx);
+      linear.z = linear_velocities(2, idx);
     }
   }
-  return result;
+}
+
+/// Fit a box to the points of a cluster and add it as a detection. The order of the points is
+/// changed.
+template<typename IT>
+void add_cluster_detection(const IT begin, const IT end, DetectedObjects & detections)
+{
+  auto box = common::geometry::bounding_box::lfit_bounding_box_2d(begin, end);
+  common::geometry::bounding_box::compute_height(begin, end, box);
+  detections.objects.push_back(common::geometry::bounding_box::details::make_detected_object(box));
 }
 
 TrackedObjectsMsg convert_to_msg(
@@ -190,31 +182,39 @@ DetectedObjectsUpdateResult MultiObjectTracker<TrackCreatorT>::update(
   const ClustersMsg & incoming_clusters,
   const nav_msgs::msg::Odometry & detection_frame_odometry)
 {
-  ClustersMsg clusters = incoming_clusters;
-  BoundingBoxArray boxes_in_detection_frame;
-  boxes_in_detection_frame.header.stamp = clusters.header.stamp;
-  boxes_in_detection_frame.header.frame_id = clusters.header.frame_id;
-  for (auto cls_id = 0U; cls_id < clusters.cluster_boundary.size(); cls_id++) {
-    const auto iter_pair = common::lidar_utils::get_cluster(clusters, cls_id);
+  DetectedObjects detections;
+  detections.header = incoming_clusters.header;
+  detections.objects.reserve(incoming_clusters.cluster_boundary.size());
+  for (auto cls_id = 0U; cls_id < incoming_clusters.cluster_boundary.size(); cls_id++) {
+    const auto iter_pair = common::lidar_utils::get_cluster(incoming_clusters, cls_id);
     if (iter_pair.first == iter_pair.second) {
       continue;
     }
-    boxes_in_detection_frame.boxes.push_back(
-      common::geometry::bounding_box::lfit_bounding_box_2d(iter_pair.first, iter_pair.second));
-    common::geometry::bounding_box::compute_height(
-      iter_pair.first, iter_pair.second, boxes_in_detection_frame.boxes.back());
+    // The box fit reorders the points, so it runs on a copy of this cluster only.
+    m_cluster_points.assign(iter_pair.first, iter_pair.second);
+    add_cluster_detection(m_cluster_points.begin(), m_cluster_points.end(), detections);
   }
 
+  return update_with_owned_detections(std::move(detections), detection_frame_odometry);
+}
+
+template<class TrackCreatorT>
+DetectedObjectsUpdateResult MultiObjectTracker<TrackCreatorT>::update(
+  ClustersMsg && incoming_clusters,
+  const nav_msgs::msg::Odometry & detection_frame_odometry)
+{
   DetectedObjects detections;
-  detections.objects.reserve(boxes_in_detection_frame.boxes.size());
-  detections.header = boxes_in_detection_frame.header;
-  std::transform(
-    boxes_in_detection_frame.boxes.begin(),
-    boxes_in_detection_frame.boxes.end(),
-    std::back_inserter(detections.objects),
-    common::geometry::bounding_box::details::make_detected_object);
+  detections.header = incoming_clusters.header;
+  detections.objects.reserve(incoming_clusters.cluster_boundary.size());
+  for (auto cls_id = 0U; cls_id < incoming_clusters.cluster_boundary.size(); cls_id++) {
+    const auto iter_pair = common::lidar_utils::get_cluster(incoming_clusters, cls_id);
+    if (iter_pair.first == iter_pair.second) {
+      continue;
+    }
+    add_cluster_detection(iter_pair.first, iter_pair.second, detections);
+  }
 
-  return update(detections, detection_frame_odometry);
+  return update_with_owned_detections(std::move(detections), detection_frame_odometry);
 }
 
 /// \relates autoware::perception::tracking::MultiObjectTracker
@@ -222,6 +222,14 @@ template<class TrackCreatorT>
 DetectedObjectsUpdateResult MultiObjectTracker<TrackCreatorT>::update(
   const DetectedObjects & detections,
   const nav_msgs::msg::Odometry & detection_frame_odometry)
+{
+  return update_with_owned_detections(DetectedObjects{detections}, detection_frame_odometry);
+}
+
+template<class TrackCreatorT>
+DetectedObjectsUpdateResult MultiObjectTracker<TrackCreatorT>::update_with_owned_detections(
+  DetectedObjects && detections,
+  const nav_msgs::msg::Odometry & detection_frame_odometry)
 {
   DetectedObjectsUpdateResult result;
   result.status = this->validate(detections, detection_frame_odometry);
@@ -232,8 +240,7 @@ DetectedObjectsUpdateResult MultiObjectTracker<TrackCreatorT>::update(
   // ==================================
   // Transform detections
   // ==================================
-  DetectedObjects detections_in_tracker_frame{
-    transform(m_options.frame, detections, detection_frame_odometry)};
+  transform_in_place(m_options.frame, detections, detection_frame_odometry);
 
   // ==================================
   // Predict tracks forward
@@ -241,32 +248,21 @@ DetectedObjectsUpdateResult MultiObjectTracker<TrackCreatorT>::update(
   // TODO(nikolai.morin): Simplify after #1002
   const auto target_time = time_utils::from_message(detections.header.stamp);
   const auto dt = target_time - m_last_update;
-  for (auto & object : m_tracks.objects) {
-    object.predict(dt);
-  }
+  TrackedObject::predict_tracks(m_tracks.objects, dt, m_track_filter);
 
   // ==================================
   // Associate observations with tracks
   // ==================================
-  const auto detection_associations =
-    m_object_associator.assign(detections_in_tracker_frame, this->m_tracks);
+  const auto detection_associations = m_object_associator.assign(detections, this->m_tracks);
   ObjectsWithAssociations detections_with_associations{
-    detections_in_tracker_frame, detection_associations};
+    std::move(detections), detection_associations};
 
   // ==================================
   // Update tracks with observations
   // ==================================
-  for (size_t detection_idx = 0;
-    detection_idx < detections_with_associations.associations().size();
-    ++detection_idx)
-  {
-    const auto & association = detections_with_associations.associations()[detection_idx];
-    if (association.matched == Matched::kExistingTrack) {
-      const auto & detection = detections_with_associations.objects().objects[detection_idx];
-      const auto matched_track_index = association.match_index;
-      m_tracks.objects[matched_track_index].update(detection);
-    }
-  }
+  TrackedObject::update_tracks(
+    m_tracks.objects, detections_with_associations.objects().objects,
+    detections_with_associations.associations(), m_track_filter);
   const auto & track_associations = m_object_associator.track_associations();
   for (auto idx = 0U; idx < m_object_associator.track_associations().size(); ++idx) {
     const auto & association = track_associations[idx];
@@ -324,9 +320,7 @@ void MultiObjectTracker<TrackCreatorT>::update(const ClassifiedRoiArrayMsg & roi
   }
   const auto dt = target_time - m_last_update;
   auto tracks_copy = m_tracks;
-  for (auto & object : tracks_copy.objects) {
-    object.predict(dt);
-  }
+  TrackedObject::predict_tracks(tracks_copy.objects, dt, m_track_filter);
   const auto association = m_vision_associator.assign(rois, tracks_copy);
   // Update the original tracks' classification.
   for (size_t i = 0U; i < m_tracks.objects.size(); ++i) {
@@ -106,6 +106,45 @@ EKF init_ekf(
     state, cov);
 }
 
+PoseMeasurementXYZ64 make_position_measurement(
+  const DetectedObjectMsg & detection, float64_t default_variance)
+{
+  // It needs to be determined which parts of the DetectedObject message are set, and can be used
+  // to update the state. Also, even if a variable is set, its covariance might not be set.
+  autoware_auto_geometry_msgs::msg::RelativePositionWithCovarianceStamped position;
+  position.position.x = detection.kinematics.pose_with_covariance.pose.position.x;
+  position.position.y = detection.kinematics.pose_with_covariance.pose.position.y;
+  position.position.z = detection.kinematics.pose_with_covariance.pose.position.z;
+  const auto & cov = detection.kinematics.pose_with_covariance.covariance;
+  position.covariance = {cov[0], cov[1], cov[2], cov[6], cov[7], cov[8], cov[12], cov[13], cov[14]};
+  auto pose_measurement =
+    convert_to<Stamped<PoseMeasurementXYZ64>>::from(position).measurement;
+  if (!detection.kinematics.has_position_covariance) {
+    pose_measurement.covariance() = default_variance *
+      PoseMeasurementXYZ64::State::Matrix::Identity();
+  }
+  return pose_measurement;
+}
+
+/// The state has no z, so the filter sees the measured z as an innovation with respect to zero.
+/// Conditioning the x and y part on it gives the equivalent planar measurement for the batched
+/// filter, which is the measurement itself when z is uncorrelated.
+void reduce_to_plane(
+  const PoseMeasurementXYZ64 & measurement, Eigen::Vector2d & position,
+  Eigen::Matrix2d & covariance)
+{
+  const auto & values = measurement.state().vector();
+  const auto & measurement_covariance = measurement.covariance();
+  position = values.head<2>();
+  covariance = measurement_covariance.topLeftCorner<2, 2>();
+  const auto z_variance = measurement_covariance(2, 2);
+  if (z_variance > 0.0) {
+    const Eigen::Vector2d cross_covariance = measurement_covariance.topRightCorner<2, 1>();
+    position -= cross_covariance * (values(2) / z_variance);
+    covariance -= cross_covariance * measurement_covariance.bottomLeftCorner<1, 2>() / z_variance;
+  }
+}
+
 }  // anonymous namespace
 
 TrackedObject::TrackedObject(
@@ -115,7 +154,8 @@ TrackedObject::TrackedObject(
   common::types::float64_t noise_variance)
 : m_msg{},
   m_ekf{init_ekf(detection, default_variance, noise_variance)},
-  m_default_variance{default_variance}
+  m_default_variance{default_variance},
+  m_noise_variance{noise_variance}
 {
   static uint64_t object_id = 0;
   m_msg.object_id = ++object_id;
@@ -145,6 +185,12 @@ void TrackedObject::predict(std::chrono::nanoseconds dt)
 }
 
 void TrackedObject::update(const DetectedObjectMsg & detection)
+{
+  update_attributes(detection);
+  m_ekf.correct(make_position_measurement(detection, m_default_variance));
+}
+
+void TrackedObject::update_attributes(const DetectedObjectMsg & detection)
 {
   m_time_since_last_seen = std::chrono::nanoseconds::zero();
   m_ticks_alive++;
@@ -153,22 +199,53 @@ void TrackedObject::update(const DetectedObjectMsg & detection)
   m_msg.shape = {detection.shape};
   m_msg.kinematics.centroid_position.z = detection.kinematics.pose_with_covariance.pose.position.z;
   m_msg.kinematics.orientation = detection.kinematics.pose_with_covariance.pose.orientation;
+}
 
-  // It needs to be determined which parts of the DetectedObject message are set, and can be used
-  // to update the state. Also, even if a variable is set, its covariance might not be set.
-  autoware_auto_geometry_msgs::msg::RelativePositionWithCovarianceStamped position;
-  position.position.x = detection.kinematics.pose_with_covariance.pose.position.x;
-  position.position.y = detection.kinematics.pose_with_covariance.pose.position.y;
-  position.position.z = detection.kinematics.pose_with_covariance.pose.position.z;
-  const auto & cov = detection.kinematics.pose_with_covariance.covariance;
-  position.covariance = {cov[0], cov[1], cov[2], cov[6], cov[7], cov[8], cov[12], cov[13], cov[14]};
-  auto pose_measurement =
-    convert_to<Stamped<PoseMeasurementXYZ64>>::from(position).measurement;
-  if (!detection.kinematics.has_position_covariance) {
-    pose_measurement.covariance() = m_default_variance *
-      PoseMeasurementXYZ64::State::Matrix::Identity();
+void TrackedObject::predict_tracks(
+  std::vector<TrackedObject> & objects, std::chrono::nanoseconds dt,
+  BatchedKalmanFilter & filter)
+{
+  filter.resize(objects.size());
+  for (auto i = 0U; i < objects.size(); ++i) {
+    const auto & object = objects[i];
+    filter.set(i, object.m_ekf.state(), object.m_ekf.covariance(), object.m_noise_variance);
+  }
+  filter.predict(dt);
+  for (auto i = 0U; i < objects.size(); ++i) {
+    auto & object = objects[i];
+    filter.get(i, object.m_ekf.state(), object.m_ekf.covariance());
+    object.m_time_since_last_seen += dt;
+  }
+}
+
+void TrackedObject::update_tracks(
+  std::vector<TrackedObject> & objects,
+  const DetectedObjectsMsg::_objects_type & detections,
+  const Associations & associations, BatchedKalmanFilter & filter)
+{
+  filter.resize(objects.size());
+  for (auto i = 0U; i < associations.size(); ++i) {
+    if (associations[i].matched != Matched::kExistingTrack) {
+      continue;
+    }
+    const auto track_index = associations[i].match_index;
+    auto & object = objects[track_index];
+    object.update_attributes(detections[i]);
+    filter.set(
+      track_index, object.m_ekf.state(), object.m_ekf.covariance(), object.m_noise_variance);
+    const auto measurement = make_position_measurement(detections[i], object.m_default_variance);
+    Eigen::Vector2d position;
+    Eigen::Matrix2d covariance;
+    reduce_to_plane(measurement, position, covariance);
+    filter.add_position_measurement(track_index, position, covariance);
+  }
+  filter.correct();
+  for (const auto & association : associations) {
+    if (association.matched == Matched::kExistingTrack) {
+      auto & ekf = objects[association.match_index].m_ekf;
+      filter.get(association.match_index, ekf.state(), ekf.covariance());
+    }
   }
-  m_ekf.correct(pose_measurement);
 }
 
 void TrackedObject::update(
@@ -0,0 +1,117 @@
+// Copyright 2021 The Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <gtest/gtest.h>
+#include <measurement_conversion/measurement_typedefs.hpp>
+#include <motion_model/linear_motion_model.hpp>
+#include <state_estimation/kalman_filter/kalman_filter.hpp>
+#include <state_estimation/noise_model/wiener_noise.hpp>
+#include <tracking/batched_kalman_filter.hpp>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+using autoware::perception::tracking::BatchedKalmanFilter;
+using State = BatchedKalmanFilter::State;
+using StateMatrix = BatchedKalmanFilter::StateMatrix;
+using MotionModel = autoware::common::motion_model::LinearMotionModel<State>;
+using NoiseModel = autoware::common::state_estimation::WienerNoise<State>;
+using EKF = autoware::common::state_estimation::KalmanFilter<MotionModel, NoiseModel>;
+using Measurement = autoware::common::state_estimation::LinearMeasurement<
+  autoware::common::state_vector::GenericState<
+    double, autoware::common::state_vector::variable::X,
+    autoware::common::state_vector::variable::Y>>;
+
+namespace
+{
+
+void expect_same(const EKF & expected, const BatchedKalmanFilter & filter, std::size_t index)
+{
+  State state;
+  StateMatrix covariance;
+  filter.get(index, state, covariance);
+  EXPECT_TRUE(state.vector().isApprox(expected.state().vector(), 1e-9)) << "track " << index;
+  EXPECT_TRUE(covariance.isApprox(expected.covariance(), 1e-9)) << "track " << index;
+}
+
+}  // namespace
+
+// Predicting and correcting a batch gives the same result as a filter per track.
+TEST(TestBatchedKalmanFilter, MatchesPerTrackFilters) {
+  constexpr std::size_t kNumTracks = 37U;
+  std::mt19937 gen{42};
+  std::uniform_real_distribution<double> value{-10.0, 10.0};
+  std::uniform_real_distribution<double> variance{0.5, 5.0};
+
+  std::vector<EKF> expected;
+  BatchedKalmanFilter filter;
+  filter.resize(kNumTracks);
+  for (auto i = 0U; i < kNumTracks; ++i) {
+    State state;
+    state.vector() = State::Vector::NullaryExpr([&]() {return value(gen);});
+    const StateMatrix root = StateMatrix::NullaryExpr([&]() {return value(gen);});
+    const StateMatrix covariance = root * root.transpose() + StateMatrix::Identity();
+    const auto noise_variance = variance(gen);
+    expected.emplace_back(
+      MotionModel{}, NoiseModel{{noise_variance, noise_variance}}, state, covariance);
+    filter.set(i, state, covariance, noise_variance);
+  }
+
+  const std::chrono::milliseconds dt{100};
+  for (auto & ekf : expected) {
+    ekf.predict(dt);
+  }
+  filter.predict(dt);
+  for (auto i = 0U; i < kNumTracks; ++i) {
+    expect_same(expected[i], filter, i);
+  }
+
+  // Correct every other track.
+  for (auto i = 0U; i < kNumTracks; i += 2U) {
+    const Eigen::Vector2d position{value(gen), value(gen)};
+    Eigen::Matrix2d covariance;
+    covariance << variance(gen), 0.1, 0.1, variance(gen);
+    expected[i].correct(Measurement{position, covariance});
+    filter.add_position_measurement(i, position, covariance);
+  }
+  filter.correct();
+  for (auto i = 0U; i < kNumTracks; ++i) {
+    expect_same(expected[i], filter, i);
+  }
+}
+
+// The batch can shrink and grow while keeping the tracks that stay in it.
+TEST(TestBatchedKalmanFilter, Resize) {
+  BatchedKalmanFilter filter;
+  filter.resize(2U);
+  State state;
+  state.vector() = State::Vector::Constant(1.0);
+  filter.set(0U, state, StateMatrix::Identity(), 1.0);
+  filter.set(1U, state, 2.0 * StateMatrix::Identity(), 1.0);
+  filter.resize(1U);
+  EXPECT_EQ(filter.size(), 1U);
+  EXPECT_THROW(
+    filter.add_position_measurement(1U, Eigen::Vector2d::Zero(), Eigen::Matrix2d::Identity()),
+    std::out_of_range);
+  filter.resize(100U);
+  EXPECT_EQ(filter.size(), 100U);
+  State result;
+  StateMatrix covariance;
+  filter.get(0U, result, covariance);
+  EXPECT_EQ(result.vector(), state.vector());
+  EXPECT_EQ(covariance, StateMatrix::Identity());
+}
@@ -248,3 +248,51 @@ TEST_F(AssociationTester, AreaGatingFails)
     }
   }
 }
+
+// Groups of tracks that are far away from each other, with a detection slightly offset from every
+// track. Every group is associated on its own, so in total there can be more tracks than the
+// capacity of a single assigner, and the groups are sized to exercise every assigner.
+TEST_F(AssociationTester, IndependentGroups)
+{
+  const std::vector<size_t> group_sizes{1U, 3U, 16U, 17U, 40U, 70U, 100U, 100U};
+  const auto group_distance = 1000.0;
+  const auto track_distance = 3.0;
+
+  std::vector<tracking::TrackedObject> tracked_object_vec{};
+  DetectedObjects detections_msg;
+  for (size_t group = 0U; group < group_sizes.size(); ++group) {
+    for (size_t i = 0U; i < group_sizes[group]; ++i) {
+      DetectedObject current_track;
+      current_track.shape = create_square(4.0F);
+      current_track.kinematics.pose_with_covariance.pose.position.x =
+        group_distance * static_cast<double>(group) + track_distance * static_cast<double>(i);
+      current_track.kinematics.pose_with_covariance.pose.position.y = -group_distance;
+      current_track.kinematics.pose_with_covariance.covariance = m_some_covariance;
+      current_track.kinematics.has_position_covariance = true;
+      tracked_object_vec.emplace_back(current_track, 0.0, 0.0);
+
+      DetectedObject current_detection = current_track;
+      current_detection.kinematics.pose_with_covariance.pose.position.x += 0.3;
+      current_detection.kinematics.pose_with_covariance.pose.position.y -= 0.2;
+      detections_msg.objects.push_back(current_detection);
+    }
+  }
+  // Far away from every track
+  DetectedObject lonely_detection = detections_msg.objects.front();
+  lonely_detection.kinematics.pose_with_covariance.pose.position.y = group_distance;
+  detections_msg.objects.push_back(lonely_detection);
+  detections_msg.header.frame_id = kTrackerFrame;
+
+  tracking::TrackedObjects tracks{tracked_object_vec, kTrackerFrame};
+  ASSERT_GT(tracks.objects.size(), static_cast<size_t>(tracking::MAX_NUM_TRACKS));
+  const auto associations = m_associator.assign(detections_msg, tracks);
+
+  ASSERT_EQ(associations.size(), tracks.objects.size() + 1U);
+  for (size_t i = 0U; i < tracks.objects.size(); ++i) {
+    EXPECT_EQ(associations[i].matched, tracking::Matched::kExistingTrack);
+    EXPECT_EQ(associations[i].match_index, i);
+    EXPECT_EQ(m_associator.track_associations()[i].matched, tracking::Matched::kOtherDetection);
+    EXPECT_EQ(m_associator.track_associations()[i].match_index, i);
+  }
+  EXPECT_EQ(associations.back().matched, tracking::Matched::kNothing);
+}
@@ -15,11 +15,13 @@
 // Co-developed by Tier IV, Inc. and Apex.AI, Inc.
 
 #include <autoware_auto_perception_msgs/msg/detected_objects.hpp>
+#include <autoware_auto_perception_msgs/msg/point_clusters.hpp>
 #include <gtest/gtest.h>
 #include <nav_msgs/msg/odometry.hpp>
 #include <tracking/multi_object_tracker.hpp>
 
 #include <memory>
+#include <utility>
 
 using autoware::perception::tracking::LidarOnlyPolicy;
 using autoware::perception::tracking::MultiObjectTracker;
@@ -28,6 +30,7 @@ using autoware::perception::tracking::TrackCreator;
 using autoware::perception::tracking::MultiObjectTrackerOptions;
 using autoware::perception::tracking::TrackerUpdateStatus;
 using autoware_auto_perception_msgs::msg::DetectedObjects;
+using autoware_auto_perception_msgs::msg::PointClusters;
 using nav_msgs::msg::Odometry;
 
 class MultiObjectTrackerTest : public ::testing::Test
@@ -79,3 +82,48 @@ TEST_F(MultiObjectTrackerTest, TestFrameOrientationValidation) {
   const auto result = m_tracker.update(m_detections, m_odom);
   EXPECT_EQ(result.status, TrackerUpdateStatus::FrameNotGravityAligned);
 }
+
+TEST_F(MultiObjectTrackerTest, TestClustersViewAndMove) {
+  // Two L-shaped clusters and an empty one in between
+  PointClusters clusters;
+  clusters.header = m_detections.header;
+  const auto add_cluster = [&clusters](float x0, float y0) {
+      for (auto i = 0; i < 10; ++i) {
+        autoware_auto_perception_msgs::msg::PointXYZIF pt;
+        pt.x = x0 + 0.4F * static_cast<float>(i);
+        pt.y = y0;
+        pt.z = 0.1F * static_cast<float>(i % 3);
+        clusters.points.push_back(pt);
+        pt.x = x0;
+        pt.y = y0 + 0.2F * static_cast<float>(i + 1);
+        clusters.points.push_back(pt);
+      }
+      clusters.cluster_boundary.push_back(static_cast<uint32_t>(clusters.points.size()));
+    };
+  add_cluster(10.0F, 5.0F);
+  clusters.cluster_boundary.push_back(static_cast<uint32_t>(clusters.points.size()));
+  add_cluster(-8.0F, 2.0F);
+  m_odom.pose.pose.position.x = 3.0;
+  m_odom.pose.pose.position.y = -1.0;
+
+  MultiObjectTracker<TrackCreatorType> moved_tracker{
+    MultiObjectTrackerOptions {{2.0F, 2.5F, true}, {}}, m_track_creator, m_tf_buffer};
+  const PointClusters original_clusters = clusters;
+  const auto result = m_tracker.update(clusters, m_odom);
+  EXPECT_EQ(original_clusters, clusters);
+  const auto moved_result = moved_tracker.update(std::move(clusters), m_odom);
+
+  ASSERT_EQ(result.status, TrackerUpdateStatus::Ok);
+  ASSERT_EQ(moved_result.status, TrackerUpdateStatus::Ok);
+  ASSERT_EQ(result.tracks.objects.size(), 2U);
+  ASSERT_EQ(moved_result.tracks.objects.size(), 2U);
+  for (auto i = 0U; i < result.tracks.objects.size(); ++i) {
+    const auto & position = result.tracks.objects[i].kinematics.centroid_position;
+    const auto & moved_position =
+      moved_result.tracks.objects[i].kinematics.centroid_position;
+    EXPECT_EQ(position, moved_position);
+  }
+  // The tracks are created in the tracking frame
+  EXPECT_GT(result.tracks.objects[0].kinematics.centroid_position.x, 12.0);
+  EXPECT_LT(result.tracks.objects[1].kinematics.centroid_position.x, -2.0);
+}
@@ -21,6 +21,11 @@
 #include "gtest/gtest.h"
 #include "tracking/tracked_object.hpp"
 
+using autoware::perception::tracking::Association;
+using autoware::perception::tracking::Associations;
+using autoware::perception::tracking::BatchedKalmanFilter;
+using autoware::perception::tracking::Matched;
+
 using TrackedObject = autoware::perception::tracking::TrackedObject;
 using DetectedObjectMsg = autoware_auto_perception_msgs::msg::DetectedObject;
 using TrackedObjectMsg = autoware_auto_perception_msgs::msg::TrackedObject;
@@ -148,3 +153,57 @@ TEST(TestTrackedObject, TestShouldBeRemoved) {
   object.no_update();
   EXPECT_EQ(object.should_be_removed(std::chrono::milliseconds(1000), 5), true);
 }
+
+// Test that predicting and updating tracks in a batch gives the same result as doing it per track.
+TEST(TestTrackedObject, TestBatchedPredictAndUpdate) {
+  std::vector<TrackedObject> tracks;
+  for (auto i = 0; i < 5; ++i) {
+    DetectedObjectMsg msg;
+    msg.kinematics.pose_with_covariance.pose.position.x = 2.0 * i;
+    msg.kinematics.has_twist = true;
+    msg.kinematics.twist.twist.linear.y = 1.0 + i;
+    tracks.emplace_back(msg, 1.0, 0.5 + i);
+  }
+  auto batched_tracks = tracks;
+  BatchedKalmanFilter filter;
+
+  const std::chrono::milliseconds dt{100};
+  for (auto & track : tracks) {
+    track.predict(dt);
+  }
+  TrackedObject::predict_tracks(batched_tracks, dt, filter);
+
+  // Detections for tracks 3 and 1, the second one with a correlated z covariance.
+  std::vector<DetectedObjectMsg> detections(3U);
+  detections[0].kinematics.pose_with_covariance.pose.position.x = 6.5;
+  detections[1].kinematics.pose_with_covariance.pose.position.x = 2.5;
+  detections[1].kinematics.pose_with_covariance.pose.position.z = 1.0;
+  detections[1].kinematics.has_position_covariance = true;
+  detections[1].kinematics.pose_with_covariance.covariance[0] = 2.0;
+  detections[1].kinematics.pose_with_covariance.covariance[2] = 0.5;
+  detections[1].kinematics.pose_with_covariance.covariance[7] = 2.0;
+  detections[1].kinematics.pose_with_covariance.covariance[12] = 0.5;
+  detections[1].kinematics.pose_with_covariance.covariance[14] = 1.0;
+  const Associations associations{
+    Association{Matched::kExistingTrack, 3U},
+    Association{Matched::kExistingTrack, 1U},
+    Association{Matched::kNothing, 0U}};
+  tracks[3].update(detections[0]);
+  tracks[1].update(detections[1]);
+  TrackedObject::update_tracks(batched_tracks, detections, associations, filter);
+
+  for (auto i = 0U; i < tracks.size(); ++i) {
+    const auto & expected = tracks[i].msg().kinematics;
+    const auto & actual = batched_tracks[i].msg().kinematics;
+    EXPECT_NEAR(expected.centroid_position.x, actual.centroid_position.x, 1e-9);
+    EXPECT_NEAR(expected.centroid_position.y, actual.centroid_position.y, 1e-9);
+    EXPECT_NEAR(expected.twist.twist.linear.x, actual.twist.twist.linear.x, 1e-9);
+    EXPECT_NEAR(expected.twist.twist.linear.y, actual.twist.twist.linear.y, 1e-9);
+    for (auto j = 0U; j < expected.position_covariance.size(); ++j) {
+      EXPECT_NEAR(expected.position_covariance[j], actual.position_covariance[j], 1e-9);
+    }
+    EXPECT_EQ(
+      tracks[i].should_be_removed(std::chrono::milliseconds(50), 5U),
+      batched_tracks[i].should_be_removed(std::chrono::milliseconds(50), 5U));
+  }
+}
@@ -55,6 +55,7 @@
 #include <tf2_ros/transform_listener.h>
 
 #include <costmap_generator/visibility_control.hpp>
+#include <costmap_generator/way_area_cache.hpp>
 #include <grid_map_ros/GridMapRosConverter.hpp>
 #include <grid_map_ros/grid_map_ros.hpp>
 #include <rclcpp/rclcpp.hpp>
@@ -88,6 +89,7 @@ struct COSTMAP_GENERATOR_PUBLIC LayerName
 struct COSTMAP_GENERATOR_PUBLIC CostmapGeneratorParams
 {
   bool use_wayarea;           ///< Decide if apply Lanelet2 info to costmap
+  bool use_wayarea_cache;     ///< Keep rasterized driveable areas between calls
   bool bound_costmap;         ///< Decide if truncate costmap regarding only crucial information
   double grid_min_value;      ///< Minimal costmap grid value (freespace)
   double grid_max_value;      ///< Maximal costmap grid value (obstacle)
@@ -129,6 +131,8 @@ private:
   grid_map::GridMap costmap_;
   CostmapGeneratorParams params_;
   std::vector<std::vector<geometry_msgs::msg::Point>> area_points_;
+  std::vector<lanelet::Id> area_ids_;
+  WayAreaCache way_area_cache_;
 
   /// \brief Fills costmap data according to given lanelet roads and parking areas
   void loadDrivableAreasFromLaneletMap(lanelet::LaneletMapPtr lanelet_ptr);
@@ -150,6 +154,10 @@ private:
   grid_map::Matrix generateWayAreaCostmap(
     const geometry_msgs::msg::TransformStamped & map_to_costmap_transform) const;
 
+  /// \brief Fill the way area layer like generateWayAreaCostmap(), but only rasterize the parts
+  ///        of the driveable areas that changed on the costmap grid since the last call
+  void fillWayAreaFromCache(const geometry_msgs::msg::TransformStamped & map_to_costmap_transform);
+
   /// \brief Calculate costmap layer costs for final output
   /// \return Costmap layer
   grid_map::Matrix generateCombinedCostmap() const;
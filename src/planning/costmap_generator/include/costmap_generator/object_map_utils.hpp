@@ -48,6 +48,19 @@ void fillPolygonAreas(
   const int in_fill_color, const int in_layer_min_value, const int in_layer_max_value,
   const geometry_msgs::msg::TransformStamped & in_transform);
 
+/*!
+  * Projects the in_area_points to polygons in pixel coordinates of the image of in_grid_map, as
+  * they are filled by fillPolygonAreas.
+  * @param[in] in_grid_map GridMap object the image is created from
+  * @param[in] in_area_points Array of points containing the wayareas
+  * @param[in] in_transform Most recent transform for wayarea points (from map to costmap frame)
+  * @return Polygons in pixel coordinates, one for each element of in_area_points
+  */
+std::vector<std::vector<cv::Point>> toImagePolygons(
+  const grid_map::GridMap & in_grid_map,
+  const std::vector<std::vector<geometry_msgs::msg::Point>> & in_area_points,
+  const geometry_msgs::msg::TransformStamped & in_transform);
+
 }  // namespace object_map
 
 #endif  // COSTMAP_GENERATOR__OBJECT_MAP_UTILS_HPP_
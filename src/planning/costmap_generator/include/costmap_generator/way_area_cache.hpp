@@ -0,0 +1,127 @@
+// Copyright 2021 The Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Robotec.AI sp. z o.o.
+
+#ifndef COSTMAP_GENERATOR__WAY_AREA_CACHE_HPP_
+#define COSTMAP_GENERATOR__WAY_AREA_CACHE_HPP_
+
+#include <opencv2/core.hpp>
+
+#include <costmap_generator/visibility_control.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace autoware
+{
+namespace planning
+{
+namespace costmap_generator
+{
+
+/// \class WayAreaCache
+/// \brief Rasterized driveable areas that are kept between costmap requests
+/// \details Polygons are given in the pixel coordinates of the costmap image, exactly as
+///          object_map::fillPolygonAreas() passes them to cv::fillPoly(). The cache stores them
+///          on a lattice that moves with the costmap cells: lattice = pixel - lattice offset,
+///          where the offset changes by whole cells when the costmap moves by whole cells.
+///
+///          cv::fillPoly() gives the same pixels for the same integer vertices after an integer
+///          shift, unless the polygon is clipped by the image border. Polygons that lie completely
+///          inside of the costmap image are therefore rasterized into square tiles of the lattice
+///          and kept until their vertices change, while polygons crossing the border are filled
+///          into the costmap image on every request. The result is identical to filling all
+///          polygons into the image. Vertices change when the map changes, but also when the
+///          costmap moves by a fraction of a cell, so the tiles are only reused while the costmap
+///          keeps its sub-cell offset.
+class COSTMAP_GENERATOR_PUBLIC WayAreaCache
+{
+public:
+  /// Number of cells along each side of a tile
+  static constexpr std::int32_t TILE_SIZE = 64;
+
+  WayAreaCache();
+
+  /// \brief Replace the driveable areas and drop the tiles that do not overlap the costmap
+  /// \details Polygons are identified by the id of the map primitive they come from. A polygon
+  ///          with a known id and the same vertices on the lattice keeps its tiles, all tiles that
+  ///          overlap a new, changed or missing polygon are rasterized again when drawn.
+  /// \param [in] ids Id of every polygon
+  /// \param [in] polygons Polygons in pixel coordinates of the costmap image
+  /// \param [in] image_size Size of the costmap image
+  /// \param [in] lattice_offset Pixel of the costmap image at the origin of the lattice
+  /// \throw std::invalid_argument if ids and polygons have different sizes
+  void update(
+    const std::vector<std::int64_t> & ids, const std::vector<std::vector<cv::Point>> & polygons,
+    const cv::Size & image_size, const cv::Point & lattice_offset);
+
+  /// \brief Draw the polygons of the last update() into the costmap image
+  /// \param [in,out] image Single channel 8 bit costmap image of the size given to update()
+  /// \param [in] color Value of the pixels covered by a polygon, the others are not changed
+  void draw(cv::Mat & image, const cv::Scalar & color);
+
+  /// \brief Remove all polygons and tiles
+  void clear();
+
+  /// \brief Number of rasterized tiles
+  std::size_t tileCount() const noexcept {return tiles_.size();}
+
+  /// \brief Number of tile rasterizations since construction, to measure how often tiles are
+  ///        reused
+  std::size_t rasterizedTileCount() const noexcept {return rasterized_tile_count_;}
+
+private:
+  struct Polygon
+  {
+    /// Vertices on the lattice
+    std::vector<cv::Point> points;
+    /// Bounding box of the vertices on the lattice
+    cv::Rect bounds;
+    /// Whether the polygon lies inside of the costmap image and is part of the tiles
+    bool tiled{false};
+    /// Last update() that contained this polygon, 0 for a polygon that was just created
+    std::size_t generation{0U};
+  };
+
+  /// \brief Drop the tiles that overlap a rectangle of the lattice
+  void invalidate(const cv::Rect & bounds);
+
+  /// \brief Rasterize the tiles overlapping the costmap that are missing
+  void rasterizeMissingTiles();
+
+  /// \brief Rectangle of the lattice covered by a tile
+  static cv::Rect tileBounds(const std::int32_t tile_x, const std::int32_t tile_y);
+
+  std::size_t generation_;
+  std::unordered_map<std::int64_t, Polygon> polygons_;
+  /// Rasterized tiles, one byte per cell in row major order of y and x
+  std::unordered_map<std::uint64_t, std::vector<std::uint8_t>> tiles_;
+  /// Costmap image of the last update() on the lattice
+  cv::Rect image_bounds_;
+  cv::Point lattice_offset_;
+  /// Polygons crossing the costmap border in pixel coordinates of the costmap image
+  std::vector<std::vector<cv::Point>> clipped_polygons_;
+  /// Canvas for rasterizing a single polygon, kept to avoid allocations
+  cv::Mat canvas_;
+  std::size_t rasterized_tile_count_;
+};
+
+}  // namespace costmap_generator
+}  // namespace planning
+}  // namespace autoware
+
+#endif  // COSTMAP_GENERATOR__WAY_AREA_CACHE_HPP_
@@ -45,6 +45,7 @@
  ********************/
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <memory>
 #include <string>
@@ -123,12 +124,14 @@ void CostmapGenerator::loadParkingAreasFromLaneletMap(const lanelet::LaneletMapP
   for (const auto & parking_spot_area : parking_spot_areas) {
     auto parking_spot_poly = autoware::common::had_map_utils::area2Polygon(parking_spot_area);
     area_points_.push_back(poly2vector(parking_spot_poly));
+    area_ids_.push_back(parking_spot_area.id());
   }
 
   // Collect points from parking spaces
   for (const auto & parking_access_area : parking_access_areas) {
     auto parking_access_poly = autoware::common::had_map_utils::area2Polygon(parking_access_area);
     area_points_.push_back(poly2vector(parking_access_poly));
+    area_ids_.push_back(parking_access_area.id());
   }
 }
 
@@ -139,6 +142,7 @@ void CostmapGenerator::loadRoadAreasFromLaneletMap(const lanelet::LaneletMapPtr
   for (const auto & road_lanelet : road_lanelets) {
     auto road_poly = autoware::common::had_map_utils::lanelet2Polygon(road_lanelet);
     area_points_.push_back(poly2vector(road_poly));
+    area_ids_.push_back(road_lanelet.id());
   }
 }
 
@@ -148,6 +152,7 @@ grid_map::GridMap CostmapGenerator::generateCostmap(
 {
   // Clear data points
   area_points_.clear();
+  area_ids_.clear();
 
   // Supply Lanelet map to costmap generator
   loadDrivableAreasFromLaneletMap(lanelet_ptr);
@@ -157,7 +162,11 @@ grid_map::GridMap CostmapGenerator::generateCostmap(
 
   // Apply lanelet2 info to costmap
   if (params_.use_wayarea) {
-    costmap_[LayerName::WAYAREA] = generateWayAreaCostmap(map_to_costmap_transform);
+    if (params_.use_wayarea_cache) {
+      fillWayAreaFromCache(map_to_costmap_transform);
+    } else {
+      costmap_[LayerName::WAYAREA] = generateWayAreaCostmap(map_to_costmap_transform);
+    }
   }
 
   costmap_[LayerName::COMBINED] = generateCombinedCostmap();
@@ -177,14 +186,7 @@ grid_map::GridMap CostmapGenerator::generateCostmap(
 grid_map::Matrix CostmapGenerator::generateCombinedCostmap() const
 {
   // assuming combined_costmap is calculated by element wise max operation
-  grid_map::GridMap combined_costmap = costmap_;
-
-  combined_costmap[LayerName::COMBINED].setConstant(static_cast<float>(params_.grid_min_value));
-
-  combined_costmap[LayerName::COMBINED] =
-    combined_costmap[LayerName::COMBINED].cwiseMax(combined_costmap[LayerName::WAYAREA]);
-
-  return combined_costmap[LayerName::COMBINED];
+  return costmap_[LayerName::WAYAREA].cwiseMax(static_cast<float>(params_.grid_min_value));
 }
 
 grid_map::Matrix CostmapGenerator::generateWayAreaCostmap(
@@ -204,6 +206,39 @@ grid_map::Matrix CostmapGenerator::generateWayAreaCostmap(
   return lanelet2_costmap[LayerName::WAYAREA];
 }
 
+void CostmapGenerator::fillWayAreaFromCache(
+  const geometry_msgs::msg::TransformStamped & map_to_costmap_transform)
+{
+  const auto & grid_min_value = static_cast<int>(params_.grid_min_value);
+  const auto & grid_max_value = static_cast<int>(params_.grid_max_value);
+  costmap_[LayerName::WAYAREA].setConstant(static_cast<float>(params_.grid_max_value));
+  if (area_points_.empty()) {
+    way_area_cache_.clear();
+    return;
+  }
+
+  cv::Mat image;
+  grid_map::GridMapCvConverter::toImage<unsigned char, 1>(
+    costmap_, LayerName::WAYAREA, CV_8UC1, grid_min_value, grid_max_value, image);
+
+  // The polygons are projected exactly as in generateWayAreaCostmap(). The whole cells of the
+  // costmap position are taken out of their pixel coordinates, so that the cache sees the same
+  // polygons while the costmap moves by whole cells.
+  const auto & length = costmap_.getLength();
+  const auto & position = costmap_.getPosition();
+  const auto resolution = costmap_.getResolution();
+  const cv::Point lattice_offset(
+    static_cast<int>(std::lround((length.y() / 2.0 + position.y()) / resolution)),
+    static_cast<int>(std::lround((length.x() / 2.0 + position.x()) / resolution)));
+  way_area_cache_.update(
+    area_ids_, object_map::toImagePolygons(costmap_, area_points_, map_to_costmap_transform),
+    image.size(), lattice_offset);
+  way_area_cache_.draw(image, cv::Scalar(grid_min_value));
+
+  grid_map::GridMapCvConverter::addLayerFromImage<unsigned char, 1>(
+    image, LayerName::WAYAREA, costmap_, grid_min_value, grid_max_value);
+}
+
 grid_map::GridMap CostmapGenerator::boundCostmap(
   const grid_map::Position & min_point, const grid_map::Position & max_point) const
 {
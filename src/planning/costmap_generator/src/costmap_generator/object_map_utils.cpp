@@ -35,6 +35,7 @@
 #include "costmap_generator/object_map_utils.hpp"
 
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace object_map
@@ -58,11 +59,33 @@ void fillPolygonAreas(
 
   cv::Mat merged_filled_image = original_image.clone();
 
-  // calculate out_grid_map position
-  grid_map::Position map_pos = out_grid_map.getPosition();
-  const double origin_x_offset = out_grid_map.getLength().x() / 2.0 - map_pos.x();
-  const double origin_y_offset = out_grid_map.getLength().y() / 2.0 - map_pos.y();
+  for (const auto & cv_polygon : toImagePolygons(out_grid_map, in_area_points, in_transform)) {
+    cv::Mat filled_image = original_image.clone();
+
+    std::vector<std::vector<cv::Point>> cv_polygons;
+    cv_polygons.push_back(cv_polygon);
+    cv::fillPoly(filled_image, cv_polygons, cv::Scalar(in_fill_color));
+
+    merged_filled_image &= filled_image;
+  }
 
+  // convert to ROS msg
+  grid_map::GridMapCvConverter::addLayerFromImage<unsigned char, 1>(
+    merged_filled_image, in_grid_layer_name, out_grid_map, in_layer_min_value, in_layer_max_value);
+}
+
+std::vector<std::vector<cv::Point>> toImagePolygons(
+  const grid_map::GridMap & in_grid_map,
+  const std::vector<std::vector<geometry_msgs::msg::Point>> & in_area_points,
+  const geometry_msgs::msg::TransformStamped & in_transform)
+{
+  // calculate in_grid_map position
+  grid_map::Position map_pos = in_grid_map.getPosition();
+  const double origin_x_offset = in_grid_map.getLength().x() / 2.0 - map_pos.x();
+  const double origin_y_offset = in_grid_map.getLength().y() / 2.0 - map_pos.y();
+
+  std::vector<std::vector<cv::Point>> cv_polygons;
+  cv_polygons.reserve(in_area_points.size());
   for (const auto & points : in_area_points) {
     std::vector<cv::Point> cv_polygon;
 
@@ -75,25 +98,15 @@ void fillPolygonAreas(
       transformed_point = output_stamped.point;
 
       // coordinate conversion for cv image
-      const double cv_x = (out_grid_map.getLength().y() - origin_y_offset - transformed_point.y) /
-        out_grid_map.getResolution();
-      const double cv_y = (out_grid_map.getLength().x() - origin_x_offset - transformed_point.x) /
-        out_grid_map.getResolution();
+      const double cv_x = (in_grid_map.getLength().y() - origin_y_offset - transformed_point.y) /
+        in_grid_map.getResolution();
+      const double cv_y = (in_grid_map.getLength().x() - origin_x_offset - transformed_point.x) /
+        in_grid_map.getResolution();
       cv_polygon.emplace_back(cv_x, cv_y);
     }
-
-    cv::Mat filled_image = original_image.clone();
-
-    std::vector<std::vector<cv::Point>> cv_polygons;
-    cv_polygons.push_back(cv_polygon);
-    cv::fillPoly(filled_image, cv_polygons, cv::Scalar(in_fill_color));
-
-    merged_filled_image &= filled_image;
+    cv_polygons.push_back(std::move(cv_polygon));
   }
-
-  // convert to ROS msg
-  grid_map::GridMapCvConverter::addLayerFromImage<unsigned char, 1>(
-    merged_filled_image, in_grid_layer_name, out_grid_map, in_layer_min_value, in_layer_max_value);
+  return cv_polygons;
 }
 
 }  // namespace object_map
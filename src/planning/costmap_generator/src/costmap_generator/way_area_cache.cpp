@@ -0,0 +1,289 @@
+// Copyright 2021 The Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Robotec.AI sp. z o.o.
+
+#include "costmap_generator/way_area_cache.hpp"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+namespace autoware
+{
+namespace planning
+{
+namespace costmap_generator
+{
+
+namespace
+{
+std::int32_t toTile(const std::int32_t cell)
+{
+  // Division rounding towards negative infinity
+  return (cell >= 0) ? (cell / WayAreaCache::TILE_SIZE) :
+         -((-cell + WayAreaCache::TILE_SIZE - 1) / WayAreaCache::TILE_SIZE);
+}
+
+std::uint64_t toTileKey(const std::int32_t tile_x, const std::int32_t tile_y)
+{
+  return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(tile_x)) << 32U) |
+         static_cast<std::uint64_t>(static_cast<std::uint32_t>(tile_y));
+}
+
+std::int32_t toTileX(const std::uint64_t key)
+{
+  return static_cast<std::int32_t>(static_cast<std::uint32_t>(key >> 32U));
+}
+
+std::int32_t toTileY(const std::uint64_t key)
+{
+  return static_cast<std::int32_t>(static_cast<std::uint32_t>(key));
+}
+
+bool isInside(const std::vector<cv::Point> & points, const cv::Size & image_size)
+{
+  return !points.empty() && std::all_of(
+    points.begin(), points.end(), [&image_size](const cv::Point & point) {
+      return (point.x >= 0) && (point.x < image_size.width) &&
+             (point.y >= 0) && (point.y < image_size.height);
+    });
+}
+
+/// Fill a single polygon, several contours in one call would be filled with the even-odd rule
+void fillPolygon(
+  cv::Mat & image, const std::vector<cv::Point> & polygon, const cv::Scalar & color,
+  const cv::Point & offset)
+{
+  const cv::Point * points = polygon.data();
+  const auto count = static_cast<int>(polygon.size());
+  cv::fillPoly(image, &points, &count, 1, color, cv::LINE_8, 0, offset);
+}
+}  // namespace
+
+constexpr std::int32_t WayAreaCache::TILE_SIZE;
+
+WayAreaCache::WayAreaCache()
+: generation_(0U),
+  rasterized_tile_count_(0U)
+{
+}
+
+void WayAreaCache::update(
+  const std::vector<std::int64_t> & ids, const std::vector<std::vector<cv::Point>> & polygons,
+  const cv::Size & image_size, const cv::Point & lattice_offset)
+{
+  if (ids.size() != polygons.size()) {
+    throw std::invalid_argument("Every polygon needs an id.");
+  }
+  ++generation_;
+  image_bounds_ = cv::Rect(-lattice_offset, image_size);
+  lattice_offset_ = lattice_offset;
+  clipped_polygons_.clear();
+
+  for (std::size_t i = 0U; i < polygons.size(); ++i) {
+    const auto & points = polygons[i];
+    const auto tiled = isInside(points, image_size);
+    if (!tiled) {
+      clipped_polygons_.push_back(points);
+    }
+
+    auto & polygon = polygons_[ids[i]];
+    if ((polygon.generation != 0U) && (polygon.tiled == tiled) &&
+      (polygon.points.size() == points.size()) &&
+      std::equal(
+        points.begin(), points.end(), polygon.points.begin(),
+        [&lattice_offset](const cv::Point & point, const cv::Point & cached) {
+          return (point - lattice_offset) == cached;
+        }))
+    {
+      polygon.generation = generation_;
+      continue;
+    }
+    // New or changed polygon, the tiles of the old and the new shape have to be rasterized again
+    if (polygon.tiled) {
+      invalidate(polygon.bounds);
+    }
+    polygon.points.resize(points.size());
+    std::transform(
+      points.begin(), points.end(), polygon.points.begin(),
+      [&lattice_offset](const cv::Point & point) {return point - lattice_offset;});
+    polygon.bounds = cv::boundingRect(polygon.points);
+    polygon.tiled = tiled;
+    polygon.generation = generation_;
+    if (polygon.tiled) {
+      invalidate(polygon.bounds);
+    }
+  }
+
+  // Polygons that are not part of the map anymore
+  for (auto it = polygons_.begin(); it != polygons_.end(); ) {
+    if (it->second.generation != generation_) {
+      if (it->second.tiled) {
+        invalidate(it->second.bounds);
+      }
+      it = polygons_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // Tiles that moved out of the costmap, which keeps the cache as large as the costmap
+  for (auto it = tiles_.begin(); it != tiles_.end(); ) {
+    if ((tileBounds(toTileX(it->first), toTileY(it->first)) & image_bounds_).empty()) {
+      it = tiles_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void WayAreaCache::draw(cv::Mat & image, const cv::Scalar & color)
+{
+  if ((image.type() != CV_8UC1) || (image.size() != image_bounds_.size())) {
+    throw std::invalid_argument("The image does not match the last update.");
+  }
+  rasterizeMissingTiles();
+
+  const auto value = cv::saturate_cast<std::uint8_t>(color[0]);
+  for (const auto & entry : tiles_) {
+    const auto tile_bounds = tileBounds(toTileX(entry.first), toTileY(entry.first));
+    const auto visible = tile_bounds & image_bounds_;
+    const auto & tile = entry.second;
+    for (auto y = visible.y; y < visible.y + visible.height; ++y) {
+      const auto * tile_row = &tile[static_cast<std::size_t>((y - tile_bounds.y) * TILE_SIZE)];
+      auto * image_row = image.ptr<std::uint8_t>(y + lattice_offset_.y);
+      for (auto x = visible.x; x < visible.x + visible.width; ++x) {
+        if (tile_row[x - tile_bounds.x] != 0U) {
+          image_row[x + lattice_offset_.x] = value;
+        }
+      }
+    }
+  }
+
+  // cv::fillPoly() draws clipped edges differently, so these are filled into the image itself
+  for (const auto & polygon : clipped_polygons_) {
+    fillPolygon(image, polygon, color, cv::Point());
+  }
+}
+
+void WayAreaCache::clear()
+{
+  polygons_.clear();
+  tiles_.clear();
+  clipped_polygons_.clear();
+}
+
+void WayAreaCache::invalidate(const cv::Rect & bounds)
+{
+  const auto min_tile_x = toTile(bounds.x);
+  const auto min_tile_y = toTile(bounds.y);
+  const auto max_tile_x = toTile(bounds.x + bounds.width - 1);
+  const auto max_tile_y = toTile(bounds.y + bounds.height - 1);
+  const auto tile_count = (static_cast<std::uint64_t>(max_tile_x - min_tile_x) + 1U) *
+    (static_cast<std::uint64_t>(max_tile_y - min_tile_y) + 1U);
+  if (tile_count <= tiles_.size()) {
+    for (auto tile_x = min_tile_x; tile_x <= max_tile_x; ++tile_x) {
+      for (auto tile_y = min_tile_y; tile_y <= max_tile_y; ++tile_y) {
+        tiles_.erase(toTileKey(tile_x, tile_y));
+      }
+    }
+  } else {
+    // A huge polygon, visiting the rasterized tiles is cheaper
+    for (auto it = tiles_.begin(); it != tiles_.end(); ) {
+      const auto tile_x = toTileX(it->first);
+      const auto tile_y = toTileY(it->first);
+      if ((tile_x >= min_tile_x) && (tile_x <= max_tile_x) &&
+        (tile_y >= min_tile_y) && (tile_y <= max_tile_y))
+      {
+        it = tiles_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+void WayAreaCache::rasterizeMissingTiles()
+{
+  if (image_bounds_.empty()) {
+    return;
+  }
+  std::unordered_set<std::uint64_t> missing_tiles;
+  const auto last_x = image_bounds_.x + image_bounds_.width - 1;
+  const auto last_y = image_bounds_.y + image_bounds_.height - 1;
+  for (auto tile_x = toTile(image_bounds_.x); tile_x <= toTile(last_x); ++tile_x) {
+    for (auto tile_y = toTile(image_bounds_.y); tile_y <= toTile(last_y); ++tile_y) {
+      const auto key = toTileKey(tile_x, tile_y);
+      if (tiles_.find(key) == tiles_.end()) {
+        tiles_[key].assign(static_cast<std::size_t>(TILE_SIZE * TILE_SIZE), 0U);
+        missing_tiles.insert(key);
+      }
+    }
+  }
+  if (missing_tiles.empty()) {
+    return;
+  }
+  rasterized_tile_count_ += missing_tiles.size();
+
+  for (const auto & entry : polygons_) {
+    const auto & polygon = entry.second;
+    if (!polygon.tiled) {
+      continue;
+    }
+    const auto & bounds = polygon.bounds;
+    const auto min_tile_x = toTile(bounds.x);
+    const auto min_tile_y = toTile(bounds.y);
+    const auto max_tile_x = toTile(bounds.x + bounds.width - 1);
+    const auto max_tile_y = toTile(bounds.y + bounds.height - 1);
+    auto rendered = false;
+    for (auto tile_x = min_tile_x; tile_x <= max_tile_x; ++tile_x) {
+      for (auto tile_y = min_tile_y; tile_y <= max_tile_y; ++tile_y) {
+        const auto key = toTileKey(tile_x, tile_y);
+        if (missing_tiles.count(key) == 0U) {
+          continue;
+        }
+        // The polygon lies inside of the canvas, so it is filled exactly as in the costmap image
+        if (!rendered) {
+          canvas_.create(bounds.size(), CV_8UC1);
+          canvas_.setTo(cv::Scalar(0));
+          fillPolygon(canvas_, polygon.points, cv::Scalar(1), -bounds.tl());
+          rendered = true;
+        }
+        const auto tile_bounds = tileBounds(tile_x, tile_y);
+        const auto overlap = tile_bounds & bounds;
+        auto & tile = tiles_[key];
+        for (auto y = overlap.y; y < overlap.y + overlap.height; ++y) {
+          const auto * canvas_row = canvas_.ptr<std::uint8_t>(y - bounds.y);
+          auto * tile_row = &tile[static_cast<std::size_t>((y - tile_bounds.y) * TILE_SIZE)];
+          for (auto x = overlap.x; x < overlap.x + overlap.width; ++x) {
+            tile_row[x - tile_bounds.x] |= canvas_row[x - bounds.x];
+          }
+        }
+      }
+    }
+  }
+}
+
+cv::Rect WayAreaCache::tileBounds(const std::int32_t tile_x, const std::int32_t tile_y)
+{
+  return cv::Rect(tile_x * TILE_SIZE, tile_y * TILE_SIZE, TILE_SIZE, TILE_SIZE);
+}
+
+}  // namespace costmap_generator
+}  // namespace planning
+}  // namespace autoware
@@ -16,9 +16,12 @@
 
 #include <gtest/gtest.h>
 
+#include <opencv2/imgproc.hpp>
+
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "had_map_utils/had_map_query.hpp"
 #include "costmap_generator/costmap_generator.hpp"
@@ -26,6 +29,7 @@
 using autoware::planning::costmap_generator::CostmapGenerator;
 using autoware::planning::costmap_generator::CostmapGeneratorParams;
 using autoware::planning::costmap_generator::LayerName;
+using autoware::planning::costmap_generator::WayAreaCache;
 
 CostmapGeneratorParams generateExampleParameters(
   const bool bound_costmap = true, const bool use_wayarea = true)
@@ -41,6 +45,7 @@ CostmapGeneratorParams generateExampleParameters(
   params.grid_position_y = 0.0;
   params.use_wayarea = use_wayarea;
   params.bound_costmap = bound_costmap;
+  params.use_wayarea_cache = false;
   params.costmap_frame = "map";
 
   return params;
@@ -48,7 +53,7 @@ CostmapGeneratorParams generateExampleParameters(
 
 std::shared_ptr<lanelet::LaneletMap> createLanelet(
   const double & resolution, const double & width = 2.0,
-  const double & length = 5.0)
+  const double & length = 5.0, const double & offset_x = 0.0)
 {
   using lanelet::Point3d;
   using lanelet::LineString3d;
@@ -57,10 +62,10 @@ std::shared_ptr<lanelet::LaneletMap> createLanelet(
 
   double padding = resolution / 2.0;
   // prepare parking place points
-  Point3d p1(getId(), padding, padding, 0.0);
-  Point3d p2(getId(), padding, width + padding, 0.0);
-  Point3d p3(getId(), length + padding, width + padding, 0.0);
-  Point3d p4(getId(), length + padding, padding, 0.0);
+  Point3d p1(getId(), offset_x + padding, padding, 0.0);
+  Point3d p2(getId(), offset_x + padding, width + padding, 0.0);
+  Point3d p3(getId(), offset_x + length + padding, width + padding, 0.0);
+  Point3d p4(getId(), offset_x + length + padding, padding, 0.0);
 
   // prepare linestrings
   LineString3d bottom(getId(), {p1, p2});
@@ -215,6 +220,136 @@ TEST(CostmapGeneratorTest, GenerateCostmapWithoutWayareasExpectOnlyObstacles)
   }
 }
 
+TEST(CostmapGeneratorTest, GenerateCachedCostmap)
+{
+  // initialize costmap generators with and without cache
+  auto costmap_param = generateExampleParameters(false);
+  auto costmap_generator = std::make_unique<CostmapGenerator>(costmap_param);
+  costmap_param.use_wayarea_cache = true;
+  auto cached_costmap_generator = std::make_unique<CostmapGenerator>(costmap_param);
+
+  auto lanelet_map_ptr = createLanelet(costmap_param.grid_resolution);
+
+  // map frame = costmap frame
+  geometry_msgs::msg::TransformStamped costmap_to_map_transform;
+
+  auto cell_value_treshold =
+    static_cast<float>((costmap_param.grid_min_value + costmap_param.grid_max_value) / 2.0);
+
+  // move the grid around off the cell grid and by whole cells, the last position puts the border
+  // of the costmap through the parking place
+  for (const auto & vehicle_to_grid_position :
+    {grid_map::Position(0.0, 0.0), grid_map::Position(3.13, -2.27),
+      grid_map::Position(3.33, -2.07), grid_map::Position(0.0, 0.0),
+      grid_map::Position(-32.97, 0.05)})
+  {
+    auto costmap = cached_costmap_generator->generateCostmap(
+      lanelet_map_ptr, vehicle_to_grid_position, costmap_to_map_transform);
+    auto expected_costmap = costmap_generator->generateCostmap(
+      lanelet_map_ptr, vehicle_to_grid_position, costmap_to_map_transform);
+
+    for (const auto & layer : {LayerName::WAYAREA, LayerName::COMBINED}) {
+      EXPECT_EQ(costmap[layer].cwiseNotEqual(expected_costmap[layer]).count(), 0) << layer;
+    }
+    EXPECT_GT((costmap[LayerName::COMBINED].array() < cell_value_treshold).count(), 0);
+  }
+}
+
+TEST(CostmapGeneratorTest, CachedCostmapFollowsMapChanges)
+{
+  // initialize costmap generator
+  auto costmap_param = generateExampleParameters(false);
+  costmap_param.use_wayarea_cache = true;
+  auto costmap_generator = std::make_unique<CostmapGenerator>(costmap_param);
+
+  grid_map::Position vehicle_to_grid_position(0.0, 0.0);
+  geometry_msgs::msg::TransformStamped costmap_to_map_transform;
+  const grid_map::Position first_place(1.0, 1.0);
+  const grid_map::Position second_place(11.0, 1.0);
+  const grid_map::Position third_place(21.0, 1.0);
+
+  auto costmap = costmap_generator->generateCostmap(
+    createLanelet(costmap_param.grid_resolution), vehicle_to_grid_position,
+    costmap_to_map_transform);
+  EXPECT_FLOAT_EQ(
+    costmap.atPosition(LayerName::COMBINED, first_place),
+    static_cast<float>(costmap_param.grid_min_value));
+  EXPECT_FLOAT_EQ(
+    costmap.atPosition(LayerName::COMBINED, second_place),
+    static_cast<float>(costmap_param.grid_max_value));
+
+  // a new map replaces the parking place with one further away
+  auto lanelet_map_ptr = createLanelet(costmap_param.grid_resolution, 2.0, 5.0, 10.0);
+  costmap = costmap_generator->generateCostmap(
+    lanelet_map_ptr, vehicle_to_grid_position, costmap_to_map_transform);
+  EXPECT_FLOAT_EQ(
+    costmap.atPosition(LayerName::COMBINED, first_place),
+    static_cast<float>(costmap_param.grid_max_value));
+  EXPECT_FLOAT_EQ(
+    costmap.atPosition(LayerName::COMBINED, second_place),
+    static_cast<float>(costmap_param.grid_min_value));
+
+  // the same parking place, with the same id, is moved further away
+  for (auto & point : lanelet_map_ptr->pointLayer) {
+    point.x() += 10.0;
+  }
+  costmap = costmap_generator->generateCostmap(
+    lanelet_map_ptr, vehicle_to_grid_position, costmap_to_map_transform);
+  EXPECT_FLOAT_EQ(
+    costmap.atPosition(LayerName::COMBINED, second_place),
+    static_cast<float>(costmap_param.grid_max_value));
+  EXPECT_FLOAT_EQ(
+    costmap.atPosition(LayerName::COMBINED, third_place),
+    static_cast<float>(costmap_param.grid_min_value));
+}
+
+TEST(WayAreaCacheTest, DrawLikeFillPoly)
+{
+  const cv::Size image_size(100, 80);
+  const std::vector<std::int64_t> ids{1, 2, 3};
+  // two overlapping polygons inside of the image and one crossing its border, in pixels of an
+  // image at the origin of the lattice
+  const std::vector<std::vector<cv::Point>> lattice_polygons{
+    {{10, 10}, {60, 12}, {45, 50}, {12, 40}},
+    {{40, 30}, {90, 35}, {70, 70}},
+    {{-20, 60}, {30, 55}, {25, 95}}};
+
+  WayAreaCache cache;
+  // the costmap moves around, far enough that all polygons leave it
+  for (int step = 0; step < 40; ++step) {
+    const cv::Point lattice_offset(step * 7 - 120, 50 - step * 3);
+    std::vector<std::vector<cv::Point>> polygons;
+    for (const auto & lattice_polygon : lattice_polygons) {
+      polygons.emplace_back();
+      for (const auto & point : lattice_polygon) {
+        polygons.back().push_back(point + lattice_offset);
+      }
+    }
+
+    cv::Mat expected_image(image_size, CV_8UC1, cv::Scalar(255));
+    for (const auto & polygon : polygons) {
+      cv::fillPoly(expected_image, std::vector<std::vector<cv::Point>>{polygon}, cv::Scalar(0));
+    }
+
+    for (int repetition = 0; repetition < 2; ++repetition) {
+      const auto rasterized_tile_count = cache.rasterizedTileCount();
+      cache.update(ids, polygons, image_size, lattice_offset);
+      cv::Mat image(image_size, CV_8UC1, cv::Scalar(255));
+      cache.draw(image, cv::Scalar(0));
+      EXPECT_EQ(cv::countNonZero(image != expected_image), 0) << "step " << step;
+      // only the tiles overlapping the costmap are kept
+      EXPECT_LE(cache.tileCount(), 3U * 3U);
+      if (repetition > 0) {
+        EXPECT_EQ(cache.rasterizedTileCount(), rasterized_tile_count);
+      }
+    }
+  }
+
+  EXPECT_THROW(
+    cache.update({1}, std::vector<std::vector<cv::Point>>{}, image_size, cv::Point()),
+    std::invalid_argument);
+}
+
 TEST(CostmapGeneratorTest, InitializeCostmapWithZeroResolution)
 {
   // initialize costmap generator
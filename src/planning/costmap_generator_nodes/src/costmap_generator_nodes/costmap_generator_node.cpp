@@ -162,6 +162,7 @@ CostmapGeneratorNode::CostmapGeneratorNode(const rclcpp::NodeOptions & node_opti
   costmap_params_.grid_position_x = this->declare_parameter<double>("grid_position_x", 0);
   costmap_params_.grid_position_y = this->declare_parameter<double>("grid_position_y", 0);
   costmap_params_.use_wayarea = this->declare_parameter<bool>("use_wayarea", true);
+  costmap_params_.use_wayarea_cache = this->declare_parameter<bool>("use_wayarea_cache", false);
   costmap_params_.bound_costmap = this->declare_parameter<bool>("bound_costmap", true);
   costmap_params_.costmap_frame = this->declare_parameter<std::string>("costmap_frame", "map");
 
@@ -27,7 +27,6 @@
 #include <std_msgs/msg/header.hpp>
 
 #include <vector>
-#include <queue>
 
 namespace autoware
 {
@@ -52,22 +51,31 @@ struct FREESPACE_PLANNER_PUBLIC AstarParam
 struct AstarNode
 {
   NodeStatus status = NodeStatus::None;  // node status
+  bool is_back = false;                  // true if the current direction of the vehicle is back
+  uint32_t generation = 0;               // search in which the node was last reset
   double x;                              // x
   double y;                              // y
   double theta;                          // theta
   double gc = 0;                         // actual cost
   double hc = 0;                         // heuristic cost
-  bool is_back;                          // true if the current direction of the vehicle is back
   AstarNode * parent = nullptr;          // parent node
 
   double cost() const {return gc + hc;}
 };
 
-struct NodeComparison
+/// Open list entry, which keeps the cost next to the node index so that ordering the open
+/// list does not need to load the nodes
+struct OpenListEntry
 {
-  bool operator()(const AstarNode * lhs, const AstarNode * rhs)
+  double cost;
+  size_t index;
+};
+
+struct OpenListComparison
+{
+  bool operator()(const OpenListEntry & lhs, const OpenListEntry & rhs) const
   {
-    return lhs->cost() > rhs->cost();
+    return lhs.cost > rhs.cost;
   }
 };
 
@@ -139,14 +147,19 @@ private:
   bool isGoal(const AstarNode & node) const;
 
   AstarNode * getNodeRef(const IndexXYT & index);
+  void pushOpenList(AstarNode * node);
 
   // Algorithm specific param
   AstarParam astar_param_;
 
   // hybrid astar variables
   TransitionTable transition_table_;
-  std::vector<std::vector<std::vector<AstarNode>>> nodes_;
-  std::priority_queue<AstarNode *, std::vector<AstarNode *>, NodeComparison> openlist_;
+  // Nodes of all (y, x, theta) cells in row-major order, kept across searches and costmaps.
+  // A node whose generation differs from generation_ has not been reached by the current search.
+  std::vector<AstarNode> nodes_;
+  uint32_t generation_ = 0;
+  // Binary heap ordered by OpenListComparison
+  std::vector<OpenListEntry> openlist_;
 };
 
 }  // namespace freespace_planner
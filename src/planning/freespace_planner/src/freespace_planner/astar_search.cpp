@@ -17,6 +17,7 @@
 
 #include "freespace_planner/astar_search.hpp"
 
+#include <algorithm>
 #include <vector>
 
 #include "tf2/utils.h"
@@ -29,6 +30,9 @@ namespace planning
 {
 namespace freespace_planner
 {
+// Number of expansions between two checks of the time limit
+constexpr size_t TIME_LIMIT_CHECK_INTERVAL = 64U;
+
 constexpr double deg2rad(const double deg)
 {
   return deg * M_PI / 180.0;
@@ -160,6 +164,15 @@ SearchStatus AstarSearch::makePlan(
   start_pose_ = global2local(costmap_, start_pose);
   goal_pose_ = global2local(costmap_, goal_pose);
 
+  // Start a new generation, so that all nodes count as unreached without touching them
+  openlist_.clear();
+  if (++generation_ == 0U) {
+    for (auto & node : nodes_) {
+      node.generation = 0U;
+    }
+    generation_ = 1U;
+  }
+
   if (!setStartNode()) {
     return SearchStatus::FAILURE_COLLISION_AT_START;
   }
@@ -193,7 +206,7 @@ bool AstarSearch::setStartNode()
   start_node->parent = nullptr;
 
   // Push start node to openlist
-  openlist_.push(start_node);
+  pushOpenList(start_node);
 
   return true;
 }
@@ -229,37 +242,42 @@ double AstarSearch::estimateCost(const geometry_msgs::msg::Pose & pose) const
 void AstarSearch::setOccupancyGrid(const nav_msgs::msg::OccupancyGrid & costmap)
 {
   BasePlanningAlgorithm::setOccupancyGrid(costmap);
-  const auto height = costmap_.info.height;
-  const auto width = costmap_.info.width;
-
-  // Initialize nodes
-  nodes_.clear();
-  nodes_.resize(height);
-  for (size_t i = 0; i < height; i++) {
-    nodes_[i].resize(width);
-    for (size_t j = 0; j < width; j++) {
-      nodes_[i][j].resize(planner_common_param_.theta_size);
-    }
-  }
+  const auto height = static_cast<size_t>(costmap_.info.height);
+  const auto width = static_cast<size_t>(costmap_.info.width);
+
+  // Nodes are reset lazily by getNodeRef, so memory is only allocated when the costmap grows
+  nodes_.resize(height * width * planner_common_param_.theta_size);
 }
 
 SearchStatus AstarSearch::search()
 {
-  const rclcpp::Time begin = rclcpp::Clock(RCL_ROS_TIME).now();
+  rclcpp::Clock clock(RCL_ROS_TIME);
+  const rclcpp::Time begin = clock.now();
 
   // Start A* search
+  size_t num_expansions = 0U;
   while (!openlist_.empty()) {
-    // Check time and terminate if the search reaches the time limit
-    const rclcpp::Time now = rclcpp::Clock(RCL_ROS_TIME).now();
-    const double msec = (now - begin).seconds() * 1000.0;
-    if (msec > planner_common_param_.time_limit) {
-      return SearchStatus::FAILURE_TIMEOUT_EXCEEDED;
+    // Check time and terminate if the search reaches the time limit. Reading the clock costs
+    // about as much as an expansion, so it is only read every few expansions.
+    if ((num_expansions % TIME_LIMIT_CHECK_INTERVAL) == 0U) {
+      const rclcpp::Time now = clock.now();
+      const double msec = (now - begin).seconds() * 1000.0;
+      if (msec > planner_common_param_.time_limit) {
+        return SearchStatus::FAILURE_TIMEOUT_EXCEEDED;
+      }
     }
 
     // Expand minimum cost node
-    AstarNode * current_node = openlist_.top();
-    openlist_.pop();
+    std::pop_heap(openlist_.begin(), openlist_.end(), OpenListComparison{});
+    AstarNode * current_node = &nodes_[openlist_.back().index];
+    openlist_.pop_back();
+    // A node is pushed again whenever a cheaper way to it is found, so the entries left over
+    // from the more expensive ways are skipped
+    if (current_node->status == NodeStatus::Closed) {
+      continue;
+    }
     current_node->status = NodeStatus::Closed;
+    ++num_expansions;
 
     if (isGoal(*current_node)) {
       setPath(*current_node);
@@ -299,7 +317,7 @@ SearchStatus AstarSearch::search()
         next_node->hc = estimateCost(next_pose);
         next_node->is_back = transition.is_back;
         next_node->parent = current_node;
-        openlist_.push(next_node);
+        pushOpenList(next_node);
         continue;
       }
     }
@@ -371,8 +389,22 @@ bool AstarSearch::isGoal(const AstarNode & node) const
 
 AstarNode * AstarSearch::getNodeRef(const IndexXYT & index)
 {
-  return &nodes_[static_cast<size_t>(index.y)][static_cast<size_t>(index.x)]
-         [static_cast<size_t>(index.theta)];
+  const auto width = static_cast<size_t>(costmap_.info.width);
+  const auto theta_size = planner_common_param_.theta_size;
+  auto & node = nodes_[
+    (static_cast<size_t>(index.y) * width + static_cast<size_t>(index.x)) * theta_size +
+    static_cast<size_t>(index.theta)];
+  if (node.generation != generation_) {
+    node = AstarNode{};
+    node.generation = generation_;
+  }
+  return &node;
+}
+
+void AstarSearch::pushOpenList(AstarNode * node)
+{
+  openlist_.push_back({node->cost(), static_cast<size_t>(node - nodes_.data())});
+  std::push_heap(openlist_.begin(), openlist_.end(), OpenListComparison{});
 }
 
 }  // namespace freespace_planner
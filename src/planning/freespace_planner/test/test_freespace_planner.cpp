@@ -465,3 +465,42 @@ TEST_F(AstarSearchTest, BackwardsPlanningSuccessfulOnEmptyCostmap)
   EXPECT_LE(lateral_error, planner_common_param->goal_lateral_tolerance);
   EXPECT_LE(angular_error, planner_common_param->goal_angular_tolerance);
 }
+
+TEST_F(AstarSearchTest, RepeatedPlanningMatchesFreshPlanner)
+{
+  auto start_pose = geometry_msgs::msg::Pose();
+  start_pose.position.x = 4.0;
+  start_pose.position.y = 4.0;
+
+  auto goal_pose = geometry_msgs::msg::Pose();
+  goal_pose.position.x = 16.0;
+  goal_pose.position.y = 16.0;
+
+  auto small_occupancy_grid = createOccupancyGridWithFrame();
+  small_occupancy_grid.info.height = 50;
+  small_occupancy_grid.info.width = 50;
+  small_occupancy_grid.data.assign(50 * 50, 0);
+  auto small_goal_pose = goal_pose;
+  small_goal_pose.position.x = 8.0;
+  small_goal_pose.position.y = 8.0;
+
+  // Plan on a smaller costmap in between, so the last plan reuses nodes of other searches
+  astar_search->setOccupancyGrid(createOccupancyGridWithFrame());
+  ASSERT_EQ(astar_search->makePlan(start_pose, goal_pose), SearchStatus::SUCCESS);
+  astar_search->setOccupancyGrid(small_occupancy_grid);
+  ASSERT_EQ(astar_search->makePlan(start_pose, small_goal_pose), SearchStatus::SUCCESS);
+  astar_search->setOccupancyGrid(createOccupancyGridWithFrame());
+  ASSERT_EQ(astar_search->makePlan(start_pose, goal_pose), SearchStatus::SUCCESS);
+
+  auto fresh_astar_search = std::make_unique<AstarSearch>(*planner_common_param, *astar_param);
+  fresh_astar_search->setOccupancyGrid(createOccupancyGridWithFrame());
+  ASSERT_EQ(fresh_astar_search->makePlan(start_pose, goal_pose), SearchStatus::SUCCESS);
+
+  const auto & waypoints = astar_search->getWaypoints().waypoints;
+  const auto & fresh_waypoints = fresh_astar_search->getWaypoints().waypoints;
+  ASSERT_EQ(waypoints.size(), fresh_waypoints.size());
+  for (size_t i = 0; i < waypoints.size(); ++i) {
+    testPoseEquality(waypoints[i].pose.pose, fresh_waypoints[i].pose.pose);
+    EXPECT_EQ(waypoints[i].is_back, fresh_waypoints[i].is_back);
+  }
+}
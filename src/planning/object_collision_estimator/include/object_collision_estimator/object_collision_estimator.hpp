@@ -26,6 +26,7 @@
 #include <vector>
 #include <cmath>
 
+#include "object_collision_estimator/obstacle_grid.hpp"
 #include "object_collision_estimator/visibility_control.hpp"
 
 namespace motion
@@ -102,6 +103,10 @@ private:
   BoundingBoxArray m_obstacles{};
   BoundingBoxArray m_trajectory_bboxes{};
   TrajectorySmoother m_smoother;
+  /// Broad phase over m_obstacles, rebuilt by updateObstacles
+  ObstacleGrid m_obstacle_grid;
+  /// Workspace for the candidates returned by the broad phase
+  std::vector<std::size_t> m_candidates{};
 };
 
 }  // namespace object_collision_estimator
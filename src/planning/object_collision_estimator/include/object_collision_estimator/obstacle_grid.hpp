@@ -0,0 +1,124 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#ifndef OBJECT_COLLISION_ESTIMATOR__OBSTACLE_GRID_HPP_
+#define OBJECT_COLLISION_ESTIMATOR__OBSTACLE_GRID_HPP_
+
+#include <autoware_auto_perception_msgs/msg/bounding_box.hpp>
+#include <autoware_auto_perception_msgs/msg/bounding_box_array.hpp>
+#include <common/types.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "object_collision_estimator/visibility_control.hpp"
+
+namespace motion
+{
+namespace planning
+{
+namespace object_collision_estimator
+{
+
+using autoware_auto_perception_msgs::msg::BoundingBox;
+using autoware_auto_perception_msgs::msg::BoundingBoxArray;
+using autoware::common::types::float32_t;
+
+/// \brief Broad phase for collision detection: a uniform 2D grid over the axis aligned bounds of
+///        a set of obstacles.
+/// \details Every obstacle is registered in all cells its (slightly inflated) axis aligned bounds
+///          touch. A query returns every obstacle whose bounds overlap the bounds of the query box,
+///          so it never misses an obstacle that the exact intersection test would report.
+///          Obstacles covering too many cells, or with non-finite corners, are returned by every
+///          query instead of being registered in the grid.
+class OBJECT_COLLISION_ESTIMATOR_PUBLIC ObstacleGrid
+{
+public:
+  /// \brief Constructor
+  /// \param[in] cell_size Edge length of a grid cell in meters. A size close to the size of the
+  ///                      query boxes keeps the number of cells visited per query small.
+  /// \param[in] max_cells_per_obstacle Obstacles touching more cells are not registered in the
+  ///                                   grid, but returned by every query
+  /// \throw std::domain_error If cell_size is not positive and finite
+  explicit ObstacleGrid(
+    const float32_t cell_size,
+    const std::size_t max_cells_per_obstacle = 64U);
+
+  /// \brief Replace the indexed obstacles
+  /// \param[in] obstacles The obstacles to index, queries return indices into obstacles.boxes
+  void build(const BoundingBoxArray & obstacles);
+
+  /// \brief Find the obstacles which may intersect a box
+  /// \param[in] box The query box, only its corners are used
+  /// \param[out] candidates Gets filled with the indices of all obstacles whose axis aligned
+  ///                        bounds overlap the ones of the box, in ascending order
+  void query(const BoundingBox & box, std::vector<std::size_t> & candidates);
+
+  /// \brief Get the number of indexed obstacles
+  /// \return The number of obstacles passed to the last call to build()
+  std::size_t size() const noexcept;
+
+private:
+  /// \brief Axis aligned bounds of a box
+  struct Bounds
+  {
+    float32_t min_x;
+    float32_t min_y;
+    float32_t max_x;
+    float32_t max_y;
+  };
+
+  /// \brief An obstacle registered in a cell
+  struct CellEntry
+  {
+    uint64_t cell;
+    std::size_t obstacle;
+  };
+
+  /// \brief Range of cells covered by some bounds, inclusive on both ends
+  struct CellRange
+  {
+    int32_t min_x;
+    int32_t min_y;
+    int32_t max_x;
+    int32_t max_y;
+  };
+
+  OBJECT_COLLISION_ESTIMATOR_LOCAL static Bounds compute_bounds(const BoundingBox & box);
+  OBJECT_COLLISION_ESTIMATOR_LOCAL static bool is_finite(const Bounds & bounds);
+  OBJECT_COLLISION_ESTIMATOR_LOCAL static bool overlap(const Bounds & lhs, const Bounds & rhs);
+  OBJECT_COLLISION_ESTIMATOR_LOCAL static uint64_t cell_key(const int32_t x, const int32_t y);
+  OBJECT_COLLISION_ESTIMATOR_LOCAL bool cell_range(const Bounds & bounds, CellRange & range) const;
+  OBJECT_COLLISION_ESTIMATOR_LOCAL void add_candidate(
+    const std::size_t obstacle, const Bounds & bounds, std::vector<std::size_t> & candidates);
+
+  float32_t m_cell_size;
+  std::size_t m_max_cells_per_obstacle;
+  std::vector<Bounds> m_bounds;
+  /// Cell entries sorted by cell
+  std::vector<CellEntry> m_cells;
+  /// Obstacles which are returned by every query
+  std::vector<std::size_t> m_unbounded;
+  /// Last query each obstacle was returned in, avoids duplicates from multiple cells
+  std::vector<uint32_t> m_query_stamps;
+  uint32_t m_query_stamp{0U};
+};
+
+}  // namespace object_collision_estimator
+}  // namespace planning
+}  // namespace motion
+
+#endif  // OBJECT_COLLISION_ESTIMATOR__OBSTACLE_GRID_HPP_
@@ -129,47 +129,84 @@ bool8_t isTooFarAway(
   return is_too_far_away;
 }
 
+/// \brief Compute the distance beyond which an obstacle can not collide with the ego vehicle
+///        placed on a waypoint.
+/// \param vehicle_param Configuration regarding the dimensions of the ego vehicle
+/// \param safety_factor A factor to inflate the size of the vehicle so to avoid getting too close
+///                      to obstacles.
+/// \return float32_t The distance threshold in meters
+float32_t computeDistanceThreshold(
+  const VehicleConfig & vehicle_param,
+  const float32_t safety_factor)
+{
+  // find the dimension of the ego vehicle.
+  const auto vehicle_length =
+    vehicle_param.front_overhang() + vehicle_param.length_cg_front_axel() +
+    vehicle_param.length_cg_rear_axel() + vehicle_param.rear_overhang();
+  const auto vehicle_width = vehicle_param.width();
+  const auto vehicle_diagonal = sqrtf(
+    (vehicle_width * vehicle_width) + (vehicle_length * vehicle_length));
+
+  return vehicle_diagonal * safety_factor;
+}
+
+/// \brief Compute the cell size of the obstacle grid. Cells about the size of a waypoint box keep
+///        the number of cells visited per waypoint small.
+/// \param config Configuration of the estimator
+/// \return float32_t The cell size in meters
+float32_t computeGridCellSize(const ObjectCollisionEstimatorConfig & config)
+{
+  constexpr float32_t MIN_CELL_SIZE = 1.0F;
+  const float32_t threshold =
+    computeDistanceThreshold(config.vehicle_config, std::max(config.safety_factor, 1.0F));
+  // Also guards against degenerate vehicle dimensions
+  return (threshold > MIN_CELL_SIZE) ? threshold : MIN_CELL_SIZE;
+}
+
 /// \brief Detect possible collision between a trajectory and a list of obstacle bounding boxes.
 ///        Return the index in the trajectory where the first collision happens.
 /// \param trajectory Planned trajectory of ego vehicle.
 /// \param obstacles Array of bounding boxes of detected obstacles.
+/// \param obstacle_grid Broad phase built over obstacles, only the obstacles it returns for a
+///                      waypoint are tested exactly.
 /// \param vehicle_param Configuration regarding the dimensions of the ego vehicle
 /// \param safety_factor A factor to inflate the size of the vehicle so to avoid getting too close
 ///                      to obstacles.
 /// \param waypoint_bboxes A list of bounding boxes around each waypoint in the trajectory
+/// \param candidates Workspace for the obstacles returned by the broad phase
 /// \return int32_t The index into the trajectory points where the first collision happens. If no
 ///         collision is detected, -1 is returned.
 int32_t detectCollision(
   const Trajectory & trajectory,
   const BoundingBoxArray & obstacles,
+  ObstacleGrid & obstacle_grid,
   const VehicleConfig & vehicle_param,
   const float32_t safety_factor,
-  BoundingBoxArray & waypoint_bboxes)
+  BoundingBoxArray & waypoint_bboxes,
+  std::vector<std::size_t> & candidates)
 {
-  // find the dimension of the ego vehicle.
-  const auto vehicle_length =
-    vehicle_param.front_overhang() + vehicle_param.length_cg_front_axel() +
-    vehicle_param.length_cg_rear_axel() + vehicle_param.rear_overhang();
-  const auto vehicle_width = vehicle_param.width();
-  const auto vehicle_diagonal = sqrtf(
-    (vehicle_width * vehicle_width) + (vehicle_length * vehicle_length));
-
   // define a distance threshold to filter obstacles that are too far away to cause any collision.
-  const float32_t distance_threshold{vehicle_diagonal * safety_factor};
+  const float32_t distance_threshold{computeDistanceThreshold(vehicle_param, safety_factor)};
 
   int32_t collision_index = -1;
 
   waypoint_bboxes.boxes.clear();
+  waypoint_bboxes.boxes.reserve(trajectory.points.size());
   for (std::size_t i = 0; i < trajectory.points.size(); ++i) {
     waypoint_bboxes.boxes.push_back(
       waypointToBox(trajectory.points[i], vehicle_param, safety_factor));
   }
+  if (obstacles.boxes.empty()) {
+    return collision_index;
+  }
   for (std::size_t i = 0; (i < trajectory.points.size()) && (collision_index == -1); ++i) {
     // calculate a bounding box given a trajectory point
     const auto & waypoint_bbox = waypoint_bboxes.boxes.at(i);
 
-    // Check for collisions with all perceived obstacles
-    for (const auto & obstacle_bbox : obstacles.boxes) {
+    // Check for collisions with the perceived obstacles near the waypoint
+    obstacle_grid.query(waypoint_bbox, candidates);
+    for (const auto obstacle_idx : candidates) {
+      const auto & obstacle_bbox = obstacles.boxes[obstacle_idx];
       if (!isTooFarAway(
           trajectory.points[i], obstacle_bbox,
           distance_threshold) && autoware::common::geometry::intersect(
@@ -221,7 +258,7 @@ int32_t getStopIndex(
 ObjectCollisionEstimator::ObjectCollisionEstimator(
   ObjectCollisionEstimatorConfig config,
   TrajectorySmoother smoother) noexcept
-: m_config(config), m_smoother(smoother)
+: m_config(config), m_smoother(smoother), m_obstacle_grid(computeGridCellSize(config))
 {
   // safety factor could not be smaller than 1
   if (m_config.safety_factor < 1.0f) {
@@ -233,8 +270,8 @@ void ObjectCollisionEstimator::updatePlan(Trajectory & trajectory) noexcept
 {
   // Collision detection
   auto collision_index = detectCollision(
-    trajectory, m_obstacles, m_config.vehicle_config,
-    m_config.safety_factor, m_trajectory_bboxes);
+    trajectory, m_obstacles, m_obstacle_grid, m_config.vehicle_config,
+    m_config.safety_factor, m_trajectory_bboxes, m_candidates);
 
   auto trajectory_end_idx = getStopIndex(trajectory, collision_index, m_config.stop_margin);
 
@@ -291,6 +328,7 @@ std::vector<BoundingBox> ObjectCollisionEstimator::updateObstacles(
       modified_obstacles.push_back(box);
     }
   }
+  m_obstacle_grid.build(m_obstacles);
 
   return modified_obstacles;
 }
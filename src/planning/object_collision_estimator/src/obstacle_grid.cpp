@@ -0,0 +1,213 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include "object_collision_estimator/obstacle_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace motion
+{
+namespace planning
+{
+namespace object_collision_estimator
+{
+
+using autoware::common::types::float64_t;
+
+namespace
+{
+// Bounds are inflated by this margin, in meters, so that the tolerance of the exact intersection
+// test can not make the broad phase miss touching boxes
+constexpr float32_t BOUNDS_MARGIN = 0.01F;
+}  // namespace
+
+ObstacleGrid::ObstacleGrid(
+  const float32_t cell_size,
+  const std::size_t max_cells_per_obstacle)
+: m_cell_size(cell_size),
+  m_max_cells_per_obstacle(max_cells_per_obstacle)
+{
+  if (!std::isfinite(cell_size) || (cell_size <= 0.0F)) {
+    throw std::domain_error{"ObstacleGrid: cell size must be positive and finite"};
+  }
+}
+
+void ObstacleGrid::build(const BoundingBoxArray & obstacles)
+{
+  const std::size_t num_obstacles = obstacles.boxes.size();
+  m_bounds.resize(num_obstacles);
+  m_cells.clear();
+  m_unbounded.clear();
+  m_query_stamps.assign(num_obstacles, 0U);
+  m_query_stamp = 0U;
+
+  for (std::size_t idx = 0U; idx < num_obstacles; ++idx) {
+    m_bounds[idx] = compute_bounds(obstacles.boxes[idx]);
+    CellRange range;
+    if (!cell_range(m_bounds[idx], range)) {
+      m_unbounded.push_back(idx);
+      continue;
+    }
+    for (int32_t x = range.min_x; x <= range.max_x; ++x) {
+      for (int32_t y = range.min_y; y <= range.max_y; ++y) {
+        m_cells.push_back(CellEntry{cell_key(x, y), idx});
+      }
+    }
+  }
+  std::sort(
+    m_cells.begin(), m_cells.end(), [](const CellEntry & lhs, const CellEntry & rhs) {
+      return (lhs.cell < rhs.cell) || ((lhs.cell == rhs.cell) && (lhs.obstacle < rhs.obstacle));
+    });
+}
+
+void ObstacleGrid::query(const BoundingBox & box, std::vector<std::size_t> & candidates)
+{
+  candidates.clear();
+  ++m_query_stamp;
+  if (m_query_stamp == 0U) {
+    // Stamps wrapped around, reset them so that old stamps can not alias the current query
+    std::fill(m_query_stamps.begin(), m_query_stamps.end(), 0U);
+    m_query_stamp = 1U;
+  }
+
+  const Bounds bounds = compute_bounds(box);
+  CellRange range;
+  if (!is_finite(bounds)) {
+    // Can not reason about this box, leave it to the exact test
+    for (std::size_t idx = 0U; idx < m_bounds.size(); ++idx) {
+      candidates.push_back(idx);
+    }
+    return;
+  }
+  if (!cell_range(bounds, range)) {
+    // The box covers too many cells, checking the bounds of all obstacles is cheaper
+    for (std::size_t idx = 0U; idx < m_bounds.size(); ++idx) {
+      add_candidate(idx, bounds, candidates);
+    }
+    return;
+  }
+
+  for (const std::size_t idx : m_unbounded) {
+    add_candidate(idx, bounds, candidates);
+  }
+  const auto cell_less = [](const CellEntry & entry, const uint64_t cell) {
+      return entry.cell < cell;
+    };
+  for (int32_t x = range.min_x; x <= range.max_x; ++x) {
+    for (int32_t y = range.min_y; y <= range.max_y; ++y) {
+      const uint64_t key = cell_key(x, y);
+      for (auto it = std::lower_bound(m_cells.cbegin(), m_cells.cend(), key, cell_less);
+        (it != m_cells.cend()) && (it->cell == key); ++it)
+      {
+        add_candidate(it->obstacle, bounds, candidates);
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+}
+
+std::size_t ObstacleGrid::size() const noexcept
+{
+  return m_bounds.size();
+}
+
+ObstacleGrid::Bounds ObstacleGrid::compute_bounds(const BoundingBox & box)
+{
+  Bounds bounds{
+    std::numeric_limits<float32_t>::infinity(), std::numeric_limits<float32_t>::infinity(),
+    -std::numeric_limits<float32_t>::infinity(), -std::numeric_limits<float32_t>::infinity()};
+  for (const auto & corner : box.corners) {
+    if (!std::isfinite(corner.x) || !std::isfinite(corner.y)) {
+      const float32_t nan = std::numeric_limits<float32_t>::quiet_NaN();
+      return Bounds{nan, nan, nan, nan};
+    }
+    bounds.min_x = std::min(bounds.min_x, corner.x);
+    bounds.min_y = std::min(bounds.min_y, corner.y);
+    bounds.max_x = std::max(bounds.max_x, corner.x);
+    bounds.max_y = std::max(bounds.max_y, corner.y);
+  }
+  bounds.min_x -= BOUNDS_MARGIN;
+  bounds.min_y -= BOUNDS_MARGIN;
+  bounds.max_x += BOUNDS_MARGIN;
+  bounds.max_y += BOUNDS_MARGIN;
+  return bounds;
+}
+
+bool ObstacleGrid::is_finite(const Bounds & bounds)
+{
+  return std::isfinite(bounds.min_x) && std::isfinite(bounds.min_y) &&
+         std::isfinite(bounds.max_x) && std::isfinite(bounds.max_y);
+}
+
+bool ObstacleGrid::overlap(const Bounds & lhs, const Bounds & rhs)
+{
+  return (lhs.min_x <= rhs.max_x) && (rhs.min_x <= lhs.max_x) &&
+         (lhs.min_y <= rhs.max_y) && (rhs.min_y <= lhs.max_y);
+}
+
+uint64_t ObstacleGrid::cell_key(const int32_t x, const int32_t y)
+{
+  return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32U) |
+         static_cast<uint64_t>(static_cast<uint32_t>(y));
+}
+
+bool ObstacleGrid::cell_range(const Bounds & bounds, CellRange & range) const
+{
+  if (!is_finite(bounds)) {
+    return false;
+  }
+  const float64_t limit = static_cast<float64_t>(std::numeric_limits<int32_t>::max());
+  const float64_t cell_size = static_cast<float64_t>(m_cell_size);
+  const float64_t min_x = std::floor(static_cast<float64_t>(bounds.min_x) / cell_size);
+  const float64_t min_y = std::floor(static_cast<float64_t>(bounds.min_y) / cell_size);
+  const float64_t max_x = std::floor(static_cast<float64_t>(bounds.max_x) / cell_size);
+  const float64_t max_y = std::floor(static_cast<float64_t>(bounds.max_y) / cell_size);
+  if ((std::fabs(min_x) > limit) || (std::fabs(min_y) > limit) ||
+    (std::fabs(max_x) > limit) || (std::fabs(max_y) > limit))
+  {
+    return false;
+  }
+  const float64_t num_cells = ((max_x - min_x) + 1.0) * ((max_y - min_y) + 1.0);
+  if (num_cells > static_cast<float64_t>(m_max_cells_per_obstacle)) {
+    return false;
+  }
+  range.min_x = static_cast<int32_t>(min_x);
+  range.min_y = static_cast<int32_t>(min_y);
+  range.max_x = static_cast<int32_t>(max_x);
+  range.max_y = static_cast<int32_t>(max_y);
+  return true;
+}
+
+void ObstacleGrid::add_candidate(
+  const std::size_t obstacle, const Bounds & bounds, std::vector<std::size_t> & candidates)
+{
+  if (m_query_stamps[obstacle] == m_query_stamp) {
+    return;
+  }
+  m_query_stamps[obstacle] = m_query_stamp;
+  const Bounds & obstacle_bounds = m_bounds[obstacle];
+  if (!is_finite(obstacle_bounds) || overlap(obstacle_bounds, bounds)) {
+    candidates.push_back(obstacle);
+  }
+}
+
+}  // namespace object_collision_estimator
+}  // namespace planning
+}  // namespace motion
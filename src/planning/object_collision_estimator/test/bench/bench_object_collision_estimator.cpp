@@ -0,0 +1,120 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <benchmark/benchmark.h>
+#include <common/types.hpp>
+#include <trajectory_smoother/trajectory_smoother.hpp>
+
+#include <cmath>
+#include <random>
+
+#include "object_collision_estimator/object_collision_estimator.hpp"
+
+namespace
+{
+using motion::planning::object_collision_estimator::ObjectCollisionEstimator;
+using motion::planning::object_collision_estimator::ObjectCollisionEstimatorConfig;
+using motion::planning::trajectory_smoother::TrajectorySmoother;
+using autoware::common::types::float32_t;
+using autoware_auto_planning_msgs::msg::Trajectory;
+using autoware_auto_planning_msgs::msg::TrajectoryPoint;
+using autoware_auto_perception_msgs::msg::BoundingBox;
+using autoware_auto_perception_msgs::msg::BoundingBoxArray;
+
+constexpr std::size_t kTrajectoryLength = 100U;
+
+ObjectCollisionEstimator make_estimator()
+{
+  const ObjectCollisionEstimatorConfig config{
+    {1.5F, 1.5F, 0.0F, 0.0F, 1500.0F, 0.0F, 2.0F, 0.5F, 0.5F},
+    1.1F,  // safety factor
+    0.0F,  // stop_margin
+    0.0004F,  // min_obstacle_dimension_m
+  };
+  return ObjectCollisionEstimator{config, TrajectorySmoother{{5, 25}}};
+}
+
+/// A straight trajectory along the x axis with 0.5 m between waypoints
+Trajectory make_trajectory()
+{
+  Trajectory trajectory{};
+  for (std::size_t i = 0U; i < kTrajectoryLength; ++i) {
+    TrajectoryPoint pt{};
+    pt.pose.position.x = 0.5 * static_cast<double>(i);
+    pt.pose.orientation.w = 1.0;
+    pt.longitudinal_velocity_mps = 5.0F;
+    trajectory.points.push_back(pt);
+  }
+  return trajectory;
+}
+
+/// Parking lot: parked cars on both sides of the trajectory, none blocking it
+BoundingBoxArray make_obstacles(const std::size_t num_obstacles)
+{
+  std::mt19937 gen{42U};
+  std::uniform_real_distribution<float32_t> x_dist{-20.0F, 70.0F};
+  std::uniform_real_distribution<float32_t> y_dist{5.0F, 60.0F};
+  std::uniform_real_distribution<float32_t> heading_dist{-3.14159F, 3.14159F};
+  BoundingBoxArray obstacles{};
+  for (std::size_t i = 0U; i < num_obstacles; ++i) {
+    const float32_t x = x_dist(gen);
+    const float32_t y = ((i % 2U) == 0U ? 1.0F : -1.0F) * y_dist(gen);
+    const float32_t heading = heading_dist(gen);
+    const float32_t ch = std::cos(heading);
+    const float32_t sh = std::sin(heading);
+    BoundingBox box{};
+    box.centroid.x = x;
+    box.centroid.y = y;
+    box.size.x = 4.5F;
+    box.size.y = 1.8F;
+    box.orientation.w = std::cos(heading * 0.5F);
+    box.orientation.z = std::sin(heading * 0.5F);
+    const float32_t dx[4U] = {-2.25F, 2.25F, 2.25F, -2.25F};
+    const float32_t dy[4U] = {-0.9F, -0.9F, 0.9F, 0.9F};
+    for (std::size_t c = 0U; c < 4U; ++c) {
+      box.corners[c].x = x + (dx[c] * ch) - (dy[c] * sh);
+      box.corners[c].y = y + (dx[c] * sh) + (dy[c] * ch);
+    }
+    obstacles.boxes.push_back(box);
+  }
+  return obstacles;
+}
+}  // namespace
+
+static void BenchUpdatePlan(benchmark::State & state)
+{
+  auto estimator = make_estimator();
+  (void)estimator.updateObstacles(make_obstacles(static_cast<std::size_t>(state.range(0))));
+  const auto trajectory = make_trajectory();
+  for (auto _ : state) {
+    auto plan = trajectory;
+    estimator.updatePlan(plan);
+    benchmark::DoNotOptimize(plan);
+  }
+}
+
+static void BenchUpdateObstacles(benchmark::State & state)
+{
+  auto estimator = make_estimator();
+  const auto obstacles = make_obstacles(static_cast<std::size_t>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(estimator.updateObstacles(obstacles));
+  }
+}
+
+BENCHMARK(BenchUpdatePlan)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK(BenchUpdateObstacles)->RangeMultiplier(4)->Range(16, 1024);
+BENCHMARK_MAIN();
@@ -17,6 +17,7 @@
 #include <common/types.hpp>
 #include <gtest/gtest.h>
 #include <chrono>
+#include <cmath>
 
 #include "object_collision_estimator/object_collision_estimator.hpp"
 
@@ -42,7 +43,8 @@ const auto make_point(const float32_t x, const float32_t y)
 void object_collision_estimator_test(
   std::size_t trajectory_length,
   std::size_t obstacle_bbox_idx,
-  float32_t generated_obstacle_size = 0.5)
+  float32_t generated_obstacle_size = 0.5,
+  std::size_t num_distractors = 0U)
 {
   // define dummy vehicle dimensions
   ObjectCollisionEstimatorConfig config{
@@ -105,6 +107,26 @@ void object_collision_estimator_test(
     bbox_array.boxes.push_back(obstacle_bbox);
   }
 
+  // insert obstacles which are close to, but clear of the trajectory
+  for (std::size_t i = 0U; (i < num_distractors) && (trajectory_length > 0U); ++i) {
+    const auto & pose = trajectory.points[i % trajectory_length].pose;
+    const auto heading =
+      static_cast<float32_t>(2.0 * std::atan2(pose.orientation.z, pose.orientation.w));
+    const float32_t side = ((i % 2U) == 0U) ? 1.0F : -1.0F;
+    const float32_t offset = side * (6.0F + static_cast<float32_t>(i % 5U));
+    const auto x = static_cast<float32_t>(pose.position.x) - (offset * std::sin(heading));
+    const auto y = static_cast<float32_t>(pose.position.y) + (offset * std::cos(heading));
+    BoundingBox distractor_bbox{};
+    distractor_bbox.centroid = make_point(x, y);
+    distractor_bbox.size = make_point(0.5F, 0.5F);
+    distractor_bbox.orientation.w = 1.0F;
+    distractor_bbox.corners = {
+      make_point(x - 0.25F, y - 0.25F), make_point(x + 0.25F, y - 0.25F),
+      make_point(x + 0.25F, y + 0.25F), make_point(x - 0.25F, y + 0.25F)
+    };
+    bbox_array.boxes.push_back(distractor_bbox);
+  }
+
   // call the estimator API
   const auto modified_boxes = estimator.updateObstacles(bbox_array);
   if (generated_obstacle_size < config.min_obstacle_dimension_m) {
@@ -164,3 +186,8 @@ TEST(ObjectCollisionEstimator, NoObstacle) {
 TEST(ObjectCollisionEstimator, SmallObstacle) {
   object_collision_estimator_test(100, 40, 0.0003);
 }
+
+TEST(ObjectCollisionEstimator, ManyObstacles) {
+  object_collision_estimator_test(100, 40, 0.5, 500U);
+  object_collision_estimator_test(100, 101, 0.5, 500U);
+}
@@ -0,0 +1,142 @@
+// Copyright 2021 the Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Co-developed by Tier IV, Inc. and Apex.AI, Inc.
+
+#include <gtest/gtest.h>
+#include <common/types.hpp>
+#include <geometry/intersection.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "object_collision_estimator/obstacle_grid.hpp"
+
+using motion::planning::object_collision_estimator::ObstacleGrid;
+using autoware::common::types::float32_t;
+using autoware_auto_perception_msgs::msg::BoundingBox;
+using autoware_auto_perception_msgs::msg::BoundingBoxArray;
+
+namespace
+{
+BoundingBox make_box(
+  const float32_t x, const float32_t y, const float32_t length, const float32_t width,
+  const float32_t heading)
+{
+  BoundingBox box{};
+  box.centroid.x = x;
+  box.centroid.y = y;
+  box.size.x = length;
+  box.size.y = width;
+  const float32_t ch = std::cos(heading);
+  const float32_t sh = std::sin(heading);
+  const float32_t dx[4U] = {-0.5F, 0.5F, 0.5F, -0.5F};
+  const float32_t dy[4U] = {-0.5F, -0.5F, 0.5F, 0.5F};
+  for (std::size_t i = 0U; i < 4U; ++i) {
+    const float32_t lx = dx[i] * length;
+    const float32_t ly = dy[i] * width;
+    box.corners[i].x = x + (lx * ch) - (ly * sh);
+    box.corners[i].y = y + (lx * sh) + (ly * ch);
+  }
+  return box;
+}
+
+bool intersects(const BoundingBox & lhs, const BoundingBox & rhs)
+{
+  return autoware::common::geometry::intersect(
+    lhs.corners.begin(), lhs.corners.end(), rhs.corners.begin(), rhs.corners.end());
+}
+}  // namespace
+
+TEST(ObstacleGrid, InvalidCellSize) {
+  EXPECT_THROW(ObstacleGrid{0.0F}, std::domain_error);
+  EXPECT_THROW(ObstacleGrid{-1.0F}, std::domain_error);
+  EXPECT_THROW(ObstacleGrid{std::numeric_limits<float32_t>::quiet_NaN()}, std::domain_error);
+}
+
+TEST(ObstacleGrid, Empty) {
+  ObstacleGrid grid{5.0F};
+  std::vector<std::size_t> candidates{1U, 2U};
+  grid.build(BoundingBoxArray{});
+  EXPECT_EQ(grid.size(), 0U);
+  grid.query(make_box(0.0F, 0.0F, 4.0F, 2.0F, 0.0F), candidates);
+  EXPECT_TRUE(candidates.empty());
+}
+
+// Every intersecting obstacle must be returned, exactly once and in ascending order
+TEST(ObstacleGrid, NoMissedIntersections) {
+  std::mt19937 gen{7U};
+  std::uniform_real_distribution<float32_t> pos_dist{-60.0F, 60.0F};
+  std::uniform_real_distribution<float32_t> size_dist{0.1F, 6.0F};
+  std::uniform_real_distribution<float32_t> heading_dist{-3.14159F, 3.14159F};
+  BoundingBoxArray obstacles{};
+  for (std::size_t i = 0U; i < 400U; ++i) {
+    obstacles.boxes.push_back(
+      make_box(pos_dist(gen), pos_dist(gen), size_dist(gen), size_dist(gen), heading_dist(gen)));
+  }
+  // A wall spanning more cells than are registered per obstacle
+  obstacles.boxes.push_back(make_box(0.0F, 0.0F, 200.0F, 0.5F, 0.3F));
+
+  ObstacleGrid grid{5.0F, 16U};
+  grid.build(obstacles);
+  EXPECT_EQ(grid.size(), obstacles.boxes.size());
+
+  std::vector<std::size_t> candidates;
+  std::size_t num_intersections = 0U;
+  for (std::size_t q = 0U; q < 500U; ++q) {
+    const auto box = make_box(pos_dist(gen), pos_dist(gen), 5.0F, 2.2F, heading_dist(gen));
+    grid.query(box, candidates);
+    EXPECT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+    EXPECT_EQ(
+      std::adjacent_find(candidates.begin(), candidates.end()), candidates.end());
+    for (std::size_t i = 0U; i < obstacles.boxes.size(); ++i) {
+      if (intersects(box, obstacles.boxes[i])) {
+        ++num_intersections;
+        EXPECT_TRUE(std::binary_search(candidates.begin(), candidates.end(), i)) << i;
+      }
+    }
+    // The broad phase should prune most obstacles
+    EXPECT_LT(candidates.size(), obstacles.boxes.size() / 4U);
+  }
+  EXPECT_GT(num_intersections, 0U);
+}
+
+TEST(ObstacleGrid, Touching) {
+  BoundingBoxArray obstacles{};
+  obstacles.boxes.push_back(make_box(5.0F, 0.0F, 2.0F, 2.0F, 0.0F));
+  ObstacleGrid grid{4.0F};
+  grid.build(obstacles);
+  std::vector<std::size_t> candidates;
+  // Shares the edge x = 4 with the obstacle, which lies on a cell boundary
+  grid.query(make_box(3.0F, 0.0F, 2.0F, 2.0F, 0.0F), candidates);
+  ASSERT_EQ(candidates.size(), 1U);
+  EXPECT_EQ(candidates[0U], 0U);
+  grid.query(make_box(0.0F, 0.0F, 2.0F, 2.0F, 0.0F), candidates);
+  EXPECT_TRUE(candidates.empty());
+}
+
+TEST(ObstacleGrid, NonFiniteObstacle) {
+  BoundingBoxArray obstacles{};
+  obstacles.boxes.push_back(make_box(100.0F, 100.0F, 2.0F, 2.0F, 0.0F));
+  obstacles.boxes.back().corners[2U].x = std::numeric_limits<float32_t>::quiet_NaN();
+  ObstacleGrid grid{4.0F};
+  grid.build(obstacles);
+  std::vector<std::size_t> candidates;
+  // Left to the exact test
+  grid.query(make_box(0.0F, 0.0F, 2.0F, 2.0F, 0.0F), candidates);
+  EXPECT_EQ(candidates.size(), 1U);
+}
@@ -15,15 +15,17 @@
 #ifndef RECORDREPLAY_PLANNER__RECORDREPLAY_PLANNER_HPP_
 #define RECORDREPLAY_PLANNER__RECORDREPLAY_PLANNER_HPP_
 
+#include <recordreplay_planner/trajectory_record.hpp>
 #include <recordreplay_planner/visibility_control.hpp>
 #include <autoware_auto_vehicle_msgs/msg/vehicle_kinematic_state.hpp>
 #include <autoware_auto_planning_msgs/msg/trajectory.hpp>
 #include <motion_common/config.hpp>
 #include <common/types.hpp>
 
-#include <deque>
+#include <memory>
 #include <string>
 #include <map>
+#include <vector>
 
 using autoware::common::types::bool8_t;
 using autoware::common::types::float64_t;
@@ -64,6 +66,7 @@ public:
   /// \brief Add a new state to the record buffer
   /// \param[in] state_to_record A state to attempt to add to the recording buffer
   /// \return True if state was added to record buffer, False otherwise
+  /// \throw std::runtime_error if a record file is open and cannot be written
   bool record_state(const State & state_to_record);
 
   // Replay trajectory from stored plan. The current state of the vehicle is given
@@ -81,10 +84,23 @@ public:
   void set_min_record_distance(float64_t min_record_distance);
   float64_t get_min_record_distance() const;
 
-  // Writing/Loading buffered trajectory information to/from disk
+  // Writing/Loading buffered trajectory information to/from disk. Recordings are written as
+  // binary record files, see trajectory_record.hpp. Reading also accepts the comma separated
+  // text files written by earlier versions.
   void writeTrajectoryBufferToFile(const std::string & record_path);
   void readTrajectoryBufferFromFile(const std::string & replay_path);
 
+  /// \brief Stream the recording to a record file. The file receives the states currently in the
+  ///        record buffer and every state recorded until close_record_file() is called.
+  ///        Clearing the record buffer does not remove states from the file.
+  /// \param[in] record_path Path of the file, an existing file is replaced
+  /// \throw std::runtime_error if the path is empty or the file cannot be written
+  void open_record_file(const std::string & record_path);
+
+  /// \brief Write the remaining buffered states and close the record file, if one is open
+  /// \throw std::runtime_error if the file cannot be written
+  void close_record_file();
+
   /**
    * \brief Judges whether current_state has reached the last point in record buffer
    * \param current_state current state of the vehicle
@@ -101,13 +117,38 @@ private:
   RECORDREPLAY_PLANNER_LOCAL const Trajectory & from_record(const State & current_state);
   RECORDREPLAY_PLANNER_LOCAL std::size_t get_closest_state(const State & current_state);
 
+  // Difference between two states in terms of location and heading
+  RECORDREPLAY_PLANNER_LOCAL float64_t state_distance(
+    const State & current_state, const State & recorded_state) const;
+
+  // Sort the recorded positions into a 2D k-d tree laid out in m_kd_tree
+  RECORDREPLAY_PLANNER_LOCAL void build_kd_tree();
+
+  // Search the k-d tree for a state closer than the best one found so far. The positions
+  // m_kd_tree[begin, end) form a subtree split along x if split_x is set and along y otherwise.
+  RECORDREPLAY_PLANNER_LOCAL void search_kd_tree(
+    const State & current_state, std::size_t begin, std::size_t end, bool8_t split_x,
+    float64_t & best_distance, std::size_t & best_idx) const;
+
+  // Position of a recorded state, stored in k-d tree order
+  struct KdTreeNode
+  {
+    float64_t x;
+    float64_t y;
+    std::size_t record_idx;
+  };
+
   // Weight of heading in computations of differences between states
   float64_t m_heading_weight = 0.1;
   float64_t m_min_record_distance = 0.0;
 
   std::size_t m_traj_start_idx{};
   std::size_t m_traj_end_idx{};
-  std::deque<State> m_record_buffer;
+  std::vector<State> m_record_buffer;
+  std::unique_ptr<TrajectoryRecordWriter> m_record_file{};
+  // Index over m_record_buffer for the closest state search, rebuilt once the buffer changed
+  std::vector<KdTreeNode> m_kd_tree{};
+  bool8_t m_kd_tree_valid{false};
   Trajectory m_trajectory{};
   RecordReplayState m_recordreplaystate{RecordReplayState::IDLE};
 };  // class RecordReplayPlanner
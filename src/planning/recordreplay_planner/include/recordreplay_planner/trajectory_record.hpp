@@ -0,0 +1,168 @@
+// Copyright 2021 The Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// \file
+/// \brief Binary file format for recorded trajectories.
+///
+/// A record file is a fixed header followed by one fixed size record per recorded state, in
+/// native byte order. Records are appended while recording and the header is updated with the
+/// number of complete records whenever the buffered records are written, so the file can be
+/// memory mapped and read in place without any parsing.
+
+#ifndef RECORDREPLAY_PLANNER__TRAJECTORY_RECORD_HPP_
+#define RECORDREPLAY_PLANNER__TRAJECTORY_RECORD_HPP_
+
+#include <recordreplay_planner/visibility_control.hpp>
+#include <autoware_auto_vehicle_msgs/msg/vehicle_kinematic_state.hpp>
+#include <common/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace motion
+{
+namespace planning
+{
+namespace recordreplay_planner
+{
+using autoware::common::types::bool8_t;
+using autoware::common::types::float32_t;
+using autoware::common::types::float64_t;
+
+/// Magic bytes at the start of every record file
+constexpr char kTrajectoryRecordMagic[8] = {'A', 'W', 'T', 'R', 'A', 'J', 'R', 'C'};
+/// Layout version, bumped on every incompatible change of the structs below
+constexpr std::uint32_t kTrajectoryRecordVersion = 1U;
+
+struct TrajectoryRecordHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_size;  ///< sizeof(TrajectoryRecord) of the writer
+  std::uint64_t record_count;  ///< number of complete records following the header
+};
+
+/// A recorded VehicleKinematicState without its frame id
+struct TrajectoryRecord
+{
+  std::int32_t stamp_sec;
+  std::uint32_t stamp_nanosec;
+  std::int32_t time_from_start_sec;
+  std::uint32_t time_from_start_nanosec;
+  float64_t x;
+  float64_t y;
+  float64_t z;
+  float64_t orientation_x;
+  float64_t orientation_y;
+  float64_t orientation_z;
+  float64_t orientation_w;
+  float32_t longitudinal_velocity_mps;
+  float32_t lateral_velocity_mps;
+  float32_t acceleration_mps2;
+  float32_t heading_rate_rps;
+  float32_t front_wheel_angle_rad;
+  float32_t rear_wheel_angle_rad;
+};
+
+static_assert(sizeof(TrajectoryRecordHeader) == 24U, "TrajectoryRecordHeader layout changed");
+static_assert(sizeof(TrajectoryRecord) == 96U, "TrajectoryRecord layout changed");
+
+/// \brief Convert a state into a record
+RECORDREPLAY_PLANNER_PUBLIC TrajectoryRecord to_trajectory_record(
+  const autoware_auto_vehicle_msgs::msg::VehicleKinematicState & state);
+
+/// \brief Convert a record back into a state, the frame id is left empty
+RECORDREPLAY_PLANNER_PUBLIC autoware_auto_vehicle_msgs::msg::VehicleKinematicState to_state(
+  const TrajectoryRecord & record);
+
+/// \brief Check whether a file starts with the record file magic bytes
+/// \param[in] path Path of the file
+/// \return True if the file looks like a record file, it may still fail validation
+RECORDREPLAY_PLANNER_PUBLIC bool8_t is_trajectory_record_file(const std::string & path);
+
+/// \brief Appends states to a record file through a fixed size buffer, so that recording does
+///        not write to the file on every state.
+class RECORDREPLAY_PLANNER_PUBLIC TrajectoryRecordWriter
+{
+public:
+  /// Number of records that are buffered before they are written to the file
+  static constexpr std::size_t CHUNK_SIZE = 256U;
+
+  /// \brief Create the file, replacing an existing one, and write an empty header
+  /// \param[in] path Path of the file
+  /// \throw std::runtime_error if the file cannot be created
+  explicit TrajectoryRecordWriter(const std::string & path);
+
+  TrajectoryRecordWriter(const TrajectoryRecordWriter &) = delete;
+  TrajectoryRecordWriter & operator=(const TrajectoryRecordWriter &) = delete;
+
+  /// \brief Write the buffered records if close() was not called, errors are ignored
+  ~TrajectoryRecordWriter();
+
+  /// \brief Append a state
+  /// \throw std::runtime_error if writing a full buffer fails
+  void append(const autoware_auto_vehicle_msgs::msg::VehicleKinematicState & state);
+
+  /// \brief Write the buffered records and update the record count in the header
+  /// \throw std::runtime_error if writing fails
+  void flush();
+
+  /// \brief Flush and close the file
+  /// \throw std::runtime_error if writing fails
+  void close();
+
+  /// \brief Number of appended records, including the buffered ones
+  std::size_t size() const noexcept {return m_num_written + m_chunk.size();}
+
+private:
+  std::string m_path;
+  std::ofstream m_file;
+  std::vector<TrajectoryRecord> m_chunk;
+  std::size_t m_num_written{0U};
+};
+
+/// \brief Read only memory mapping of a record file
+class RECORDREPLAY_PLANNER_PUBLIC MappedTrajectoryRecordFile
+{
+public:
+  /// \brief Map the file and validate its header
+  /// \param[in] path Path of the file
+  /// \throw std::runtime_error if the file cannot be mapped or is not a valid record file of a
+  ///        supported version
+  explicit MappedTrajectoryRecordFile(const std::string & path);
+
+  MappedTrajectoryRecordFile(const MappedTrajectoryRecordFile &) = delete;
+  MappedTrajectoryRecordFile & operator=(const MappedTrajectoryRecordFile &) = delete;
+
+  ~MappedTrajectoryRecordFile();
+
+  const TrajectoryRecord * begin() const noexcept {return m_records;}
+  const TrajectoryRecord * end() const noexcept {return m_records + m_num_records;}
+  std::size_t size() const noexcept {return m_num_records;}
+  const TrajectoryRecord & operator[](std::size_t idx) const {return m_records[idx];}
+
+private:
+  void * m_mapping{nullptr};
+  std::size_t m_mapping_size{0U};
+  const TrajectoryRecord * m_records{nullptr};
+  std::size_t m_num_records{0U};
+};
+}  // namespace recordreplay_planner
+}  // namespace planning
+}  // namespace motion
+
+#endif  // RECORDREPLAY_PLANNER__TRAJECTORY_RECORD_HPP_
@@ -26,6 +26,7 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 #include <map>
 
@@ -38,6 +39,10 @@ using Csv = std::vector<std::vector<std::string>>;
 using Association = std::map<std::string /* label */, int32_t /* row */>;
 namespace
 {
+// Recorded states around the last match that are checked before the k-d tree is searched
+constexpr std::size_t PROGRESS_WINDOW_BEHIND = 5U;
+constexpr std::size_t PROGRESS_WINDOW_AHEAD = 50U;
+
 std::vector<std::string> split(const std::string & input, char delimiter)
 {
   std::istringstream stream(input);
@@ -150,6 +155,7 @@ void RecordReplayPlanner::stop_replaying() noexcept
 void RecordReplayPlanner::clear_record() noexcept
 {
   m_record_buffer.clear();
+  m_kd_tree_valid = false;
 }
 
 std::size_t RecordReplayPlanner::get_record_length() const noexcept
@@ -189,10 +195,14 @@ bool RecordReplayPlanner::record_state(const State & state_to_record)
 {
   if (m_record_buffer.empty()) {
     m_record_buffer.push_back(state_to_record);
+    m_kd_tree_valid = false;
+    if (m_record_file) {
+      m_record_file->append(state_to_record);
+    }
     return true;
   }
 
-  auto previous_state = m_record_buffer.back();
+  const auto & previous_state = m_record_buffer.back();
   auto distance_sq =
     (state_to_record.state.pose.position.x - previous_state.state.pose.position.x) *
     (state_to_record.state.pose.position.x - previous_state.state.pose.position.x) +
@@ -201,6 +211,10 @@ bool RecordReplayPlanner::record_state(const State & state_to_record)
 
   if (distance_sq >= (m_min_record_distance * m_min_record_distance) ) {
     m_record_buffer.push_back(state_to_record);
+    m_kd_tree_valid = false;
+    if (m_record_file) {
+      m_record_file->append(state_to_record);
+    }
     return true;
   } else {
     return false;
@@ -215,30 +229,113 @@ const Trajectory & RecordReplayPlanner::plan(const State & current_state)
 
 std::size_t RecordReplayPlanner::get_closest_state(const State & current_state)
 {
-  // Find the closest point to the current state in the stored states buffer
-  const auto distance_from_current_state =
-    [this, &current_state](State & other_state) {
-      const auto s1 = current_state.state, s2 = other_state.state;
-      return (s1.pose.position.x - s2.pose.position.x) * (s1.pose.position.x - s2.pose.position.x) +
-             (s1.pose.position.y - s2.pose.position.y) * (s1.pose.position.y - s2.pose.position.y) +
-             m_heading_weight * std::abs(
-        ::motion::motion_common::to_angle(
-          s1.pose.orientation - s2.pose.orientation));
-    };
-  const auto comparison_function =
-    [&distance_from_current_state](State & one, State & two)
-    {return distance_from_current_state(one) < distance_from_current_state(two);};
-
-
-  const auto minimum_index_iterator =
-    std::min_element(
-    std::begin(m_record_buffer), std::end(m_record_buffer),
-    comparison_function);
-  auto minimum_idx = std::distance(std::begin(m_record_buffer), minimum_index_iterator);
-
-  return static_cast<std::size_t>(minimum_idx);
+  if (m_record_buffer.empty()) {
+    return 0U;
+  }
+  if (!m_kd_tree_valid) {
+    build_kd_tree();
+  }
+
+  // While the vehicle follows the recording, the closest state is right around the last match.
+  // Checking there first gives a tight bound, so the k-d tree search only has to confirm it. If
+  // the vehicle was moved, the tree search finds the closest state elsewhere.
+  const auto last_idx = std::min(m_traj_start_idx, m_record_buffer.size() - 1U);
+  const auto window_begin = last_idx - std::min(last_idx, PROGRESS_WINDOW_BEHIND);
+  const auto window_end = std::min(last_idx + PROGRESS_WINDOW_AHEAD, m_record_buffer.size());
+  auto best_idx = window_begin;
+  auto best_distance = state_distance(current_state, m_record_buffer[window_begin]);
+  for (auto idx = window_begin + 1U; idx < window_end; ++idx) {
+    const auto distance = state_distance(current_state, m_record_buffer[idx]);
+    if (distance < best_distance) {
+      best_distance = distance;
+      best_idx = idx;
+    }
+  }
+
+  search_kd_tree(current_state, 0U, m_kd_tree.size(), true, best_distance, best_idx);
+  return best_idx;
+}
+
+float64_t RecordReplayPlanner::state_distance(
+  const State & current_state, const State & recorded_state) const
+{
+  const auto & s1 = current_state.state;
+  const auto & s2 = recorded_state.state;
+  return (s1.pose.position.x - s2.pose.position.x) * (s1.pose.position.x - s2.pose.position.x) +
+         (s1.pose.position.y - s2.pose.position.y) * (s1.pose.position.y - s2.pose.position.y) +
+         m_heading_weight * std::abs(
+    ::motion::motion_common::to_angle(
+      s1.pose.orientation - s2.pose.orientation));
+}
+
+void RecordReplayPlanner::build_kd_tree()
+{
+  m_kd_tree.clear();
+  m_kd_tree.reserve(m_record_buffer.size());
+  for (std::size_t idx = {}; idx < m_record_buffer.size(); ++idx) {
+    const auto & position = m_record_buffer[idx].state.pose.position;
+    m_kd_tree.push_back({position.x, position.y, idx});
+  }
+
+  // Each subtree is stored as [left subtree, root, right subtree] with the root in the middle
+  struct Range
+  {
+    std::size_t begin;
+    std::size_t end;
+    bool8_t split_x;
+  };
+  std::vector<Range> ranges{{0U, m_kd_tree.size(), true}};
+  while (!ranges.empty()) {
+    const auto range = ranges.back();
+    ranges.pop_back();
+    if (range.end - range.begin < 2U) {
+      continue;
+    }
+    const auto mid = range.begin + (range.end - range.begin) / 2U;
+    const auto split_x = range.split_x;
+    std::nth_element(
+      m_kd_tree.begin() + static_cast<std::ptrdiff_t>(range.begin),
+      m_kd_tree.begin() + static_cast<std::ptrdiff_t>(mid),
+      m_kd_tree.begin() + static_cast<std::ptrdiff_t>(range.end),
+      [split_x](const KdTreeNode & one, const KdTreeNode & two) {
+        return split_x ? (one.x < two.x) : (one.y < two.y);
+      });
+    ranges.push_back({range.begin, mid, !split_x});
+    ranges.push_back({mid + 1U, range.end, !split_x});
+  }
+  m_kd_tree_valid = true;
 }
 
+void RecordReplayPlanner::search_kd_tree(
+  const State & current_state, std::size_t begin, std::size_t end, bool8_t split_x,
+  float64_t & best_distance, std::size_t & best_idx) const
+{
+  if (begin >= end) {
+    return;
+  }
+  const auto mid = begin + (end - begin) / 2U;
+  const auto & node = m_kd_tree[mid];
+  const auto distance = state_distance(current_state, m_record_buffer[node.record_idx]);
+  // Ties go to the earlier state, as in a linear search over the recording
+  if ((distance < best_distance) || ((distance == best_distance) && (node.record_idx < best_idx))) {
+    best_distance = distance;
+    best_idx = node.record_idx;
+  }
+
+  const auto & position = current_state.state.pose.position;
+  const auto offset = split_x ? (position.x - node.x) : (position.y - node.y);
+  const auto near_first = (offset < 0.0);
+  search_kd_tree(
+    current_state, near_first ? begin : mid + 1U, near_first ? mid : end, !split_x,
+    best_distance, best_idx);
+  // The squared distance to the split line bounds the distance of every state on the other side
+  // from below, since the heading term is never negative.
+  if (offset * offset <= best_distance) {
+    search_kd_tree(
+      current_state, near_first ? mid + 1U : begin, near_first ? end : mid, !split_x,
+      best_distance, best_idx);
+  }
+}
 
 const Trajectory & RecordReplayPlanner::from_record(const State & current_state)
 {
@@ -303,26 +400,34 @@ void RecordReplayPlanner::writeTrajectoryBufferToFile(const std::string & record
     throw std::runtime_error("record_path cannot be empty");
   }
 
-  std::ofstream ofs;
-  ofs.open(record_path, std::ios::trunc);
-  if (!ofs.is_open()) {
-    throw std::runtime_error("Could not open file.");
+  TrajectoryRecordWriter writer{record_path};
+  for (const auto & state : m_record_buffer) {
+    writer.append(state);
   }
-  ofs << "t_sec, t_nanosec, x, y, orientation_x, orientation_y, orientation_z, orientation_w, " <<
-    "longitudinal_velocity_mps, lateral_velocity_mps, acceleration_mps2, heading_rate_rps, " <<
-    "front_wheel_angle_rad, rear_wheel_angle_rad" << std::endl;
+  writer.close();
+}
 
-  for (const auto & trajectory_point : m_record_buffer) {
-    const auto & s = trajectory_point.state;
-    const auto & t = s.time_from_start;
-    ofs << t.sec << ", " << t.nanosec << ", " << s.pose.position.x << ", " << s.pose.position.y <<
-      ", " << s.pose.orientation.x << ", " << s.pose.orientation.y << ", " <<
-      s.pose.orientation.z << ", " << s.pose.orientation.w << ", " <<
-      s.longitudinal_velocity_mps << ", " << s.lateral_velocity_mps << ", " <<
-      s.acceleration_mps2 << ", " << s.heading_rate_rps << ", " << s.front_wheel_angle_rad <<
-      ", " << s.rear_wheel_angle_rad << std::endl;
+void RecordReplayPlanner::open_record_file(const std::string & record_path)
+{
+  if (record_path.empty()) {
+    throw std::runtime_error("record_path cannot be empty");
+  }
+
+  close_record_file();
+  auto writer = std::make_unique<TrajectoryRecordWriter>(record_path);
+  for (const auto & state : m_record_buffer) {
+    writer->append(state);
+  }
+  m_record_file = std::move(writer);
+}
+
+void RecordReplayPlanner::close_record_file()
+{
+  if (m_record_file) {
+    // Drop the writer even if the last write fails, so the error is reported only once
+    auto writer = std::move(m_record_file);
+    writer->close();
   }
-  ofs.close();
 }
 
 void RecordReplayPlanner::readTrajectoryBufferFromFile(const std::string & replay_path)
@@ -331,9 +436,19 @@ void RecordReplayPlanner::readTrajectoryBufferFromFile(const std::string & repla
     throw std::runtime_error("replay_path cannot be empty");
   }
 
-  // Clear current trajectory deque
+  // Clear current trajectory buffer
   clear_record();
 
+  if (is_trajectory_record_file(replay_path)) {
+    const MappedTrajectoryRecordFile records{replay_path};
+    m_record_buffer.reserve(records.size());
+    for (const auto & record : records) {
+      record_state(to_state(record));
+    }
+    return;
+  }
+
+  // Comma separated text written by earlier versions
   Csv file_data;
   Association map;  // row labeled Association map
   if (!loadData(replay_path, map, file_data)) {
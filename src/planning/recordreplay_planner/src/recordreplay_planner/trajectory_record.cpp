@@ -0,0 +1,209 @@
+// Copyright 2021 The Autoware Foundation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "recordreplay_planner/trajectory_record.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace motion
+{
+namespace planning
+{
+namespace recordreplay_planner
+{
+using autoware_auto_vehicle_msgs::msg::VehicleKinematicState;
+
+constexpr std::size_t TrajectoryRecordWriter::CHUNK_SIZE;
+
+TrajectoryRecord to_trajectory_record(const VehicleKinematicState & state)
+{
+  const auto & s = state.state;
+  TrajectoryRecord record{};
+  record.stamp_sec = state.header.stamp.sec;
+  record.stamp_nanosec = state.header.stamp.nanosec;
+  record.time_from_start_sec = s.time_from_start.sec;
+  record.time_from_start_nanosec = s.time_from_start.nanosec;
+  record.x = s.pose.position.x;
+  record.y = s.pose.position.y;
+  record.z = s.pose.position.z;
+  record.orientation_x = s.pose.orientation.x;
+  record.orientation_y = s.pose.orientation.y;
+  record.orientation_z = s.pose.orientation.z;
+  record.orientation_w = s.pose.orientation.w;
+  record.longitudinal_velocity_mps = s.longitudinal_velocity_mps;
+  record.lateral_velocity_mps = s.lateral_velocity_mps;
+  record.acceleration_mps2 = s.acceleration_mps2;
+  record.heading_rate_rps = s.heading_rate_rps;
+  record.front_wheel_angle_rad = s.front_wheel_angle_rad;
+  record.rear_wheel_angle_rad = s.rear_wheel_angle_rad;
+  return record;
+}
+
+VehicleKinematicState to_state(const TrajectoryRecord & record)
+{
+  VehicleKinematicState state;
+  auto & s = state.state;
+  state.header.stamp.sec = record.stamp_sec;
+  state.header.stamp.nanosec = record.stamp_nanosec;
+  s.time_from_start.sec = record.time_from_start_sec;
+  s.time_from_start.nanosec = record.time_from_start_nanosec;
+  s.pose.position.x = record.x;
+  s.pose.position.y = record.y;
+  s.pose.position.z = record.z;
+  s.pose.orientation.x = record.orientation_x;
+  s.pose.orientation.y = record.orientation_y;
+  s.pose.orientation.z = record.orientation_z;
+  s.pose.orientation.w = record.orientation_w;
+  s.longitudinal_velocity_mps = record.longitudinal_velocity_mps;
+  s.lateral_velocity_mps = record.lateral_velocity_mps;
+  s.acceleration_mps2 = record.acceleration_mps2;
+  s.heading_rate_rps = record.heading_rate_rps;
+  s.front_wheel_angle_rad = record.front_wheel_angle_rad;
+  s.rear_wheel_angle_rad = record.rear_wheel_angle_rad;
+  return state;
+}
+
+bool8_t is_trajectory_record_file(const std::string & path)
+{
+  std::ifstream ifs(path, std::ios::binary);
+  char magic[sizeof(kTrajectoryRecordMagic)] = {};
+  ifs.read(magic, sizeof(magic));
+  return ifs.good() && (std::memcmp(magic, kTrajectoryRecordMagic, sizeof(magic)) == 0);
+}
+
+TrajectoryRecordWriter::TrajectoryRecordWriter(const std::string & path)
+: m_path{path}
+{
+  m_file.open(path, std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open()) {
+    throw std::runtime_error("TrajectoryRecordWriter: cannot open " + path);
+  }
+  m_chunk.reserve(CHUNK_SIZE);
+  // Write an empty file first, so a recording that is interrupted before the first flush is
+  // still a valid file
+  flush();
+}
+
+TrajectoryRecordWriter::~TrajectoryRecordWriter()
+{
+  if (m_file.is_open()) {
+    try {
+      close();
+    } catch (const std::runtime_error &) {
+    }
+  }
+}
+
+void TrajectoryRecordWriter::append(const VehicleKinematicState & state)
+{
+  m_chunk.push_back(to_trajectory_record(state));
+  if (m_chunk.size() >= CHUNK_SIZE) {
+    flush();
+  }
+}
+
+void TrajectoryRecordWriter::flush()
+{
+  if (!m_file.is_open()) {
+    throw std::runtime_error("TrajectoryRecordWriter: " + m_path + " is closed");
+  }
+  // Records go behind the ones already written, then the header is rewritten with the new
+  // count. A reader thus never sees a count that includes records not yet in the file.
+  const auto records_offset = static_cast<std::streamoff>(
+    sizeof(TrajectoryRecordHeader) + m_num_written * sizeof(TrajectoryRecord));
+  m_file.seekp(records_offset);
+  m_file.write(
+    reinterpret_cast<const char *>(m_chunk.data()),
+    static_cast<std::streamsize>(m_chunk.size() * sizeof(TrajectoryRecord)));
+  m_file.flush();
+
+  TrajectoryRecordHeader header{};
+  std::memcpy(header.magic, kTrajectoryRecordMagic, sizeof(header.magic));
+  header.version = kTrajectoryRecordVersion;
+  header.record_size = static_cast<std::uint32_t>(sizeof(TrajectoryRecord));
+  header.record_count = m_num_written + m_chunk.size();
+  m_file.seekp(0);
+  m_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  m_file.flush();
+  if (!m_file.good()) {
+    throw std::runtime_error("TrajectoryRecordWriter: cannot write " + m_path);
+  }
+  m_num_written += m_chunk.size();
+  m_chunk.clear();
+}
+
+void TrajectoryRecordWriter::close()
+{
+  flush();
+  m_file.close();
+}
+
+MappedTrajectoryRecordFile::MappedTrajectoryRecordFile(const std::string & path)
+{
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::runtime_error("MappedTrajectoryRecordFile: cannot open " + path);
+  }
+  struct stat file_stat {};
+  if ((::fstat(fd, &file_stat) != 0) ||
+    (static_cast<std::size_t>(file_stat.st_size) < sizeof(TrajectoryRecordHeader)))
+  {
+    ::close(fd);
+    throw std::runtime_error("MappedTrajectoryRecordFile: cannot stat or truncated file " + path);
+  }
+  m_mapping_size = static_cast<std::size_t>(file_stat.st_size);
+  m_mapping = ::mmap(nullptr, m_mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (m_mapping == MAP_FAILED) {
+    throw std::runtime_error("MappedTrajectoryRecordFile: cannot map " + path);
+  }
+
+  const auto * const data = static_cast<const std::uint8_t *>(m_mapping);
+  TrajectoryRecordHeader header{};
+  std::memcpy(&header, data, sizeof(header));
+  const auto max_count =
+    (m_mapping_size - sizeof(TrajectoryRecordHeader)) / sizeof(TrajectoryRecord);
+  const char * error = nullptr;
+  if (std::memcmp(header.magic, kTrajectoryRecordMagic, sizeof(header.magic)) != 0) {
+    error = "not a trajectory record file ";
+  } else if (header.version != kTrajectoryRecordVersion) {
+    error = "unsupported version in ";
+  } else if (header.record_size != sizeof(TrajectoryRecord)) {
+    error = "unexpected record size in ";
+  } else if (header.record_count > max_count) {
+    error = "missing records in ";
+  }
+  if (error != nullptr) {
+    ::munmap(m_mapping, m_mapping_size);
+    throw std::runtime_error(std::string{"MappedTrajectoryRecordFile: "} + error + path);
+  }
+  // The header size is a multiple of the record alignment and mappings are page aligned
+  m_records = reinterpret_cast<const TrajectoryRecord *>(data + sizeof(TrajectoryRecordHeader));
+  m_num_records = static_cast<std::size_t>(header.record_count);
+}
+
+MappedTrajectoryRecordFile::~MappedTrajectoryRecordFile()
+{
+  ::munmap(m_mapping, m_mapping_size);
+}
+}  // namespace recordreplay_planner
+}  // namespace planning
+}  // namespace motion
@@ -26,6 +26,7 @@
 #include <chrono>
 #include <set>
 #include <algorithm>
+#include <fstream>
 #include <string>
 #include <cstdio>
 
@@ -206,6 +207,72 @@ TEST(RecordreplaySanityChecks, RecedingHorizonCornercases)
   }
 }
 
+//------------------ Test that the closest state search matches a search over all states
+TEST(RecordreplaySanityChecks, ClosestStateMatchesLinearSearch)
+{
+  auto planner = RecordReplayPlanner{};
+  const auto t0 = system_clock::from_time_t({});
+  std::vector<autoware_auto_vehicle_msgs::msg::VehicleKinematicState> recording;
+
+  // Record one and a half laps of a slowly widening circle, so the route passes close to itself
+  constexpr uint32_t N = 3000U;
+  for (uint32_t k = {}; k < N; ++k) {
+    const auto angle = 3.0F * autoware::common::types::PI * static_cast<float32_t>(k) / N;
+    const auto radius = 20.0F + 0.001F * static_cast<float32_t>(k);
+    recording.push_back(
+      make_state(
+        radius * std::cos(angle), radius * std::sin(angle),
+        angle + autoware::common::types::PI_2, 1.0F, 0.0F, 0.0F,
+        t0 + k * std::chrono::milliseconds{100LL}));
+    planner.record_state(recording.back());
+  }
+
+  const auto closest_position = [&planner, &recording](const auto & current_state) {
+      const auto distance = [&planner, &current_state](const auto & recorded_state) {
+          const auto & s1 = current_state.state;
+          const auto & s2 = recorded_state.state;
+          return (s1.pose.position.x - s2.pose.position.x) *
+                 (s1.pose.position.x - s2.pose.position.x) +
+                 (s1.pose.position.y - s2.pose.position.y) *
+                 (s1.pose.position.y - s2.pose.position.y) +
+                 planner.get_heading_weight() * std::abs(
+            motion::motion_common::to_angle(s1.pose.orientation - s2.pose.orientation));
+        };
+      return std::min_element(
+        recording.begin(), recording.end(), [&distance](const auto & one, const auto & two) {
+          return distance(one) < distance(two);
+        })->state.pose.position;
+    };
+
+  // Follow the route, then jump around
+  std::vector<autoware_auto_vehicle_msgs::msg::VehicleKinematicState> queries;
+  for (uint32_t k = {}; k < N; k += 7U) {
+    auto query = recording[k];
+    query.state.pose.position.x += 0.3;
+    query.state.pose.position.y -= 0.2;
+    queries.push_back(query);
+  }
+  for (auto k = 0; k < 200; ++k) {
+    queries.push_back(
+      make_state(
+        static_cast<float32_t>((k * 37) % 61 - 30), static_cast<float32_t>((k * 53) % 67 - 33),
+        0.1F * static_cast<float32_t>(k), 0.0F, 0.0F, 0.0F, t0));
+  }
+
+  for (const auto & query : queries) {
+    const auto expected = closest_position(query);
+    const auto & trajectory = planner.plan(query);
+    ASSERT_FALSE(trajectory.points.empty());
+    EXPECT_EQ(trajectory.points[0].pose.position.x, expected.x);
+    EXPECT_EQ(trajectory.points[0].pose.position.y, expected.y);
+  }
+
+  // Recording more states updates the search
+  const auto extra_state = make_state(100.0F, 100.0F, 0.0F, 1.0F, 0.0F, 0.0F, t0);
+  planner.record_state(extra_state);
+  EXPECT_EQ(planner.plan(extra_state).points[0].pose.position.x, 100.0F);
+}
+
 TEST(RecordreplaySanityChecks, StateSettingMechanism)
 {
   auto planner = RecordReplayPlanner{};
@@ -291,6 +358,97 @@ TEST(RecordreplayWriteReadTrajectory, readTrajectoryEmptyPath)
   ASSERT_THROW(planner.readTrajectoryBufferFromFile(""), std::runtime_error);
 }
 
+TEST(RecordreplayWriteReadTrajectory, StreamRecordFile)
+{
+  using motion::planning::recordreplay_planner::TrajectoryRecordWriter;
+  std::string file_name("stream_test.trajectory");
+
+  // Enough states for several chunks, the last one incomplete
+  const auto N = 2U * TrajectoryRecordWriter::CHUNK_SIZE + 10U;
+  auto planner = helper_create_and_record_example(5U);
+  planner.open_record_file(file_name);
+  const auto t0 = system_clock::from_time_t({});
+  for (uint32_t k = 5U; k < N; ++k) {
+    auto state = make_state(
+      1.0F * k, 0.5F, 0.1F, 2.0F, 0.3F, 0.01F, t0 + k * std::chrono::milliseconds{100LL});
+    state.state.front_wheel_angle_rad = 0.05F;
+    planner.record_state(state);
+  }
+
+  // The complete chunks can be read while recording goes on
+  RecordReplayPlanner reader{};
+  reader.readTrajectoryBufferFromFile(file_name);
+  EXPECT_EQ(reader.get_record_length(), 2U * TrajectoryRecordWriter::CHUNK_SIZE);
+
+  planner.close_record_file();
+  reader.readTrajectoryBufferFromFile(file_name);
+  EXPECT_EQ(std::remove(file_name.c_str()), 0);
+  ASSERT_EQ(reader.get_record_length(), static_cast<std::size_t>(N));
+
+  // The recorded fields are restored exactly
+  const auto state = make_state(0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, t0);
+  const auto & expected = planner.plan(state);
+  const auto & actual = reader.plan(state);
+  ASSERT_EQ(expected.points.size(), actual.points.size());
+  for (std::size_t k = {}; k < expected.points.size(); ++k) {
+    const auto & p0 = expected.points[k];
+    const auto & p1 = actual.points[k];
+    EXPECT_EQ(p0.pose.position.x, p1.pose.position.x);
+    EXPECT_EQ(p0.pose.position.y, p1.pose.position.y);
+    EXPECT_EQ(p0.pose.orientation.z, p1.pose.orientation.z);
+    EXPECT_EQ(p0.pose.orientation.w, p1.pose.orientation.w);
+    EXPECT_EQ(p0.longitudinal_velocity_mps, p1.longitudinal_velocity_mps);
+    EXPECT_EQ(p0.acceleration_mps2, p1.acceleration_mps2);
+    EXPECT_EQ(p0.heading_rate_rps, p1.heading_rate_rps);
+    EXPECT_EQ(p0.front_wheel_angle_rad, p1.front_wheel_angle_rad);
+    EXPECT_EQ(p0.time_from_start.sec, p1.time_from_start.sec);
+    EXPECT_EQ(p0.time_from_start.nanosec, p1.time_from_start.nanosec);
+  }
+}
+
+TEST(RecordreplayWriteReadTrajectory, ReadTextTrajectory)
+{
+  std::string file_name("text_test.trajectory");
+  {
+    std::ofstream ofs(file_name);
+    ofs << "t_sec, t_nanosec, x, y, orientation_x, orientation_y, orientation_z, " <<
+      "orientation_w, longitudinal_velocity_mps, lateral_velocity_mps, acceleration_mps2, " <<
+      "heading_rate_rps, front_wheel_angle_rad, rear_wheel_angle_rad" << std::endl;
+    for (uint32_t k = {}; k < 3U; ++k) {
+      ofs << "0, 0, " << k << ", 1, 0, 0, 0, 1, 2.5, 0, 0, 0, 0, 0" << std::endl;
+    }
+  }
+
+  RecordReplayPlanner planner{};
+  planner.readTrajectoryBufferFromFile(file_name);
+  EXPECT_EQ(std::remove(file_name.c_str()), 0);
+  ASSERT_EQ(planner.get_record_length(), 3U);
+
+  const auto t0 = system_clock::from_time_t({});
+  const auto & trajectory = planner.plan(make_state(0.0F, 1.0F, 0.0F, 0.0F, 0.0F, 0.0F, t0));
+  for (uint32_t k = {}; k < 2U; ++k) {
+    EXPECT_EQ(1.0F * k, trajectory.points[k].pose.position.x);
+    EXPECT_EQ(2.5F, trajectory.points[k].longitudinal_velocity_mps);
+  }
+}
+
+TEST(RecordreplayWriteReadTrajectory, ReadInvalidRecordFile)
+{
+  using motion::planning::recordreplay_planner::kTrajectoryRecordMagic;
+  std::string file_name("invalid_test.trajectory");
+  {
+    // Magic bytes and an unknown version, but no complete header
+    std::ofstream ofs(file_name, std::ios::binary);
+    ofs.write(kTrajectoryRecordMagic, sizeof(kTrajectoryRecordMagic));
+    const std::uint32_t version = 1000U;
+    ofs.write(reinterpret_cast<const char *>(&version), sizeof(version));
+  }
+
+  RecordReplayPlanner planner{};
+  EXPECT_THROW(planner.readTrajectoryBufferFromFile(file_name), std::runtime_error);
+  EXPECT_EQ(std::remove(file_name.c_str()), 0);
+}
+
 TEST(RecordreplayReachGoal, checkReachGoalCondition)
 {
   const auto N = 6;
@@ -279,15 +279,10 @@ rclcpp_action::CancelResponse RecordReplayPlannerNode::record_handle_cancel(
   if (m_planner->is_recording()) {
     RCLCPP_INFO(this->get_logger(), "Cancel recording");
     m_planner->stop_recording();
+    (void)goal_handle;
 
-    std::string record_path = goal_handle->get_goal()->record_path;
-
-    // If a path is specified
-    if (record_path.length() > 0) {
-      // Write trajectory to file
-      m_planner->writeTrajectoryBufferToFile(
-        goal_handle->get_goal()->record_path);
-    }
+    // Write the states still buffered by the record file, if a path was specified
+    m_planner->close_record_file();
   }
 
   return rclcpp_action::CancelResponse::ACCEPT;
@@ -299,6 +294,12 @@ void RecordReplayPlannerNode::record_handle_accepted(
   // Store the goal handle otherwise the action gets canceled immediately
   m_recordgoalhandle = goal_handle;
   m_planner->clear_record();
+
+  // If a path is specified, the states are streamed to the file while recording
+  const auto & record_path = goal_handle->get_goal()->record_path;
+  if (record_path.length() > 0) {
+    m_planner->open_record_file(record_path);
+  }
   m_planner->start_recording();
 
   // If a path was recorded previously, clear the markers